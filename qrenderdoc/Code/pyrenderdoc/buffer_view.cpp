@@ -0,0 +1,303 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2022 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include <Python.h>
+#include <string.h>
+
+#include "renderdoc_replay.h"
+
+#include "buffer_view.h"
+
+PyTypeObject BufferViewType = {PyVarObject_HEAD_INIT(NULL, 0)};
+
+static BufferViewObject *BufferView_Alloc(const byte *data, size_t size)
+{
+  PyTypeObject *type = GetBufferViewType();
+  if(!type)
+    return NULL;
+
+  BufferViewObject *ret = PyObject_New(BufferViewObject, type);
+  if(!ret)
+    return NULL;
+
+  ret->owned = NULL;
+  ret->base = NULL;
+  ret->data = data;
+  ret->size = (Py_ssize_t)size;
+  ret->itemsize = 1;
+  ret->stride = 1;
+  ret->count = (Py_ssize_t)size;
+  strcpy(ret->format, "B");
+
+  return ret;
+}
+
+PyObject *BufferView_Own(bytebuf &data)
+{
+  bytebuf *owned = new bytebuf;
+  owned->swap(data);
+
+  BufferViewObject *ret = BufferView_Alloc(owned->data(), owned->size());
+  if(!ret)
+  {
+    delete owned;
+    return NULL;
+  }
+
+  ret->owned = owned;
+  return (PyObject *)ret;
+}
+
+PyObject *BufferView_Borrow(PyObject *owner, const bytebuf &data)
+{
+  BufferViewObject *ret = BufferView_Alloc(data.data(), data.size());
+  if(!ret)
+    return NULL;
+
+  ret->base = owner;
+  Py_XINCREF(ret->base);
+
+  return (PyObject *)ret;
+}
+
+static void BufferView_dealloc(PyObject *self)
+{
+  BufferViewObject *view = (BufferViewObject *)self;
+
+  delete view->owned;
+  Py_XDECREF(view->base);
+
+  Py_TYPE(self)->tp_free(self);
+}
+
+static int BufferView_getbuffer(PyObject *self, Py_buffer *buf, int flags)
+{
+  BufferViewObject *view = (BufferViewObject *)self;
+
+  buf->obj = NULL;
+
+  if((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE)
+  {
+    PyErr_SetString(PyExc_BufferError, "BufferView is read-only");
+    return -1;
+  }
+
+  const bool strided = (flags & PyBUF_STRIDES) == PyBUF_STRIDES;
+
+  if(!strided && view->stride != view->itemsize)
+  {
+    PyErr_SetString(PyExc_BufferError, "BufferView is not contiguous");
+    return -1;
+  }
+
+  buf->obj = self;
+  Py_INCREF(self);
+
+  buf->buf = (void *)view->data;
+  buf->len = view->count * view->itemsize;
+  buf->readonly = 1;
+  buf->itemsize = view->itemsize;
+  buf->format = (flags & PyBUF_FORMAT) ? view->format : NULL;
+  buf->ndim = 1;
+  buf->shape = (flags & PyBUF_ND) ? &view->count : NULL;
+  buf->strides = strided ? &view->stride : NULL;
+  buf->suboffsets = NULL;
+  buf->internal = NULL;
+
+  return 0;
+}
+
+static Py_ssize_t BufferView_length(PyObject *self)
+{
+  return ((BufferViewObject *)self)->count;
+}
+
+static Py_ssize_t BufferView_CalcSize(const char *format)
+{
+  static PyObject *calcsize = NULL;
+
+  if(!calcsize)
+  {
+    PyObject *structmod = PyImport_ImportModule("struct");
+    if(!structmod)
+      return -1;
+
+    calcsize = PyObject_GetAttrString(structmod, "calcsize");
+    Py_DECREF(structmod);
+
+    if(!calcsize)
+      return -1;
+  }
+
+  PyObject *result = PyObject_CallFunction(calcsize, "s", format);
+  if(!result)
+    return -1;
+
+  Py_ssize_t ret = PyLong_AsSsize_t(result);
+  Py_DECREF(result);
+  return ret;
+}
+
+static PyObject *BufferView_typed(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+  BufferViewObject *view = (BufferViewObject *)self;
+
+  static const char *kwlist[] = {"format", "stride", "count", "offset", NULL};
+
+  const char *format = NULL;
+  Py_ssize_t stride = 0, count = 0, offset = 0;
+
+  if(!PyArg_ParseTupleAndKeywords(args, kwargs, "s|nnn", (char **)kwlist, &format, &stride,
+                                  &count, &offset))
+    return NULL;
+
+  if(strlen(format) >= sizeof(view->format))
+  {
+    PyErr_SetString(PyExc_ValueError, "format string is too long");
+    return NULL;
+  }
+
+  Py_ssize_t itemsize = BufferView_CalcSize(format);
+  if(itemsize < 0)
+    return NULL;
+
+  if(itemsize == 0)
+  {
+    PyErr_SetString(PyExc_ValueError, "format must describe at least one byte");
+    return NULL;
+  }
+
+  if(stride == 0)
+    stride = itemsize;
+
+  if(stride < 0 || count < 0 || offset < 0 || offset > view->size)
+  {
+    PyErr_SetString(PyExc_ValueError, "stride, count and offset must be positive and in bounds");
+    return NULL;
+  }
+
+  Py_ssize_t available = view->size - offset;
+
+  // by default take as many whole elements as fit
+  if(count == 0)
+    count = available < itemsize ? 0 : (available - itemsize) / stride + 1;
+
+  if(count > 0 && (available < itemsize || (count - 1) > (available - itemsize) / stride))
+  {
+    PyErr_SetString(PyExc_ValueError, "typed view extends past the end of the buffer");
+    return NULL;
+  }
+
+  BufferViewObject *ret = BufferView_Alloc(view->data + offset, (size_t)available);
+  if(!ret)
+    return NULL;
+
+  // keep whichever object owns the storage alive
+  ret->base = view->owned ? self : view->base;
+  Py_XINCREF(ret->base);
+
+  ret->itemsize = itemsize;
+  ret->stride = stride;
+  ret->count = count;
+  strcpy(ret->format, format);
+
+  return (PyObject *)ret;
+}
+
+static PyObject *BufferView_get_format(PyObject *self, void *)
+{
+  return PyUnicode_FromString(((BufferViewObject *)self)->format);
+}
+
+static PyObject *BufferView_get_itemsize(PyObject *self, void *)
+{
+  return PyLong_FromSsize_t(((BufferViewObject *)self)->itemsize);
+}
+
+static PyObject *BufferView_get_stride(PyObject *self, void *)
+{
+  return PyLong_FromSsize_t(((BufferViewObject *)self)->stride);
+}
+
+static PyObject *BufferView_get_count(PyObject *self, void *)
+{
+  return PyLong_FromSsize_t(((BufferViewObject *)self)->count);
+}
+
+static PyMethodDef BufferView_methods[] = {
+    {"Typed", (PyCFunction)(void (*)(void))BufferView_typed, METH_VARARGS | METH_KEYWORDS,
+     R"(Creates a view of the same data interpreted as an array of elements, without copying.
+
+:param str format: The ``struct`` module format of each element, e.g. ``'4f'`` or ``'<HH'``.
+:param int stride: The byte stride between elements, or 0 to tightly pack them.
+:param int count: The number of elements, or 0 to use as many as fit.
+:param int offset: The byte offset of the first element.
+:return: The typed view, which keeps this view's data alive.
+:rtype: BufferView
+)"},
+    {NULL},
+};
+
+static PyGetSetDef BufferView_getset[] = {
+    {(char *)"format", &BufferView_get_format, NULL,
+     (char *)"The ``struct`` module format of each element.", NULL},
+    {(char *)"itemsize", &BufferView_get_itemsize, NULL,
+     (char *)"The size in bytes of each element.", NULL},
+    {(char *)"stride", &BufferView_get_stride, NULL,
+     (char *)"The byte stride between consecutive elements.", NULL},
+    {(char *)"count", &BufferView_get_count, NULL, (char *)"The number of elements.", NULL},
+    {NULL},
+};
+
+static PyBufferProcs BufferView_bufferprocs = {&BufferView_getbuffer, NULL};
+
+static PySequenceMethods BufferView_sequencemethods = {&BufferView_length};
+
+PyTypeObject *GetBufferViewType()
+{
+  if(BufferViewType.tp_flags & Py_TPFLAGS_READY)
+    return &BufferViewType;
+
+  BufferViewType.tp_name = "renderdoc.BufferView";
+  BufferViewType.tp_basicsize = sizeof(BufferViewObject);
+  BufferViewType.tp_flags = Py_TPFLAGS_DEFAULT;
+  BufferViewType.tp_doc =
+      R"(A read-only view of binary data returned from the replay, such as buffer or texture contents,
+that doesn't copy the data into a ``bytes`` object.
+
+It supports the buffer protocol, so it can be passed to ``memoryview``, ``bytes``, the ``struct``
+module or ``numpy.frombuffer`` directly. :meth:`Typed` creates strided views of elements for
+interleaved data.
+)";
+  BufferViewType.tp_dealloc = &BufferView_dealloc;
+  BufferViewType.tp_as_buffer = &BufferView_bufferprocs;
+  BufferViewType.tp_as_sequence = &BufferView_sequencemethods;
+  BufferViewType.tp_methods = BufferView_methods;
+  BufferViewType.tp_getset = BufferView_getset;
+
+  if(PyType_Ready(&BufferViewType) < 0)
+    return NULL;
+
+  return &BufferViewType;
+}
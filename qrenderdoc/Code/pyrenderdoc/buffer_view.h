@@ -0,0 +1,64 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2022 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+// A read-only python object exposing a bytebuf through the buffer protocol without copying it
+// into a bytes object. It can either own the bytebuf (moved in from a by-value return), or borrow
+// one that lives in C++ - in which case it holds a reference to the python object that owns the
+// bytebuf, so the view stays valid as long as the owner doesn't replace the bytebuf.
+//
+// Views can be re-interpreted with a struct-style format, a stride and a count, which gives a
+// 1D strided buffer that numpy and memoryview can consume directly, e.g. for interleaved vertex
+// data. Typed views keep a reference to the view that owns the storage.
+
+struct BufferViewObject
+{
+  PyObject_HEAD;
+  // the storage, if this view owns it
+  bytebuf *owned;
+  // the object that owns the storage, if this view doesn't: either the owning view this is a typed
+  // view of, or the python object a borrowed bytebuf belongs to
+  PyObject *base;
+  // the first element, and the number of bytes available from there for sub-views
+  const byte *data;
+  Py_ssize_t size;
+  // the layout exposed through the buffer protocol
+  Py_ssize_t itemsize;
+  Py_ssize_t stride;
+  Py_ssize_t count;
+  char format[32];
+};
+
+extern PyTypeObject BufferViewType;
+
+// returns NULL with a python error set if the type couldn't be initialised
+PyTypeObject *GetBufferViewType();
+
+// takes ownership of the contents of data, leaving it empty
+PyObject *BufferView_Own(bytebuf &data);
+
+// references data in place, keeping owner alive for as long as the view exists
+PyObject *BufferView_Borrow(PyObject *owner, const bytebuf &data);
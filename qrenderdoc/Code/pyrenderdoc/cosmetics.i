@@ -181,12 +181,16 @@ DEFINE_SAFE_EQUALITY(EnvironmentModification)
 DEFINE_SAFE_EQUALITY(EventUsage)
 DEFINE_SAFE_EQUALITY(PathEntry)
 DEFINE_SAFE_EQUALITY(PixelModification)
+DEFINE_SAFE_EQUALITY(PixelHistoryResult)
 DEFINE_SAFE_EQUALITY(ResourceDescription)
 DEFINE_SAFE_EQUALITY(ResourceId)
 DEFINE_SAFE_EQUALITY(LineColumnInfo)
 DEFINE_SAFE_EQUALITY(ShaderCompileFlag)
 DEFINE_SAFE_EQUALITY(ShaderConstant)
 DEFINE_SAFE_EQUALITY(ShaderDebugState)
+DEFINE_SAFE_EQUALITY(ShaderDebugResult)
+DEFINE_SAFE_EQUALITY(DebugPixelInvocation)
+DEFINE_SAFE_EQUALITY(DebugThreadInvocation)
 DEFINE_SAFE_EQUALITY(ShaderResource)
 DEFINE_SAFE_EQUALITY(ShaderSampler)
 DEFINE_SAFE_EQUALITY(ShaderSourceFile)
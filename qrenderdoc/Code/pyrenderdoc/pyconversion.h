@@ -519,6 +519,8 @@ struct TypeConversion<rdcpair<A, B>, false>
   static PyObject *ConvertToPy(const rdcpair<A, B> &in) { return ConvertToPy(in, NULL); }
 };
 
+#include "buffer_view.h"
+
 // specialisation for bytebuf
 template <>
 struct TypeConversion<bytebuf, false>
@@ -527,13 +529,36 @@ struct TypeConversion<bytebuf, false>
   // nicer failure error messages out with the index that failed
   static int ConvertFromPy(PyObject *in, bytebuf &out, int *failIdx)
   {
-    if(!PyBytes_Check(in))
+    if(PyBytes_Check(in))
+    {
+      Py_ssize_t len = PyBytes_Size(in);
+
+      out.resize((size_t)len);
+      memcpy(out.data(), PyBytes_AsString(in), out.size());
+
+      return SWIG_OK;
+    }
+
+    // accept anything else that exposes its data, such as a BufferView or bytearray
+    if(!PyObject_CheckBuffer(in))
       return SWIG_TypeError;
 
-    Py_ssize_t len = PyBytes_Size(in);
+    Py_buffer buf;
+    if(PyObject_GetBuffer(in, &buf, PyBUF_FULL_RO) != 0)
+    {
+      PyErr_Clear();
+      return SWIG_TypeError;
+    }
+
+    out.resize((size_t)buf.len);
+    int ret = PyBuffer_ToContiguous(out.data(), &buf, buf.len, 'C');
+    PyBuffer_Release(&buf);
 
-    out.resize((size_t)len);
-    memcpy(out.data(), PyBytes_AsString(in), out.size());
+    if(ret != 0)
+    {
+      PyErr_Clear();
+      return SWIG_TypeError;
+    }
 
     return SWIG_OK;
   }
@@ -545,6 +570,9 @@ struct TypeConversion<bytebuf, false>
     return SWIG_Py_Void();
   }
 
+  // this still copies. The bytebuf may be a member of an object python doesn't own, and bytes
+  // objects are what existing scripts expect. Functions returning large data by value have
+  // *View variants that return a BufferView owning the data instead.
   static PyObject *ConvertToPy(const bytebuf &in, int *failIdx)
   {
     return PyBytes_FromStringAndSize((const char *)in.data(), (Py_ssize_t)in.size());
@@ -74,6 +74,9 @@ VA_IGNORE_REST_OF_FILE
 %}
 %init %{
   PyDateTime_IMPORT;
+
+  if(GetBufferViewType())
+    PyDict_SetItemString(d, "BufferView", (PyObject *)&BufferViewType);
 %}
 
 %include "pyconversion.i"
@@ -318,6 +321,82 @@ Invalid if the object is not actually a string.
   PyObject *AsString() { return ConvertToPy($self->data.str); }
 }
 
+// with -builtin the wrapper's self is the python object being called on, which borrowed views
+// reference to keep their storage alive
+%typemap(in, numinputs=0) PyObject *viewOwner { $1 = self; }
+
+%extend SDFile {
+  %feature("docstring") R"(Returns a view of one of the file's buffers without copying it. The view
+borrows the buffer and keeps this file alive, but the buffer must not be replaced while the view is
+in use.
+
+:param int index: The index of the buffer.
+:return: A read-only view of the buffer contents.
+:rtype: BufferView
+)";
+  PyObject *GetBufferView(int index, PyObject *viewOwner)
+  {
+    if(index < 0 || index >= $self->buffers.count() || !$self->buffers[index])
+    {
+      PyErr_SetString(PyExc_IndexError, "buffer index out of range");
+      return NULL;
+    }
+
+    return BufferView_Borrow(viewOwner, *$self->buffers[index]);
+  }
+}
+
+%extend IReplayController {
+  %feature("docstring") R"(Retrieve the contents of a range of a buffer as a :class:`BufferView`,
+which takes ownership of the data instead of copying it into a ``bytes``. Otherwise identical to
+:meth:`GetBufferData`.
+
+:param ResourceId buff: The id of the buffer to retrieve data from.
+:param int offset: The byte offset to the start of the range.
+:param int len: The length of the range, or 0 to retrieve the rest of the bytes in the buffer.
+:return: A read-only view of the requested buffer contents.
+:rtype: BufferView
+)";
+  PyObject *GetBufferDataView(ResourceId buff, uint64_t offset, uint64_t len)
+  {
+    bytebuf data = $self->GetBufferData(buff, offset, len);
+    return BufferView_Own(data);
+  }
+
+  %feature("docstring") R"(Retrieve the contents of one subresource of a texture as a
+:class:`BufferView`, which takes ownership of the data instead of copying it into a ``bytes``.
+Otherwise identical to :meth:`GetTextureData`.
+
+:param ResourceId tex: The id of the texture to retrieve data from.
+:param Subresource sub: The subresource within this texture to use.
+:return: A read-only view of the requested texture contents.
+:rtype: BufferView
+)";
+  PyObject *GetTextureDataView(ResourceId tex, const Subresource &sub)
+  {
+    bytebuf data = $self->GetTextureData(tex, sub);
+    return BufferView_Own(data);
+  }
+}
+
+%extend ICaptureAccess {
+  %feature("docstring") R"(Get the raw byte contents of the specified section as a
+:class:`BufferView`, which takes ownership of the data instead of copying it into a ``bytes``.
+Otherwise identical to :meth:`GetSectionContents`.
+
+:param int index: The index of the section.
+:return: A read-only view of the raw contents of the section, if the index is valid.
+:rtype: BufferView
+)";
+  PyObject *GetSectionContentsView(int32_t index)
+  {
+    bytebuf data = $self->GetSectionContents(index);
+    return BufferView_Own(data);
+  }
+}
+
+  %feature("docstring") "";
+
 // add python array members that aren't in slots
 EXTEND_ARRAY_CLASS_METHODS(rdcarray)
 EXTEND_ARRAY_CLASS_METHODS(StructuredChunkList)
@@ -355,6 +434,8 @@ TEMPLATE_ARRAY_INSTANTIATE(rdcarray, int)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, float)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, uint32_t)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, uint64_t)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, int64_t)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, double)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, rdcstr)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, WindowingSystem)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ActionDescription)
@@ -370,6 +451,7 @@ TEMPLATE_ARRAY_INSTANTIATE(rdcarray, EnvironmentModification)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, EventUsage)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, PathEntry)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, PixelModification)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, PixelHistoryResult)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ResourceDescription)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ResourceId)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, LineColumnInfo)
@@ -377,6 +459,9 @@ TEMPLATE_ARRAY_INSTANTIATE(rdcarray, InstructionSourceInfo)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderCompileFlag)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderConstant)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderDebugState)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderDebugResult)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, DebugPixelInvocation)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, DebugThreadInvocation)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderMessage)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderResource)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderSampler)
@@ -387,6 +472,7 @@ TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderEncoding)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderVariableChange)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, DebugVariableReference)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, SourceVariableMapping)
+TEMPLATE_ARRAY_INSTANTIATE(rdcarray, SDQueryColumn)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, SigParameter)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, TextureDescription)
 TEMPLATE_ARRAY_INSTANTIATE(rdcarray, ShaderEntryPoint)
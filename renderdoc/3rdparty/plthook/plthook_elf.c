@@ -635,6 +635,31 @@ int plthook_enum(plthook_t *plthook, unsigned int *pos, const char **name_out, v
     return EOF;
 }
 
+int plthook_patch(plthook_t *plthook, void **addr, void *funcaddr, void **oldfunc)
+{
+#ifdef SUPPORT_RELRO
+    void *maddr = NULL;
+    if (plthook->relro_start <= (char*)addr && (char*)addr < plthook->relro_end) {
+        maddr = (void*)((size_t)addr & ~(page_size - 1));
+        if (mprotect(maddr, page_size, PROT_READ | PROT_WRITE) != 0) {
+            set_errmsg("Could not change the process memory protection at %p: %s",
+                       maddr, strerror(errno));
+            return PLTHOOK_INTERNAL_ERROR;
+        }
+    }
+#endif
+    if (oldfunc) {
+        *oldfunc = *addr;
+    }
+    *addr = funcaddr;
+#ifdef SUPPORT_RELRO
+    if (maddr != NULL) {
+        mprotect(maddr, page_size, PROT_READ);
+    }
+#endif
+    return 0;
+}
+
 int plthook_replace(plthook_t *plthook, const char *funcname, void *funcaddr, void **oldfunc)
 {
     size_t funcnamelen = strlen(funcname);
@@ -650,27 +675,7 @@ int plthook_replace(plthook_t *plthook, const char *funcname, void *funcaddr, vo
     while ((rv = plthook_enum(plthook, &pos, &name, &addr)) == 0) {
         if (strncmp(name, funcname, funcnamelen) == 0) {
             if (name[funcnamelen] == '\0' || name[funcnamelen] == '@') {
-#ifdef SUPPORT_RELRO
-                void *maddr = NULL;
-                if (plthook->relro_start <= (char*)addr && (char*)addr < plthook->relro_end) {
-                    maddr = (void*)((size_t)addr & ~(page_size - 1));
-                    if (mprotect(maddr, page_size, PROT_READ | PROT_WRITE) != 0) {
-                        set_errmsg("Could not change the process memory protection at %p: %s",
-                                   maddr, strerror(errno));
-                        return PLTHOOK_INTERNAL_ERROR;
-                    }
-                }
-#endif
-                if (oldfunc) {
-                    *oldfunc = *addr;
-                }
-                *addr = funcaddr;
-#ifdef SUPPORT_RELRO
-                if (maddr != NULL) {
-                    mprotect(maddr, page_size, PROT_READ);
-                }
-#endif
-                return 0;
+                return plthook_patch(plthook, addr, funcaddr, oldfunc);
             }
         }
     }
@@ -0,0 +1,796 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2022 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "adb_client.h"
+#include "common/formatting.h"
+#include "common/threading.h"
+#include "core/settings.h"
+#include "strings/string_utils.h"
+
+RDOC_CONFIG(bool, Android_UseAdbServerProtocol, true,
+            "Send adb commands directly to the adb server where possible, instead of running the "
+            "adb executable for each one.");
+
+namespace Android
+{
+// some commands like 'pm dump' can take a while before they produce any output
+static const uint32_t AdbCommandTimeoutMS = 60 * 1000;
+
+// the most data the device accepts in one sync DATA message
+static const uint32_t AdbSyncMaxChunk = 64 * 1024;
+
+// the header of each packet in the shell protocol, followed by length bytes of data
+#pragma pack(push, 1)
+struct ShellPacketHeader
+{
+  uint8_t id;
+  uint32_t length;
+};
+#pragma pack(pop)
+
+enum ShellPacketId : uint8_t
+{
+  ShellStdout = 1,
+  ShellStderr = 2,
+  ShellExit = 3,
+};
+
+// the header of each sync request and response
+struct SyncHeader
+{
+  char id[4];
+  uint32_t length;
+};
+
+static SyncHeader MakeSyncHeader(const char *id, uint32_t length)
+{
+  SyncHeader ret;
+  memcpy(ret.id, id, 4);
+  ret.length = length;
+  return ret;
+}
+
+AdbClient::~AdbClient()
+{
+  for(auto it = m_Devices.begin(); it != m_Devices.end(); ++it)
+  {
+    if(it->second.sync)
+    {
+      SyncHeader quit = MakeSyncHeader("QUIT", 0);
+      it->second.sync->SendDataBlocking(&quit, sizeof(quit));
+      SAFE_DELETE(it->second.sync);
+    }
+  }
+}
+
+Network::Socket *AdbClient::Connect()
+{
+  Network::Socket *sock = Network::CreateClientSocket(m_Host, m_Port, 250);
+
+  if(sock)
+    sock->SetTimeout(AdbCommandTimeoutMS);
+
+  return sock;
+}
+
+bool AdbClient::SendRequest(Network::Socket *sock, const rdcstr &request)
+{
+  // requests are prefixed with their length as four hex digits
+  rdcstr message = StringFormat::Fmt("%04x", (uint32_t)request.size()) + request;
+  return sock->SendDataBlocking(message.c_str(), (uint32_t)message.size());
+}
+
+static bool ReadHexLength(Network::Socket *sock, uint32_t &length)
+{
+  char hex[5] = {};
+  if(!sock->RecvDataBlocking(hex, 4))
+    return false;
+
+  char *end = NULL;
+  length = (uint32_t)strtoul(hex, &end, 16);
+  return end == hex + 4;
+}
+
+bool AdbClient::ReadStatus(Network::Socket *sock)
+{
+  char status[4] = {};
+  if(!sock->RecvDataBlocking(status, 4))
+    return false;
+
+  if(!memcmp(status, "OKAY", 4))
+    return true;
+
+  uint32_t length = 0;
+  if(!memcmp(status, "FAIL", 4) && ReadHexLength(sock, length))
+  {
+    rdcstr message;
+    message.resize(length);
+    if(sock->RecvDataBlocking(message.data(), length))
+      RDCDEBUG("adb server refused request: %s", message.c_str());
+  }
+
+  return false;
+}
+
+Network::Socket *AdbClient::OpenService(const rdcstr &deviceID, const rdcstr &service,
+                                        bool &refused)
+{
+  refused = false;
+
+  Network::Socket *sock = Connect();
+  if(!sock)
+    return NULL;
+
+  // switch the connection over to the device, then ask for the service on it
+  rdcstr transport = deviceID.empty() ? "host:transport-any" : "host:transport:" + deviceID;
+
+  if(SendRequest(sock, transport) && ReadStatus(sock))
+  {
+    if(SendRequest(sock, service))
+    {
+      if(ReadStatus(sock))
+        return sock;
+
+      refused = sock->Connected();
+    }
+  }
+
+  SAFE_DELETE(sock);
+  return NULL;
+}
+
+bool AdbClient::ReadShellV2(Network::Socket *sock, Process::ProcessResult &result)
+{
+  bytebuf data;
+
+  for(;;)
+  {
+    ShellPacketHeader header;
+    if(!sock->RecvDataBlocking(&header, sizeof(header)))
+      return false;
+
+    data.resize(header.length);
+    if(!sock->RecvDataBlocking(data.data(), header.length))
+      return false;
+
+    if(header.id == ShellStdout)
+      result.strStdout.append((const char *)data.data(), data.size());
+    else if(header.id == ShellStderr)
+      result.strStderror.append((const char *)data.data(), data.size());
+    else if(header.id == ShellExit && !data.empty())
+      result.retCode = data[0];
+
+    if(header.id == ShellExit)
+      return true;
+  }
+}
+
+bool AdbClient::ReadUntilClosed(Network::Socket *sock, rdcstr &output)
+{
+  Network::SocketReactor reactor;
+  reactor.Add(sock);
+
+  char buf[4096];
+
+  bool success = false;
+
+  while(sock->Connected())
+  {
+    if(!reactor.Wait(sock->GetTimeout()))
+      break;
+
+    // the socket is readable, so no data means the server closed the connection
+    uint32_t length = sizeof(buf);
+    if(!sock->RecvDataNonBlocking(buf, length) || length == 0)
+    {
+      success = true;
+      break;
+    }
+
+    output.append(buf, length);
+  }
+
+  reactor.Remove(sock);
+
+  return success;
+}
+
+bool AdbClient::ListDevices(Process::ProcessResult &result)
+{
+  Network::Socket *sock = Connect();
+  if(!sock)
+    return false;
+
+  bool success = false;
+
+  uint32_t length = 0;
+  if(SendRequest(sock, "host:devices") && ReadStatus(sock) && ReadHexLength(sock, length))
+  {
+    rdcstr devices;
+    devices.resize(length);
+
+    if(sock->RecvDataBlocking(devices.data(), length))
+    {
+      // match the output of 'adb devices'
+      result.strStdout = "List of devices attached\n" + devices + "\n";
+      result.strStderror.clear();
+      result.retCode = 0;
+      success = true;
+    }
+  }
+
+  SAFE_DELETE(sock);
+
+  return success;
+}
+
+bool AdbClient::Shell(const rdcstr &deviceID, const rdcstr &command,
+                      Process::ProcessResult &result)
+{
+  bool shellV2 = true;
+  {
+    SCOPED_LOCK(m_Lock);
+    shellV2 = m_Devices[deviceID].shellV2;
+  }
+
+  result.strStdout.clear();
+  result.strStderror.clear();
+  result.retCode = -1;
+
+  bool refused = false;
+
+  // the shell protocol keeps stdout and stderr apart and reports the exit code, but older devices
+  // only have the raw shell which mixes the two
+  if(shellV2)
+  {
+    Network::Socket *sock = OpenService(deviceID, "shell,v2,raw:" + command, refused);
+
+    if(sock)
+    {
+      // once the command is running we can't fall back to running it again through adb, so report
+      // what we got even if the connection drops before it exits
+      if(!ReadShellV2(sock, result))
+        RDCWARN("Lost connection to adb server while running '%s'", command.c_str());
+
+      SAFE_DELETE(sock);
+      return true;
+    }
+
+    if(!refused)
+      return false;
+
+    SCOPED_LOCK(m_Lock);
+    m_Devices[deviceID].shellV2 = false;
+  }
+
+  Network::Socket *sock = OpenService(deviceID, "shell:" + command, refused);
+
+  if(!sock)
+    return false;
+
+  if(!ReadUntilClosed(sock, result.strStdout))
+    RDCWARN("Lost connection to adb server while running '%s'", command.c_str());
+  else
+    result.retCode = 0;
+
+  SAFE_DELETE(sock);
+  return true;
+}
+
+bool AdbClient::SyncSend(Network::Socket *sock, const bytebuf &contents, const rdcstr &remotePath)
+{
+  // the path is followed by the file mode, in decimal
+  rdcstr spec = StringFormat::Fmt("%s,%u", remotePath.c_str(), 0644U);
+
+  SyncHeader header = MakeSyncHeader("SEND", (uint32_t)spec.size());
+  if(!sock->SendDataBlocking(&header, sizeof(header)) ||
+     !sock->SendDataBlocking(spec.c_str(), (uint32_t)spec.size()))
+    return false;
+
+  for(size_t offset = 0; offset < contents.size(); offset += AdbSyncMaxChunk)
+  {
+    uint32_t chunkSize = (uint32_t)RDCMIN(contents.size() - offset, (size_t)AdbSyncMaxChunk);
+
+    header = MakeSyncHeader("DATA", chunkSize);
+    if(!sock->SendDataBlocking(&header, sizeof(header)) ||
+       !sock->SendDataBlocking(contents.data() + offset, chunkSize))
+      return false;
+  }
+
+  // the length of DONE is the modification time to set on the file
+  header = MakeSyncHeader("DONE", (uint32_t)Timing::GetUTCTime());
+  if(!sock->SendDataBlocking(&header, sizeof(header)))
+    return false;
+
+  if(!sock->RecvDataBlocking(&header, sizeof(header)))
+    return false;
+
+  if(!memcmp(header.id, "OKAY", 4))
+    return true;
+
+  if(!memcmp(header.id, "FAIL", 4))
+  {
+    rdcstr message;
+    message.resize(header.length);
+    if(sock->RecvDataBlocking(message.data(), header.length))
+      RDCWARN("Failed to push to %s: %s", remotePath.c_str(), message.c_str());
+  }
+
+  return false;
+}
+
+bool AdbClient::Push(const rdcstr &deviceID, const rdcstr &localPath, const rdcstr &remotePath)
+{
+  bytebuf contents;
+  if(!FileIO::ReadAll(localPath, contents))
+    return false;
+
+  SCOPED_LOCK(m_Lock);
+
+  DeviceState &device = m_Devices[deviceID];
+
+  // the sync connection we have may have been closed by the device since we last used it, in which
+  // case try once more on a new one
+  for(int attempt = 0; attempt < 2; attempt++)
+  {
+    if(!device.sync)
+    {
+      bool refused = false;
+      device.sync = OpenService(deviceID, "sync:", refused);
+
+      if(!device.sync)
+        return false;
+    }
+
+    if(SyncSend(device.sync, contents, remotePath))
+      return true;
+
+    SAFE_DELETE(device.sync);
+  }
+
+  return false;
+}
+
+bool AdbClient::GetProperty(const rdcstr &deviceID, const rdcstr &name, rdcstr &value)
+{
+  if(!name.beginsWith("ro."))
+    return false;
+
+  {
+    SCOPED_LOCK(m_Lock);
+
+    DeviceState &device = m_Devices[deviceID];
+    if(device.propertiesFetched)
+    {
+      auto it = device.properties.find(name);
+      value = it == device.properties.end() ? rdcstr() : it->second;
+      return true;
+    }
+  }
+
+  Process::ProcessResult getprop;
+  if(!Shell(deviceID, "getprop", getprop) || getprop.retCode != 0)
+    return false;
+
+  // each property is listed as '[name]: [value]'
+  std::map<rdcstr, rdcstr> properties;
+
+  rdcarray<rdcstr> lines;
+  split(getprop.strStdout, lines, '\n');
+  for(rdcstr &line : lines)
+  {
+    line.trim();
+
+    int32_t sep = line.find("]: [");
+    if(line.size() < 6 || line[0] != '[' || line.back() != ']' || sep < 0)
+      continue;
+
+    rdcstr propName = line.substr(1, sep - 1);
+    if(propName.beginsWith("ro."))
+      properties[propName] = line.substr(sep + 4, line.size() - sep - 5);
+  }
+
+  SCOPED_LOCK(m_Lock);
+
+  DeviceState &device = m_Devices[deviceID];
+  device.properties.swap(properties);
+  device.propertiesFetched = true;
+
+  auto it = device.properties.find(name);
+  value = it == device.properties.end() ? rdcstr() : it->second;
+  return true;
+}
+
+void AdbClient::ResetDevice(const rdcstr &deviceID)
+{
+  SCOPED_LOCK(m_Lock);
+
+  auto it = m_Devices.find(deviceID);
+  if(it != m_Devices.end())
+    SAFE_DELETE(it->second.sync);
+}
+
+AdbClient *GetAdbClient()
+{
+  if(!Android_UseAdbServerProtocol())
+    return NULL;
+
+  // adb itself lets the server port be changed with this variable
+  static AdbClient *client = []() {
+    uint32_t port = 5037;
+    rdcstr portVar = Process::GetEnvVariable("ANDROID_ADB_SERVER_PORT");
+    if(!portVar.empty())
+      port = (uint32_t)atoi(portVar.c_str());
+    return new AdbClient("127.0.0.1", (uint16_t)port);
+  }();
+
+  return client;
+}
+};
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include <algorithm>
+#include "catch/catch.hpp"
+
+// a stand-in for the adb server with one device, which answers the few services the client uses
+struct FakeAdbServer
+{
+  FakeAdbServer()
+  {
+    for(uint16_t probe = 0; probe < 20 && !server; probe++)
+    {
+      server = Network::CreateServerSocket("localhost", port, 4);
+
+      if(!server)
+        port++;
+    }
+
+    if(server)
+      acceptThread = Threading::CreateThread([this]() { AcceptLoop(); });
+  }
+
+  ~FakeAdbServer()
+  {
+    Atomic::Inc32(&stop);
+
+    if(acceptThread)
+    {
+      Threading::JoinThread(acceptThread);
+      Threading::CloseThread(acceptThread);
+    }
+
+    for(Threading::ThreadHandle thread : clientThreads)
+    {
+      Threading::JoinThread(thread);
+      Threading::CloseThread(thread);
+    }
+
+    SAFE_DELETE(server);
+  }
+
+  int CountRequests(const rdcstr &request)
+  {
+    SCOPED_LOCK(lock);
+    return (int)std::count(requests.begin(), requests.end(), request);
+  }
+
+  Network::Socket *server = NULL;
+  uint16_t port = 8335;
+  bool shellV2 = true;
+
+  Threading::CriticalSection lock;
+  rdcarray<rdcstr> requests;
+  std::map<rdcstr, bytebuf> files;
+
+private:
+  void AcceptLoop()
+  {
+    while(Atomic::CmpExch32(&stop, 0, 0) == 0)
+    {
+      Network::Socket *client = server->AcceptClient(20);
+
+      if(client)
+        clientThreads.push_back(Threading::CreateThread([this, client]() {
+          Serve(client);
+          delete client;
+        }));
+    }
+  }
+
+  bool ReadRequest(Network::Socket *sock, rdcstr &request)
+  {
+    char hex[5] = {};
+    if(!sock->RecvDataBlocking(hex, 4))
+      return false;
+
+    request.resize(strtoul(hex, NULL, 16));
+    if(!sock->RecvDataBlocking(request.data(), (uint32_t)request.size()))
+      return false;
+
+    SCOPED_LOCK(lock);
+    requests.push_back(request);
+    return true;
+  }
+
+  void SendStatus(Network::Socket *sock, const rdcstr &failure)
+  {
+    rdcstr status = "OKAY";
+    if(!failure.empty())
+      status = StringFormat::Fmt("FAIL%04x", (uint32_t)failure.size()) + failure;
+    sock->SendDataBlocking(status.c_str(), (uint32_t)status.size());
+  }
+
+  void SendShellPacket(Network::Socket *sock, uint8_t id, const rdcstr &data)
+  {
+    Android::ShellPacketHeader header = {id, (uint32_t)data.size()};
+    sock->SendDataBlocking(&header, sizeof(header));
+    sock->SendDataBlocking(data.c_str(), (uint32_t)data.size());
+  }
+
+  void Serve(Network::Socket *sock)
+  {
+    rdcstr request;
+    if(!ReadRequest(sock, request))
+      return;
+
+    if(request == "host:devices")
+    {
+      rdcstr devices = "emulator-5554\tdevice\nabcdef\toffline\n";
+      SendStatus(sock, rdcstr());
+      rdcstr length = StringFormat::Fmt("%04x", (uint32_t)devices.size());
+      sock->SendDataBlocking(length.c_str(), 4);
+      sock->SendDataBlocking(devices.c_str(), (uint32_t)devices.size());
+      return;
+    }
+
+    if(request != "host:transport:emulator-5554" && request != "host:transport-any")
+    {
+      SendStatus(sock, "device not found");
+      return;
+    }
+
+    SendStatus(sock, rdcstr());
+
+    if(!ReadRequest(sock, request))
+      return;
+
+    if(request == "sync:")
+    {
+      SendStatus(sock, rdcstr());
+      ServeSync(sock);
+      return;
+    }
+
+    rdcstr command, out, err;
+    if(request.beginsWith("shell,v2,raw:"))
+    {
+      if(!shellV2)
+      {
+        SendStatus(sock, "unknown service");
+        return;
+      }
+      command = request.substr(13);
+    }
+    else if(request.beginsWith("shell:"))
+    {
+      command = request.substr(6);
+    }
+
+    uint8_t exitCode = 0;
+
+    if(command == "echo hi")
+    {
+      out = "hi\n";
+    }
+    else if(command == "fail")
+    {
+      err = "oops\n";
+      exitCode = 3;
+    }
+    else if(command == "getprop")
+    {
+      out = "[debug.foo]: [1]\n[ro.build.version.sdk]: [30]\n[ro.product.model]: [Pixel 4]\n";
+    }
+
+    SendStatus(sock, rdcstr());
+
+    if(!request.beginsWith("shell,v2,raw:"))
+    {
+      // the raw shell mixes the output together, and the exit code is lost
+      rdcstr all = out + err;
+      sock->SendDataBlocking(all.c_str(), (uint32_t)all.size());
+      return;
+    }
+
+    if(!out.empty())
+      SendShellPacket(sock, Android::ShellStdout, out);
+    if(!err.empty())
+      SendShellPacket(sock, Android::ShellStderr, err);
+    SendShellPacket(sock, Android::ShellExit, rdcstr((const char *)&exitCode, 1));
+  }
+
+  void ServeSync(Network::Socket *sock)
+  {
+    rdcstr path;
+    bytebuf contents;
+
+    Android::SyncHeader header;
+    while(sock->RecvDataBlocking(&header, sizeof(header)))
+    {
+      if(!memcmp(header.id, "SEND", 4))
+      {
+        path.resize(header.length);
+        if(!sock->RecvDataBlocking(path.data(), header.length))
+          return;
+        path = path.substr(0, path.find(','));
+        contents.clear();
+      }
+      else if(!memcmp(header.id, "DATA", 4))
+      {
+        size_t offset = contents.size();
+        contents.resize(offset + header.length);
+        if(!sock->RecvDataBlocking(contents.data() + offset, header.length))
+          return;
+      }
+      else if(!memcmp(header.id, "DONE", 4))
+      {
+        {
+          SCOPED_LOCK(lock);
+          files[path] = contents;
+        }
+
+        header = Android::MakeSyncHeader("OKAY", 0);
+        sock->SendDataBlocking(&header, sizeof(header));
+      }
+      else
+      {
+        return;
+      }
+    }
+  }
+
+  int32_t stop = 0;
+  Threading::ThreadHandle acceptThread = 0;
+  rdcarray<Threading::ThreadHandle> clientThreads;
+};
+
+TEST_CASE("Test adb server protocol client", "[android]")
+{
+  FakeAdbServer server;
+
+  REQUIRE(server.server);
+
+  Android::AdbClient *client = new Android::AdbClient("localhost", server.port);
+
+  Process::ProcessResult result;
+
+  SECTION("Listing devices")
+  {
+    REQUIRE(client->ListDevices(result));
+    CHECK(result.strStdout ==
+          "List of devices attached\nemulator-5554\tdevice\nabcdef\toffline\n\n");
+  };
+
+  SECTION("Shell commands")
+  {
+    REQUIRE(client->Shell("emulator-5554", "echo hi", result));
+    CHECK(result.strStdout == "hi\n");
+    CHECK(result.strStderror == "");
+    CHECK(result.retCode == 0);
+
+    REQUIRE(client->Shell("emulator-5554", "fail", result));
+    CHECK(result.strStdout == "");
+    CHECK(result.strStderror == "oops\n");
+    CHECK(result.retCode == 3);
+
+    // an unknown device fails so that adb itself can be run to report the error
+    CHECK_FALSE(client->Shell("nodevice", "echo hi", result));
+  };
+
+  SECTION("Shell commands on devices without the shell protocol")
+  {
+    server.shellV2 = false;
+
+    REQUIRE(client->Shell("emulator-5554", "echo hi", result));
+    CHECK(result.strStdout == "hi\n");
+    CHECK(result.retCode == 0);
+
+    REQUIRE(client->Shell("emulator-5554", "echo hi", result));
+    CHECK(result.strStdout == "hi\n");
+
+    // the shell protocol is only tried once
+    CHECK(server.CountRequests("shell,v2,raw:echo hi") == 1);
+    CHECK(server.CountRequests("shell:echo hi") == 2);
+  };
+
+  SECTION("Read-only properties are cached")
+  {
+    rdcstr value;
+    REQUIRE(client->GetProperty("emulator-5554", "ro.build.version.sdk", value));
+    CHECK(value == "30");
+    REQUIRE(client->GetProperty("emulator-5554", "ro.product.model", value));
+    CHECK(value == "Pixel 4");
+    REQUIRE(client->GetProperty("emulator-5554", "ro.missing", value));
+    CHECK(value == "");
+
+    // other properties can change, so they aren't cached
+    CHECK_FALSE(client->GetProperty("emulator-5554", "debug.foo", value));
+
+    CHECK(server.CountRequests("shell,v2,raw:getprop") == 1);
+  };
+
+  SECTION("Pushes share a sync connection")
+  {
+    rdcstr tempDir = FileIO::GetTempFolderFilename();
+    rdcstr small = StringFormat::Fmt("%s/renderdoc_adb_test_%u_a", tempDir.c_str(),
+                                     Process::GetCurrentPID());
+    rdcstr large = StringFormat::Fmt("%s/renderdoc_adb_test_%u_b", tempDir.c_str(),
+                                     Process::GetCurrentPID());
+
+    bytebuf smallContents = {1, 2, 3, 4};
+
+    // larger than the most that's sent in one message
+    bytebuf largeContents;
+    largeContents.resize(200 * 1024);
+    for(size_t i = 0; i < largeContents.size(); i++)
+      largeContents[i] = byte(i * 7);
+
+    FileIO::WriteAll(small, smallContents);
+    FileIO::WriteAll(large, largeContents);
+
+    CHECK(client->Push("emulator-5554", small, "/sdcard/a"));
+    CHECK(client->Push("emulator-5554", large, "/sdcard/b"));
+
+    FileIO::Delete(small);
+    FileIO::Delete(large);
+
+    SCOPED_LOCK(server.lock);
+    CHECK((server.files["/sdcard/a"] == smallContents));
+    CHECK((server.files["/sdcard/b"] == largeContents));
+    CHECK(std::count(server.requests.begin(), server.requests.end(), "sync:") == 1);
+  };
+
+  SAFE_DELETE(client);
+}
+
+TEST_CASE("Test adb server protocol client without a server", "[android]")
+{
+  uint16_t port = 0;
+
+  {
+    // find a port nothing is listening on
+    FakeAdbServer server;
+    REQUIRE(server.server);
+    port = server.port;
+  }
+
+  Android::AdbClient client("localhost", port);
+
+  Process::ProcessResult result;
+  CHECK_FALSE(client.ListDevices(result));
+  CHECK_FALSE(client.Shell("emulator-5554", "echo hi", result));
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -0,0 +1,89 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2022 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include <map>
+#include "os/os_specific.h"
+
+namespace Android
+{
+// a client for the adb server's host protocol, described in SERVICES.TXT, SYNC.TXT and
+// shell_protocol.h in the adb source. Talking to the server over its local socket is much cheaper
+// than launching the adb executable for every command. Every function returns false if the server
+// couldn't be reached or refused the request, so the caller can fall back to launching adb.
+class AdbClient
+{
+public:
+  AdbClient(const rdcstr &host, uint16_t port) : m_Host(host), m_Port(port) {}
+  ~AdbClient();
+
+  // the equivalent of 'adb devices'
+  bool ListDevices(Process::ProcessResult &result);
+
+  // runs a command in the device shell. Each command uses its own connection, since the server
+  // closes it when the command exits.
+  bool Shell(const rdcstr &deviceID, const rdcstr &command, Process::ProcessResult &result);
+
+  // copies a file to the device over a sync connection, which is kept open for later copies
+  bool Push(const rdcstr &deviceID, const rdcstr &localPath, const rdcstr &remotePath);
+
+  // returns a system property. The read-only ro.* properties can't change while the device is
+  // running, so they are all fetched the first time one is needed and then cached.
+  bool GetProperty(const rdcstr &deviceID, const rdcstr &name, rdcstr &value);
+
+  // forget any connection to the device, for when adbd on it restarts
+  void ResetDevice(const rdcstr &deviceID);
+
+private:
+  Network::Socket *Connect();
+  // refused is set if the server was reached but it or the device rejected the service
+  Network::Socket *OpenService(const rdcstr &deviceID, const rdcstr &service, bool &refused);
+  bool SendRequest(Network::Socket *sock, const rdcstr &request);
+  bool ReadStatus(Network::Socket *sock);
+  bool ReadShellV2(Network::Socket *sock, Process::ProcessResult &result);
+  bool ReadUntilClosed(Network::Socket *sock, rdcstr &output);
+  bool SyncSend(Network::Socket *sock, const bytebuf &contents, const rdcstr &remotePath);
+
+  struct DeviceState
+  {
+    // the sync connection, opened the first time a file is pushed
+    Network::Socket *sync = NULL;
+    // false if the device doesn't support the shell protocol which separates stdout and stderr
+    bool shellV2 = true;
+    bool propertiesFetched = false;
+    std::map<rdcstr, rdcstr> properties;
+  };
+
+  rdcstr m_Host;
+  uint16_t m_Port;
+
+  Threading::CriticalSection m_Lock;
+  std::map<rdcstr, DeviceState> m_Devices;
+};
+
+// the client for the adb server adb commands are run against, or NULL if the server protocol is
+// disabled
+AdbClient *GetAdbClient();
+};
@@ -26,6 +26,7 @@
 #include "core/core.h"
 #include "core/settings.h"
 #include "strings/string_utils.h"
+#include "adb_client.h"
 #include "android_utils.h"
 
 RDOC_CONFIG(rdcstr, Android_SDKDirPath, "",
@@ -324,17 +325,106 @@ Process::ProcessResult execCommand(const rdcstr &exe, const rdcstr &args, const
   Process::LaunchProcess(exe, workDir, args, true, &result);
   return result;
 }
+// run the commands we use most often through the adb server, without launching adb. Returns false
+// for anything else, or if the server can't be reached
+static bool adbServerCommand(const rdcstr &device, const rdcstr &args, bool silent,
+                             Process::ProcessResult &result)
+{
+  AdbClient *client = GetAdbClient();
+  if(!client)
+    return false;
+
+  if(args == "devices")
+    return client->ListDevices(result);
+
+  if(args.beginsWith("shell getprop ro.") && !args.substr(14).contains(' '))
+  {
+    // fetched with the rest of the read-only properties at most once
+    rdcstr value;
+    if(!client->GetProperty(device, args.substr(14), value))
+      return false;
+
+    result.strStdout = value + "\n";
+    result.strStderror.clear();
+    result.retCode = 0;
+    return true;
+  }
+
+  rdcstr command;
+
+  if(args.beginsWith("shell "))
+  {
+    command = args.substr(6);
+  }
+  else if(args.beginsWith("logcat "))
+  {
+    // this is what adb runs for logcat, with the arguments quoted so the device shell doesn't
+    // expand wildcards in them
+    rdcarray<rdcstr> logcatArgs;
+    split(args.substr(7), logcatArgs, ' ');
+
+    command = "export ANDROID_LOG_TAGS=\"\"; exec logcat";
+    for(const rdcstr &arg : logcatArgs)
+      if(!arg.empty() && !arg.contains('\''))
+        command += " '" + arg + "'";
+  }
+  else if(args.beginsWith("push \""))
+  {
+    // push "local" remote
+    int32_t quote = args.find('"', 6);
+    if(quote < 0)
+      return false;
+
+    rdcstr local = args.substr(6, quote - 6);
+    rdcstr remote = args.substr(quote + 1).trimmed();
+    if(remote.empty() || remote.contains(' ') || remote.contains('"'))
+      return false;
+
+    if(!silent)
+      RDCLOG("PUSH: %s to %s", local.c_str(), remote.c_str());
+
+    if(!client->Push(device, local, remote))
+      return false;
+
+    result.strStdout.clear();
+    result.strStderror.clear();
+    result.retCode = 0;
+    return true;
+  }
+  else
+  {
+    return false;
+  }
+
+  if(!silent)
+    RDCLOG("SHELL: %s", command.c_str());
+
+  return client->Shell(device, command, result);
+}
 Process::ProcessResult adbExecCommand(const rdcstr &device, const rdcstr &args,
                                       const rdcstr &workDir, bool silent)
 {
-  rdcstr adb = getToolPath(ToolDir::PlatformTools, "adb", false);
   Process::ProcessResult result;
+  if(adbServerCommand(device, args, silent, result))
+    return result;
+
+  rdcstr adb = getToolPath(ToolDir::PlatformTools, "adb", false);
   rdcstr deviceArgs;
   if(device.empty())
     deviceArgs = args;
   else
     deviceArgs = StringFormat::Fmt("-s %s %s", device.c_str(), args.c_str());
-  return execCommand(adb, deviceArgs, workDir, silent);
+  result = execCommand(adb, deviceArgs, workDir, silent);
+
+  // restarting adbd on the device closes any connections we have open to it
+  if(args == "root")
+  {
+    AdbClient *client = GetAdbClient();
+    if(client)
+      client->ResetDevice(device);
+  }
+
+  return result;
 }
 void initAdb()
 {
@@ -926,6 +926,28 @@ bucket when the pixel values are divided between ``minval`` and ``maxval``.
   virtual rdcarray<PixelModification> PixelHistory(ResourceId texture, uint32_t x, uint32_t y,
                                                    const Subresource &sub, CompType typeCast) = 0;
 
+  DOCUMENT(R"(Retrieve the history of modifications to several pixels on the selected texture at once.
+
+This returns the same results as calling :meth:`PixelHistory` for each pixel in turn, but allows the
+replay to share work between pixels - such as replaying the frame once to determine which events
+touched any of the pixels - which is significantly faster for more than a handful of pixels.
+
+.. note::
+  X and Y co-ordinates are always considered to be top-left, the same as :meth:`PixelHistory`.
+
+:param ResourceId texture: The texture to search for modifications.
+:param List[Tuple[int,int]] pixels: The x and y co-ordinates of each pixel to query.
+:param Subresource sub: The subresource within this texture to use.
+:param CompType typeCast: If possible interpret the texture with this type instead of its normal
+  type. See :meth:`PixelHistory`.
+:return: The history of each pixel, in the same order as the pixels were given. Pixels that are
+  out of bounds have an empty list of modifications.
+:rtype: List[PixelHistoryResult]
+)");
+  virtual rdcarray<PixelHistoryResult> PixelHistoryBatch(
+      ResourceId texture, const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels,
+      const Subresource &sub, CompType typeCast) = 0;
+
   DOCUMENT(R"(Retrieve a debugging trace from running a vertex shader.
 
 :param int vertid: The vertex ID as a 0-based index up to the number of vertices in the draw.
@@ -991,6 +1013,42 @@ completed, further calls will return an empty list.
 )");
   virtual void FreeTrace(ShaderDebugTrace *trace) = 0;
 
+  DOCUMENT(R"(Debug a batch of pixel shader invocations, running each to completion and returning only
+the final values of the requested variables.
+
+This is equivalent to calling :meth:`DebugPixel` for each invocation, then :meth:`ContinueDebug`
+until the debug finishes and finally :meth:`FreeTrace`, but without transferring any intermediate
+states. It's intended for automated use where the shader is evaluated for many invocations.
+
+The invocations are still debugged one after another on the replay side, each with its own setup,
+so the work done per invocation is the same as debugging it on its own. The saving is in not
+returning every step, and on a remote replay the whole batch is a single round trip.
+
+:param List[DebugPixelInvocation] pixels: The pixel shader invocations to debug.
+:param List[str] variables: The names of the debug variables to return at the end of each
+  invocation. Structure members and array elements can be named with a ``.member`` or ``[index]``
+  suffix. If the list is empty, the variables backing the shader's output signature are returned.
+:return: The results, one per invocation in the same order as :paramref:`pixels`.
+:rtype: List[ShaderDebugResult]
+)");
+  virtual rdcarray<ShaderDebugResult> DebugPixelBatch(const rdcarray<DebugPixelInvocation> &pixels,
+                                                      const rdcarray<rdcstr> &variables) = 0;
+
+  DOCUMENT(R"(Debug a batch of compute threads, running each to completion and returning only the
+final values of the requested variables.
+
+See :meth:`DebugPixelBatch` for details of how results are returned.
+
+:param List[DebugThreadInvocation] threads: The compute threads to debug.
+:param List[str] variables: The names of the debug variables to return at the end of each
+  invocation. If the list is empty, the variables backing the shader's output signature are
+  returned.
+:return: The results, one per invocation in the same order as :paramref:`threads`.
+:rtype: List[ShaderDebugResult]
+)");
+  virtual rdcarray<ShaderDebugResult> DebugThreadBatch(const rdcarray<DebugThreadInvocation> &threads,
+                                                       const rdcarray<rdcstr> &variables) = 0;
+
   DOCUMENT(R"(Retrieve a list of ways a given resource is used.
 
 :param ResourceId id: The id of the texture or buffer resource to be queried.
@@ -1389,6 +1447,9 @@ This function will block until the copy is fully complete, or an error has occur
 This is primarily useful for when a capture is only stored locally and must be replayed remotely, as
 the capture must be available on the machine where the replay happens.
 
+If a previous copy of the same file was interrupted, e.g. by the connection dropping, the copy
+resumes from where it left off.
+
 :param str filename: The path to the file on the local system.
 :param ProgressCallback progress: A callback that will be repeatedly called with an updated progress
   value for the copy. Can be ``None`` if no progress is desired.
@@ -1401,6 +1462,9 @@ the capture must be available on the machine where the replay happens.
 
 This function will block until the copy is fully complete, or an error has occurred.
 
+While the copy is in progress the file is written to ``localpath`` with ``.partial`` appended. If
+the copy is interrupted that file is kept, and a later copy to the same path resumes from it.
+
 :param str remotepath: The remote path where the file should be copied from.
 :param str localpath: The local path where the file should be saved.
 :param ProgressCallback progress: A callback that will be repeatedly called with an updated progress
@@ -2289,6 +2353,21 @@ extern "C" RENDERDOC_API int RENDERDOC_CC RENDERDOC_RunUnitTests(const rdcstr &c
 DOCUMENT("INTERNAL: Run functional tests.");
 extern "C" RENDERDOC_API int RENDERDOC_CC RENDERDOC_RunFunctionalTests(int pythonMinorVersion,
                                                                        const rdcarray<rdcstr> &args);
+
+DOCUMENT("INTERNAL: Benchmark capture file processing on a synthetic capture.");
+extern "C" RENDERDOC_API ResultDetails RENDERDOC_CC RENDERDOC_RunCaptureBenchmark(
+    uint32_t chunkCount, uint32_t bufferSize, SectionFlags compression, uint32_t iterations,
+    const rdcstr &tempDir, rdcstr &report);
+
+DOCUMENT("INTERNAL: Benchmark the per-message cost of logging.");
+extern "C" RENDERDOC_API ResultDetails RENDERDOC_CC RENDERDOC_RunLogBenchmark(uint32_t messageCount,
+                                                                            uint32_t threadCount,
+                                                                            rdcstr &report);
+
+DOCUMENT("INTERNAL: Benchmark WrappingPool allocation as the number of pools grows.");
+extern "C" RENDERDOC_API ResultDetails RENDERDOC_CC RENDERDOC_RunPoolBenchmark(uint32_t opsPerThread,
+                                                                             uint32_t threadCount,
+                                                                             rdcstr &report);
 #endif
 
 #if !defined(SWIG)
@@ -871,6 +871,141 @@ per-instruction information such as source line mapping, and source variables.
 
 DECLARE_REFLECTION_STRUCT(ShaderDebugTrace);
 
+DOCUMENT(R"(The parameters identifying a single pixel shader invocation to debug in a batch. See
+:meth:`ReplayController.DebugPixelBatch`.
+)");
+struct DebugPixelInvocation
+{
+  DOCUMENT("");
+  DebugPixelInvocation() = default;
+  DebugPixelInvocation(const DebugPixelInvocation &) = default;
+  DebugPixelInvocation &operator=(const DebugPixelInvocation &) = default;
+  DebugPixelInvocation(uint32_t x, uint32_t y, uint32_t sample, uint32_t primitive)
+      : x(x), y(y), sample(sample), primitive(primitive)
+  {
+  }
+
+  bool operator==(const DebugPixelInvocation &o) const
+  {
+    return x == o.x && y == o.y && sample == o.sample && primitive == o.primitive;
+  }
+  bool operator<(const DebugPixelInvocation &o) const
+  {
+    if(!(x == o.x))
+      return x < o.x;
+    if(!(y == o.y))
+      return y < o.y;
+    if(!(sample == o.sample))
+      return sample < o.sample;
+    if(!(primitive == o.primitive))
+      return primitive < o.primitive;
+    return false;
+  }
+
+  DOCUMENT("The x co-ordinate, as in :meth:`ReplayController.DebugPixel`.");
+  uint32_t x = 0;
+  DOCUMENT("The y co-ordinate, as in :meth:`ReplayController.DebugPixel`.");
+  uint32_t y = 0;
+  DOCUMENT("The multi-sampled sample. Ignored if non-multisampled texture.");
+  uint32_t sample = ~0U;
+  DOCUMENT(R"(Debug the pixel from this primitive if there's ambiguity. If set to
+:data:`ReplayController.NoPreference` then a random fragment writing to the co-ordinate is debugged.
+)");
+  uint32_t primitive = ~0U;
+};
+
+DECLARE_REFLECTION_STRUCT(DebugPixelInvocation);
+
+DOCUMENT(R"(The parameters identifying a single compute thread to debug in a batch. See
+:meth:`ReplayController.DebugThreadBatch`.
+)");
+struct DebugThreadInvocation
+{
+  DOCUMENT("");
+  DebugThreadInvocation() = default;
+  DebugThreadInvocation(const DebugThreadInvocation &) = default;
+  DebugThreadInvocation &operator=(const DebugThreadInvocation &) = default;
+  DebugThreadInvocation(const rdcfixedarray<uint32_t, 3> &groupid,
+                        const rdcfixedarray<uint32_t, 3> &threadid)
+      : groupid(groupid), threadid(threadid)
+  {
+  }
+
+  bool operator==(const DebugThreadInvocation &o) const
+  {
+    return groupid == o.groupid && threadid == o.threadid;
+  }
+  bool operator<(const DebugThreadInvocation &o) const
+  {
+    if(!(groupid == o.groupid))
+      return groupid < o.groupid;
+    if(!(threadid == o.threadid))
+      return threadid < o.threadid;
+    return false;
+  }
+
+  DOCUMENT(R"(The 3D workgroup index.
+
+:type: Tuple[int,int,int]
+)");
+  rdcfixedarray<uint32_t, 3> groupid = {0, 0, 0};
+  DOCUMENT(R"(The 3D thread index within the workgroup.
+
+:type: Tuple[int,int,int]
+)");
+  rdcfixedarray<uint32_t, 3> threadid = {0, 0, 0};
+};
+
+DECLARE_REFLECTION_STRUCT(DebugThreadInvocation);
+
+DOCUMENT(R"(The final result of running one shader invocation's debug to completion, as part of a
+batch debug such as :meth:`ReplayController.DebugPixelBatch`.
+)");
+struct ShaderDebugResult
+{
+  DOCUMENT("");
+  ShaderDebugResult() = default;
+  ShaderDebugResult(const ShaderDebugResult &) = default;
+  ShaderDebugResult &operator=(const ShaderDebugResult &) = default;
+#if !defined(SWIG)
+  ShaderDebugResult(ShaderDebugResult &&) = default;
+  ShaderDebugResult &operator=(ShaderDebugResult &&) = default;
+#endif
+
+  bool operator==(const ShaderDebugResult &o) const
+  {
+    return valid == o.valid && stepCount == o.stepCount && variables == o.variables;
+  }
+  bool operator<(const ShaderDebugResult &o) const
+  {
+    if(!(valid == o.valid))
+      return valid < o.valid;
+    if(!(stepCount == o.stepCount))
+      return stepCount < o.stepCount;
+    if(!(variables == o.variables))
+      return variables < o.variables;
+    return false;
+  }
+
+  DOCUMENT(R"(``True`` if the invocation could be debugged. If ``False`` then no shader ran for the
+requested invocation, or shader debugging is not supported, and :data:`variables` is empty.
+)");
+  bool valid = false;
+
+  DOCUMENT("The number of steps the invocation executed before finishing.");
+  uint32_t stepCount = 0;
+
+  DOCUMENT(R"(The final values of the requested variables once the invocation finished, in the same
+order as requested. Each variable is named with the name that was requested. Any requested variable
+that never existed in the invocation is returned with no contents.
+
+:type: List[ShaderVariable]
+)");
+  rdcarray<ShaderVariable> variables;
+};
+
+DECLARE_REFLECTION_STRUCT(ShaderDebugResult);
+
 DOCUMENT(R"(The information describing an input or output signature element describing the interface
 between shader stages.
 
@@ -1491,6 +1491,142 @@ private:
 
 DECLARE_REFLECTION_STRUCT(StructuredBufferList);
 
+DOCUMENT(R"(Describes a bulk query over the chunks in an :class:`SDFile`, see :meth:`SDFile.Query`.
+)");
+struct SDQuery
+{
+  DOCUMENT("");
+  SDQuery() = default;
+  SDQuery(const SDQuery &) = default;
+  SDQuery &operator=(const SDQuery &) = default;
+
+  DOCUMENT("Only chunks with this name are matched. If empty, chunks with any name are matched.");
+  rdcstr chunkName;
+
+  DOCUMENT(R"(Only chunks with this :data:`SDChunkMetaData.chunkID` are matched. If 0, chunks with
+any ID are matched.
+)");
+  uint32_t chunkID = 0;
+
+  DOCUMENT("The index of the first chunk in :data:`SDFile.chunks` to consider.");
+  uint32_t firstChunk = 0;
+
+  DOCUMENT("The index of the last chunk in :data:`SDFile.chunks` to consider, inclusive.");
+  uint32_t lastChunk = ~0U;
+
+  DOCUMENT(R"(The parameter paths to extract from each matched chunk, one column per path.
+
+A path is a list of child names separated by ``.``, and any name can be followed by ``[index]`` to
+select an element of an array, e.g. ``CreateInfo.extent.width`` or ``pRegions[0].size``. A path
+that doesn't follow this form, such as ``pRegions[x]``, ``pRegions[0`` or ``pRegions[0][1]``, is
+rejected and is missing in every row.
+
+:type: List[str]
+)");
+  rdcarray<rdcstr> paths;
+};
+
+DECLARE_REFLECTION_STRUCT(SDQuery);
+
+DOCUMENT(R"(One column of results from :meth:`SDFile.Query`, holding the value of one parameter path
+for every matched chunk.
+
+Only the array that corresponds to :data:`type` is filled in, with one entry for each matched chunk.
+Chunks where the path didn't resolve, or resolved to a value of a different kind than the first
+found value, have a default value and are listed in :data:`missingRows`.
+)");
+struct SDQueryColumn
+{
+  DOCUMENT("");
+  SDQueryColumn() = default;
+  SDQueryColumn(const SDQueryColumn &) = default;
+  SDQueryColumn &operator=(const SDQueryColumn &) = default;
+
+  bool operator==(const SDQueryColumn &o) const
+  {
+    return path == o.path && type == o.type && unsignedValues == o.unsignedValues &&
+           signedValues == o.signedValues && floatValues == o.floatValues &&
+           stringValues == o.stringValues && missingRows == o.missingRows;
+  }
+  bool operator<(const SDQueryColumn &o) const { return path < o.path; }
+
+  DOCUMENT("The parameter path that this column holds.");
+  rdcstr path;
+
+  DOCUMENT(R"(The :class:`SDBasic` type of the first value found for this path, or
+:data:`SDBasic.Null` if the path didn't resolve to a basic value in any matched chunk.
+
+:data:`SDBasic.UnsignedInteger`, :data:`SDBasic.Enum`, :data:`SDBasic.Boolean`,
+:data:`SDBasic.Character`, :data:`SDBasic.Resource` and :data:`SDBasic.Buffer` values are stored in
+:data:`unsignedValues`.
+)");
+  SDBasic type = SDBasic::Null;
+
+  DOCUMENT(R"(The values if this column holds unsigned integers, enums, booleans, characters,
+resource IDs or buffer indices.
+
+:type: List[int]
+)");
+  rdcarray<uint64_t> unsignedValues;
+
+  DOCUMENT(R"(The values if this column holds signed integers.
+
+:type: List[int]
+)");
+  rdcarray<int64_t> signedValues;
+
+  DOCUMENT(R"(The values if this column holds floating point numbers.
+
+:type: List[float]
+)");
+  rdcarray<double> floatValues;
+
+  DOCUMENT(R"(The values if this column holds strings.
+
+:type: List[str]
+)");
+  rdcarray<rdcstr> stringValues;
+
+  DOCUMENT(R"(The rows which have no value for this path.
+
+:type: List[int]
+)");
+  rdcarray<uint32_t> missingRows;
+};
+
+DECLARE_REFLECTION_STRUCT(SDQueryColumn);
+
+DOCUMENT("The results of :meth:`SDFile.Query` in columnar form, with one row per matched chunk.");
+struct SDQueryResult
+{
+  DOCUMENT("");
+  SDQueryResult() = default;
+  SDQueryResult(const SDQueryResult &) = default;
+  SDQueryResult &operator=(const SDQueryResult &) = default;
+
+  DOCUMENT(R"(The index in :data:`SDFile.chunks` of the chunk for each row.
+
+:type: List[int]
+)");
+  rdcarray<uint32_t> chunkIndices;
+
+  DOCUMENT(R"(The extracted values, one column for each of :data:`SDQuery.paths` in the same order.
+
+:type: List[SDQueryColumn]
+)");
+  rdcarray<SDQueryColumn> columns;
+};
+
+DECLARE_REFLECTION_STRUCT(SDQueryResult);
+
+struct SDFile;
+
+#if !defined(SWIG)
+extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_QueryStructuredFile(const SDFile &file,
+                                                                         const SDQuery &query,
+                                                                         SDQueryResult &result);
+#endif
+
 DOCUMENT("Contains the structured information in a file. Owns the buffers and chunks.");
 struct SDFile
 {
@@ -1561,6 +1697,20 @@ public:
     std::swap(version, other.version);
   }
 
+  DOCUMENT(R"(Extracts parameter values from many chunks at once. This is much faster than walking
+the chunks object by object from a script when scanning a large capture.
+
+:param SDQuery query: The chunks to match and parameter paths to extract.
+:return: The extracted values, with one row for each matched chunk.
+:rtype: SDQueryResult
+)");
+  SDQueryResult Query(const SDQuery &query) const
+  {
+    SDQueryResult ret;
+    RENDERDOC_QueryStructuredFile(*this, query, ret);
+    return ret;
+  }
+
 protected:
   SDFile(const SDFile &) = delete;
   SDFile &operator=(const SDFile &) = delete;
@@ -25,7 +25,9 @@
 
 #include "common.h"
 #include <stdarg.h>
+#include <stdlib.h>
 #include <string.h>
+#include <algorithm>
 #include "common/threading.h"
 #include "os/os_specific.h"
 #include "strings/string_utils.h"
@@ -265,11 +267,324 @@ uint64_t Log2Ceil(uint64_t value)
   return 64 - Bits::CountLeadingZeroes(value - 1);
 }
 #endif
-
 // deliberately leak so it doesn't get destroyed before our static RenderDoc destructor needs it
 static rdcstr *logfile = new rdcstr;
 static FileIO::LogFileHandle *logfileHandle = NULL;
 
+const int rdclog_outBufSize = 4 * 1024;
+
+// the log file is normally written by a background thread so that logging never waits on the disk
+// or on other threads. Messages are copied into one of a fixed set of rings - each thread starts
+// looking at its own ring so in practice threads don't share - and the flusher thread drains all of
+// them in a single write. Errors and fatal messages are still written immediately, after anything
+// already queued, and whatever is still queued is written out if the process crashes or exits.
+static const uint32_t LogRingCount = 16;
+static const uint32_t LogRingSize = 64 * 1024;
+// how long queued messages can wait before the flusher writes them out
+static const uint32_t LogFlushIntervalMS = 100;
+
+struct LogRing
+{
+  // non-zero while a thread is logging through this ring
+  int32_t busy;
+  // the total bytes ever queued and written out. The difference between them is what's queued
+  int64_t head;
+  int64_t tail;
+  byte data[LogRingSize];
+
+  // the buffer a message is formatted into while this ring is held
+  char format[rdclog_outBufSize + 3];
+};
+
+// each queued message is this header followed by the text, wrapping around the end of the ring
+struct LogMessageHeader
+{
+  // messages are written out in this order, since threads queue into different rings
+  int64_t sequence;
+  uint32_t length;
+};
+
+// these are all allocated once and deliberately leaked, like the filename above
+static LogRing *logRings = NULL;
+static int64_t logSequence = 0;
+static int32_t logAsyncEnabled = 0;
+// non-zero while the rings are being written out, so only one thread drains them at a time
+static int32_t logDraining = 0;
+// each flusher thread runs until this changes from the value it was started with, so a thread that
+// was stopped without being joined can't be kept running by the next one starting
+static int32_t logFlushGeneration = 0;
+static Threading::ThreadHandle logFlushThread = 0;
+static Threading::Semaphore *logFlushWake = NULL;
+static Threading::Semaphore *logFlushExited = NULL;
+
+// held while writing to the log file, so queued messages and immediate messages stay in order
+static Threading::CriticalSection &LogFileLock()
+{
+  static Threading::CriticalSection *lock = new Threading::CriticalSection();
+  return *lock;
+}
+
+static LogRing *AcquireLogRing()
+{
+  if(Atomic::CmpExch32(&logAsyncEnabled, 1, 1) != 1)
+    return NULL;
+
+  // spread threads over the rings. Thread IDs can be aligned pointers, so hash them first
+  const uint64_t id = Threading::GetCurrentID() * 0x9E3779B97F4A7C15ULL;
+  const uint32_t start = uint32_t(id >> 32) % LogRingCount;
+
+  for(uint32_t i = 0; i < LogRingCount; i++)
+  {
+    LogRing *ring = &logRings[(start + i) % LogRingCount];
+    if(Atomic::CmpExch32(&ring->busy, 0, 1) == 0)
+      return ring;
+  }
+
+  return NULL;
+}
+
+static void ReleaseLogRing(LogRing *ring)
+{
+  if(ring)
+    Atomic::CmpExch32(&ring->busy, 1, 0);
+}
+
+static void CopyToLogRing(LogRing *ring, int64_t offset, const void *src, uint32_t length)
+{
+  const uint32_t start = uint32_t(offset % LogRingSize);
+  const uint32_t first = RDCMIN(length, LogRingSize - start);
+  memcpy(ring->data + start, src, first);
+  memcpy(ring->data, (const byte *)src + first, length - first);
+}
+
+static void CopyFromLogRing(const LogRing *ring, int64_t offset, void *dst, uint32_t length)
+{
+  const uint32_t start = uint32_t(offset % LogRingSize);
+  const uint32_t first = RDCMIN(length, LogRingSize - start);
+  memcpy(dst, ring->data + start, first);
+  memcpy((byte *)dst + first, ring->data, length - first);
+}
+
+static void AppendFromLogRing(const LogRing *ring, int64_t offset, uint32_t length)
+{
+  const uint32_t start = uint32_t(offset % LogRingSize);
+  const uint32_t first = RDCMIN(length, LogRingSize - start);
+  FileIO::logfile_append(logfileHandle, (const char *)ring->data + start, first);
+  if(length > first)
+    FileIO::logfile_append(logfileHandle, (const char *)ring->data, length - first);
+}
+
+// queue a message into a ring we hold. Returns false if it doesn't fit, in which case the caller
+// writes it immediately instead.
+static bool QueueLogMessage(LogRing *ring, const char *msg)
+{
+  LogMessageHeader header;
+  header.length = (uint32_t)strlen(msg);
+
+  const int64_t size = int64_t(sizeof(header)) + header.length;
+
+  // only the thread holding the ring changes head, only the flusher changes tail
+  const int64_t head = ring->head;
+  const int64_t tail = Atomic::ExchAdd64(&ring->tail, 0);
+
+  if(size > int64_t(LogRingSize) - (head - tail))
+  {
+    logFlushWake->Wake();
+    return false;
+  }
+
+  header.sequence = Atomic::Inc64(&logSequence);
+
+  CopyToLogRing(ring, head, &header, sizeof(header));
+  CopyToLogRing(ring, head + sizeof(header), msg, header.length);
+
+  // publish the message to the flusher
+  Atomic::ExchAdd64(&ring->head, size);
+
+  // wake the flusher early if the ring is filling up
+  if((head + size - tail) * 2 > int64_t(LogRingSize) && (head - tail) * 2 <= int64_t(LogRingSize))
+    logFlushWake->Wake();
+
+  return true;
+}
+
+// write out everything queued, in the order it was logged. Must be called with LogFileLock held
+static void FlushLogRings()
+{
+  // if writing the log logs anything, don't recurse into the flush we're already in. This also
+  // stops a crash flush from writing the same messages again
+  if(logRings == NULL || Atomic::CmpExch32(&logDraining, 0, 1) != 0)
+    return;
+
+  struct QueuedMessage
+  {
+    int64_t sequence;
+    size_t offset;
+    uint32_t length;
+  };
+
+  static rdcarray<QueuedMessage> *messages = new rdcarray<QueuedMessage>;
+  static rdcarray<char> *text = new rdcarray<char>;
+
+  messages->clear();
+  text->clear();
+
+  for(uint32_t r = 0; r < LogRingCount; r++)
+  {
+    LogRing *ring = &logRings[r];
+
+    const int64_t head = Atomic::ExchAdd64(&ring->head, 0);
+    const int64_t tail = ring->tail;
+
+    for(int64_t offset = tail; offset < head;)
+    {
+      LogMessageHeader header;
+      CopyFromLogRing(ring, offset, &header, sizeof(header));
+      offset += sizeof(header);
+
+      messages->push_back({header.sequence, text->size(), header.length});
+      text->resize(text->size() + header.length);
+      CopyFromLogRing(ring, offset, text->data() + text->size() - header.length, header.length);
+      offset += header.length;
+    }
+
+    // let the ring be reused
+    Atomic::ExchAdd64(&ring->tail, head - tail);
+  }
+
+  if(!messages->empty())
+  {
+    std::sort(messages->begin(), messages->end(),
+              [](const QueuedMessage &a, const QueuedMessage &b) {
+                return a.sequence < b.sequence;
+              });
+
+    static rdcarray<char> *output = new rdcarray<char>;
+    output->clear();
+    output->reserve(text->size());
+
+    for(const QueuedMessage &msg : *messages)
+      output->append(text->data() + msg.offset, msg.length);
+
+    if(logfileHandle)
+      FileIO::logfile_append(logfileHandle, output->data(), output->size());
+  }
+
+  Atomic::CmpExch32(&logDraining, 1, 0);
+}
+
+void rdclog_crashflush()
+{
+  if(logRings == NULL)
+    return;
+
+  // queueing is left enabled. This is also called for faults that a previous handler recovers
+  // from, and the process carries on logging normally afterwards.
+
+  // if another thread is part-way through writing the rings out it will finish, unless it's the one
+  // crashing, in which case there's nothing safe left to do
+  if(Atomic::CmpExch32(&logDraining, 0, 1) != 0)
+    return;
+
+  // the file lock may be held by a thread that will never release it, and allocating may not be
+  // safe, so write each message straight from its ring. Messages from different threads may be out
+  // of order, but they all reach the file.
+  for(uint32_t r = 0; r < LogRingCount; r++)
+  {
+    LogRing *ring = &logRings[r];
+
+    const int64_t head = Atomic::ExchAdd64(&ring->head, 0);
+    const int64_t tail = ring->tail;
+
+    for(int64_t offset = tail; offset < head;)
+    {
+      LogMessageHeader header;
+      CopyFromLogRing(ring, offset, &header, sizeof(header));
+      offset += sizeof(header);
+
+      AppendFromLogRing(ring, offset, header.length);
+      offset += header.length;
+    }
+
+    Atomic::ExchAdd64(&ring->tail, head - tail);
+  }
+
+  Atomic::CmpExch32(&logDraining, 1, 0);
+}
+
+static void LogFlushThreadEntry(int32_t generation)
+{
+  Threading::SetCurrentThreadName("RenderDoc log writer");
+
+  while(Atomic::CmpExch32(&logFlushGeneration, generation, generation) == generation)
+  {
+    logFlushWake->WaitForWake(LogFlushIntervalMS);
+
+    SCOPED_LOCK(LogFileLock());
+    FlushLogRings();
+  }
+
+  logFlushExited->Wake();
+}
+
+static void StartLogFlushThread()
+{
+  if(logFlushThread)
+    return;
+
+  if(logRings == NULL)
+  {
+    logRings = new LogRing[LogRingCount];
+    memset(logRings, 0, sizeof(LogRing) * LogRingCount);
+    logFlushWake = new Threading::Semaphore;
+    logFlushExited = new Threading::Semaphore;
+
+    // nothing else writes out the queue when the process exits or crashes
+    atexit(&rdclog_crashflush);
+    OSUtility::RegisterCrashCallback(&rdclog_crashflush);
+  }
+
+  const int32_t generation = Atomic::CmpExch32(&logFlushGeneration, 0, 0);
+
+  logFlushThread =
+      Threading::CreateThread([generation]() { LogFlushThreadEntry(generation); });
+
+  if(logFlushThread)
+    Atomic::CmpExch32(&logAsyncEnabled, 0, 1);
+}
+
+static void StopLogFlushThread(bool join)
+{
+  if(!logFlushThread)
+    return;
+
+  // send new messages straight to disk, and wait for any thread part-way through queueing one
+  Atomic::CmpExch32(&logAsyncEnabled, 1, 0);
+
+  for(uint32_t r = 0; r < LogRingCount; r++)
+  {
+    while(Atomic::CmpExch32(&logRings[r].busy, 0, 0) != 0)
+      Threading::Sleep(0);
+  }
+
+  Atomic::Inc32(&logFlushGeneration);
+  logFlushWake->Wake();
+
+  // when the log is closed the module may be being unloaded, where joining can deadlock. Give the
+  // thread a short time to notice it should exit instead - if it hasn't by then it still will, and
+  // won't be confused by a new flusher starting.
+  if(join)
+    Threading::JoinThread(logFlushThread);
+  else
+    logFlushExited->WaitForWake(50);
+
+  Threading::CloseThread(logFlushThread);
+  logFlushThread = 0;
+
+  SCOPED_LOCK(LogFileLock());
+  FlushLogRings();
+}
+
 const char *rdclog_getfilename()
 {
   return logfile->c_str();
@@ -283,29 +598,48 @@ void rdclog_filename(const char *filename)
   if(filename && filename[0])
     *logfile = filename;
 
-  FileIO::logfile_close(logfileHandle, rdcstr());
+  {
+    SCOPED_LOCK(LogFileLock());
 
-  logfileHandle = NULL;
+    // anything queued belongs to the previous file
+    FlushLogRings();
 
-  if(!logfile->empty())
-  {
-    logfileHandle = FileIO::logfile_open(*logfile);
+    FileIO::logfile_close(logfileHandle, rdcstr());
+
+    logfileHandle = NULL;
 
-    if(logfileHandle && !previous.empty())
+    if(!logfile->empty())
     {
-      rdcstr previousContents;
-      FileIO::ReadAll(previous, previousContents);
+      logfileHandle = FileIO::logfile_open(*logfile);
 
-      if(!previousContents.empty())
-        FileIO::logfile_append(logfileHandle, previousContents.c_str(), previousContents.length());
+      if(logfileHandle && !previous.empty())
+      {
+        rdcstr previousContents;
+        FileIO::ReadAll(previous, previousContents);
+
+        if(!previousContents.empty())
+          FileIO::logfile_append(logfileHandle, previousContents.c_str(),
+                                 previousContents.length());
 
-      FileIO::Delete(previous);
+        FileIO::Delete(previous);
+      }
     }
   }
+
+  if(logfileHandle)
+    StartLogFlushThread();
 }
 
 static bool log_output_enabled = false;
 
+// only these platforms have a debug monitor, elsewhere writing to it does nothing
+#if ENABLED(OUTPUT_LOG_TO_DEBUG_OUT) && \
+    (ENABLED(RDOC_WIN32) || ENABLED(RDOC_ANDROID) || ENABLED(RDOC_APPLE))
+#define LOG_TO_DEBUG_MONITOR OPTION_ON
+#else
+#define LOG_TO_DEBUG_MONITOR OPTION_OFF
+#endif
+
 void rdclog_enableoutput()
 {
   log_output_enabled = true;
@@ -314,40 +648,108 @@ void rdclog_enableoutput()
 void rdclog_closelog()
 {
   log_output_enabled = false;
+
+  StopLogFlushThread(false);
+
+  SCOPED_LOCK(LogFileLock());
   FileIO::logfile_close(logfileHandle, *logfile);
 }
 
 void rdclog_flush()
 {
+  SCOPED_LOCK(LogFileLock());
+  FlushLogRings();
 }
 
-void rdclogprint_int(LogType type, const char *fullMsg, const char *msg)
+void rdclog_prefork()
 {
-  static Threading::CriticalSection *lock = new Threading::CriticalSection();
+  // write out everything queued, and hold the file lock over the fork so the child doesn't inherit
+  // it locked by another thread
+  LogFileLock().Lock();
+  FlushLogRings();
+}
+
+void rdclog_postfork(bool child)
+{
+  if(child && logFlushThread)
+  {
+    // the flusher thread doesn't exist in the child, and any thread that was part-way through
+    // queueing a message doesn't either. Anything queued since the flush above is the parent's.
+    // The child usually execs soon, so it logs directly instead of starting its own flusher.
+    for(uint32_t r = 0; r < LogRingCount; r++)
+    {
+      logRings[r].busy = 0;
+      logRings[r].tail = logRings[r].head;
+    }
+
+    logFlushThread = 0;
+    Atomic::CmpExch32(&logAsyncEnabled, 1, 0);
+  }
+
+  LogFileLock().Unlock();
+}
 
-  SCOPED_LOCK(*lock);
+void rdclog_setasync(bool enabled)
+{
+  if(enabled && logfileHandle)
+    StartLogFlushThread();
+  else if(!enabled)
+    StopLogFlushThread(true);
+}
+
+bool rdclog_getasync()
+{
+  return Atomic::CmpExch32(&logAsyncEnabled, 1, 1) == 1;
+}
 
-#if ENABLED(OUTPUT_LOG_TO_DEBUG_OUT)
+static void rdclogprint_ring(LogRing *ring, LogType type, const char *fullMsg, const char *msg)
+{
+#if ENABLED(LOG_TO_DEBUG_MONITOR)
+  // the debug monitors are all safe to write to from several threads at once
   OSUtility::WriteOutput(OSUtility::Output_DebugMon, fullMsg);
 #endif
-#if ENABLED(OUTPUT_LOG_TO_STDOUT)
-  // don't output debug messages to stdout/stderr
-  if(type != LogType::Debug && log_output_enabled)
-    OSUtility::WriteOutput(OSUtility::Output_StdOut, msg);
-#endif
-#if ENABLED(OUTPUT_LOG_TO_STDERR)
+
+  // always output fatal errors to stderr no matter what, even if not normally enabled, to catch
+  // errors during startup
+  bool console = (type == LogType::Fatal);
+#if ENABLED(OUTPUT_LOG_TO_STDOUT) || ENABLED(OUTPUT_LOG_TO_STDERR)
   // don't output debug messages to stdout/stderr
   if(type != LogType::Debug && log_output_enabled)
-    OSUtility::WriteOutput(OSUtility::Output_StdErr, msg);
-  else
+    console = true;
 #endif
+
+  // only the console outputs need threads to take turns, so messages that are just queued for the
+  // log file never wait on each other
+  if(console)
   {
-    // always output fatal errors to stderr no matter what, even if not normally enabled, to catch
-    // errors during startup
-    if(type == LogType::Fatal)
+    static Threading::CriticalSection *lock = new Threading::CriticalSection();
+
+    SCOPED_LOCK(*lock);
+
+#if ENABLED(OUTPUT_LOG_TO_STDOUT)
+    if(type != LogType::Debug && log_output_enabled)
+      OSUtility::WriteOutput(OSUtility::Output_StdOut, msg);
+#endif
+#if ENABLED(OUTPUT_LOG_TO_STDERR)
+    if(type != LogType::Debug && log_output_enabled)
       OSUtility::WriteOutput(OSUtility::Output_StdErr, msg);
+    else
+#endif
+    {
+      if(type == LogType::Fatal)
+        OSUtility::WriteOutput(OSUtility::Output_StdErr, msg);
+    }
   }
 #if ENABLED(OUTPUT_LOG_TO_DISK)
+  // errors go straight to disk in case we're about to crash
+  if(ring && type < LogType::Error && QueueLogMessage(ring, fullMsg))
+    return;
+
+  SCOPED_LOCK(LogFileLock());
+
+  // write anything queued first so the file stays in order
+  FlushLogRings();
+
   if(logfileHandle)
   {
     // strlen used as byte length - str is UTF-8 so this is NOT number of characters
@@ -356,7 +758,13 @@ void rdclogprint_int(LogType type, const char *fullMsg, const char *msg)
 #endif
 }
 
-const int rdclog_outBufSize = 4 * 1024;
+void rdclogprint_int(LogType type, const char *fullMsg, const char *msg)
+{
+  LogRing *ring = AcquireLogRing();
+  rdclogprint_ring(ring, type, fullMsg, msg);
+  ReleaseLogRing(ring);
+}
+
 static char rdclog_outputBuffer[rdclog_outBufSize + 3];
 
 static void write_newline(char *output)
@@ -402,13 +810,20 @@ void rdclog_direct(time_t utcTime, uint32_t pid, LogType type, const char *proje
       "Debug  ", "Log    ", "Warning", "Error  ", "Fatal  ",
   };
 
+  // format into the buffer of the ring we're logging through, or the shared buffer if we couldn't
+  // get one
+  LogRing *ring = AcquireLogRing();
+
   static Threading::CriticalSection *lock = new Threading::CriticalSection();
 
-  SCOPED_LOCK(*lock);
+  if(!ring)
+    lock->Lock();
 
-  rdclog_outputBuffer[rdclog_outBufSize] = rdclog_outputBuffer[0] = 0;
+  char *outputBuffer = ring ? ring->format : rdclog_outputBuffer;
 
-  char *output = rdclog_outputBuffer;
+  outputBuffer[rdclog_outBufSize] = outputBuffer[0] = 0;
+
+  char *output = outputBuffer;
   size_t available = rdclog_outBufSize;
 
   char *base = output;
@@ -420,6 +835,10 @@ void rdclog_direct(time_t utcTime, uint32_t pid, LogType type, const char *proje
   {
     va_end(args);
     va_end(args2);
+    if(ring)
+      ReleaseLogRing(ring);
+    else
+      lock->Unlock();
     return;
   }
 
@@ -441,6 +860,10 @@ void rdclog_direct(time_t utcTime, uint32_t pid, LogType type, const char *proje
   if(numWritten < 0)
   {
     va_end(args2);
+    if(ring)
+      ReleaseLogRing(ring);
+    else
+      lock->Unlock();
     return;
   }
 
@@ -480,7 +903,7 @@ void rdclog_direct(time_t utcTime, uint32_t pid, LogType type, const char *proje
     // append newline
     write_newline(output);
 
-    rdclogprint_int(type, base, noPrefixOutput);
+    rdclogprint_ring(ring, type, base, noPrefixOutput);
   }
   else
   {
@@ -500,9 +923,9 @@ void rdclog_direct(time_t utcTime, uint32_t pid, LogType type, const char *proje
       write_newline(nl);
 
       if(first)
-        rdclogprint_int(type, base, noPrefixOutput);
+        rdclogprint_ring(ring, type, base, noPrefixOutput);
       else
-        rdclogprint_int(type, (prefixText + base).c_str(), noPrefixOutput);
+        rdclogprint_ring(ring, type, (prefixText + base).c_str(), noPrefixOutput);
 
       // restore the characters
       nl[1] = backup[0];
@@ -520,10 +943,15 @@ void rdclog_direct(time_t utcTime, uint32_t pid, LogType type, const char *proje
     write_newline(output);
 
     if(first)
-      rdclogprint_int(type, base, noPrefixOutput);
+      rdclogprint_ring(ring, type, base, noPrefixOutput);
     else
-      rdclogprint_int(type, (prefixText + base).c_str(), noPrefixOutput);
+      rdclogprint_ring(ring, type, (prefixText + base).c_str(), noPrefixOutput);
   }
 
   SAFE_DELETE_ARRAY(oversizedBuffer);
+
+  if(ring)
+    ReleaseLogRing(ring);
+  else
+    lock->Unlock();
 }
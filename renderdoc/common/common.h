@@ -469,6 +469,20 @@ void rdclog_filename(const char *filename);
 void rdclog_enableoutput();
 void rdclog_closelog();
 
+// the log file is written from a background thread once it's open. This can turn that off so every
+// message is written immediately, or back on again.
+void rdclog_setasync(bool enabled);
+bool rdclog_getasync();
+
+// write out anything queued for the log file without locking or allocating, for when the process
+// is crashing or exiting. Messages are still queued as normal afterwards.
+void rdclog_crashflush();
+
+// must be called around fork() so that the child doesn't inherit a locked log or messages queued
+// by the parent. The child writes its log directly.
+void rdclog_prefork();
+void rdclog_postfork(bool child);
+
 #define RDCLOGFILE(fn) rdclog_filename(fn)
 #define RDCGETLOGFILE() rdclog_getfilename()
 
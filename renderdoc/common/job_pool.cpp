@@ -0,0 +1,301 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2022 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "common/job_pool.h"
+#include "common/formatting.h"
+
+namespace Threading
+{
+struct JobPool::Job
+{
+  std::function<void()> work;
+  // set under the pool lock, but read without it
+  int32_t finished = 0;
+  // set under the pool lock once the handle has been released
+  bool released = false;
+  // the job's position in m_Jobs, so it can be removed when freed
+  size_t index = 0;
+};
+
+static uint64_t GetWorkerTLSSlot()
+{
+  static uint64_t slot = AllocateTLSSlot();
+  return slot;
+}
+
+JobPool::JobPool(uint32_t numWorkers)
+{
+  if(numWorkers == 0)
+    numWorkers = GetProcessorCount();
+
+  // make sure the slot is allocated before any worker looks at it
+  GetWorkerTLSSlot();
+
+  for(uint32_t i = 0; i < numWorkers; i++)
+  {
+    m_Workers.push_back(CreateThread([this, i]() {
+      SetCurrentThreadName(StringFormat::Fmt("RenderDoc job worker %u", i));
+      SetTLSValue(GetWorkerTLSSlot(), (void *)this);
+      WorkerMain();
+      SetTLSValue(GetWorkerTLSSlot(), NULL);
+    }));
+  }
+}
+
+JobPool::~JobPool()
+{
+  WaitAll();
+
+  Atomic::Inc32(&m_Shutdown);
+  m_WorkReady.Wake(m_Workers.count());
+
+  for(ThreadHandle t : m_Workers)
+  {
+    JoinThread(t);
+    CloseThread(t);
+  }
+
+  for(Job *job : m_Jobs)
+    delete job;
+}
+
+bool JobPool::IsWorkerThread()
+{
+  return GetTLSValue(GetWorkerTLSSlot()) != NULL;
+}
+
+JobPool::Job *JobPool::Add(std::function<void()> work)
+{
+  Job *job = new Job;
+  job->work = std::move(work);
+
+  Atomic::Inc32(&m_Outstanding);
+
+  SCOPED_LOCK(m_Lock);
+
+  job->index = m_Jobs.size();
+  m_Jobs.push_back(job);
+
+  PushReady(job);
+
+  return job;
+}
+
+void JobPool::Release(Job *job)
+{
+  if(job == NULL)
+    return;
+
+  SCOPED_LOCK(m_Lock);
+
+  // a finished job has nothing else referencing it, otherwise it's freed when it finishes
+  if(job->finished)
+    Free(job);
+  else
+    job->released = true;
+}
+
+// must be called with m_Lock held
+void JobPool::Free(Job *job)
+{
+  // swap the last job into this one's place
+  Job *last = m_Jobs.back();
+  last->index = job->index;
+  m_Jobs[job->index] = last;
+  m_Jobs.pop_back();
+
+  delete job;
+}
+
+// must be called with m_Lock held
+void JobPool::PushReady(Job *job)
+{
+  m_Ready.push_back(job);
+  m_WorkReady.Wake();
+}
+
+bool JobPool::IsFinished(Job *job)
+{
+  return Atomic::CmpExch32(&job->finished, 0, 0) != 0;
+}
+
+void JobPool::Wait(Job *job)
+{
+  if(job == NULL)
+    return;
+
+  while(!IsFinished(job))
+  {
+    Job *ready = PopReady();
+    if(ready)
+      Run(ready);
+    else
+      Sleep(0);
+  }
+}
+
+void JobPool::WaitAll()
+{
+  while(Atomic::CmpExch32(&m_Outstanding, 0, 0) != 0)
+  {
+    Job *ready = PopReady();
+    if(ready)
+      Run(ready);
+    else
+      Sleep(0);
+  }
+}
+
+JobPool::Job *JobPool::PopReady()
+{
+  SCOPED_LOCK(m_Lock);
+
+  if(m_ReadyHead >= m_Ready.size())
+    return NULL;
+
+  Job *ret = m_Ready[m_ReadyHead++];
+
+  // once everything queued has been taken, reuse the storage from the start
+  if(m_ReadyHead == m_Ready.size())
+  {
+    m_Ready.clear();
+    m_ReadyHead = 0;
+  }
+
+  return ret;
+}
+
+void JobPool::Run(Job *job)
+{
+  job->work();
+
+  // release anything captured by the job now rather than when the pool is destroyed
+  job->work = std::function<void()>();
+
+  {
+    SCOPED_LOCK(m_Lock);
+
+    Atomic::Inc32(&job->finished);
+
+    if(job->released)
+      Free(job);
+  }
+
+  Atomic::Dec32(&m_Outstanding);
+}
+
+void JobPool::WorkerMain()
+{
+  while(Atomic::CmpExch32(&m_Shutdown, 0, 0) == 0)
+  {
+    Job *job = PopReady();
+
+    if(job)
+    {
+      Run(job);
+      continue;
+    }
+
+    // the job we were woken for may have been taken by a waiting thread, in which case this just
+    // goes round again and finds nothing
+    m_WorkReady.WaitForWake();
+  }
+}
+};
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "catch/catch.hpp"
+
+TEST_CASE("Job pool", "[threading]")
+{
+  SECTION("Independent jobs all run")
+  {
+    Threading::JobPool pool(4);
+
+    int32_t count = 0;
+    for(int i = 0; i < 1000; i++)
+      pool.Add([&count]() { Atomic::Inc32(&count); });
+
+    pool.WaitAll();
+
+    CHECK(count == 1000);
+  }
+
+  SECTION("Waiting on one job from the owning thread")
+  {
+    Threading::JobPool pool(1);
+
+    int32_t a = 0;
+    Threading::JobPool::Job *job = pool.Add([&a]() { Atomic::Inc32(&a); });
+
+    pool.Wait(job);
+
+    CHECK(pool.IsFinished(job));
+    CHECK(a == 1);
+
+    CHECK_FALSE(Threading::JobPool::IsWorkerThread());
+  }
+
+  SECTION("Released jobs still run")
+  {
+    Threading::JobPool pool(4);
+
+    int32_t count = 0;
+
+    for(int i = 0; i < 1000; i++)
+      pool.Release(pool.Add([&count]() { Atomic::Inc32(&count); }));
+
+    // release a job that may still be running, while holding on to a later one
+    Threading::JobPool::Job *first = pool.Add([&count]() { Atomic::Inc32(&count); });
+    Threading::JobPool::Job *second = pool.Add([&count]() { Atomic::Inc32(&count); });
+    pool.Release(first);
+
+    pool.Wait(second);
+    CHECK(pool.IsFinished(second));
+    pool.Release(second);
+
+    pool.WaitAll();
+
+    CHECK(count == 1002);
+  }
+
+  SECTION("Idle workers wake for new jobs")
+  {
+    Threading::JobPool pool(2);
+
+    // let the workers go idle before anything is queued
+    Threading::Sleep(50);
+
+    int32_t count = 0;
+    for(int i = 0; i < 100; i++)
+      pool.Release(pool.Add([&count]() { Atomic::Inc32(&count); }));
+
+    pool.WaitAll();
+
+    CHECK(count == 100);
+  }
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -0,0 +1,84 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2022 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include <functional>
+#include "api/replay/rdcarray.h"
+#include "common/threading.h"
+
+namespace Threading
+{
+// A set of worker threads that run independent jobs, started in the order they were added. This is
+// intended for short-lived bursts of work like capture loading - the pool is created for the burst
+// and destroyed afterwards. Idle workers sleep until a job is added.
+//
+// Jobs are owned by the pool and the handles returned stay valid until they are released, or the
+// pool is destroyed. A job is freed once it has both finished and been released, so callers that
+// don't need the handle should release it straight away. Adding jobs and waiting must happen from
+// the thread that owns the pool, waiting threads run queued jobs themselves rather than idling.
+class JobPool
+{
+public:
+  struct Job;
+
+  // numWorkers of 0 uses one per processor
+  explicit JobPool(uint32_t numWorkers = 0);
+  ~JobPool();
+
+  Job *Add(std::function<void()> work);
+  // the handle can't be used after this
+  void Release(Job *job);
+
+  bool IsFinished(Job *job);
+  void Wait(Job *job);
+  void WaitAll();
+
+  uint32_t GetNumWorkers() const { return m_Workers.count(); }
+  // true on the pool's worker threads, for code that needs to know if it's running as a job
+  static bool IsWorkerThread();
+
+  JobPool(const JobPool &) = delete;
+  JobPool &operator=(const JobPool &) = delete;
+
+private:
+  Job *PopReady();
+  void PushReady(Job *job);
+  void Run(Job *job);
+  void Free(Job *job);
+  void WorkerMain();
+
+  CriticalSection m_Lock;
+  // jobs waiting to run. Popped from m_ReadyHead onwards, and compacted when empty
+  rdcarray<Job *> m_Ready;
+  size_t m_ReadyHead = 0;
+  // every job not yet freed, so any still held can be freed with the pool
+  rdcarray<Job *> m_Jobs;
+  int32_t m_Outstanding = 0;
+  int32_t m_Shutdown = 0;
+  // woken once for each job pushed to m_Ready, and once per worker on shutdown
+  Semaphore m_WorkReady;
+  rdcarray<ThreadHandle> m_Workers;
+};
+};
@@ -0,0 +1,409 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2022 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "common/profiler.h"
+#include <set>
+#include "common/formatting.h"
+#include "common/threading.h"
+#include "core/settings.h"
+#include "os/os_specific.h"
+
+RDOC_CONFIG(rdcstr, Profiling_ChromeTracePath, "",
+            "If set, RenderDoc records its own profiling zones and counters and writes them as a "
+            "Chrome trace to this path on shutdown.");
+RDOC_CONFIG(uint32_t, Profiling_EventsPerThread, 64 * 1024,
+            "The number of profiling events kept for each thread. Once full the oldest events are "
+            "overwritten.");
+RDOC_CONFIG(uint32_t, Profiling_MaxThreads, 32,
+            "The maximum number of threads that profiling events are recorded for. Each thread's "
+            "events are kept until shutdown, so this bounds the memory used when many threads come "
+            "and go.");
+
+namespace Profiler
+{
+bool recording = false;
+
+enum class EventType : uint8_t
+{
+  Zone,
+  Counter,
+};
+
+struct Event
+{
+  const char *name;
+  uint64_t start;
+  // the duration in ticks for a zone, or the value for a counter
+  int64_t value;
+  EventType type;
+};
+
+// zones nested deeper than this are still tracked but not recorded
+static const uint32_t MaxZoneDepth = 64;
+
+struct ThreadEvents
+{
+  // a small sequential ID for the trace, and the OS thread ID for its name
+  uint32_t index;
+  uint64_t threadID;
+
+  // only contended while a trace is being written or recording restarts
+  Threading::SpinLock lock;
+  rdcarray<Event> ring;
+  size_t next = 0;
+  bool wrapped = false;
+
+  // open zones on this thread, only touched by the thread itself
+  uint32_t depth = 0;
+  const char *zoneNames[MaxZoneDepth];
+  uint64_t zoneStarts[MaxZoneDepth];
+
+  void Push(const Event &ev)
+  {
+    SCOPED_SPINLOCK(lock);
+
+    ring[next++] = ev;
+    if(next == ring.size())
+    {
+      next = 0;
+      wrapped = true;
+    }
+  }
+};
+
+static Threading::CriticalSection threadsLock;
+// thread event buffers are never freed, since a thread may still be inside a zone. There's no
+// notification when a thread exits so they can't be reused either, instead the number of them is
+// capped by Profiling_MaxThreads.
+static rdcarray<ThreadEvents *> threads;
+// threads past the cap point their TLS here, so they don't contend on threadsLock for every zone
+static ThreadEvents untrackedThread;
+static bool untrackedWarned = false;
+static uint64_t threadSlot = 0;
+static uint64_t baseTick = 0;
+static rdcstr tracePath;
+
+static Threading::CriticalSection namesLock;
+static std::set<rdcstr> names;
+
+static ThreadEvents *GetThreadEvents()
+{
+  if(threadSlot == 0)
+    return NULL;
+
+  ThreadEvents *events = (ThreadEvents *)Threading::GetTLSValue(threadSlot);
+  if(events)
+    return events == &untrackedThread ? NULL : events;
+
+  {
+    SCOPED_LOCK(threadsLock);
+
+    if(threads.size() >= Profiling_MaxThreads())
+    {
+      if(!untrackedWarned)
+        RDCWARN("Profiling events are recorded for at most %u threads, ignoring new threads",
+                Profiling_MaxThreads());
+      untrackedWarned = true;
+
+      Threading::SetTLSValue(threadSlot, &untrackedThread);
+      return NULL;
+    }
+
+    events = new ThreadEvents;
+    events->threadID = Threading::GetCurrentID();
+    events->ring.resize(RDCMAX(Profiling_EventsPerThread(), 16U));
+    events->index = (uint32_t)threads.size();
+    threads.push_back(events);
+  }
+
+  Threading::SetTLSValue(threadSlot, events);
+
+  return events;
+}
+
+void Init()
+{
+  rdcstr path = Profiling_ChromeTracePath();
+
+  if(path.empty() || recording)
+    return;
+
+  tracePath = path;
+  Start();
+
+  RDCLOG("Recording self-profiling trace to %s", tracePath.c_str());
+}
+
+void Shutdown()
+{
+  if(!recording || tracePath.empty())
+    return;
+
+  Stop();
+
+  if(WriteChromeTrace(tracePath))
+    RDCLOG("Wrote self-profiling trace to %s", tracePath.c_str());
+  else
+    RDCERR("Couldn't write self-profiling trace to %s", tracePath.c_str());
+}
+
+void Start()
+{
+  if(threadSlot == 0)
+    threadSlot = Threading::AllocateTLSSlot();
+
+  {
+    SCOPED_LOCK(threadsLock);
+    for(ThreadEvents *events : threads)
+    {
+      SCOPED_SPINLOCK(events->lock);
+      events->next = 0;
+      events->wrapped = false;
+    }
+  }
+
+  baseTick = Timing::GetTick();
+  recording = true;
+}
+
+void Stop()
+{
+  recording = false;
+}
+
+void BeginZone(const char *name)
+{
+  ThreadEvents *events = GetThreadEvents();
+  if(!events)
+    return;
+
+  if(events->depth < MaxZoneDepth)
+  {
+    events->zoneNames[events->depth] = name;
+    events->zoneStarts[events->depth] = Timing::GetTick();
+  }
+
+  events->depth++;
+}
+
+void EndZone()
+{
+  ThreadEvents *events = GetThreadEvents();
+
+  // recording may have started part-way through this zone
+  if(!events || events->depth == 0)
+    return;
+
+  events->depth--;
+
+  if(events->depth < MaxZoneDepth)
+  {
+    uint64_t start = events->zoneStarts[events->depth];
+    events->Push({events->zoneNames[events->depth], start, int64_t(Timing::GetTick() - start),
+                  EventType::Zone});
+  }
+}
+
+void SetCounter(const char *name, int64_t value)
+{
+  ThreadEvents *events = GetThreadEvents();
+  if(events)
+    events->Push({name, Timing::GetTick(), value, EventType::Counter});
+}
+
+const char *Intern(const rdcstr &name)
+{
+  SCOPED_LOCK(namesLock);
+  return names.insert(name).first->c_str();
+}
+
+static rdcstr EscapeJSON(const char *str)
+{
+  rdcstr ret;
+  for(; *str; str++)
+  {
+    if(*str == '"' || *str == '\\')
+      ret.push_back('\\');
+    if((unsigned char)*str >= 0x20)
+      ret.push_back(*str);
+  }
+  return ret;
+}
+
+bool WriteChromeTrace(const rdcstr &filename)
+{
+  FILE *f = FileIO::fopen(filename, FileIO::WriteBinary);
+  if(!f)
+    return false;
+
+  const uint32_t pid = Process::GetCurrentPID();
+  // ticks per microsecond
+  const double tickFrequency = Timing::GetTickFrequency() / 1000.0;
+
+  rdcstr out = "{\"traceEvents\":[\n";
+  bool first = true;
+
+  rdcarray<Event> ordered;
+
+  SCOPED_LOCK(threadsLock);
+
+  for(ThreadEvents *events : threads)
+  {
+    {
+      SCOPED_SPINLOCK(events->lock);
+
+      ordered.clear();
+      if(events->wrapped)
+        ordered.append(events->ring.data() + events->next, events->ring.size() - events->next);
+      ordered.append(events->ring.data(), events->next);
+    }
+
+    if(ordered.empty())
+      continue;
+
+    out += StringFormat::Fmt(
+        "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,"
+        "\"args\":{\"name\":\"Thread %llu\"}}",
+        first ? "" : ",\n", pid, events->index, events->threadID);
+    first = false;
+
+    for(const Event &ev : ordered)
+    {
+      // events from before recording (re)started
+      if(ev.start < baseTick)
+        continue;
+
+      double ts = double(ev.start - baseTick) / tickFrequency;
+
+      if(ev.type == EventType::Zone)
+        out += StringFormat::Fmt(
+            ",\n{\"name\":\"%s\",\"cat\":\"renderdoc\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+            "\"pid\":%u,\"tid\":%u}",
+            EscapeJSON(ev.name).c_str(), ts, double(ev.value) / tickFrequency, pid, events->index);
+      else
+        out += StringFormat::Fmt(
+            ",\n{\"name\":\"%s\",\"cat\":\"renderdoc\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%u,"
+            "\"args\":{\"value\":%lld}}",
+            EscapeJSON(ev.name).c_str(), ts, pid, ev.value);
+
+      // flush periodically rather than building the whole trace in memory
+      if(out.size() > 1024 * 1024)
+      {
+        FileIO::fwrite(out.data(), 1, out.size(), f);
+        out.clear();
+      }
+    }
+  }
+
+  out += "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+  bool success = FileIO::fwrite(out.data(), 1, out.size(), f) == out.size();
+
+  FileIO::fclose(f);
+
+  return success;
+}
+};
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "catch/catch.hpp"
+
+TEST_CASE("Self-profiling Chrome trace", "[profiler]")
+{
+  Profiler::Start();
+
+  {
+    RDCPROFILE_ZONE("Outer zone");
+
+    {
+      RDCPROFILE_ZONE(Profiler::Intern("Inner \"quoted\" zone"));
+      RDCPROFILE_COUNTER("Test counter", 42);
+    }
+
+    Threading::ThreadHandle thread =
+        Threading::CreateThread([]() { RDCPROFILE_ZONE("Other thread zone"); });
+    Threading::JoinThread(thread);
+    Threading::CloseThread(thread);
+  }
+
+  Profiler::Stop();
+
+  // nothing is recorded while stopped
+  {
+    RDCPROFILE_ZONE("Stopped zone");
+  }
+
+  rdcstr filename = FileIO::GetTempFolderFilename() + "renderdoc_profiler_test.json";
+
+  REQUIRE(Profiler::WriteChromeTrace(filename));
+
+  rdcstr trace;
+  FileIO::ReadAll(filename, trace);
+  FileIO::Delete(filename);
+
+  CHECK(trace.beginsWith("{\"traceEvents\":["));
+  CHECK(trace.find("\"name\":\"Outer zone\",\"cat\":\"renderdoc\",\"ph\":\"X\"") >= 0);
+  CHECK(trace.find("\"name\":\"Inner \\\"quoted\\\" zone\"") >= 0);
+  CHECK(trace.find("\"name\":\"Other thread zone\"") >= 0);
+  CHECK(trace.find("\"name\":\"Test counter\",\"cat\":\"renderdoc\",\"ph\":\"C\"") >= 0);
+  CHECK(trace.find("\"args\":{\"value\":42}") >= 0);
+  CHECK(trace.find("Stopped zone") < 0);
+  CHECK(trace.endsWith("],\"displayTimeUnit\":\"ms\"}\n"));
+};
+
+TEST_CASE("Self-profiling thread cap", "[profiler]")
+{
+  Profiler::Start();
+
+  // more short-lived threads than can be recorded, each of which would otherwise keep its own ring
+  for(uint32_t i = 0; i < Profiling_MaxThreads() + 8; i++)
+  {
+    Threading::ThreadHandle thread =
+        Threading::CreateThread([]() { RDCPROFILE_ZONE("Short-lived thread zone"); });
+    Threading::JoinThread(thread);
+    Threading::CloseThread(thread);
+  }
+
+  Profiler::Stop();
+
+  rdcstr filename = FileIO::GetTempFolderFilename() + "renderdoc_profiler_cap_test.json";
+
+  REQUIRE(Profiler::WriteChromeTrace(filename));
+
+  rdcstr trace;
+  FileIO::ReadAll(filename, trace);
+  FileIO::Delete(filename);
+
+  uint32_t numThreads = 0;
+  for(int32_t offs = trace.find("\"thread_name\""); offs >= 0;
+      offs = trace.find("\"thread_name\"", offs + 1))
+    numThreads++;
+
+  CHECK(numThreads > 0);
+  CHECK(numThreads <= Profiling_MaxThreads());
+  CHECK(trace.find("Short-lived thread zone") >= 0);
+};
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
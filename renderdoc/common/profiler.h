@@ -0,0 +1,94 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2022 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include "api/replay/rdcstr.h"
+#include "common/common.h"
+
+// Lightweight self-profiling. Zones and counters are recorded into a fixed-size ring buffer per
+// thread, and can be written out as a Chrome trace (chrome://tracing or ui.perfetto.dev) to see
+// where time goes inside RenderDoc without attaching an external profiler.
+//
+// Recording is enabled by setting Profiling_ChromeTracePath, either in the config or with
+// renderdoccmd's --profile-trace option. While it's disabled each zone or counter costs only a
+// check of a global flag.
+namespace Profiler
+{
+// reads the config and begins recording if a trace path is set. Safe to call multiple times.
+void Init();
+// stops recording and writes the trace to the configured path, if recording.
+void Shutdown();
+
+// internal, use IsRecording()
+extern bool recording;
+
+// whether zones and counters are currently being recorded
+inline bool IsRecording()
+{
+  return recording;
+}
+
+// begin or end recording explicitly, independent of the config. Starting discards anything
+// previously recorded.
+void Start();
+void Stop();
+
+// name must be a string literal or otherwise live until the trace is written - see Intern()
+void BeginZone(const char *name);
+void EndZone();
+void SetCounter(const char *name, int64_t value);
+
+// returns a persistent copy of a name, for zones named at runtime (e.g. by chunk type)
+const char *Intern(const rdcstr &name);
+
+// writes everything recorded so far, returns false if the file couldn't be written
+bool WriteChromeTrace(const rdcstr &filename);
+};
+
+class ProfileZone
+{
+public:
+  ProfileZone(const char *name) : m_Recording(Profiler::IsRecording())
+  {
+    if(m_Recording)
+      Profiler::BeginZone(name);
+  }
+  ~ProfileZone()
+  {
+    if(m_Recording)
+      Profiler::EndZone();
+  }
+
+private:
+  bool m_Recording;
+};
+
+#define RDCPROFILE_ZONE(name) ProfileZone CONCAT(profilezone, __LINE__)(name);
+#define RDCPROFILE_COUNTER(name, value)  \
+  do                                     \
+  {                                      \
+    if(Profiler::IsRecording())          \
+      Profiler::SetCounter(name, value); \
+  } while((void)0, 0)
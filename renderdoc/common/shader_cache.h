@@ -31,9 +31,10 @@
 
 static const uint32_t ShaderCacheMagic = MAKE_FOURCC('R', 'D', '$', '$');
 
-template <typename ResultType, typename ShaderCallbacks>
+// keys are usually a 32-bit hash, but can be any plain-old-data type that's written as-is
+template <typename KeyType, typename ResultType, typename ShaderCallbacks>
 bool LoadShaderCache(const rdcstr &filename, const uint32_t magicNumber, const uint32_t versionNumber,
-                     std::map<uint32_t, ResultType> &resultCache, const ShaderCallbacks &callbacks)
+                     std::map<KeyType, ResultType> &resultCache, const ShaderCallbacks &callbacks)
 {
   rdcstr shadercache = FileIO::GetAppFolderFilename(filename);
 
@@ -62,7 +63,8 @@ bool LoadShaderCache(const rdcstr &filename, const uint32_t magicNumber, const u
 
   for(uint32_t i = 0; i < numentries; i++)
   {
-    uint32_t hash = 0, length = 0;
+    KeyType hash = {};
+    uint32_t length = 0;
     compressedReader.Read(hash);
     compressedReader.Read(length);
 
@@ -85,9 +87,9 @@ bool LoadShaderCache(const rdcstr &filename, const uint32_t magicNumber, const u
   return ret && !compressedReader.IsErrored() && !fileReader.IsErrored();
 }
 
-template <typename ResultType, typename ShaderCallbacks>
+template <typename KeyType, typename ResultType, typename ShaderCallbacks>
 void SaveShaderCache(const rdcstr &filename, uint32_t magicNumber, uint32_t versionNumber,
-                     const std::map<uint32_t, ResultType> &cache, const ShaderCallbacks &callbacks)
+                     const std::map<KeyType, ResultType> &cache, const ShaderCallbacks &callbacks)
 {
   rdcstr shadercache = FileIO::GetAppFolderFilename(filename);
 
@@ -111,7 +113,7 @@ void SaveShaderCache(const rdcstr &filename, uint32_t magicNumber, uint32_t vers
 
   // hash + length + data for each entry
   for(auto it = cache.begin(); it != cache.end(); ++it)
-    uncompressedSize += sizeof(uint32_t) * 2 + callbacks.GetSize(it->second);
+    uncompressedSize += sizeof(KeyType) + sizeof(uint32_t) + callbacks.GetSize(it->second);
 
   fileWriter.Write(uncompressedSize);
 
@@ -122,7 +124,7 @@ void SaveShaderCache(const rdcstr &filename, uint32_t magicNumber, uint32_t vers
 
   for(auto it = cache.begin(); it != cache.end(); ++it)
   {
-    uint32_t hash = it->first;
+    const KeyType &hash = it->first;
     uint32_t len = callbacks.GetSize(it->second);
     const byte *data = callbacks.GetData(it->second);
 
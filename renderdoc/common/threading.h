@@ -110,6 +110,134 @@ public:
 private:
   SpinLock *m_Spin = NULL;
 };
+
+// A reader/writer lock for state that is read constantly and written very rarely, like the capture
+// state transitions. Each thread that reads gets its own reader record on its own cache line, found
+// through a TLS slot, so taking a read lock only writes memory private to the thread instead of a
+// cache line shared by every reader as with RWLock. Writers set a flag that stops new readers from
+// entering, then wait for every thread's record to drain to zero.
+//
+// Read locks are recursive - a thread that already holds a read lock will always be able to take
+// it again, even while a writer is waiting. Taking a read lock while holding the write lock on the
+// same thread deadlocks, as with RWLock.
+//
+// Reader records live as long as the lock, since we aren't told when threads exit.
+class EpochLock
+{
+public:
+  EpochLock() : m_ThreadSlot(AllocateTLSSlot()) {}
+  ~EpochLock()
+  {
+    for(ReaderRecord *rec : m_Records)
+    {
+      rec->~ReaderRecord();
+      FreeAlignedBuffer((byte *)rec);
+    }
+  }
+  // no copying
+  EpochLock &operator=(const EpochLock &other) = delete;
+  EpochLock(const EpochLock &other) = delete;
+
+  void ReadLock()
+  {
+    ReaderRecord *rec = GetRecord();
+
+    // the increment is a full barrier, so the writer either sees our count or we see its flag. If
+    // we already held the lock the writer is waiting on us, so we must not back off. The flag is
+    // read with acquire ordering so none of the reads it protects can happen before it's checked.
+    if(Atomic::Inc32(&rec->depth) == 1)
+    {
+      while(Atomic::LoadAcquire32(&m_Writing) != 0)
+      {
+        Atomic::Dec32(&rec->depth);
+
+        // block until the writer is finished
+        m_WriterLock.Lock();
+        m_WriterLock.Unlock();
+
+        Atomic::Inc32(&rec->depth);
+      }
+    }
+  }
+
+  void ReadUnlock()
+  {
+    ReaderRecord *rec = (ReaderRecord *)GetTLSValue(m_ThreadSlot);
+    Atomic::Dec32(&rec->depth);
+  }
+
+  void WriteLock()
+  {
+    m_WriterLock.Lock();
+
+    Atomic::CmpExch32(&m_Writing, 0, 1);
+
+    // wait for any readers that got in before the flag was set. Threads registering after this
+    // point will see the flag and back off
+    ScopedLock lock(&m_RecordsLock);
+    for(ReaderRecord *rec : m_Records)
+    {
+      while(Atomic::LoadAcquire32(&rec->depth) != 0)
+        Sleep(0);
+    }
+  }
+
+  void WriteUnlock()
+  {
+    // release, so every write made under the lock is visible before readers can see the flag clear
+    Atomic::StoreRelease32(&m_Writing, 0);
+
+    m_WriterLock.Unlock();
+  }
+
+private:
+  // each thread's recursion depth is on its own cache line. Records are allocated aligned, as new
+  // isn't guaranteed to respect the alignment before C++17
+  struct alignas(64) ReaderRecord
+  {
+    int32_t depth = 0;
+  };
+
+  ReaderRecord *GetRecord()
+  {
+    ReaderRecord *rec = (ReaderRecord *)GetTLSValue(m_ThreadSlot);
+    if(rec == NULL)
+    {
+      // only happens the first time a thread reads this lock
+      rec = new(AllocAlignedBuffer(sizeof(ReaderRecord), alignof(ReaderRecord))) ReaderRecord;
+      {
+        ScopedLock lock(&m_RecordsLock);
+        m_Records.push_back(rec);
+      }
+      SetTLSValue(m_ThreadSlot, rec);
+    }
+    return rec;
+  }
+
+  int32_t m_Writing = 0;
+  uint64_t m_ThreadSlot;
+  CriticalSection m_WriterLock;
+  CriticalSection m_RecordsLock;
+  rdcarray<ReaderRecord *> m_Records;
+};
+
+class ScopedEpochReadLock
+{
+public:
+  ScopedEpochReadLock(EpochLock &lock) : m_Lock(&lock) { m_Lock->ReadLock(); }
+  ~ScopedEpochReadLock() { m_Lock->ReadUnlock(); }
+private:
+  EpochLock *m_Lock;
+};
+
+class ScopedEpochWriteLock
+{
+public:
+  ScopedEpochWriteLock(EpochLock &lock) : m_Lock(&lock) { m_Lock->WriteLock(); }
+  ~ScopedEpochWriteLock() { m_Lock->WriteUnlock(); }
+private:
+  EpochLock *m_Lock;
+};
 };
 
 #define SCOPED_LOCK(cs) Threading::ScopedLock CONCAT(scopedlock, __LINE__)(&cs);
@@ -119,4 +247,9 @@ private:
 #define SCOPED_READLOCK(rw) Threading::ScopedReadLock CONCAT(scopedlock, __LINE__)(rw);
 #define SCOPED_WRITELOCK(rw) Threading::ScopedWriteLock CONCAT(scopedlock, __LINE__)(rw);
 
+#define SCOPED_EPOCH_READLOCK(lock) \
+  Threading::ScopedEpochReadLock CONCAT(scopedlock, __LINE__)(lock);
+#define SCOPED_EPOCH_WRITELOCK(lock) \
+  Threading::ScopedEpochWriteLock CONCAT(scopedlock, __LINE__)(lock);
+
 #define SCOPED_SPINLOCK(cs) Threading::ScopedSpinLock CONCAT(scopedlock, __LINE__)(cs);
@@ -23,6 +23,8 @@
  ******************************************************************************/
 
 #include "common/threading.h"
+#include "common/timing.h"
+#include "common/wrapped_pool.h"
 #include "os/os_specific.h"
 
 #if ENABLED(ENABLE_UNIT_TESTS)
@@ -71,4 +73,212 @@ TEST_CASE("Test spin lock", "[threading]")
   CHECK(finalValue == value);
 }
 
+TEST_CASE("Test epoch lock", "[threading]")
+{
+  const int numThreads = 8;
+
+  rdcarray<Threading::ThreadHandle> threads;
+  threads.resize(numThreads);
+
+  SECTION("Readers never see a partial write")
+  {
+    Threading::EpochLock lock;
+
+    // written together under the write lock, so readers must always see them equal
+    int32_t a = 0, b = 0;
+    int32_t failures = 0;
+    int32_t running = numThreads;
+
+    for(int i = 0; i < numThreads; i++)
+    {
+      threads[i] = Threading::CreateThread([&]() {
+        for(int c = 0; c < 20000; c++)
+        {
+          SCOPED_EPOCH_READLOCK(lock);
+
+          int32_t va = *(volatile int32_t *)&a;
+
+          // recursive read locks must not deadlock against a waiting writer
+          if(c % 64 == 0)
+          {
+            SCOPED_EPOCH_READLOCK(lock);
+            if(*(volatile int32_t *)&b != va)
+              Atomic::Inc32(&failures);
+          }
+
+          if(*(volatile int32_t *)&b != va)
+            Atomic::Inc32(&failures);
+        }
+
+        Atomic::Dec32(&running);
+      });
+    }
+
+    while(*(volatile int32_t *)&running > 0)
+    {
+      SCOPED_EPOCH_WRITELOCK(lock);
+      a++;
+      Threading::Sleep(0);
+      b++;
+    }
+
+    for(Threading::ThreadHandle t : threads)
+    {
+      Threading::JoinThread(t);
+      Threading::CloseThread(t);
+    }
+
+    CHECK(failures == 0);
+    CHECK(a == b);
+  }
+
+  SECTION("Read lock contention compared to RWLock")
+  {
+    const int opsPerThread = 500000;
+
+    Threading::EpochLock epoch;
+    Threading::RWLock rwlock;
+
+    double epochTime = 0.0, rwlockTime = 0.0;
+
+    for(int pass = 0; pass < 2; pass++)
+    {
+      PerformanceTimer timer;
+
+      for(int i = 0; i < numThreads; i++)
+      {
+        threads[i] = Threading::CreateThread([&, pass]() {
+          for(int c = 0; c < opsPerThread; c++)
+          {
+            if(pass == 0)
+            {
+              SCOPED_EPOCH_READLOCK(epoch);
+            }
+            else
+            {
+              SCOPED_READLOCK(rwlock);
+            }
+          }
+        });
+      }
+
+      for(Threading::ThreadHandle t : threads)
+      {
+        Threading::JoinThread(t);
+        Threading::CloseThread(t);
+      }
+
+      (pass == 0 ? epochTime : rwlockTime) =
+          timer.GetMicroseconds() * 1000.0 / double(numThreads * opsPerThread);
+    }
+
+    RDCLOG("Concurrent read locking on %d threads: EpochLock %.1f ns, RWLock %.1f ns", numThreads,
+           epochTime, rwlockTime);
+  }
+}
+
+struct PoolTestItem
+{
+  ALLOCATE_WITH_WRAPPED_POOL(PoolTestItem);
+
+  uint64_t tag;
+  uint64_t payload[7];
+};
+
+WRAPPED_POOL_INST(PoolTestItem);
+
+TEST_CASE("Test wrapping pool", "[threading]")
+{
+  const int numThreads = 8;
+
+  rdcarray<Threading::ThreadHandle> threads;
+  threads.resize(numThreads);
+
+  SECTION("Concurrent churn")
+  {
+    int32_t failures = 0;
+
+    for(int i = 0; i < numThreads; i++)
+    {
+      threads[i] = Threading::CreateThread([&failures, i]() {
+        rdcarray<PoolTestItem *> live;
+        live.resize(1000);
+
+        for(int iter = 0; iter < 50; iter++)
+        {
+          // vary the number held so slots are passed back and forth between the caches and pools
+          size_t num = live.size() >> (iter % 4);
+
+          for(size_t o = 0; o < num; o++)
+          {
+            live[o] = new PoolTestItem;
+            live[o]->tag = (uint64_t(i) << 32) | o;
+
+            if(!PoolTestItem::IsAlloc(live[o]))
+              Atomic::Inc32(&failures);
+          }
+
+          // if any slot was handed out twice, another thread or object will have stomped its tag
+          for(size_t o = 0; o < num; o++)
+          {
+            if(live[o]->tag != ((uint64_t(i) << 32) | o))
+              Atomic::Inc32(&failures);
+
+            delete live[o];
+          }
+        }
+      });
+    }
+
+    for(Threading::ThreadHandle t : threads)
+    {
+      Threading::JoinThread(t);
+      Threading::CloseThread(t);
+    }
+
+    CHECK(failures == 0);
+
+    PoolTestItem notPooled;
+    CHECK_FALSE(PoolTestItem::IsAlloc(&notPooled));
+    CHECK_FALSE(PoolTestItem::IsAlloc(NULL));
+  }
+
+  SECTION("Lookup by address across many pools")
+  {
+    // each additional pool is 512kB, so this spans ~50 pools
+    const size_t liveCount = 400000;
+
+    rdcarray<PoolTestItem *> held;
+    held.resize(liveCount);
+    for(size_t o = 0; o < liveCount; o++)
+      held[o] = new PoolTestItem;
+
+    // free every other item so later pools have holes to be reused
+    for(size_t o = 0; o < liveCount; o += 2)
+    {
+      delete held[o];
+      held[o] = NULL;
+    }
+
+    for(size_t o = 0; o < liveCount; o += 2)
+      held[o] = new PoolTestItem;
+
+    size_t notFound = 0;
+    for(PoolTestItem *item : held)
+    {
+      if(!PoolTestItem::IsAlloc(item))
+        notFound++;
+    }
+
+    CHECK(notFound == 0);
+
+    // the binary search over pools must still reject an address outside all of them
+    PoolTestItem notPooled;
+    CHECK_FALSE(PoolTestItem::IsAlloc(&notPooled));
+
+    for(PoolTestItem *item : held)
+      delete item;
+  }
+}
+
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
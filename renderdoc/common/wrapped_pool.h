@@ -38,52 +38,43 @@ public:
   typedef C Type;
 };
 
-// allocate each class in its own pool so we can identify the type by the pointer
+// allocate each class in its own pool so we can identify the type by the pointer.
+//
+// Allocations and frees go through a small cache of free slots chosen by hashing the calling
+// thread's ID, so in the common case they only take a spinlock that no other thread is using.
+// Caches are refilled from and flushed back to the pools in batches under the pool lock. Pools
+// with free slots are kept in a list so finding one doesn't need to scan every pool, and the
+// additional pools are published in a table sorted by address so ownership can be found with a
+// binary search, without locking.
 template <typename WrapType, bool DebugClear = true>
 class WrappingPool
 {
 public:
   void *Allocate()
   {
-    SCOPED_LOCK(m_Lock);
-
-    // try and allocate from immediate pool
-    void *ret = m_ImmediatePool.Allocate();
-    if(ret != NULL)
-      return ret;
+    void *ret = NULL;
 
-    // fall back to additional pools, if there are any
-    for(size_t i = 0; i < m_AdditionalPools.size(); i++)
     {
-      ret = m_AdditionalPools[i]->Allocate();
-      if(ret != NULL)
-        return ret;
+      SlotCache &cache = GetCache();
+      SCOPED_SPINLOCK(cache.lock);
+
+      if(cache.count == 0)
+        Refill(cache);
+
+      ret = cache.slots[--cache.count];
     }
 
-    // allocate a new additional pool and use that to allocate from
-    m_AdditionalPools.push_back(new ItemPool(m_AdditionalPools.size() + 1));
+#if ENABLED(RDOC_DEVEL)
+    memset(ret, 0xb0, sizeof(WrapType));
+#endif
 
-    return m_AdditionalPools.back()->Allocate();
+    return ret;
   }
 
-  bool IsAlloc(const void *p)
+  bool IsAlloc(const void *p) const
   {
-    // we can check the immediate pool without locking
-    if(m_ImmediatePool.IsAlloc(p))
-      return true;
-
-    // if we have additional pools, lock and check them.
-    // TODO: Check for additional pools in a lock-free manner,
-    // to prevent the cost of locking if there are no more pools.
-    {
-      SCOPED_LOCK(m_Lock);
-
-      for(size_t i = 0; i < m_AdditionalPools.size(); i++)
-        if(m_AdditionalPools[i]->IsAlloc(p))
-          return true;
-    }
-
-    return false;
+    // we can check the immediate pool directly, and the rest through the sorted table
+    return m_ImmediatePool.IsAlloc(p) || FindAdditionalPool(p) != NULL;
   }
 
   void Deallocate(void *p)
@@ -91,41 +82,61 @@ public:
     if(p == NULL)
       return;
 
-    SCOPED_LOCK(m_Lock);
-
-    // try immediate pool
-    if(m_ImmediatePool.IsAlloc(p))
+    if(!IsAlloc(p))
     {
-      m_ImmediatePool.Deallocate(p);
+      // this is an error - deleting an object that we don't recognise
+      RDCERR("Resource being deleted through wrong pool - 0x%p not a member of this pool", p);
       return;
     }
-    else if(!m_AdditionalPools.empty())
-    {
-      // fall back and try additional pools
-      for(size_t i = 0; i < m_AdditionalPools.size(); i++)
-      {
-        if(m_AdditionalPools[i]->IsAlloc(p))
-        {
-          m_AdditionalPools[i]->Deallocate(p);
-          return;
-        }
-      }
-    }
 
-    // this is an error - deleting an object that we don't recognise
-    RDCERR("Resource being deleted through wrong pool - 0x%p not a member of this pool", p);
+#if ENABLED(RDOC_DEVEL)
+    if(DebugClear)
+      memset(p, 0xfe, sizeof(WrapType));
+#endif
+
+    SlotCache &cache = GetCache();
+    SCOPED_SPINLOCK(cache.lock);
+
+    if(cache.count == CacheSize)
+      Flush(cache);
+
+    cache.slots[cache.count++] = p;
+  }
+
+  // the immediate pool and any additional pools, for diagnostics
+  size_t GetPoolCount()
+  {
+    SCOPED_LOCK(m_Lock);
+    return m_AdditionalPools.size() + 1;
   }
 
   static const size_t AllocByteSize;
 
 private:
-  WrappingPool() : m_ImmediatePool(0) {}
+  // threads are hashed to one of 2^CacheBits slot caches
+  static const uint32_t CacheBits = 4;
+  static const uint32_t CacheCount = 1U << CacheBits;
+  // the number of free slots each cache can hold, and how many move to or from the pools at once
+  static const uint32_t CacheSize = 32;
+  static const uint32_t CacheBatch = CacheSize / 2;
+
+  WrappingPool() : m_ImmediatePool(0)
+  {
+    m_ImmediatePool.freeListed = true;
+    m_FreePools.push_back(&m_ImmediatePool);
+  }
   ~WrappingPool()
   {
     for(size_t i = 0; i < m_AdditionalPools.size(); i++)
       delete m_AdditionalPools[i];
 
     m_AdditionalPools.clear();
+
+    for(size_t i = 0; i < m_PoolTables.size(); i++)
+      delete m_PoolTables[i];
+
+    m_PoolTables.clear();
+    m_PoolTable = NULL;
   }
 
   Threading::CriticalSection m_Lock;
@@ -155,7 +166,8 @@ private:
         size = 512 * 1024;
       }
 
-      count = size / itemSize;
+      // always fit at least one item, for objects larger than the pool size
+      count = RDCMAX(size / itemSize, (size_t)1);
 
       items = (WrapType *)(new uint8_t[count * itemSize]);
       freeStack = new int[count];
@@ -177,14 +189,7 @@ private:
         return NULL;
       }
       --freeStackHead;
-      void *ret = items + freeStack[freeStackHead];
-
-#if ENABLED(RDOC_DEVEL)
-      const size_t itemSize = sizeof(WrapType);
-      memset(ret, 0xb0, itemSize);
-#endif
-
-      return ret;
+      return items + freeStack[freeStackHead];
     }
 
     void Deallocate(void *p)
@@ -193,12 +198,6 @@ private:
 
       freeStack[freeStackHead] = idx;
       ++freeStackHead;
-
-#if ENABLED(RDOC_DEVEL)
-      const size_t itemSize = sizeof(WrapType);
-      if(DebugClear)
-        memset(p, 0xfe, itemSize);
-#endif
     }
 
     bool IsAlloc(const void *p) const { return p >= &items[0] && p < &items[count]; }
@@ -206,10 +205,139 @@ private:
     size_t count;
     int *freeStack;
     size_t freeStackHead;
+    // whether this pool is in m_FreePools
+    bool freeListed = false;
   };
 
+  struct SlotCache
+  {
+    Threading::SpinLock lock;
+    uint32_t count = 0;
+    void *slots[CacheSize];
+  };
+
+  SlotCache &GetCache()
+  {
+    // fibonacci hash so that thread IDs which only differ in a few bits still spread out
+    uint64_t id = Threading::GetCurrentID();
+    return m_Caches[(id * 0x9E3779B97F4A7C15ULL) >> (64 - CacheBits)];
+  }
+
+  ItemPool *FindAdditionalPool(const void *p) const
+  {
+    // tables are fully written before being published, and never modified or freed afterwards
+    // while the pool is alive, so reading the current one doesn't need a lock.
+    const rdcarray<ItemPool *> *table = *(rdcarray<ItemPool *> *const volatile *)&m_PoolTable;
+    if(table == NULL)
+      return NULL;
+
+    // find the last pool starting at or before p
+    const uintptr_t addr = (uintptr_t)p;
+    size_t lo = 0, hi = table->size();
+    while(lo < hi)
+    {
+      size_t mid = (lo + hi) / 2;
+      if((uintptr_t)table->at(mid)->items <= addr)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    if(lo == 0)
+      return NULL;
+
+    ItemPool *pool = table->at(lo - 1);
+    return pool->IsAlloc(p) ? pool : NULL;
+  }
+
+  // called with the cache locked, moves a batch of free slots into the cache
+  void Refill(SlotCache &cache)
+  {
+    SCOPED_LOCK(m_Lock);
+
+    while(cache.count < CacheBatch)
+    {
+      if(m_FreePools.empty())
+      {
+        // only add a new pool if the existing ones are entirely exhausted
+        if(cache.count > 0)
+          break;
+
+        AddPool();
+      }
+
+      ItemPool *pool = m_FreePools.back();
+
+      while(cache.count < CacheBatch && pool->freeStackHead > 0)
+        cache.slots[cache.count++] = pool->Allocate();
+
+      if(pool->freeStackHead == 0)
+      {
+        pool->freeListed = false;
+        m_FreePools.pop_back();
+      }
+    }
+  }
+
+  // called with the cache locked and full, returns its oldest batch of slots to their pools
+  void Flush(SlotCache &cache)
+  {
+    SCOPED_LOCK(m_Lock);
+
+    for(uint32_t i = 0; i < CacheBatch; i++)
+    {
+      void *p = cache.slots[i];
+      ItemPool *pool = m_ImmediatePool.IsAlloc(p) ? &m_ImmediatePool : FindAdditionalPool(p);
+
+      pool->Deallocate(p);
+
+      if(!pool->freeListed)
+      {
+        pool->freeListed = true;
+        m_FreePools.push_back(pool);
+      }
+    }
+
+    cache.count -= CacheBatch;
+    memmove(cache.slots, cache.slots + CacheBatch, cache.count * sizeof(void *));
+  }
+
+  // called with m_Lock held
+  void AddPool()
+  {
+    ItemPool *pool = new ItemPool(m_AdditionalPools.size() + 1);
+    m_AdditionalPools.push_back(pool);
+
+    pool->freeListed = true;
+    m_FreePools.push_back(pool);
+
+    // build a new sorted table with the pool inserted. The old table could still be in use by a
+    // lock-free lookup so it is kept until the pool is destroyed.
+    rdcarray<ItemPool *> *table = new rdcarray<ItemPool *>;
+    table->reserve(m_AdditionalPools.size());
+    if(m_PoolTable)
+      table->append(*m_PoolTable);
+
+    size_t idx = 0;
+    while(idx < table->size() && (uintptr_t)table->at(idx)->items < (uintptr_t)pool->items)
+      idx++;
+    table->insert(idx, pool);
+
+    m_PoolTables.push_back(table);
+
+    // publish with a full barrier so the table's contents are visible before the pointer
+    Atomic::CmpExchPtr((void **)&m_PoolTable, m_PoolTable, table);
+  }
+
   ItemPool m_ImmediatePool;
   rdcarray<ItemPool *> m_AdditionalPools;
+  // pools that have at least one free slot, most recently freed into at the back
+  rdcarray<ItemPool *> m_FreePools;
+  // the current table of additional pools sorted by address, and every table ever published
+  rdcarray<ItemPool *> *m_PoolTable = NULL;
+  rdcarray<rdcarray<ItemPool *> *> m_PoolTables;
+
+  SlotCache m_Caches[CacheCount];
 
   friend typename FriendMaker<WrapType>::Type;
 };
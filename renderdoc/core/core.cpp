@@ -28,6 +28,7 @@
 #include <algorithm>
 #include "api/replay/version.h"
 #include "common/common.h"
+#include "common/profiler.h"
 #include "common/threading.h"
 #include "core/settings.h"
 #include "hooks/hooks.h"
@@ -530,6 +531,8 @@ void RenderDoc::Initialise()
     RDCLOGOUTPUT();
 
   ProcessConfig();
+
+  Profiler::Init();
 }
 
 RenderDoc::~RenderDoc()
@@ -543,6 +546,8 @@ RenderDoc::~RenderDoc()
     (*it)();
   m_ShutdownFunctions.clear();
 
+  Profiler::Shutdown();
+
   for(size_t i = 0; i < m_Captures.size(); i++)
   {
     if(m_Captures[i].retrieved)
@@ -622,6 +627,9 @@ void RenderDoc::InitialiseReplay(GlobalEnvironment env, const rdcarray<rdcstr> &
   else
     RecreateCrashHandler();
 
+  // the config may have been changed since the library was initialised
+  Profiler::Init();
+
   if(env.enumerateGPUs)
   {
     m_AvailableGPUThread = Threading::CreateThread([this]() {
@@ -741,6 +749,8 @@ void RenderDoc::ShutdownReplay()
   for(auto it = m_ShutdownFunctions.begin(); it != m_ShutdownFunctions.end(); ++it)
     (*it)();
   m_ShutdownFunctions.clear();
+
+  Profiler::Shutdown();
 }
 
 void RenderDoc::RegisterShutdownFunction(ShutdownFunction func)
@@ -712,6 +712,8 @@ private:
 
   volatile bool m_TargetControlThreadShutdown;
   volatile bool m_ControlClientThreadShutdown;
+  // used to wake the client thread when it's waiting for messages, protected by m_SingleClientLock
+  Network::SocketReactor *m_ControlClientReactor = NULL;
   Threading::CriticalSection m_SingleClientLock;
   rdcstr m_SingleClientName;
   bool m_RequestControllerShow = false;
@@ -721,6 +723,7 @@ private:
 
   static void TargetControlServerThread(Network::Socket *sock);
   static void TargetControlClientThread(uint32_t version, Network::Socket *client);
+  static void WakeControlClientThread();
 
   ICrashHandler *m_ExHandler;
   Threading::RWLock m_ExHandlerLock;
@@ -87,7 +87,7 @@ public:
     RDCLOG("Connecting to server %s", m_PipeName.c_str());
 
     m_ExHandler = new google_breakpad::ExceptionHandler(
-        StringFormat::UTF82Wide(dumpFolder).c_str(), NULL, NULL, NULL,
+        StringFormat::UTF82Wide(dumpFolder).c_str(), &FlushLogBeforeDump, NULL, NULL,
         google_breakpad::ExceptionHandler::HANDLER_ALL, dumpType,
         StringFormat::UTF82Wide(m_PipeName).c_str(), &custom);
 
@@ -102,7 +102,7 @@ public:
       CreateCrashHandlingServer();
 
       m_ExHandler = new google_breakpad::ExceptionHandler(
-          StringFormat::UTF82Wide(dumpFolder).c_str(), NULL, NULL, NULL,
+          StringFormat::UTF82Wide(dumpFolder).c_str(), &FlushLogBeforeDump, NULL, NULL,
           google_breakpad::ExceptionHandler::HANDLER_ALL, dumpType,
           StringFormat::UTF82Wide(m_PipeName).c_str(), &custom);
 
@@ -116,6 +116,13 @@ public:
       m_ExHandler->RegisterAppMemory((void *)mem[i].ptr, mem[i].length);
   }
 
+  // breakpad replaces any unhandled exception filter, so write out the queued log here instead
+  static bool FlushLogBeforeDump(void *, EXCEPTION_POINTERS *, MDRawAssertionInfo *)
+  {
+    rdclog_crashflush();
+    return true;
+  }
+
   void CreateCrashHandlingServer()
   {
     PROCESS_INFORMATION pi;
@@ -38,17 +38,32 @@
 #include "strings/string_utils.h"
 #include "replay_proxy.h"
 
+#include "lz4/lz4.h"
+
 RDOC_CONFIG(uint32_t, RemoteServer_TimeoutMS, 5000,
             "Timeout in milliseconds for remote server operations.");
 
+RDOC_CONFIG(bool, RemoteServer_CompressTransfers, true,
+            "Compress capture file blocks with LZ4 when transferring them to or from a remote "
+            "server, when doing so makes them smaller.");
+
 RDOC_CONFIG(bool, RemoteServer_DebugLogging, false,
             "Output a verbose logging file in the system's temporary folder containing the "
             "traffic to and from the remote server.");
 
 #define MAKE_REMOTE_SERVER_VERSION(maj, min) uint32_t((maj)*1000) + (min)
 
+// bumped whenever the packets change without the version changing, so that builds speaking
+// different protocols refuse to connect instead of misreading each other. It's kept in the top
+// byte so the release version can still be reported on a mismatch.
+//  1 - shader debugging can be batched in a single replay proxy packet
+//  2 - capture files are copied in checksummed blocks
+//  3 - copies to the server resume from the server's partial file
+static const uint32_t RemoteServerProtocolRevision = 3;
+
 static const uint32_t RemoteServerProtocolVersion =
-    MAKE_REMOTE_SERVER_VERSION(RENDERDOC_VERSION_MAJOR, RENDERDOC_VERSION_MINOR);
+    (MAKE_REMOTE_SERVER_VERSION(RENDERDOC_VERSION_MAJOR, RENDERDOC_VERSION_MINOR)) |
+    (RemoteServerProtocolRevision << 24);
 
 enum RemoteServerPacket
 {
@@ -86,6 +101,7 @@ enum RemoteServerPacket
   eRemoteServer_GetSectionContents,
   eRemoteServer_WriteSection,
   eRemoteServer_GetAvailableGPUs,
+  eRemoteServer_CaptureBlock,
   eRemoteServer_RemoteServerCount,
 };
 
@@ -130,6 +146,7 @@ rdcstr DoStringise(const RemoteServerPacket &el)
     STRINGISE_ENUM_NAMED(eRemoteServer_GetSectionContents, "GetSectionContents");
     STRINGISE_ENUM_NAMED(eRemoteServer_WriteSection, "WriteSection");
     STRINGISE_ENUM_NAMED(eRemoteServer_GetAvailableGPUs, "GetAvailableGPUs");
+    STRINGISE_ENUM_NAMED(eRemoteServer_CaptureBlock, "CaptureBlock");
     STRINGISE_ENUM_NAMED(eRemoteServer_RemoteServerCount, "RemoteServerCount");
   }
   END_ENUM_STRINGISE();
@@ -146,6 +163,238 @@ rdcstr GetRemoteServerChunkName(uint32_t idx)
 #define WRITE_DATA_SCOPE() WriteSerialiser &ser = writer;
 #define READ_DATA_SCOPE() ReadSerialiser &ser = reader;
 
+// capture files are transferred in checksummed blocks. The receiver writes each verified block to
+// a partial file as it arrives. When a copy is interrupted the receiver keeps its partial file, and
+// a later copy of the same file resumes after the blocks that still match. Copies to the server
+// identify the file by a key from the client's path, size and modified time, since the server's
+// final path is unique per copy.
+//
+// A capture is only copied once it has been completely written, a copy can't start while the
+// capture is still being written out.
+static const uint64_t CaptureBlockSize = 4 * 1024 * 1024;
+
+static uint64_t CaptureBlockChecksum(const byte *data, size_t size)
+{
+  // FNV-1a
+  uint64_t hash = 14695981039346656037ULL;
+  for(size_t i = 0; i < size; i++)
+  {
+    hash ^= data[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+// checksums of each complete block in the first length bytes of f
+static rdcarray<uint64_t> CaptureBlockChecksums(FILE *f, uint64_t length)
+{
+  rdcarray<uint64_t> ret;
+
+  if(f == NULL)
+    return ret;
+
+  bytebuf block;
+  block.resize((size_t)CaptureBlockSize);
+
+  FileIO::fseek64(f, 0, SEEK_SET);
+
+  for(uint64_t offset = 0; offset + CaptureBlockSize <= length; offset += CaptureBlockSize)
+  {
+    if(FileIO::fread(block.data(), 1, block.size(), f) != block.size())
+      break;
+
+    ret.push_back(CaptureBlockChecksum(block.data(), block.size()));
+  }
+
+  return ret;
+}
+
+// returns the offset a transfer of f, of size fileSize, can resume from given the receiver's
+// checksums of the blocks it already has. Every block that is skipped must match, and at least one
+// block is always left to send so the receiver sees where the sender decided to start.
+static uint64_t CaptureResumeOffset(FILE *f, uint64_t fileSize, const rdcarray<uint64_t> &checksums)
+{
+  if(f == NULL || fileSize == 0 || checksums.empty())
+    return 0;
+
+  rdcarray<uint64_t> ours =
+      CaptureBlockChecksums(f, RDCMIN(fileSize - 1, checksums.size() * CaptureBlockSize));
+
+  size_t matching = 0;
+  while(matching < ours.size() && ours[matching] == checksums[matching])
+    matching++;
+
+  return matching * CaptureBlockSize;
+}
+
+static bool SendCaptureBlocks(WriteSerialiser &ser, FILE *f, uint64_t offset, uint64_t fileSize,
+                              RENDERDOC_ProgressCallback progress)
+{
+  const bool compress = RemoteServer_CompressTransfers();
+
+  bytebuf block, compressed;
+  block.resize((size_t)CaptureBlockSize);
+  if(compress)
+    compressed.resize((size_t)LZ4_COMPRESSBOUND(CaptureBlockSize));
+
+  FileIO::fseek64(f, offset, SEEK_SET);
+
+  while(offset < fileSize)
+  {
+    uint32_t size = (uint32_t)RDCMIN(CaptureBlockSize, fileSize - offset);
+
+    if(FileIO::fread(block.data(), 1, size, f) != size)
+    {
+      RDCERR("Failed to read capture block at %llu", offset);
+      return false;
+    }
+
+    uint64_t checksum = CaptureBlockChecksum(block.data(), size);
+    bool isCompressed = false;
+
+    int compSize = 0;
+    if(compress)
+      compSize = LZ4_compress_default((const char *)block.data(), (char *)compressed.data(),
+                                      (int)size, (int)compressed.size());
+
+    {
+      SCOPED_SERIALISE_CHUNK(eRemoteServer_CaptureBlock);
+      SERIALISE_ELEMENT(offset);
+      SERIALISE_ELEMENT(size);
+      SERIALISE_ELEMENT(checksum);
+
+      // only send the compressed data if it actually saved anything, already-compressed sections
+      // won't get any smaller
+      isCompressed = compSize > 0 && (uint32_t)compSize < size;
+      SERIALISE_ELEMENT(isCompressed);
+
+      byte *data = isCompressed ? compressed.data() : block.data();
+      ser.Serialise("data"_lit, data, isCompressed ? (uint64_t)compSize : (uint64_t)size);
+    }
+
+    if(ser.IsErrored())
+      return false;
+
+    offset += size;
+
+    if(progress)
+      progress(float(offset) / float(fileSize));
+  }
+
+  return true;
+}
+
+// receives blocks into f until the end of the file. The first block must start on a block
+// boundary within the partialSize bytes already in f, and every block after must follow on
+// directly.
+static bool ReceiveCaptureBlocks(ReadSerialiser &ser, FILE *f, uint64_t partialSize,
+                                 uint64_t fileSize, RENDERDOC_ProgressCallback progress)
+{
+  if(fileSize == 0)
+  {
+    FileIO::ftruncateat(f, 0);
+    return true;
+  }
+
+  bytebuf block, data;
+  block.resize((size_t)CaptureBlockSize);
+
+  uint64_t expected = ~0ULL;
+
+  while(expected != fileSize)
+  {
+    RemoteServerPacket type = ser.ReadChunk<RemoteServerPacket>();
+
+    if(ser.IsErrored() || type != eRemoteServer_CaptureBlock)
+    {
+      RDCERR("Expected capture block, got %s", ToStr(type).c_str());
+      return false;
+    }
+
+    uint64_t offset = 0, checksum = 0;
+    uint32_t size = 0;
+    bool isCompressed = false;
+
+    SERIALISE_ELEMENT(offset);
+    SERIALISE_ELEMENT(size);
+    SERIALISE_ELEMENT(checksum);
+    SERIALISE_ELEMENT(isCompressed);
+    SERIALISE_ELEMENT(data);
+
+    ser.EndChunk();
+
+    if(ser.IsErrored())
+      return false;
+
+    if(expected == ~0ULL)
+    {
+      if(offset > partialSize || (offset % CaptureBlockSize) != 0)
+      {
+        RDCERR("Capture transfer started at unexpected offset %llu", offset);
+        return false;
+      }
+
+      // discard anything past where the sender is starting from
+      FileIO::ftruncateat(f, offset);
+      FileIO::fseek64(f, offset, SEEK_SET);
+    }
+    else if(offset != expected)
+    {
+      RDCERR("Capture block at %llu received out of order, expected %llu", offset, expected);
+      return false;
+    }
+
+    if(size > CaptureBlockSize || offset + size > fileSize)
+    {
+      RDCERR("Invalid capture block of %u bytes at %llu", size, offset);
+      return false;
+    }
+
+    const byte *contents = data.data();
+
+    if(isCompressed)
+    {
+      int decompSize = LZ4_decompress_safe((const char *)data.data(), (char *)block.data(),
+                                           (int)data.size(), (int)size);
+
+      if(decompSize != (int)size)
+      {
+        RDCERR("Failed to decompress capture block at %llu", offset);
+        return false;
+      }
+
+      contents = block.data();
+    }
+    else if(data.size() != size)
+    {
+      RDCERR("Capture block at %llu has %zu bytes, expected %u", offset, data.size(), size);
+      return false;
+    }
+
+    if(CaptureBlockChecksum(contents, size) != checksum)
+    {
+      RDCERR("Checksum mismatch in capture block at %llu", offset);
+      return false;
+    }
+
+    if(FileIO::fwrite(contents, 1, size, f) != size)
+    {
+      RDCERR("Failed to write capture block at %llu", offset);
+      return false;
+    }
+
+    // make sure the block is on disk before counting it as received, so a resume can trust it
+    FileIO::fflush(f);
+
+    expected = offset + size;
+
+    if(progress)
+      progress(float(expected) / float(fileSize));
+  }
+
+  return true;
+}
+
 struct ClientThread
 {
   ClientThread()
@@ -392,24 +641,60 @@ static void ActiveRemoteClientThread(ClientThread *threadData,
     else if(type == eRemoteServer_CopyCaptureFromRemote)
     {
       rdcstr path;
+      rdcarray<uint64_t> resumeChecksums;
 
       {
         READ_DATA_SCOPE();
         SERIALISE_ELEMENT(path);
+        SERIALISE_ELEMENT(resumeChecksums);
       }
 
       reader.EndChunk();
 
+      FILE *f = FileIO::fopen(path, FileIO::ReadBinary);
+
+      bool success = (f != NULL);
+      uint64_t fileSize = success ? FileIO::GetFileSize(path) : 0;
+
+      // skip only the blocks the client already has that match ours
+      uint64_t startOffset = CaptureResumeOffset(f, fileSize, resumeChecksums);
+
       {
         WRITE_DATA_SCOPE();
         SCOPED_SERIALISE_CHUNK(eRemoteServer_CopyCaptureFromRemote);
+        SERIALISE_ELEMENT(success);
+        SERIALISE_ELEMENT(fileSize);
+        SERIALISE_ELEMENT(startOffset);
+      }
+
+      if(f)
+      {
+        if(startOffset > 0)
+          RDCLOG("Resuming transfer of '%s' from %llu bytes.", path.c_str(), startOffset);
+
+        success = SendCaptureBlocks(writer, f, startOffset, fileSize, NULL);
 
-        StreamReader fileStream(FileIO::fopen(path, FileIO::ReadBinary));
-        ser.SerialiseStream(path, fileStream);
+        FileIO::fclose(f);
+
+        if(!success)
+        {
+          RDCERR("Network error sending file");
+          break;
+        }
       }
     }
     else if(type == eRemoteServer_CopyCaptureToRemote)
     {
+      uint64_t fileSize = 0, uploadKey = 0;
+
+      {
+        READ_DATA_SCOPE();
+        SERIALISE_ELEMENT(fileSize);
+        SERIALISE_ELEMENT(uploadKey);
+      }
+
+      reader.EndChunk();
+
       rdcstr path;
       rdcstr dummy, dummy2;
       FileIO::GetDefaultFiles("remotecopy", path, dummy, dummy2);
@@ -417,32 +702,54 @@ static void ActiveRemoteClientThread(ClientThread *threadData,
       // remove the .rdc
       path.erase(path.size() - 4, 4);
 
+      // the partial file is named after the upload so an interrupted copy of the same file can
+      // resume, even from a different server process
+      rdcstr partialPath = path + StringFormat::Fmt("_upload_%016llx.rdc.partial", uploadKey);
+
       // append a process- and capture- specific suffix to avoid clashes
       path += StringFormat::Fmt("_remotecopy_%u_%u.rdc", Process::GetCurrentPID(), captureNum);
       captureNum++;
 
-      RDCLOG("Copying file to local path '%s'.", path.c_str());
-
       FileIO::CreateParentDirectory(path);
 
-      {
-        READ_DATA_SCOPE();
+      rdcarray<uint64_t> resumeChecksums;
 
-        StreamWriter streamWriter(FileIO::fopen(path, FileIO::WriteBinary), Ownership::Stream);
+      FILE *f = FileIO::fopen(partialPath, FileIO::UpdateBinary);
+      if(f)
+        resumeChecksums = CaptureBlockChecksums(f, FileIO::GetFileSize(partialPath));
+      else
+        f = FileIO::fopen(partialPath, FileIO::OverwriteBinary);
 
-        ser.SerialiseStream(path, streamWriter, NULL);
-      }
+      bool success = (f != NULL);
 
-      reader.EndChunk();
+      {
+        WRITE_DATA_SCOPE();
+        SCOPED_SERIALISE_CHUNK(eRemoteServer_CopyCaptureToRemote);
+        SERIALISE_ELEMENT(success);
+        SERIALISE_ELEMENT(resumeChecksums);
+      }
 
-      if(reader.IsErrored())
+      if(!success)
       {
-        FileIO::Delete(path);
+        RDCERR("Can't open '%s' to receive file", partialPath.c_str());
+        continue;
+      }
+
+      RDCLOG("Copying file to local path '%s'.", path.c_str());
 
-        RDCERR("Network error receiving file");
+      success = ReceiveCaptureBlocks(reader, f, resumeChecksums.size() * CaptureBlockSize, fileSize,
+                                     NULL);
+
+      FileIO::fclose(f);
+
+      if(!success)
+      {
+        RDCERR("Network error receiving file, partial copy kept to resume from");
         break;
       }
 
+      FileIO::Move(partialPath, path, true);
+
       RDCLOG("File received.");
 
       tempFiles.push_back(path);
@@ -521,19 +828,23 @@ static void ActiveRemoteClientThread(ClientThread *threadData,
           bool kill = false;
           float progress = 0.0f;
 
+          // the ticker waits on this between updates so that it can be woken to exit immediately
+          Threading::Semaphore tickerWait;
+
           RenderDoc::Inst().SetProgressCallback<LoadProgress>([&progress](float p) { progress = p; });
 
-          Threading::ThreadHandle ticker = Threading::CreateThread([&writer, &kill, &progress]() {
-            while(!kill)
-            {
-              {
-                WRITE_DATA_SCOPE();
-                SCOPED_SERIALISE_CHUNK(eRemoteServer_LogOpenProgress);
-                SERIALISE_ELEMENT(progress);
-              }
-              Threading::Sleep(100);
-            }
-          });
+          Threading::ThreadHandle ticker =
+              Threading::CreateThread([&writer, &kill, &progress, &tickerWait]() {
+                while(!kill)
+                {
+                  {
+                    WRITE_DATA_SCOPE();
+                    SCOPED_SERIALISE_CHUNK(eRemoteServer_LogOpenProgress);
+                    SERIALISE_ELEMENT(progress);
+                  }
+                  tickerWait.WaitForWake(100);
+                }
+              });
 
           // if we have a replay driver, try to create it so we can display a local preview e.g.
           if(RenderDoc::Inst().HasReplayDriver(rdc->GetDriver()))
@@ -567,6 +878,7 @@ static void ActiveRemoteClientThread(ClientThread *threadData,
           RenderDoc::Inst().SetProgressCallback<LoadProgress>(RENDERDOC_ProgressCallback());
 
           kill = true;
+          tickerWait.Wake();
           Threading::JoinThread(ticker);
           Threading::CloseThread(ticker);
 
@@ -626,21 +938,26 @@ static void ActiveRemoteClientThread(ClientThread *threadData,
         {
           float progress = 0.0f;
 
-          Threading::ThreadHandle ticker = Threading::CreateThread([&writer, &resolver, &progress]() {
-            while(!resolver)
-            {
-              {
-                WRITE_DATA_SCOPE();
-                SCOPED_SERIALISE_CHUNK(eRemoteServer_ResolverProgress);
-                SERIALISE_ELEMENT(progress);
-              }
-              Threading::Sleep(100);
-            }
-          });
+          Threading::Semaphore tickerWait;
+
+          Threading::ThreadHandle ticker =
+              Threading::CreateThread([&writer, &resolver, &progress, &tickerWait]() {
+                while(!resolver)
+                {
+                  {
+                    WRITE_DATA_SCOPE();
+                    SCOPED_SERIALISE_CHUNK(eRemoteServer_ResolverProgress);
+                    SERIALISE_ELEMENT(progress);
+                  }
+                  tickerWait.WaitForWake(100);
+                }
+              });
 
           resolver = Callstack::MakeResolver(false, buf.data(), buf.size(),
                                              [&progress](float p) { progress = p; });
 
+          tickerWait.Wake();
+
           Threading::JoinThread(ticker);
           Threading::CloseThread(ticker);
         }
@@ -1038,7 +1355,9 @@ void RenderDoc::BecomeRemoteServer(const rdcstr &listenhost, uint16_t port,
 
   while(!killReplay())
   {
-    Network::Socket *client = sock->AcceptClient(0);
+    // block until a client connects. The timeout bounds how long it takes to reap finished clients
+    // and notice if we've been killed
+    Network::Socket *client = sock->AcceptClient(20);
 
     {
       SCOPED_LOCK(activeClientData.lock);
@@ -1075,8 +1394,6 @@ void RenderDoc::BecomeRemoteServer(const rdcstr &listenhost, uint16_t port,
         return;
       }
 
-      Threading::Sleep(5);
-
       continue;
     }
 
@@ -1226,10 +1543,15 @@ RENDERDOC_CreateRemoteServerConnection(const rdcstr &URL, IRemoteServer **rend)
     {
       SAFE_DELETE(sock);
 
-      rdcstr ver = StringFormat::Fmt("Server on v%d.%d", remoteVersion / 1000, remoteVersion % 1000);
+      uint32_t remoteRelease = remoteVersion & 0xffffff;
+
+      rdcstr ver =
+          StringFormat::Fmt("Server on v%d.%d", remoteRelease / 1000, remoteRelease % 1000);
 
       if(remoteVersion == 0)
         ver = "Server older than v1.23";
+      else if(remoteRelease == (RemoteServerProtocolVersion & 0xffffff))
+        ver += " with a different protocol revision";
 
       return RDResult(ResultCode::NetworkVersionMismatch, ver);
     }
@@ -1530,27 +1852,52 @@ ExecuteResult RemoteServer::ExecuteAndInject(const rdcstr &app, const rdcstr &wo
 void RemoteServer::CopyCaptureFromRemote(const rdcstr &remotepath, const rdcstr &localpath,
                                          RENDERDOC_ProgressCallback progress)
 {
+  rdcstr partialPath = localpath + ".partial";
+
+  rdcarray<uint64_t> resumeChecksums;
+
+  // if a previous copy to this path was interrupted, offer the checksums of every complete block
+  // so the server can resume after the ones that still match
+  // only a partial file created here is removed if the copy can't start, an older one can still be
+  // resumed later
+  bool createdPartial = false;
+
+  FILE *f = FileIO::fopen(partialPath, FileIO::UpdateBinary);
+  if(f)
+  {
+    resumeChecksums = CaptureBlockChecksums(f, FileIO::GetFileSize(partialPath));
+  }
+  else
+  {
+    f = FileIO::fopen(partialPath, FileIO::OverwriteBinary);
+    createdPartial = true;
+  }
+
+  if(!f)
+  {
+    RDCERR("Can't open '%s' to receive file", partialPath.c_str());
+    return;
+  }
+
   {
     WRITE_DATA_SCOPE();
     SCOPED_SERIALISE_CHUNK(eRemoteServer_CopyCaptureFromRemote);
     SERIALISE_ELEMENT(remotepath);
+    SERIALISE_ELEMENT(resumeChecksums);
   }
 
+  bool success = false;
+  uint64_t fileSize = 0, startOffset = 0;
+
   {
     READ_DATA_SCOPE();
     RemoteServerPacket type = ser.ReadChunk<RemoteServerPacket>();
 
     if(type == eRemoteServer_CopyCaptureFromRemote)
     {
-      StreamWriter streamWriter(FileIO::fopen(localpath, FileIO::WriteBinary), Ownership::Stream);
-
-      ser.SerialiseStream(localpath, streamWriter, progress);
-
-      if(ser.IsErrored())
-      {
-        RDCERR("Network error receiving file");
-        return;
-      }
+      SERIALISE_ELEMENT(success);
+      SERIALISE_ELEMENT(fileSize);
+      SERIALISE_ELEMENT(startOffset);
     }
     else
     {
@@ -1559,6 +1906,31 @@ void RemoteServer::CopyCaptureFromRemote(const rdcstr &remotepath, const rdcstr
 
     ser.EndChunk();
   }
+
+  if(!success)
+  {
+    RDCERR("Couldn't open remote file '%s'", remotepath.c_str());
+    FileIO::fclose(f);
+    if(createdPartial)
+      FileIO::Delete(partialPath);
+    return;
+  }
+
+  if(startOffset > 0)
+    RDCLOG("Resuming transfer of '%s' from %llu bytes.", remotepath.c_str(), startOffset);
+
+  success = ReceiveCaptureBlocks(*reader, f, resumeChecksums.size() * CaptureBlockSize, fileSize,
+                                 progress);
+
+  FileIO::fclose(f);
+
+  if(!success)
+  {
+    RDCERR("Network error receiving file, partial copy kept to resume from");
+    return;
+  }
+
+  FileIO::Move(partialPath, localpath, true);
 }
 
 rdcstr RemoteServer::CopyCaptureToRemote(const rdcstr &filename, RENDERDOC_ProgressCallback progress)
@@ -1571,15 +1943,58 @@ rdcstr RemoteServer::CopyCaptureToRemote(const rdcstr &filename, RENDERDOC_Progr
     return "";
   }
 
+  uint64_t fileSize = FileIO::GetFileSize(filename);
+
+  // identifies this version of the file, so the server can find a partial copy to resume from
+  rdcstr uploadName = StringFormat::Fmt("%s|%llu|%llu", filename.c_str(), fileSize,
+                                        FileIO::GetModifiedTimestamp(filename));
+  uint64_t uploadKey = CaptureBlockChecksum((const byte *)uploadName.c_str(), uploadName.size());
+
   {
     WRITE_DATA_SCOPE();
     SCOPED_SERIALISE_CHUNK(eRemoteServer_CopyCaptureToRemote);
+    SERIALISE_ELEMENT(fileSize);
+    SERIALISE_ELEMENT(uploadKey);
+  }
+
+  bool success = false;
+  rdcarray<uint64_t> resumeChecksums;
+
+  {
+    READ_DATA_SCOPE();
+    RemoteServerPacket type = ser.ReadChunk<RemoteServerPacket>();
+
+    if(type == eRemoteServer_CopyCaptureToRemote)
+    {
+      SERIALISE_ELEMENT(success);
+      SERIALISE_ELEMENT(resumeChecksums);
+    }
+    else
+    {
+      RDCERR("Unexpected response to capture copy request");
+    }
 
-    // this will take ownership of and close the file
-    StreamReader fileStream(fileHandle);
-    ser.SerialiseStream(filename, fileStream, progress);
+    ser.EndChunk();
+  }
+
+  if(!success)
+  {
+    FileIO::fclose(fileHandle);
+    return "";
   }
 
+  uint64_t startOffset = CaptureResumeOffset(fileHandle, fileSize, resumeChecksums);
+
+  if(startOffset > 0)
+    RDCLOG("Resuming transfer of '%s' from %llu bytes.", filename.c_str(), startOffset);
+
+  success = SendCaptureBlocks(*writer, fileHandle, startOffset, fileSize, progress);
+
+  FileIO::fclose(fileHandle);
+
+  if(!success)
+    return "";
+
   rdcstr path;
 
   {
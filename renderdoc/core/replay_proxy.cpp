@@ -88,6 +88,9 @@ rdcstr DoStringise(const ReplayProxyPacket &el)
     STRINGISE_ENUM_NAMED(eReplayProxy_RenderOverlay, "RenderOverlay");
 
     STRINGISE_ENUM_NAMED(eReplayProxy_PixelHistory, "PixelHistory");
+    STRINGISE_ENUM_NAMED(eReplayProxy_PixelHistoryBatch, "PixelHistoryBatch");
+    STRINGISE_ENUM_NAMED(eReplayProxy_DebugPixelBatch, "DebugPixelBatch");
+    STRINGISE_ENUM_NAMED(eReplayProxy_DebugThreadBatch, "DebugThreadBatch");
 
     STRINGISE_ENUM_NAMED(eReplayProxy_DisassembleShader, "DisassembleShader");
     STRINGISE_ENUM_NAMED(eReplayProxy_GetDisassemblyTargets, "GetDisassemblyTargets");
@@ -1532,6 +1535,62 @@ rdcarray<PixelModification> ReplayProxy::PixelHistory(rdcarray<EventUsage> event
   PROXY_FUNCTION(PixelHistory, events, target, x, y, sub, typeCast);
 }
 
+template <typename ParamSerialiser, typename ReturnSerialiser>
+rdcarray<PixelHistoryResult> ReplayProxy::Proxied_PixelHistoryBatch(
+    ParamSerialiser &paramser, ReturnSerialiser &retser, rdcarray<EventUsage> events,
+    ResourceId target, const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels,
+    const Subresource &sub, CompType typeCast)
+{
+  const ReplayProxyPacket expectedPacket = eReplayProxy_PixelHistoryBatch;
+  ReplayProxyPacket packet = eReplayProxy_PixelHistoryBatch;
+  rdcarray<PixelHistoryResult> ret;
+
+  // the pixel list is sent as separate co-ordinate arrays, pairs aren't serialisable
+  rdcarray<uint32_t> xs, ys;
+  xs.reserve(pixels.size());
+  ys.reserve(pixels.size());
+  for(const rdcpair<uint32_t, uint32_t> &p : pixels)
+  {
+    xs.push_back(p.first);
+    ys.push_back(p.second);
+  }
+
+  {
+    BEGIN_PARAMS();
+    SERIALISE_ELEMENT(events);
+    SERIALISE_ELEMENT(target);
+    SERIALISE_ELEMENT(xs);
+    SERIALISE_ELEMENT(ys);
+    SERIALISE_ELEMENT(sub);
+    SERIALISE_ELEMENT(typeCast);
+    END_PARAMS();
+  }
+
+  {
+    REMOTE_EXECUTION();
+    if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
+    {
+      rdcarray<rdcpair<uint32_t, uint32_t>> remotePixels;
+      remotePixels.reserve(xs.size());
+      for(size_t i = 0; i < xs.size() && i < ys.size(); i++)
+        remotePixels.push_back(make_rdcpair(xs[i], ys[i]));
+
+      ret = m_Remote->PixelHistoryBatch(events, target, remotePixels, sub, typeCast);
+    }
+  }
+
+  SERIALISE_RETURN(ret);
+
+  return ret;
+}
+
+rdcarray<PixelHistoryResult> ReplayProxy::PixelHistoryBatch(
+    rdcarray<EventUsage> events, ResourceId target,
+    const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels, const Subresource &sub, CompType typeCast)
+{
+  PROXY_FUNCTION(PixelHistoryBatch, events, target, pixels, sub, typeCast);
+}
+
 template <typename ParamSerialiser, typename ReturnSerialiser>
 ShaderDebugTrace *ReplayProxy::Proxied_DebugVertex(ParamSerialiser &paramser,
                                                    ReturnSerialiser &retser, uint32_t eventId,
@@ -1709,6 +1768,76 @@ void ReplayProxy::FreeDebugger(ShaderDebugger *debugger)
   PROXY_FUNCTION(FreeDebugger, debugger);
 }
 
+template <typename ParamSerialiser, typename ReturnSerialiser>
+rdcarray<ShaderDebugResult> ReplayProxy::Proxied_DebugPixelBatch(
+    ParamSerialiser &paramser, ReturnSerialiser &retser, uint32_t eventId,
+    const rdcarray<DebugPixelInvocation> &pixels, const rdcarray<rdcstr> &variables)
+{
+  const ReplayProxyPacket expectedPacket = eReplayProxy_DebugPixelBatch;
+  ReplayProxyPacket packet = eReplayProxy_DebugPixelBatch;
+  rdcarray<ShaderDebugResult> ret;
+
+  {
+    BEGIN_PARAMS();
+    SERIALISE_ELEMENT(eventId);
+    SERIALISE_ELEMENT(pixels);
+    SERIALISE_ELEMENT(variables);
+    END_PARAMS();
+  }
+
+  {
+    REMOTE_EXECUTION();
+    if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
+      ret = m_Remote->DebugPixelBatch(eventId, pixels, variables);
+  }
+
+  SERIALISE_RETURN(ret);
+
+  return ret;
+}
+
+rdcarray<ShaderDebugResult> ReplayProxy::DebugPixelBatch(uint32_t eventId,
+                                                         const rdcarray<DebugPixelInvocation> &pixels,
+                                                         const rdcarray<rdcstr> &variables)
+{
+  PROXY_FUNCTION(DebugPixelBatch, eventId, pixels, variables);
+}
+
+template <typename ParamSerialiser, typename ReturnSerialiser>
+rdcarray<ShaderDebugResult> ReplayProxy::Proxied_DebugThreadBatch(
+    ParamSerialiser &paramser, ReturnSerialiser &retser, uint32_t eventId,
+    const rdcarray<DebugThreadInvocation> &threads, const rdcarray<rdcstr> &variables)
+{
+  const ReplayProxyPacket expectedPacket = eReplayProxy_DebugThreadBatch;
+  ReplayProxyPacket packet = eReplayProxy_DebugThreadBatch;
+  rdcarray<ShaderDebugResult> ret;
+
+  {
+    BEGIN_PARAMS();
+    SERIALISE_ELEMENT(eventId);
+    SERIALISE_ELEMENT(threads);
+    SERIALISE_ELEMENT(variables);
+    END_PARAMS();
+  }
+
+  {
+    REMOTE_EXECUTION();
+    if(paramser.IsReading() && !paramser.IsErrored() && !m_IsErrored)
+      ret = m_Remote->DebugThreadBatch(eventId, threads, variables);
+  }
+
+  SERIALISE_RETURN(ret);
+
+  return ret;
+}
+
+rdcarray<ShaderDebugResult> ReplayProxy::DebugThreadBatch(
+    uint32_t eventId, const rdcarray<DebugThreadInvocation> &threads,
+    const rdcarray<rdcstr> &variables)
+{
+  PROXY_FUNCTION(DebugThreadBatch, eventId, threads, variables);
+}
+
 template <typename ParamSerialiser, typename ReturnSerialiser>
 void ReplayProxy::Proxied_SavePipelineState(ParamSerialiser &paramser, ReturnSerialiser &retser,
                                             uint32_t eventId)
@@ -2672,6 +2801,7 @@ void ReplayProxy::ShutdownRemoteExecutionThread()
   if(m_RemoteExecutionThread)
   {
     Atomic::Inc32(&m_RemoteExecutionKill);
+    m_RemoteExecutionWait.Wake();
 
     Threading::JoinThread(m_RemoteExecutionThread);
     Threading::CloseThread(m_RemoteExecutionThread);
@@ -2686,6 +2816,7 @@ void ReplayProxy::BeginRemoteExecution()
     // m_RemoteExecutionActive must be inactive because it starts inactive, and we synchronise it in
     // EndRemoteExecution
     Atomic::CmpExch32(&m_RemoteExecutionState, RemoteExecution_Inactive, RemoteExecution_ThreadIdle);
+    m_RemoteExecutionWait.Wake();
   }
   else
   {
@@ -2703,6 +2834,8 @@ void ReplayProxy::EndRemoteExecution()
                             RemoteExecution_Inactive) == RemoteExecution_ThreadIdle)
       Threading::Sleep(0);
 
+    m_RemoteExecutionWait.Wake();
+
     // send the finished packet
     m_Writer.BeginChunk(eReplayProxy_RemoteExecutionFinished, 0);
     m_Writer.EndChunk();
@@ -2747,7 +2880,7 @@ void ReplayProxy::RemoteExecutionThreadEntry()
       // 2. Send a keepalive packet
       //
       // The wait we tradeoff between busy-waits (to catch very short-lived executions) with waits
-      // to avoid spinning too much.
+      // to avoid spinning too much. EndRemoteExecution() wakes us if we're sleeping.
 
       while(IsThreadIdle())
       {
@@ -2758,16 +2891,10 @@ void ReplayProxy::RemoteExecutionThreadEntry()
         if(!IsThreadIdle())
           break;
 
-        // 5ms has elapsed, wait up to 100ms in 5ms chunks
-        while(waitTimer.GetMilliseconds() < 100 && IsThreadIdle())
-          Threading::Sleep(5);
-
-        if(!IsThreadIdle())
-          break;
-
-        // 100ms has elapsed, wait up to 1000ms in 50ms chunks
+        // 5ms has elapsed, sleep for the rest of the second unless we're woken
         while(waitTimer.GetMilliseconds() < 1000 && IsThreadIdle())
-          Threading::Sleep(50);
+          m_RemoteExecutionWait.WaitForWake(
+              (uint32_t)RDCMAX(1.0, 1000.0 - waitTimer.GetMilliseconds()));
 
         if(!IsThreadIdle())
           break;
@@ -2786,8 +2913,9 @@ void ReplayProxy::RemoteExecutionThreadEntry()
       }
     }
 
-    // don't busy-wait
-    Threading::Sleep(0);
+    // sleep until BeginRemoteExecution() or shutdown wakes us
+    if(!IsThreadIdle())
+      m_RemoteExecutionWait.WaitForWake(50);
   }
 }
 
@@ -2949,6 +3077,11 @@ bool ReplayProxy::Tick(int type)
     case eReplayProxy_PixelHistory:
       PixelHistory(rdcarray<EventUsage>(), ResourceId(), 0, 0, Subresource(), CompType::Typeless);
       break;
+    case eReplayProxy_PixelHistoryBatch:
+      PixelHistoryBatch(rdcarray<EventUsage>(), ResourceId(), {}, Subresource(), CompType::Typeless);
+      break;
+    case eReplayProxy_DebugPixelBatch: DebugPixelBatch(0, {}, {}); break;
+    case eReplayProxy_DebugThreadBatch: DebugThreadBatch(0, {}, {}); break;
     case eReplayProxy_DisassembleShader: DisassembleShader(ResourceId(), NULL, ""); break;
     case eReplayProxy_GetDisassemblyTargets: GetDisassemblyTargets(false); break;
     case eReplayProxy_GetTargetShaderEncodings: GetTargetShaderEncodings(); break;
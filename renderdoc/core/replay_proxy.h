@@ -105,6 +105,11 @@ enum ReplayProxyPacket
   eReplayProxy_FreeDebugger,
 
   eReplayProxy_FatalErrorCheck,
+
+  eReplayProxy_PixelHistoryBatch,
+
+  eReplayProxy_DebugPixelBatch,
+  eReplayProxy_DebugThreadBatch,
 };
 
 DECLARE_REFLECTION_ENUM(ReplayProxyPacket);
@@ -524,6 +529,10 @@ public:
   IMPLEMENT_FUNCTION_PROXIED(rdcarray<PixelModification>, PixelHistory, rdcarray<EventUsage> events,
                              ResourceId target, uint32_t x, uint32_t y, const Subresource &sub,
                              CompType typeCast);
+  IMPLEMENT_FUNCTION_PROXIED(rdcarray<PixelHistoryResult>, PixelHistoryBatch,
+                             rdcarray<EventUsage> events, ResourceId target,
+                             const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels,
+                             const Subresource &sub, CompType typeCast);
   IMPLEMENT_FUNCTION_PROXIED(ShaderDebugTrace *, DebugVertex, uint32_t eventId, uint32_t vertid,
                              uint32_t instid, uint32_t idx, uint32_t view);
   IMPLEMENT_FUNCTION_PROXIED(ShaderDebugTrace *, DebugPixel, uint32_t eventId, uint32_t x,
@@ -533,6 +542,12 @@ public:
                              const rdcfixedarray<uint32_t, 3> &threadid);
   IMPLEMENT_FUNCTION_PROXIED(rdcarray<ShaderDebugState>, ContinueDebug, ShaderDebugger *debugger);
   IMPLEMENT_FUNCTION_PROXIED(void, FreeDebugger, ShaderDebugger *debugger);
+  IMPLEMENT_FUNCTION_PROXIED(rdcarray<ShaderDebugResult>, DebugPixelBatch, uint32_t eventId,
+                             const rdcarray<DebugPixelInvocation> &pixels,
+                             const rdcarray<rdcstr> &variables);
+  IMPLEMENT_FUNCTION_PROXIED(rdcarray<ShaderDebugResult>, DebugThreadBatch, uint32_t eventId,
+                             const rdcarray<DebugThreadInvocation> &threads,
+                             const rdcarray<rdcstr> &variables);
 
   IMPLEMENT_FUNCTION_PROXIED(rdcarray<ShaderEncoding>, GetTargetShaderEncodings);
   IMPLEMENT_FUNCTION_PROXIED(void, BuildTargetShader, ShaderEncoding sourceEncoding,
@@ -708,6 +723,8 @@ private:
   }
 
   Threading::ThreadHandle m_RemoteExecutionThread = 0;
+  // the remote execution thread sleeps on this, and is woken whenever the state changes
+  Threading::Semaphore m_RemoteExecutionWait;
 
   bool m_IsErrored = false;
   RDResult m_FatalError = ResultCode::Succeeded;
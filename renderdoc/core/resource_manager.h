@@ -644,6 +644,7 @@ public:
   // when asked for a given id, return the resource for a replacement id
   void ReplaceResource(ResourceId from, ResourceId to);
   bool HasReplacement(ResourceId from);
+  bool HasReplacements();
   void RemoveReplacement(ResourceId id);
 
   // get the original ID for a real ID that may be a replacement. i.e. if ID 123 is ID 10000005
@@ -1644,6 +1645,14 @@ bool ResourceManager<Configuration>::HasReplacement(ResourceId from)
   return m_Replacements.find(from) != m_Replacements.end();
 }
 
+template <typename Configuration>
+bool ResourceManager<Configuration>::HasReplacements()
+{
+  SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
+
+  return !m_Replacements.empty();
+}
+
 template <typename Configuration>
 void ResourceManager<Configuration>::RemoveReplacement(ResourceId id)
 {
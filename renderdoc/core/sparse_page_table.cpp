@@ -23,6 +23,7 @@
  ******************************************************************************/
 
 #include "sparse_page_table.h"
+#include <algorithm>
 #include "common/globalconfig.h"
 #include "serialise/serialiser.h"
 
@@ -33,34 +34,129 @@ static uint32_t calcPageForTileCoord(const Coord &coord, const Coord &subresourc
   return (((coord.z * subresourcePageDim.y) + coord.y) * subresourcePageDim.x) + coord.x;
 }
 
-void PageRangeMapping::createPages(uint32_t numPages, uint32_t pageSize)
+void PageRangeMapping::createPages(uint32_t pageCount, uint32_t pageSize)
 {
-  // don't do anything if the pages have already been populated
-  if(!pages.empty())
+  // don't do anything if the pages have already been split
+  if(!runs.empty())
     return;
 
-  // otherwise allocate them. If we have a single page mapping we can just duplicate and it's easy
-  if(singlePageReused || singleMapping.memory == ResourceId())
+  // start with one run covering everything, that's identical to the single mapping. Unmapped runs
+  // are always stored as a reused page at offset 0 so that they merge with each other
+  PageRun run;
+  run.firstPage = 0;
+  run.mapping = singleMapping;
+  run.singlePageReused = singlePageReused;
+  if(run.mapping.memory == ResourceId())
   {
-    pages.fill(numPages, singleMapping);
-  }
-  else
-  {
-    // otherwise we need to allocate and increment
-    pages.reserve(numPages);
-    pages.clear();
-    for(uint32_t i = 0; i < numPages; i++)
-    {
-      pages.push_back(singleMapping);
-      singleMapping.offset += pageSize;
-    }
+    run.mapping.offset = 0;
+    run.singlePageReused = true;
   }
 
+  runs = {run};
+  numPages = pageCount;
+
   // reset the single mapping to be super clear
   singleMapping = {};
   singlePageReused = false;
 }
 
+size_t PageRangeMapping::findRun(uint32_t page) const
+{
+  // find the first run starting after this page, the run before it contains the page. The first
+  // run always starts at page 0 so there is always one before
+  const PageRun *it =
+      std::upper_bound(runs.begin(), runs.end(), page,
+                       [](uint32_t page, const PageRun &run) { return page < run.firstPage; });
+  return size_t(it - runs.begin()) - 1;
+}
+
+void PageRangeMapping::splitRun(uint32_t page, uint32_t pageSize)
+{
+  if(page >= numPages)
+    return;
+
+  const size_t idx = findRun(page);
+
+  // if a run already starts here there's nothing to split
+  if(runs[idx].firstPage == page)
+    return;
+
+  PageRun split = runs[idx];
+  if(!split.singlePageReused)
+    split.mapping.offset += uint64_t(pageSize) * (page - split.firstPage);
+  split.firstPage = page;
+
+  runs.insert(idx + 1, split);
+}
+
+bool PageRangeMapping::mergeRuns(size_t run, uint32_t pageSize)
+{
+  if(run + 1 >= runs.size())
+    return false;
+
+  const PageRun &a = runs[run];
+  const PageRun &b = runs[run + 1];
+
+  if(a.mapping.memory != b.mapping.memory)
+    return false;
+
+  const uint32_t countA = b.firstPage - a.firstPage;
+  const uint32_t countB = getRunPageCount(run + 1);
+
+  // a run of one page can be treated either as reusing its page or as consecutive pages, so it can
+  // merge with either kind of neighbour
+  const bool reused = (a.singlePageReused || countA == 1) && (b.singlePageReused || countB == 1) &&
+                      a.mapping.offset == b.mapping.offset;
+  const bool consecutive = (!a.singlePageReused || countA == 1) &&
+                           (!b.singlePageReused || countB == 1) &&
+                           b.mapping.offset == a.mapping.offset + uint64_t(pageSize) * countA;
+
+  if(!reused && !consecutive)
+    return false;
+
+  runs[run].singlePageReused = reused;
+  runs.erase(run + 1);
+  return true;
+}
+
+void PageRangeMapping::setPages(uint32_t firstPage, uint32_t count, Page page, bool useSinglePage,
+                                uint32_t pageSize)
+{
+  RDCASSERT(!runs.empty());
+
+  if(firstPage >= numPages || count == 0)
+    return;
+
+  count = RDCMIN(count, numPages - firstPage);
+
+  // store unmapped pages consistently so they merge
+  if(page.memory == ResourceId())
+  {
+    page.offset = 0;
+    useSinglePage = true;
+  }
+
+  // make sure runs begin exactly at the start and end of the range, then replace all the runs in
+  // between with one run for the new mapping
+  splitRun(firstPage + count, pageSize);
+  splitRun(firstPage, pageSize);
+
+  const size_t first = findRun(firstPage);
+  size_t last = first + 1;
+  while(last < runs.size() && runs[last].firstPage < firstPage + count)
+    last++;
+
+  runs[first].mapping = page;
+  runs[first].singlePageReused = useSinglePage;
+  if(last > first + 1)
+    runs.erase(first + 1, last - first - 1);
+
+  // merge with the following run and then the preceding run if they continue this one
+  mergeRuns(first, pageSize);
+  if(first > 0)
+    mergeRuns(first - 1, pageSize);
+}
+
 void PageTable::Initialise(uint64_t bufferByteSize, uint32_t pageByteSize)
 {
   m_PageByteSize = pageByteSize;
@@ -171,7 +267,7 @@ uint64_t PageTable::setMipTailRange(uint64_t resourceByteOffset, ResourceId memo
   {
     for(size_t i = 0; i < m_MipTail.mappings.size(); i++)
     {
-      m_MipTail.mappings[i].pages.clear();
+      m_MipTail.mappings[i].runs.clear();
       m_MipTail.mappings[i].singleMapping.memory = memory;
       m_MipTail.mappings[i].singleMapping.offset = memoryByteOffset;
       m_MipTail.mappings[i].singlePageReused = useSinglePage;
@@ -194,19 +290,15 @@ uint64_t PageTable::setMipTailRange(uint64_t resourceByteOffset, ResourceId memo
 
     mapping.createPages(numTailPages, m_PageByteSize);
 
-    // iterate through each referenced resource page
-    for(size_t
-            page = size_t(resourceByteOffset / m_PageByteSize),
-            endPage = size_t((resourceByteOffset + byteSize + m_PageByteSize - 1) / m_PageByteSize);
-        page < mapping.pages.size() && page < endPage; page++)
-    {
-      mapping.pages[page].memory = memory;
-      mapping.pages[page].offset = memoryByteOffset;
+    // update the referenced resource pages
+    const uint64_t startPage = resourceByteOffset / m_PageByteSize;
+    const uint64_t endPage =
+        RDCMIN(uint64_t(numTailPages),
+               (resourceByteOffset + byteSize + m_PageByteSize - 1) / m_PageByteSize);
 
-      // if we're not mapping all resource pages to a single memory page, advance the offset
-      if(!useSinglePage && memory != ResourceId())
-        memoryByteOffset += m_PageByteSize;
-    }
+    if(endPage > startPage)
+      mapping.setPages(uint32_t(startPage), uint32_t(endPage - startPage),
+                       {memory, memoryByteOffset}, useSinglePage, m_PageByteSize);
 
     mapping.simplifyUnmapped();
 
@@ -236,7 +328,7 @@ uint64_t PageTable::setMipTailRange(uint64_t resourceByteOffset, ResourceId memo
       // if we're setting the whole miptail, store that concisely
       if(resourceByteOffset == 0 && byteSize >= mipTailSubresourceByteSize)
       {
-        mapping.pages.clear();
+        mapping.runs.clear();
         mapping.singleMapping.memory = memory;
         mapping.singleMapping.offset = memoryByteOffset;
         mapping.singlePageReused = useSinglePage;
@@ -248,25 +340,28 @@ uint64_t PageTable::setMipTailRange(uint64_t resourceByteOffset, ResourceId memo
       }
       else
       {
-        mapping.createPages(
-            uint32_t((mipTailSubresourceByteSize + m_PageByteSize - 1) / m_PageByteSize),
-            m_PageByteSize);
-
-        // iterate through each referenced page in this subresource's mip tail. Note we only iterate
-        // over as many pages as this mapping has, even if the bound region is larger.
-        for(size_t page = size_t(resourceByteOffset / m_PageByteSize),
-                   endPage =
-                       size_t((resourceByteOffset + byteSize + m_PageByteSize - 1) / m_PageByteSize);
-            page < mapping.pages.size() && page < endPage; page++)
+        const uint32_t numPages =
+            uint32_t((mipTailSubresourceByteSize + m_PageByteSize - 1) / m_PageByteSize);
+
+        mapping.createPages(numPages, m_PageByteSize);
+
+        // update the referenced pages in this subresource's mip tail. Note we only update as many
+        // pages as this mapping has, even if the bound region is larger.
+        const uint64_t startPage = resourceByteOffset / m_PageByteSize;
+        const uint64_t endPage =
+            RDCMIN(uint64_t(numPages),
+                   (resourceByteOffset + byteSize + m_PageByteSize - 1) / m_PageByteSize);
+
+        if(endPage > startPage)
         {
-          mapping.pages[page].memory = memory;
-          mapping.pages[page].offset = memoryByteOffset;
+          mapping.setPages(uint32_t(startPage), uint32_t(endPage - startPage),
+                           {memory, memoryByteOffset}, useSinglePage, m_PageByteSize);
 
           // if we're not mapping all resource pages to a single memory page, advance the offset
           if(!useSinglePage && memory != ResourceId())
-            memoryByteOffset += m_PageByteSize;
+            memoryByteOffset += (endPage - startPage) * m_PageByteSize;
 
-          consumedBytes += m_PageByteSize;
+          consumedBytes += (endPage - startPage) * m_PageByteSize;
         }
 
         memoryByteOffset += m_MipTail.byteStride - mipTailSubresourceByteSize;
@@ -362,7 +457,7 @@ void PageTable::setImageBoxRange(uint32_t subresource, const Sparse::Coord &coor
   // if we're setting the whole subresource, set it to use the optimal single mapping
   if(curCoord.x == 0 && curCoord.y == 0 && curCoord.z == 0 && curDim == subresourcePageDim)
   {
-    sub.pages.clear();
+    sub.runs.clear();
     sub.singleMapping.memory = memory;
     sub.singleMapping.offset = memoryByteOffset;
     sub.singlePageReused = useSinglePage;
@@ -375,22 +470,19 @@ void PageTable::setImageBoxRange(uint32_t subresource, const Sparse::Coord &coor
         subresourcePageDim.x * subresourcePageDim.y * subresourcePageDim.z;
     sub.createPages(numSubresourcePages, m_PageByteSize);
 
+    // each row of the box is a contiguous range of pages
     for(uint32_t z = curCoord.z; z < curCoord.z + curDim.z; z++)
     {
       for(uint32_t y = curCoord.y; y < curCoord.y + curDim.y; y++)
       {
-        for(uint32_t x = curCoord.x; x < curCoord.x + curDim.x; x++)
-        {
-          // calculate the page
-          const uint32_t page = calcPageForTileCoord({x, y, z}, subresourcePageDim);
+        // calculate the first page in the row
+        const uint32_t page = calcPageForTileCoord({curCoord.x, y, z}, subresourcePageDim);
 
-          sub.pages[page].memory = memory;
-          sub.pages[page].offset = memoryByteOffset;
+        sub.setPages(page, curDim.x, {memory, memoryByteOffset}, useSinglePage, m_PageByteSize);
 
-          // if we're not mapping all resource pages to a single memory page, advance the offset
-          if(!useSinglePage && memory != ResourceId())
-            memoryByteOffset += m_PageByteSize;
-        }
+        // if we're not mapping all resource pages to a single memory page, advance the offset
+        if(!useSinglePage && memory != ResourceId())
+          memoryByteOffset += uint64_t(curDim.x) * m_PageByteSize;
       }
     }
 
@@ -443,7 +535,7 @@ rdcpair<uint32_t, Coord> PageTable::setImageWrappedRange(uint32_t subresource,
     {
       if(updateMappings)
       {
-        sub.pages.clear();
+        sub.runs.clear();
         sub.singleMapping.memory = memory;
         sub.singleMapping.offset = memoryByteOffset;
         sub.singlePageReused = useSinglePage;
@@ -506,19 +598,21 @@ rdcpair<uint32_t, Coord> PageTable::setImageWrappedRange(uint32_t subresource,
       uint32_t startingPage =
           (((curCoord.z * subresourcePageDim.y) + curCoord.y) * subresourcePageDim.x) + curCoord.x;
 
-      for(uint32_t page = startingPage;
-          page < startingPage + numPages && page < numSubresourcePages; page++)
+      const uint64_t endPage =
+          RDCMIN(uint64_t(startingPage) + numPages, uint64_t(numSubresourcePages));
+
+      if(endPage > startingPage)
       {
+        const uint32_t count = uint32_t(endPage - startingPage);
+
         if(updateMappings)
-        {
-          sub.pages[page].memory = memory;
-          sub.pages[page].offset = memoryByteOffset;
-        }
+          sub.setPages(startingPage, count, {memory, memoryByteOffset}, useSinglePage,
+                       m_PageByteSize);
 
         // if we're not mapping all resource pages to a single memory page, advance the offset
         if(!useSinglePage && memory != ResourceId())
-          memoryByteOffset += m_PageByteSize;
-        byteSize -= m_PageByteSize;
+          memoryByteOffset += uint64_t(count) * m_PageByteSize;
+        byteSize -= uint64_t(count) * m_PageByteSize;
       }
 
       if(updateMappings)
@@ -678,7 +772,8 @@ void PageTable::copyImageBoxRange(uint32_t dstSubresource, const Coord &coordInT
             {coordInTiles.x + x, coordInTiles.y + y, coordInTiles.z + z}, dstSubSize);
         const uint32_t srcPage = calcPageForTileCoord(
             {srcCoordInTiles.x + x, srcCoordInTiles.y + y, srcCoordInTiles.z + z}, srcSubSize);
-        dstSub.pages[dstPage] = srcSub.getPage(srcPage, m_PageByteSize);
+        dstSub.setPages(dstPage, 1, srcSub.getPage(srcPage, m_PageByteSize), false,
+                        m_PageByteSize);
       }
     }
   }
@@ -768,7 +863,8 @@ void PageTable::copyImageWrappedRange(uint32_t dstSubresource, const Coord &coor
     {
       // otherwise just copy the current page
       dstMapping->createPages(dstSubTiles, m_PageByteSize);
-      dstMapping->pages[dstPage] = srcMapping->getPage(srcPage, m_PageByteSize);
+      dstMapping->setPages(dstPage, 1, srcMapping->getPage(srcPage, m_PageByteSize), false,
+                           m_PageByteSize);
 
       dstPage++;
       srcPage++;
@@ -881,9 +977,8 @@ uint64_t PageTable::GetSerialiseSize() const
   {
     ret += sizeof(Sparse::PageRangeMapping);
 
-    // and the size of each page if the range mapping is expanded
-    if(!getMipTail().mappings[s].hasSingleMapping())
-      ret += sizeof(Sparse::Page) * getMipTail().mappings[s].pages.size();
+    // and the size of each run if the range mapping is split
+    ret += sizeof(Sparse::PageRun) * getMipTail().mappings[s].runs.size();
   }
 
   // for each subresource the size of it
@@ -891,9 +986,8 @@ uint64_t PageTable::GetSerialiseSize() const
   {
     ret += sizeof(Sparse::PageRangeMapping);
 
-    // and the size of each page if the range mapping is expanded
-    if(!getSubresource(s).hasSingleMapping())
-      ret += sizeof(Sparse::Page) * getSubresource(s).pages.size();
+    // and the size of each run if the range mapping is split
+    ret += sizeof(Sparse::PageRun) * getSubresource(s).runs.size();
   }
 
   return ret;
@@ -915,11 +1009,21 @@ void DoSerialise(SerialiserType &ser, Sparse::Page &el)
   SERIALISE_MEMBER(offset);
 }
 
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, Sparse::PageRun &el)
+{
+  SERIALISE_MEMBER(firstPage);
+  SERIALISE_MEMBER(singlePageReused);
+  SERIALISE_MEMBER(mapping);
+}
+
 template <typename SerialiserType>
 void DoSerialise(SerialiserType &ser, Sparse::PageRangeMapping &el)
 {
   SERIALISE_MEMBER(singleMapping);
-  SERIALISE_MEMBER(pages);
+  SERIALISE_MEMBER(singlePageReused);
+  SERIALISE_MEMBER(numPages);
+  SERIALISE_MEMBER(runs);
 }
 
 template <typename SerialiserType>
@@ -946,10 +1050,134 @@ void DoSerialise(SerialiserType &ser, Sparse::PageTable &el)
 
 INSTANTIATE_SERIALISE_TYPE(Sparse::Coord);
 INSTANTIATE_SERIALISE_TYPE(Sparse::Page);
+INSTANTIATE_SERIALISE_TYPE(Sparse::PageRun);
 INSTANTIATE_SERIALISE_TYPE(Sparse::PageRangeMapping);
 INSTANTIATE_SERIALISE_TYPE(Sparse::MipTail);
 INSTANTIATE_SERIALISE_TYPE(Sparse::PageTable);
 
+namespace Sparse
+{
+// the layout of a range before they were stored as runs, kept only to read older captures
+struct LegacyPageRangeMapping
+{
+  Page singleMapping;
+  rdcarray<Page> pages;
+};
+
+struct LegacyMipTail
+{
+  uint32_t firstMip = 0;
+  uint64_t byteOffset = 0;
+  uint64_t byteStride = 0;
+  uint64_t totalPackedByteSize = 0;
+  rdcarray<LegacyPageRangeMapping> mappings;
+};
+
+static LegacyPageRangeMapping ExpandLegacyMapping(const PageRangeMapping &src, uint32_t pageSize)
+{
+  LegacyPageRangeMapping ret;
+  ret.singleMapping = src.singleMapping;
+  for(uint32_t i = 0; i < src.getNumPages(); i++)
+    ret.pages.push_back(src.getPage(i, pageSize));
+  return ret;
+}
+
+static void ConvertLegacyMapping(PageRangeMapping &dst, const LegacyPageRangeMapping &src,
+                                 uint32_t pageSize)
+{
+  dst = PageRangeMapping();
+  dst.singleMapping = src.singleMapping;
+
+  if(src.pages.empty())
+    return;
+
+  dst.createPages((uint32_t)src.pages.size(), pageSize);
+  for(uint32_t i = 0; i < src.pages.size(); i++)
+    dst.setPages(i, 1, src.pages[i], false, pageSize);
+  dst.simplifyUnmapped();
+}
+};    // namespace Sparse
+
+// keep the original type names so structured data looks the same as it did
+template <>
+inline rdcliteral TypeName<Sparse::LegacyPageRangeMapping>()
+{
+  return "Sparse::PageRangeMapping"_lit;
+}
+
+template <>
+inline rdcliteral TypeName<Sparse::LegacyMipTail>()
+{
+  return "Sparse::MipTail"_lit;
+}
+
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, Sparse::LegacyPageRangeMapping &el)
+{
+  SERIALISE_MEMBER(singleMapping);
+  SERIALISE_MEMBER(pages);
+}
+
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, Sparse::LegacyMipTail &el)
+{
+  SERIALISE_MEMBER(firstMip);
+  SERIALISE_MEMBER(byteOffset);
+  SERIALISE_MEMBER(byteStride);
+  SERIALISE_MEMBER(totalPackedByteSize);
+  SERIALISE_MEMBER(mappings);
+}
+
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, Sparse::LegacyPageTable &el)
+{
+  Sparse::PageTable &table = el.table;
+
+  rdcarray<Sparse::LegacyPageRangeMapping> subresources;
+  Sparse::LegacyMipTail mipTail;
+
+  // there's no reason to write the old format, but support it by expanding each range
+  if(ser.IsWriting())
+  {
+    for(const Sparse::PageRangeMapping &m : table.m_Subresources)
+      subresources.push_back(Sparse::ExpandLegacyMapping(m, table.m_PageByteSize));
+
+    mipTail.firstMip = table.m_MipTail.firstMip;
+    mipTail.byteOffset = table.m_MipTail.byteOffset;
+    mipTail.byteStride = table.m_MipTail.byteStride;
+    mipTail.totalPackedByteSize = table.m_MipTail.totalPackedByteSize;
+    for(const Sparse::PageRangeMapping &m : table.m_MipTail.mappings)
+      mipTail.mappings.push_back(Sparse::ExpandLegacyMapping(m, table.m_PageByteSize));
+  }
+
+  ser.Serialise("m_TextureDim"_lit, table.m_TextureDim);
+  ser.Serialise("m_MipCount"_lit, table.m_MipCount);
+  ser.Serialise("m_ArraySize"_lit, table.m_ArraySize);
+  ser.Serialise("m_PageByteSize"_lit, table.m_PageByteSize);
+  ser.Serialise("m_PageTexelSize"_lit, table.m_PageTexelSize);
+  ser.Serialise("m_Subresources"_lit, subresources);
+  ser.Serialise("m_MipTail"_lit, mipTail);
+
+  if(ser.IsReading())
+  {
+    table.m_Subresources.resize(subresources.size());
+    for(size_t i = 0; i < subresources.size(); i++)
+      Sparse::ConvertLegacyMapping(table.m_Subresources[i], subresources[i],
+                                   table.m_PageByteSize);
+
+    table.m_MipTail.firstMip = mipTail.firstMip;
+    table.m_MipTail.byteOffset = mipTail.byteOffset;
+    table.m_MipTail.byteStride = mipTail.byteStride;
+    table.m_MipTail.totalPackedByteSize = mipTail.totalPackedByteSize;
+    table.m_MipTail.mappings.resize(mipTail.mappings.size());
+    for(size_t i = 0; i < mipTail.mappings.size(); i++)
+      Sparse::ConvertLegacyMapping(table.m_MipTail.mappings[i], mipTail.mappings[i],
+                                   table.m_PageByteSize);
+  }
+}
+
+INSTANTIATE_SERIALISE_TYPE(Sparse::LegacyPageTable);
+
 #if ENABLED(ENABLE_UNIT_TESTS)
 
 #include "catch/catch.hpp"
@@ -1019,47 +1247,47 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
       CHECK(nextTailOffset == 128 + 64);
 
       CHECK_FALSE(pageTable.getMipTail().mappings[0].hasSingleMapping());
-      REQUIRE(pageTable.getMipTail().mappings[0].pages.size() == 4);
-      CHECK(pageTable.getMipTail().mappings[0].pages[0] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[1] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[2] == Sparse::Page({mem, 512}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[3] == Sparse::Page({ResourceId(), 0}));
+      REQUIRE(pageTable.getMipTail().mappings[0].getNumPages() == 4);
+      CHECK(pageTable.getMipTail().mappings[0].getPage(0, 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(1, 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(2, 64) == Sparse::Page({mem, 512}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(3, 64) == Sparse::Page({ResourceId(), 0}));
 
       nextTailOffset = pageTable.setBufferRange(0, mem, 1024, 64, false);
 
       CHECK(nextTailOffset == 64);
 
-      CHECK(pageTable.getMipTail().mappings[0].pages[0] == Sparse::Page({mem, 1024}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[1] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[2] == Sparse::Page({mem, 512}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[3] == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(0, 64) == Sparse::Page({mem, 1024}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(1, 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(2, 64) == Sparse::Page({mem, 512}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(3, 64) == Sparse::Page({ResourceId(), 0}));
 
       nextTailOffset = pageTable.setBufferRange(64, mem, 128, 128, false);
 
       CHECK(nextTailOffset == 64 + 128);
 
-      CHECK(pageTable.getMipTail().mappings[0].pages[0] == Sparse::Page({mem, 1024}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[1] == Sparse::Page({mem, 128}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[2] == Sparse::Page({mem, 128 + 64}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[3] == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(0, 64) == Sparse::Page({mem, 1024}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(1, 64) == Sparse::Page({mem, 128}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(2, 64) == Sparse::Page({mem, 128 + 64}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(3, 64) == Sparse::Page({ResourceId(), 0}));
 
       nextTailOffset = pageTable.setBufferRange(64, mem, 256, 128, true);
 
       CHECK(nextTailOffset == 64 + 128);
 
-      CHECK(pageTable.getMipTail().mappings[0].pages[0] == Sparse::Page({mem, 1024}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[1] == Sparse::Page({mem, 256}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[2] == Sparse::Page({mem, 256}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[3] == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(0, 64) == Sparse::Page({mem, 1024}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(1, 64) == Sparse::Page({mem, 256}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(2, 64) == Sparse::Page({mem, 256}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(3, 64) == Sparse::Page({ResourceId(), 0}));
 
       nextTailOffset = pageTable.setBufferRange(64, ResourceId(), 256, 64, true);
 
       CHECK(nextTailOffset == 64 + 64);
 
-      CHECK(pageTable.getMipTail().mappings[0].pages[0] == Sparse::Page({mem, 1024}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[1] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[2] == Sparse::Page({mem, 256}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[3] == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(0, 64) == Sparse::Page({mem, 1024}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(1, 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(2, 64) == Sparse::Page({mem, 256}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(3, 64) == Sparse::Page({ResourceId(), 0}));
     };
   };
 
@@ -1120,9 +1348,9 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
     CHECK(nextTailOffset == 64);
 
     CHECK_FALSE(pageTable.getMipTail().mappings[0].hasSingleMapping());
-    REQUIRE(pageTable.getMipTail().mappings[0].pages.size() == 2);
-    CHECK(pageTable.getMipTail().mappings[0].pages[0] == Sparse::Page({ResourceId(), 0}));
-    CHECK(pageTable.getMipTail().mappings[0].pages[1] == Sparse::Page({mem, 1024 + 64}));
+    REQUIRE(pageTable.getMipTail().mappings[0].getNumPages() == 2);
+    CHECK(pageTable.getMipTail().mappings[0].getPage(0, 64) == Sparse::Page({ResourceId(), 0}));
+    CHECK(pageTable.getMipTail().mappings[0].getPage(1, 64) == Sparse::Page({mem, 1024 + 64}));
   };
 
   SECTION("sub-page sized buffer")
@@ -1314,16 +1542,16 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
       CHECK_FALSE(pageTable.getSubresource(3).singlePageReused);
 
       CHECK_FALSE(pageTable.getMipTail().mappings[0].hasSingleMapping());
-      REQUIRE(pageTable.getMipTail().mappings[0].pages.size() == 4);
+      REQUIRE(pageTable.getMipTail().mappings[0].getNumPages() == 4);
 
       // first two pages have been updated
-      CHECK(pageTable.getMipTail().mappings[0].pages[0] == Sparse::Page({sub, 64}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[1] == Sparse::Page({sub, 128}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(0, 64) == Sparse::Page({sub, 64}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(1, 64) == Sparse::Page({sub, 128}));
 
       // second two pages still point into whole
-      CHECK(pageTable.getMipTail().mappings[0].pages[2] ==
+      CHECK(pageTable.getMipTail().mappings[0].getPage(2, 64) ==
             Sparse::Page({whole, (8 * 8 + 4 * 4 + 2 * 2 + 1 * 1) * 64 + 128}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[3] ==
+      CHECK(pageTable.getMipTail().mappings[0].getPage(3, 64) ==
             Sparse::Page({whole, (8 * 8 + 4 * 4 + 2 * 2 + 1 * 1) * 64 + 192}));
     };
 
@@ -1338,44 +1566,48 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
 
       CHECK_FALSE(pageTable.getSubresource(0).hasSingleMapping());
       // 8x8 pages in top mip
-      REQUIRE(pageTable.getSubresource(0).pages.size() == 64);
+      REQUIRE(pageTable.getSubresource(0).getNumPages() == 64);
 
 #define _idx(x, y) y * 8 + x
 
       // don't check every one, spot-check
-      CHECK(pageTable.getSubresource(0).pages[_idx(0, 0)] == Sparse::Page({sub0a, 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 0)] == Sparse::Page({sub0a, 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 0)] == Sparse::Page({sub0a, 128}));
-
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 2)] == Sparse::Page({sub0a, (2 * 8 + 1) * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 2)] == Sparse::Page({sub0a, (2 * 8 + 2) * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 2)] == Sparse::Page({sub0a, (2 * 8 + 3) * 64}));
-
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 6)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 6)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 7)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 7)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 7)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(4, 7)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(7, 7)] == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(0, 0), 64) == Sparse::Page({sub0a, 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 0), 64) == Sparse::Page({sub0a, 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 0), 64) == Sparse::Page({sub0a, 128}));
+
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 2), 64) ==
+            Sparse::Page({sub0a, (2 * 8 + 1) * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 2), 64) ==
+            Sparse::Page({sub0a, (2 * 8 + 2) * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 2), 64) ==
+            Sparse::Page({sub0a, (2 * 8 + 3) * 64}));
+
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 6), 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 6), 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 7), 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 7), 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 7), 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(4, 7), 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(7, 7), 64) == Sparse::Page({ResourceId(), 0}));
 
       // update only a sub-box
       pageTable.setImageBoxRange(0, {64, 0, 0}, {32, 256, 1}, sub0b, 0, false);
 
-      CHECK(pageTable.getSubresource(0).pages[_idx(0, 0)] == Sparse::Page({sub0a, 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 0)] == Sparse::Page({sub0a, 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 0)] == Sparse::Page({sub0b, 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(0, 0), 64) == Sparse::Page({sub0a, 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 0), 64) == Sparse::Page({sub0a, 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 0), 64) == Sparse::Page({sub0b, 0}));
 
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 2)] == Sparse::Page({sub0b, 128}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 2)] == Sparse::Page({sub0a, (2 * 8 + 3) * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 2), 64) == Sparse::Page({sub0b, 128}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 2), 64) ==
+            Sparse::Page({sub0a, (2 * 8 + 3) * 64}));
 
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 6)] == Sparse::Page({sub0b, 6 * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 6)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 7)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 7)] == Sparse::Page({sub0b, 7 * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 7)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(4, 7)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(7, 7)] == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 6), 64) == Sparse::Page({sub0b, 6 * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 6), 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 7), 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 7), 64) == Sparse::Page({sub0b, 7 * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 7), 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(4, 7), 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(7, 7), 64) == Sparse::Page({ResourceId(), 0}));
 
       rdcpair<uint32_t, Sparse::Coord> nextCoord;
 
@@ -1385,101 +1617,106 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
       CHECK(nextCoord.first == 0);
       CHECK(nextCoord.second == Sparse::Coord({3, 7, 0}));
 
-      CHECK(pageTable.getSubresource(0).pages[_idx(0, 0)] == Sparse::Page({sub0a, 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 0)] == Sparse::Page({sub0a, 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 0)] == Sparse::Page({sub0b, 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(0, 0), 64) == Sparse::Page({sub0a, 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 0), 64) == Sparse::Page({sub0a, 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 0), 64) == Sparse::Page({sub0b, 0}));
 
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 2)] == Sparse::Page({sub0b, 128}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 2)] == Sparse::Page({sub0a, (2 * 8 + 3) * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 2), 64) == Sparse::Page({sub0b, 128}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 2), 64) ==
+            Sparse::Page({sub0a, (2 * 8 + 3) * 64}));
 
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 6)] == Sparse::Page({sub0b, 6 * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 6)] == Sparse::Page({sub0c, 640}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 7)] == Sparse::Page({sub0c, 640}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 7)] == Sparse::Page({sub0c, 640}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 7)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(4, 7)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(7, 7)] == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 6), 64) == Sparse::Page({sub0b, 6 * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 6), 64) == Sparse::Page({sub0c, 640}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 7), 64) == Sparse::Page({sub0c, 640}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 7), 64) == Sparse::Page({sub0c, 640}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 7), 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(4, 7), 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(7, 7), 64) == Sparse::Page({ResourceId(), 0}));
 
       nextCoord = pageTable.setImageWrappedRange(0, {64, 224, 0}, 11 * 64, sub0c, 6400, false);
 
       CHECK(nextCoord.first == 1);
       CHECK(nextCoord.second == Sparse::Coord({1, 1, 0}));
 
-      CHECK(pageTable.getSubresource(0).pages[_idx(0, 0)] == Sparse::Page({sub0a, 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 0)] == Sparse::Page({sub0a, 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 0)] == Sparse::Page({sub0b, 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(0, 0), 64) == Sparse::Page({sub0a, 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 0), 64) == Sparse::Page({sub0a, 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 0), 64) == Sparse::Page({sub0b, 0}));
 
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 2)] == Sparse::Page({sub0b, 128}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 2)] == Sparse::Page({sub0a, (2 * 8 + 3) * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 2), 64) == Sparse::Page({sub0b, 128}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 2), 64) ==
+            Sparse::Page({sub0a, (2 * 8 + 3) * 64}));
 
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 6)] == Sparse::Page({sub0b, 6 * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 6)] == Sparse::Page({sub0c, 640}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 7)] == Sparse::Page({sub0c, 640}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 7)] == Sparse::Page({sub0c, 6400}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 7)] == Sparse::Page({sub0c, 6464}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(4, 7)] == Sparse::Page({sub0c, 6528}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(7, 7)] == Sparse::Page({sub0c, 6720}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 6), 64) == Sparse::Page({sub0b, 6 * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 6), 64) == Sparse::Page({sub0c, 640}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 7), 64) == Sparse::Page({sub0c, 640}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 7), 64) == Sparse::Page({sub0c, 6400}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 7), 64) == Sparse::Page({sub0c, 6464}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(4, 7), 64) == Sparse::Page({sub0c, 6528}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(7, 7), 64) == Sparse::Page({sub0c, 6720}));
 
       CHECK_FALSE(pageTable.getSubresource(1).hasSingleMapping());
       // 4x4 pages in second mip
-      REQUIRE(pageTable.getSubresource(1).pages.size() == 16);
-      CHECK(pageTable.getSubresource(1).pages[0] == Sparse::Page({sub0c, 6784}));
+      REQUIRE(pageTable.getSubresource(1).getNumPages() == 16);
+      CHECK(pageTable.getSubresource(1).getPage(0, 64) == Sparse::Page({sub0c, 6784}));
 
       nextCoord = pageTable.setImageWrappedRange(0, {32, 0, 0}, 64, ResourceId(), 640, false);
 
       CHECK(nextCoord.first == 0);
       CHECK(nextCoord.second == Sparse::Coord({2, 0, 0}));
 
-      CHECK(pageTable.getSubresource(0).pages[_idx(0, 0)] == Sparse::Page({sub0a, 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 0)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 0)] == Sparse::Page({sub0b, 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(0, 0), 64) == Sparse::Page({sub0a, 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 0), 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 0), 64) == Sparse::Page({sub0b, 0}));
 
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 2)] == Sparse::Page({sub0b, 128}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 2)] == Sparse::Page({sub0a, (2 * 8 + 3) * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 2), 64) == Sparse::Page({sub0b, 128}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 2), 64) ==
+            Sparse::Page({sub0a, (2 * 8 + 3) * 64}));
 
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 6)] == Sparse::Page({sub0b, 6 * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 6)] == Sparse::Page({sub0c, 640}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 7)] == Sparse::Page({sub0c, 640}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 7)] == Sparse::Page({sub0c, 6400}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 7)] == Sparse::Page({sub0c, 6464}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(4, 7)] == Sparse::Page({sub0c, 6528}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(7, 7)] == Sparse::Page({sub0c, 6720}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 6), 64) == Sparse::Page({sub0b, 6 * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 6), 64) == Sparse::Page({sub0c, 640}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 7), 64) == Sparse::Page({sub0c, 640}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 7), 64) == Sparse::Page({sub0c, 6400}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 7), 64) == Sparse::Page({sub0c, 6464}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(4, 7), 64) == Sparse::Page({sub0c, 6528}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(7, 7), 64) == Sparse::Page({sub0c, 6720}));
 
       pageTable.setImageBoxRange(0, {32, 192, 0}, {64, 64, 1}, ResourceId(), 640, false);
 
-      CHECK(pageTable.getSubresource(0).pages[_idx(0, 0)] == Sparse::Page({sub0a, 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 0)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 0)] == Sparse::Page({sub0b, 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(0, 0), 64) == Sparse::Page({sub0a, 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 0), 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 0), 64) == Sparse::Page({sub0b, 0}));
 
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 2)] == Sparse::Page({sub0b, 128}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 2)] == Sparse::Page({sub0a, (2 * 8 + 3) * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 2), 64) == Sparse::Page({sub0b, 128}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 2), 64) ==
+            Sparse::Page({sub0a, (2 * 8 + 3) * 64}));
 
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 6)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 6)] == Sparse::Page({sub0c, 640}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 7)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 7)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 7)] == Sparse::Page({sub0c, 6464}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(4, 7)] == Sparse::Page({sub0c, 6528}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(7, 7)] == Sparse::Page({sub0c, 6720}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 6), 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 6), 64) == Sparse::Page({sub0c, 640}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 7), 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 7), 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 7), 64) == Sparse::Page({sub0c, 6464}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(4, 7), 64) == Sparse::Page({sub0c, 6528}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(7, 7), 64) == Sparse::Page({sub0c, 6720}));
 
       nextCoord = pageTable.setImageWrappedRange(0, {128, 224, 0}, 64 * 4, sub0a, 512, true);
 
-      CHECK(pageTable.getSubresource(0).pages[_idx(0, 0)] == Sparse::Page({sub0a, 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 0)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 0)] == Sparse::Page({sub0b, 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(0, 0), 64) == Sparse::Page({sub0a, 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 0), 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 0), 64) == Sparse::Page({sub0b, 0}));
 
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 2)] == Sparse::Page({sub0b, 128}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 2)] == Sparse::Page({sub0a, (2 * 8 + 3) * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 2), 64) == Sparse::Page({sub0b, 128}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 2), 64) ==
+            Sparse::Page({sub0a, (2 * 8 + 3) * 64}));
 
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 6)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 6)] == Sparse::Page({sub0c, 640}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 7)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 7)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 7)] == Sparse::Page({sub0c, 6464}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(4, 7)] == Sparse::Page({sub0a, 512}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(7, 7)] == Sparse::Page({sub0a, 512}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 6), 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 6), 64) == Sparse::Page({sub0c, 640}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 7), 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 7), 64) == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 7), 64) == Sparse::Page({sub0c, 6464}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(4, 7), 64) == Sparse::Page({sub0a, 512}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(7, 7), 64) == Sparse::Page({sub0a, 512}));
 
-      CHECK(pageTable.getSubresource(1).pages[0] == Sparse::Page({sub0c, 6784}));
+      CHECK(pageTable.getSubresource(1).getPage(0, 64) == Sparse::Page({sub0c, 6784}));
 
       CHECK(nextCoord.first == 1);
       CHECK(nextCoord.second == Sparse::Coord({0, 0, 0}));
@@ -1498,44 +1735,44 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
 
     CHECK_FALSE(pageTable.getSubresource(0).hasSingleMapping());
     // 16x4 pages in top mip
-    REQUIRE(pageTable.getSubresource(0).pages.size() == 64);
+    REQUIRE(pageTable.getSubresource(0).getNumPages() == 64);
 
 #undef _idx
 #define _idx(x, y) y * 16 + x
 
-    CHECK(pageTable.getSubresource(0).pages[_idx(0, 0)] == Sparse::Page({mem0, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(1, 0)] == Sparse::Page({mem0, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(2, 0)] == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(0, 0), 64) == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(1, 0), 64) == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(2, 0), 64) == Sparse::Page({mem0, 0}));
 
-    CHECK(pageTable.getSubresource(0).pages[_idx(1, 1)] == Sparse::Page({mem0, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(2, 1)] == Sparse::Page({mem0, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(3, 1)] == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(1, 1), 64) == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(2, 1), 64) == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(3, 1), 64) == Sparse::Page({mem0, 0}));
 
-    CHECK(pageTable.getSubresource(0).pages[_idx(11, 2)] == Sparse::Page({ResourceId(), 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(12, 2)] == Sparse::Page({ResourceId(), 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(13, 2)] == Sparse::Page({ResourceId(), 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(11, 2), 64) == Sparse::Page({ResourceId(), 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(12, 2), 64) == Sparse::Page({ResourceId(), 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(13, 2), 64) == Sparse::Page({ResourceId(), 0}));
 
-    CHECK(pageTable.getSubresource(0).pages[_idx(11, 3)] == Sparse::Page({ResourceId(), 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(12, 3)] == Sparse::Page({ResourceId(), 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(13, 3)] == Sparse::Page({ResourceId(), 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(11, 3), 64) == Sparse::Page({ResourceId(), 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(12, 3), 64) == Sparse::Page({ResourceId(), 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(13, 3), 64) == Sparse::Page({ResourceId(), 0}));
 
     pageTable.setImageBoxRange(0, {256, 64, 0}, {256, 64, 1}, mem1, 0, true);
 
-    CHECK(pageTable.getSubresource(0).pages[_idx(0, 0)] == Sparse::Page({mem0, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(1, 0)] == Sparse::Page({mem0, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(2, 0)] == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(0, 0), 64) == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(1, 0), 64) == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(2, 0), 64) == Sparse::Page({mem0, 0}));
 
-    CHECK(pageTable.getSubresource(0).pages[_idx(1, 1)] == Sparse::Page({mem0, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(2, 1)] == Sparse::Page({mem0, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(3, 1)] == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(1, 1), 64) == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(2, 1), 64) == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(3, 1), 64) == Sparse::Page({mem0, 0}));
 
-    CHECK(pageTable.getSubresource(0).pages[_idx(11, 2)] == Sparse::Page({mem1, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(12, 2)] == Sparse::Page({mem1, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(13, 2)] == Sparse::Page({mem1, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(11, 2), 64) == Sparse::Page({mem1, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(12, 2), 64) == Sparse::Page({mem1, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(13, 2), 64) == Sparse::Page({mem1, 0}));
 
-    CHECK(pageTable.getSubresource(0).pages[_idx(11, 3)] == Sparse::Page({mem1, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(12, 3)] == Sparse::Page({mem1, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(13, 3)] == Sparse::Page({mem1, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(11, 3), 64) == Sparse::Page({mem1, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(12, 3), 64) == Sparse::Page({mem1, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(13, 3), 64) == Sparse::Page({mem1, 0}));
 
     rdcpair<uint32_t, Sparse::Coord> nextCoord;
 
@@ -1545,21 +1782,21 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
     CHECK(nextCoord.first == 0);
     CHECK(nextCoord.second == Sparse::Coord({12, 3, 0}));
 
-    CHECK(pageTable.getSubresource(0).pages[_idx(0, 0)] == Sparse::Page({mem0, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(1, 0)] == Sparse::Page({mem0, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(2, 0)] == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(0, 0), 64) == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(1, 0), 64) == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(2, 0), 64) == Sparse::Page({mem0, 0}));
 
-    CHECK(pageTable.getSubresource(0).pages[_idx(1, 1)] == Sparse::Page({mem0, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(2, 1)] == Sparse::Page({mem0, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(3, 1)] == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(1, 1), 64) == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(2, 1), 64) == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(3, 1), 64) == Sparse::Page({mem0, 0}));
 
-    CHECK(pageTable.getSubresource(0).pages[_idx(11, 2)] == Sparse::Page({mem2, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(12, 2)] == Sparse::Page({mem2, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(13, 2)] == Sparse::Page({mem2, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(11, 2), 64) == Sparse::Page({mem2, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(12, 2), 64) == Sparse::Page({mem2, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(13, 2), 64) == Sparse::Page({mem2, 0}));
 
-    CHECK(pageTable.getSubresource(0).pages[_idx(11, 3)] == Sparse::Page({mem2, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(12, 3)] == Sparse::Page({mem1, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(13, 3)] == Sparse::Page({mem1, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(11, 3), 64) == Sparse::Page({mem2, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(12, 3), 64) == Sparse::Page({mem1, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(13, 3), 64) == Sparse::Page({mem1, 0}));
   };
 
   SECTION("2D non-aligned texture")
@@ -1578,23 +1815,23 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
     pageTable.setImageWrappedRange(0, {11 * 32, 64, 0}, 64 * 17, mem2, 0, true);
 
     // still 16x4 pages in top mip
-    REQUIRE(pageTable.getSubresource(0).pages.size() == 64);
+    REQUIRE(pageTable.getSubresource(0).getNumPages() == 64);
 
-    CHECK(pageTable.getSubresource(0).pages[_idx(0, 0)] == Sparse::Page({mem0, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(1, 0)] == Sparse::Page({mem0, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(2, 0)] == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(0, 0), 64) == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(1, 0), 64) == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(2, 0), 64) == Sparse::Page({mem0, 0}));
 
-    CHECK(pageTable.getSubresource(0).pages[_idx(1, 1)] == Sparse::Page({mem0, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(2, 1)] == Sparse::Page({mem0, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(3, 1)] == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(1, 1), 64) == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(2, 1), 64) == Sparse::Page({mem0, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(3, 1), 64) == Sparse::Page({mem0, 0}));
 
-    CHECK(pageTable.getSubresource(0).pages[_idx(11, 2)] == Sparse::Page({mem2, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(12, 2)] == Sparse::Page({mem2, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(13, 2)] == Sparse::Page({mem2, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(11, 2), 64) == Sparse::Page({mem2, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(12, 2), 64) == Sparse::Page({mem2, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(13, 2), 64) == Sparse::Page({mem2, 0}));
 
-    CHECK(pageTable.getSubresource(0).pages[_idx(11, 3)] == Sparse::Page({mem2, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(12, 3)] == Sparse::Page({mem1, 0}));
-    CHECK(pageTable.getSubresource(0).pages[_idx(13, 3)] == Sparse::Page({mem1, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(11, 3), 64) == Sparse::Page({mem2, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(12, 3), 64) == Sparse::Page({mem1, 0}));
+    CHECK(pageTable.getSubresource(0).getPage(_idx(13, 3), 64) == Sparse::Page({mem1, 0}));
   };
 
   SECTION("2D texture that's all mip tail")
@@ -1630,13 +1867,13 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
     CHECK(nextTailOffset == 256);
 
     CHECK_FALSE(pageTable.getMipTail().mappings[0].hasSingleMapping());
-    REQUIRE(pageTable.getMipTail().mappings[0].pages.size() == 8192 / 64);
-    CHECK(pageTable.getMipTail().mappings[0].pages[0] == Sparse::Page({mip, 512}));
-    CHECK(pageTable.getMipTail().mappings[0].pages[1] == Sparse::Page({mip, 576}));
-    CHECK(pageTable.getMipTail().mappings[0].pages[2] == Sparse::Page({mip, 640}));
-    CHECK(pageTable.getMipTail().mappings[0].pages[3] == Sparse::Page({mip, 704}));
-    CHECK(pageTable.getMipTail().mappings[0].pages[4] == Sparse::Page({ResourceId(), 0}));
-    CHECK(pageTable.getMipTail().mappings[0].pages[5] == Sparse::Page({ResourceId(), 0}));
+    REQUIRE(pageTable.getMipTail().mappings[0].getNumPages() == 8192 / 64);
+    CHECK(pageTable.getMipTail().mappings[0].getPage(0, 64) == Sparse::Page({mip, 512}));
+    CHECK(pageTable.getMipTail().mappings[0].getPage(1, 64) == Sparse::Page({mip, 576}));
+    CHECK(pageTable.getMipTail().mappings[0].getPage(2, 64) == Sparse::Page({mip, 640}));
+    CHECK(pageTable.getMipTail().mappings[0].getPage(3, 64) == Sparse::Page({mip, 704}));
+    CHECK(pageTable.getMipTail().mappings[0].getPage(4, 64) == Sparse::Page({ResourceId(), 0}));
+    CHECK(pageTable.getMipTail().mappings[0].getPage(5, 64) == Sparse::Page({ResourceId(), 0}));
   };
 
   SECTION("mip tails smaller than the page size")
@@ -1653,14 +1890,14 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
 
       CHECK(nextTailOffset == 8192);
       CHECK(pageTable.getMipTail().mappings[0].hasSingleMapping());
-      REQUIRE(pageTable.getMipTail().mappings[0].pages.size() == 0);
+      REQUIRE(pageTable.getMipTail().mappings[0].getNumPages() == 0);
       CHECK(pageTable.getMipTail().mappings[0].singleMapping == Sparse::Page({mip, 65536 * 3}));
 
       nextTailOffset = pageTable.setMipTailRange(0, mip, 65536 * 3, 65536, false);
 
       CHECK(nextTailOffset == 8192);
       CHECK(pageTable.getMipTail().mappings[0].hasSingleMapping());
-      REQUIRE(pageTable.getMipTail().mappings[0].pages.size() == 0);
+      REQUIRE(pageTable.getMipTail().mappings[0].getNumPages() == 0);
       CHECK(pageTable.getMipTail().mappings[0].singleMapping == Sparse::Page({mip, 65536 * 3}));
 
       rdcpair<uint32_t, Sparse::Coord> nextCoord;
@@ -1670,7 +1907,7 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
       CHECK(nextCoord.first == 6);
       CHECK(nextCoord.second == Sparse::Coord({0, 0, 0}));
       CHECK(pageTable.getMipTail().mappings[0].hasSingleMapping());
-      REQUIRE(pageTable.getMipTail().mappings[0].pages.size() == 0);
+      REQUIRE(pageTable.getMipTail().mappings[0].getNumPages() == 0);
       CHECK(pageTable.getMipTail().mappings[0].singleMapping == Sparse::Page({mip, 65536 * 10}));
     };
 
@@ -1684,14 +1921,14 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
 
       CHECK(nextTailOffset == 8192);
       CHECK(pageTable.getMipTail().mappings[0].hasSingleMapping());
-      REQUIRE(pageTable.getMipTail().mappings[0].pages.size() == 0);
+      REQUIRE(pageTable.getMipTail().mappings[0].getNumPages() == 0);
       CHECK(pageTable.getMipTail().mappings[0].singleMapping == Sparse::Page({mip, 65536 * 3}));
 
       nextTailOffset = pageTable.setMipTailRange(0, mip, 65536 * 3, 65536, false);
 
       CHECK(nextTailOffset == 8192);
       CHECK(pageTable.getMipTail().mappings[0].hasSingleMapping());
-      REQUIRE(pageTable.getMipTail().mappings[0].pages.size() == 0);
+      REQUIRE(pageTable.getMipTail().mappings[0].getNumPages() == 0);
       CHECK(pageTable.getMipTail().mappings[0].singleMapping == Sparse::Page({mip, 65536 * 3}));
 
       rdcpair<uint32_t, Sparse::Coord> nextCoord;
@@ -1701,7 +1938,7 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
       CHECK(nextCoord.first == 6);
       CHECK(nextCoord.second == Sparse::Coord({0, 0, 0}));
       CHECK(pageTable.getMipTail().mappings[0].hasSingleMapping());
-      REQUIRE(pageTable.getMipTail().mappings[0].pages.size() == 0);
+      REQUIRE(pageTable.getMipTail().mappings[0].getNumPages() == 0);
       CHECK(pageTable.getMipTail().mappings[0].singleMapping == Sparse::Page({mip, 65536 * 10}));
     };
 
@@ -1715,14 +1952,14 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
 
       CHECK(nextTailOffset == 8192);
       CHECK(pageTable.getMipTail().mappings[0].hasSingleMapping());
-      REQUIRE(pageTable.getMipTail().mappings[0].pages.size() == 0);
+      REQUIRE(pageTable.getMipTail().mappings[0].getNumPages() == 0);
       CHECK(pageTable.getMipTail().mappings[0].singleMapping == Sparse::Page({mip, 65536 * 3}));
 
       nextTailOffset = pageTable.setMipTailRange(0, mip, 65536 * 3, 65536, false);
 
       CHECK(nextTailOffset == 8192);
       CHECK(pageTable.getMipTail().mappings[0].hasSingleMapping());
-      REQUIRE(pageTable.getMipTail().mappings[0].pages.size() == 0);
+      REQUIRE(pageTable.getMipTail().mappings[0].getNumPages() == 0);
       CHECK(pageTable.getMipTail().mappings[0].singleMapping == Sparse::Page({mip, 65536 * 3}));
 
       rdcpair<uint32_t, Sparse::Coord> nextCoord;
@@ -1732,7 +1969,7 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
       CHECK(nextCoord.first == 1);
       CHECK(nextCoord.second == Sparse::Coord({0, 0, 0}));
       CHECK(pageTable.getMipTail().mappings[0].hasSingleMapping());
-      REQUIRE(pageTable.getMipTail().mappings[0].pages.size() == 0);
+      REQUIRE(pageTable.getMipTail().mappings[0].getNumPages() == 0);
       CHECK(pageTable.getMipTail().mappings[0].singleMapping == Sparse::Page({mip, 65536 * 10}));
     };
   };
@@ -1825,33 +2062,39 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
 
       CHECK_FALSE(pageTable.getSubresource(0).hasSingleMapping());
       // 8x8x16 pages in top mip
-      REQUIRE(pageTable.getSubresource(0).pages.size() == 8 * 8 * 16);
+      REQUIRE(pageTable.getSubresource(0).getNumPages() == 8 * 8 * 16);
 
 #undef _idx
 #define _idx(x, y, z) ((z * 8 + y) * 8 + x)
 
       // don't check every one, spot-check
-      CHECK(pageTable.getSubresource(0).pages[_idx(0, 0, 0)] ==
+      CHECK(pageTable.getSubresource(0).getPage(_idx(0, 0, 0), 64) ==
             Sparse::Page({sub0a, _idx(0, 0, 0) * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 4, 0)] ==
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 4, 0), 64) ==
             Sparse::Page({sub0a, _idx(3, 4, 0) * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(7, 7, 0)] ==
+      CHECK(pageTable.getSubresource(0).getPage(_idx(7, 7, 0), 64) ==
             Sparse::Page({sub0a, _idx(7, 7, 0) * 64}));
 
-      CHECK(pageTable.getSubresource(0).pages[_idx(0, 0, 1)] ==
+      CHECK(pageTable.getSubresource(0).getPage(_idx(0, 0, 1), 64) ==
             Sparse::Page({sub0a, _idx(0, 0, 1) * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 4, 1)] ==
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 4, 1), 64) ==
             Sparse::Page({sub0a, _idx(3, 4, 1) * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(7, 7, 1)] ==
+      CHECK(pageTable.getSubresource(0).getPage(_idx(7, 7, 1), 64) ==
             Sparse::Page({sub0a, _idx(7, 7, 1) * 64}));
 
-      CHECK(pageTable.getSubresource(0).pages[_idx(0, 0, 10)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 4, 10)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(7, 7, 10)] == Sparse::Page({ResourceId(), 0}));
-
-      CHECK(pageTable.getSubresource(0).pages[_idx(0, 0, 11)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 4, 11)] == Sparse::Page({ResourceId(), 0}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(7, 7, 11)] == Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(0, 0, 10), 64) ==
+            Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 4, 10), 64) ==
+            Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(7, 7, 10), 64) ==
+            Sparse::Page({ResourceId(), 0}));
+
+      CHECK(pageTable.getSubresource(0).getPage(_idx(0, 0, 11), 64) ==
+            Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 4, 11), 64) ==
+            Sparse::Page({ResourceId(), 0}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(7, 7, 11), 64) ==
+            Sparse::Page({ResourceId(), 0}));
     };
   };
 
@@ -2005,15 +2248,15 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
         CHECK(nextTailOffset == pageTable.getMipTailByteOffsetForSubresource(12));
 
         CHECK_FALSE(pageTable.getMipTail().mappings[0].hasSingleMapping());
-        REQUIRE(pageTable.getMipTail().mappings[0].pages.size() == 2);
+        REQUIRE(pageTable.getMipTail().mappings[0].getNumPages() == 2);
         CHECK_FALSE(pageTable.getMipTail().mappings[0].singlePageReused);
-        CHECK(pageTable.getMipTail().mappings[0].pages[0] == Sparse::Page({mip0, 0}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[1] == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(0, 64) == Sparse::Page({mip0, 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(1, 64) == Sparse::Page({ResourceId(), 0}));
 
         CHECK_FALSE(pageTable.getMipTail().mappings[1].hasSingleMapping());
-        REQUIRE(pageTable.getMipTail().mappings[1].pages.size() == 2);
-        CHECK(pageTable.getMipTail().mappings[1].pages[0] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getMipTail().mappings[1].pages[1] == Sparse::Page({mip1, 256}));
+        REQUIRE(pageTable.getMipTail().mappings[1].getNumPages() == 2);
+        CHECK(pageTable.getMipTail().mappings[1].getPage(0, 64) == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[1].getPage(1, 64) == Sparse::Page({mip1, 256}));
 
         // this set is dubiously legal in client APIs but we ensure it works. We set part of one mip
         // tail, then the whole stride (which overwrites the real non-tail subresources?) then part
@@ -2027,15 +2270,15 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
         CHECK(nextTailOffset == pageTable.getMipTailByteOffsetForSubresource(6) + 64);
 
         CHECK_FALSE(pageTable.getMipTail().mappings[0].hasSingleMapping());
-        REQUIRE(pageTable.getMipTail().mappings[0].pages.size() == 2);
+        REQUIRE(pageTable.getMipTail().mappings[0].getNumPages() == 2);
         CHECK_FALSE(pageTable.getMipTail().mappings[0].singlePageReused);
-        CHECK(pageTable.getMipTail().mappings[0].pages[0] == Sparse::Page({mip0, 0}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[1] == Sparse::Page({mip2, 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(0, 64) == Sparse::Page({mip0, 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(1, 64) == Sparse::Page({mip2, 64}));
 
         CHECK_FALSE(pageTable.getMipTail().mappings[1].hasSingleMapping());
-        REQUIRE(pageTable.getMipTail().mappings[1].pages.size() == 2);
-        CHECK(pageTable.getMipTail().mappings[1].pages[0] == Sparse::Page({mip2, 32768}));
-        CHECK(pageTable.getMipTail().mappings[1].pages[1] == Sparse::Page({mip1, 256}));
+        REQUIRE(pageTable.getMipTail().mappings[1].getNumPages() == 2);
+        CHECK(pageTable.getMipTail().mappings[1].getPage(0, 64) == Sparse::Page({mip2, 32768}));
+        CHECK(pageTable.getMipTail().mappings[1].getPage(1, 64) == Sparse::Page({mip1, 256}));
 
         nextTailOffset =
             pageTable.setMipTailRange(pageTable.getMipTailByteOffsetForSubresource(18) + 64, mip2,
@@ -2044,9 +2287,9 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
         CHECK(nextTailOffset >= pageTable.getMipTailByteOffsetForSubresource(29) + 128);
 
         CHECK_FALSE(pageTable.getMipTail().mappings[3].hasSingleMapping());
-        REQUIRE(pageTable.getMipTail().mappings[3].pages.size() == 2);
-        CHECK(pageTable.getMipTail().mappings[3].pages[0] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getMipTail().mappings[3].pages[1] == Sparse::Page({mip2, 0}));
+        REQUIRE(pageTable.getMipTail().mappings[3].getNumPages() == 2);
+        CHECK(pageTable.getMipTail().mappings[3].getPage(0, 64) == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[3].getPage(1, 64) == Sparse::Page({mip2, 0}));
 
         CHECK(pageTable.getMipTail().mappings[4].hasSingleMapping());
         CHECK_FALSE(pageTable.getMipTail().mappings[4].singlePageReused);
@@ -2124,16 +2367,16 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
 
         // we should only allocate the minimum number of pages - total size divided by page size
         CHECK_FALSE(pageTable.getMipTail().mappings[0].hasSingleMapping());
-        REQUIRE(pageTable.getMipTail().mappings[0].pages.size() == 5 * 2);
-
-        CHECK(pageTable.getMipTail().mappings[0].pages[0] == Sparse::Page({mip0, 0}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[1] == Sparse::Page({mip0, 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[2] == Sparse::Page({mip1, 640}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[3] == Sparse::Page({mip1, 704}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[4] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[5] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[6] == Sparse::Page({mip2, 6400}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[7] == Sparse::Page({mip2, 6464}));
+        REQUIRE(pageTable.getMipTail().mappings[0].getNumPages() == 5 * 2);
+
+        CHECK(pageTable.getMipTail().mappings[0].getPage(0, 64) == Sparse::Page({mip0, 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(1, 64) == Sparse::Page({mip0, 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(2, 64) == Sparse::Page({mip1, 640}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(3, 64) == Sparse::Page({mip1, 704}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(4, 64) == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(5, 64) == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(6, 64) == Sparse::Page({mip2, 6400}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(7, 64) == Sparse::Page({mip2, 6464}));
       };
     };
 
@@ -2220,11 +2463,11 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
 
     pageTable.setImageBoxRange(8, {32, 0, 0}, {32, 64, 1}, sub8, 12800, false);
 
-    CHECK(pageTable.getSubresource(8).pages[_idx(0, 0)] == Sparse::Page({ResourceId(), 0}));
-    CHECK(pageTable.getSubresource(8).pages[_idx(1, 0)] == Sparse::Page({sub8, 12800}));
+    CHECK(pageTable.getSubresource(8).getPage(_idx(0, 0), 64) == Sparse::Page({ResourceId(), 0}));
+    CHECK(pageTable.getSubresource(8).getPage(_idx(1, 0), 64) == Sparse::Page({sub8, 12800}));
 
-    CHECK(pageTable.getSubresource(8).pages[_idx(0, 1)] == Sparse::Page({ResourceId(), 0}));
-    CHECK(pageTable.getSubresource(8).pages[_idx(1, 1)] == Sparse::Page({sub8, 12864}));
+    CHECK(pageTable.getSubresource(8).getPage(_idx(0, 1), 64) == Sparse::Page({ResourceId(), 0}));
+    CHECK(pageTable.getSubresource(8).getPage(_idx(1, 1), 64) == Sparse::Page({sub8, 12864}));
 
     // this sets some of subresource 18 (8x8 tiles), all of subresource 19 (4x4 tiles) and some of
     // 20 (2x2 tiles)
@@ -2237,14 +2480,17 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
 #undef _idx
 #define _idx(x, y) y * 8 + x
 
-    CHECK(pageTable.getSubresource(18).pages[_idx(0, 0)] == Sparse::Page({ResourceId(), 0}));
-    CHECK(pageTable.getSubresource(18).pages[_idx(3, 3)] == Sparse::Page({ResourceId(), 0}));
-    CHECK(pageTable.getSubresource(18).pages[_idx(4, 3)] == Sparse::Page({ResourceId(), 0}));
-    CHECK(pageTable.getSubresource(18).pages[_idx(5, 3)] == Sparse::Page({ResourceId(), 0}));
-    CHECK(pageTable.getSubresource(18).pages[_idx(3, 4)] == Sparse::Page({ResourceId(), 0}));
-    CHECK(pageTable.getSubresource(18).pages[_idx(4, 4)] == Sparse::Page({sub18_19_20, 0 * 64}));
-    CHECK(pageTable.getSubresource(18).pages[_idx(5, 4)] == Sparse::Page({sub18_19_20, 1 * 64}));
-    CHECK(pageTable.getSubresource(18).pages[_idx(7, 7)] == Sparse::Page({sub18_19_20, 27 * 64}));
+    CHECK(pageTable.getSubresource(18).getPage(_idx(0, 0), 64) == Sparse::Page({ResourceId(), 0}));
+    CHECK(pageTable.getSubresource(18).getPage(_idx(3, 3), 64) == Sparse::Page({ResourceId(), 0}));
+    CHECK(pageTable.getSubresource(18).getPage(_idx(4, 3), 64) == Sparse::Page({ResourceId(), 0}));
+    CHECK(pageTable.getSubresource(18).getPage(_idx(5, 3), 64) == Sparse::Page({ResourceId(), 0}));
+    CHECK(pageTable.getSubresource(18).getPage(_idx(3, 4), 64) == Sparse::Page({ResourceId(), 0}));
+    CHECK(pageTable.getSubresource(18).getPage(_idx(4, 4), 64) ==
+          Sparse::Page({sub18_19_20, 0 * 64}));
+    CHECK(pageTable.getSubresource(18).getPage(_idx(5, 4), 64) ==
+          Sparse::Page({sub18_19_20, 1 * 64}));
+    CHECK(pageTable.getSubresource(18).getPage(_idx(7, 7), 64) ==
+          Sparse::Page({sub18_19_20, 27 * 64}));
 
     CHECK(pageTable.getSubresource(19).hasSingleMapping());
     CHECK(pageTable.getSubresource(19).singleMapping == Sparse::Page({sub18_19_20, 28 * 64}));
@@ -2253,11 +2499,11 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
 #undef _idx
 #define _idx(x, y) y * 2 + x
 
-    CHECK(pageTable.getSubresource(20).pages[_idx(0, 0)] ==
+    CHECK(pageTable.getSubresource(20).getPage(_idx(0, 0), 64) ==
           Sparse::Page({sub18_19_20, (28 + 16) * 64}));
-    CHECK(pageTable.getSubresource(20).pages[_idx(1, 0)] == Sparse::Page({ResourceId(), 0}));
-    CHECK(pageTable.getSubresource(20).pages[_idx(0, 1)] == Sparse::Page({ResourceId(), 0}));
-    CHECK(pageTable.getSubresource(20).pages[_idx(1, 1)] == Sparse::Page({ResourceId(), 0}));
+    CHECK(pageTable.getSubresource(20).getPage(_idx(1, 0), 64) == Sparse::Page({ResourceId(), 0}));
+    CHECK(pageTable.getSubresource(20).getPage(_idx(0, 1), 64) == Sparse::Page({ResourceId(), 0}));
+    CHECK(pageTable.getSubresource(20).getPage(_idx(1, 1), 64) == Sparse::Page({ResourceId(), 0}));
   };
 
   SECTION("Updates from whole-subresource to split pages")
@@ -2292,24 +2538,24 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
       CHECK(nextTailOffset == 128 + 64);
 
       CHECK_FALSE(pageTable.getMipTail().mappings[0].hasSingleMapping());
-      REQUIRE(pageTable.getMipTail().mappings[0].pages.size() == 5);
-      CHECK(pageTable.getMipTail().mappings[0].pages[0] == Sparse::Page({mem0, 0}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[1] == Sparse::Page({mem0, 64}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[2] == Sparse::Page({mem1, 0}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[3] == Sparse::Page({mem0, 192}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[4] == Sparse::Page({mem0, 256}));
+      REQUIRE(pageTable.getMipTail().mappings[0].getNumPages() == 5);
+      CHECK(pageTable.getMipTail().mappings[0].getPage(0, 64) == Sparse::Page({mem0, 0}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(1, 64) == Sparse::Page({mem0, 64}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(2, 64) == Sparse::Page({mem1, 0}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(3, 64) == Sparse::Page({mem0, 192}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(4, 64) == Sparse::Page({mem0, 256}));
 
       nextTailOffset = pageTable.setBufferRange(0, mem2, 1024, 64, false);
 
       CHECK(nextTailOffset == 0 + 64);
 
       CHECK_FALSE(pageTable.getMipTail().mappings[0].hasSingleMapping());
-      REQUIRE(pageTable.getMipTail().mappings[0].pages.size() == 5);
-      CHECK(pageTable.getMipTail().mappings[0].pages[0] == Sparse::Page({mem2, 1024}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[1] == Sparse::Page({mem0, 64}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[2] == Sparse::Page({mem1, 0}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[3] == Sparse::Page({mem0, 192}));
-      CHECK(pageTable.getMipTail().mappings[0].pages[4] == Sparse::Page({mem0, 256}));
+      REQUIRE(pageTable.getMipTail().mappings[0].getNumPages() == 5);
+      CHECK(pageTable.getMipTail().mappings[0].getPage(0, 64) == Sparse::Page({mem2, 1024}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(1, 64) == Sparse::Page({mem0, 64}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(2, 64) == Sparse::Page({mem1, 0}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(3, 64) == Sparse::Page({mem0, 192}));
+      CHECK(pageTable.getMipTail().mappings[0].getPage(4, 64) == Sparse::Page({mem0, 256}));
 
       nextTailOffset = pageTable.setBufferRange(0, mem2, 0, 320, false);
 
@@ -2358,38 +2604,54 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
 #undef _idx
 #define _idx(x, y) (y * 8 + x)
 
-      CHECK(pageTable.getSubresource(0).pages[_idx(0, 0)] == Sparse::Page({mem0, _idx(0, 0) * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 0)] == Sparse::Page({mem0, _idx(1, 0) * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 0)] == Sparse::Page({mem0, _idx(2, 0) * 64}));
-
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 1)] == Sparse::Page({mem1, 10240}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 1)] == Sparse::Page({mem1, 10240}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 2)] == Sparse::Page({mem1, 10240}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 2)] == Sparse::Page({mem1, 10240}));
-
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 6)] == Sparse::Page({mem0, _idx(2, 6) * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 6)] == Sparse::Page({mem0, _idx(3, 6) * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 7)] == Sparse::Page({mem0, _idx(1, 7) * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 7)] == Sparse::Page({mem0, _idx(2, 7) * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 7)] == Sparse::Page({mem0, _idx(3, 7) * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(0, 0), 64) ==
+            Sparse::Page({mem0, _idx(0, 0) * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 0), 64) ==
+            Sparse::Page({mem0, _idx(1, 0) * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 0), 64) ==
+            Sparse::Page({mem0, _idx(2, 0) * 64}));
+
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 1), 64) == Sparse::Page({mem1, 10240}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 1), 64) == Sparse::Page({mem1, 10240}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 2), 64) == Sparse::Page({mem1, 10240}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 2), 64) == Sparse::Page({mem1, 10240}));
+
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 6), 64) ==
+            Sparse::Page({mem0, _idx(2, 6) * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 6), 64) ==
+            Sparse::Page({mem0, _idx(3, 6) * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 7), 64) ==
+            Sparse::Page({mem0, _idx(1, 7) * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 7), 64) ==
+            Sparse::Page({mem0, _idx(2, 7) * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 7), 64) ==
+            Sparse::Page({mem0, _idx(3, 7) * 64}));
 
       pageTable.setImageBoxRange(0, {0, 0, 0}, {256, 256, 1}, mem0, 0, false);
       pageTable.setImageBoxRange(0, {32, 32, 0}, {64, 64, 1}, mem1, 1024000, false);
 
-      CHECK(pageTable.getSubresource(0).pages[_idx(0, 0)] == Sparse::Page({mem0, _idx(0, 0) * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 0)] == Sparse::Page({mem0, _idx(1, 0) * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 0)] == Sparse::Page({mem0, _idx(2, 0) * 64}));
-
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 1)] == Sparse::Page({mem1, 1024000}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 1)] == Sparse::Page({mem1, 1024064}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 2)] == Sparse::Page({mem1, 1024128}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 2)] == Sparse::Page({mem1, 1024192}));
-
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 6)] == Sparse::Page({mem0, _idx(2, 6) * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 6)] == Sparse::Page({mem0, _idx(3, 6) * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(1, 7)] == Sparse::Page({mem0, _idx(1, 7) * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(2, 7)] == Sparse::Page({mem0, _idx(2, 7) * 64}));
-      CHECK(pageTable.getSubresource(0).pages[_idx(3, 7)] == Sparse::Page({mem0, _idx(3, 7) * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(0, 0), 64) ==
+            Sparse::Page({mem0, _idx(0, 0) * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 0), 64) ==
+            Sparse::Page({mem0, _idx(1, 0) * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 0), 64) ==
+            Sparse::Page({mem0, _idx(2, 0) * 64}));
+
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 1), 64) == Sparse::Page({mem1, 1024000}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 1), 64) == Sparse::Page({mem1, 1024064}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 2), 64) == Sparse::Page({mem1, 1024128}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 2), 64) == Sparse::Page({mem1, 1024192}));
+
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 6), 64) ==
+            Sparse::Page({mem0, _idx(2, 6) * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 6), 64) ==
+            Sparse::Page({mem0, _idx(3, 6) * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(1, 7), 64) ==
+            Sparse::Page({mem0, _idx(1, 7) * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(2, 7), 64) ==
+            Sparse::Page({mem0, _idx(2, 7) * 64}));
+      CHECK(pageTable.getSubresource(0).getPage(_idx(3, 7), 64) ==
+            Sparse::Page({mem0, _idx(3, 7) * 64}));
     };
   };
 
@@ -2425,11 +2687,11 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
 
         CHECK(srcPageTable.getMipTail().mappings[0].hasSingleMapping());
         REQUIRE_FALSE(pageTable.getMipTail().mappings[0].hasSingleMapping());
-        CHECK(pageTable.getMipTail().mappings[0].pages[0] == Sparse::Page({mem0, 0 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[1] == Sparse::Page({mem0, 1 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[2] == Sparse::Page({mem0, 2 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[3] == Sparse::Page({mem0, 3 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[4] == Sparse::Page({mem0, 4 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(0, 64) == Sparse::Page({mem0, 0 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(1, 64) == Sparse::Page({mem0, 1 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(2, 64) == Sparse::Page({mem0, 2 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(3, 64) == Sparse::Page({mem0, 3 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(4, 64) == Sparse::Page({mem0, 4 * 64}));
 
         pageTable.copyImageWrappedRange(0, {0, 0, 0}, 5, srcPageTable, 0, {0, 0, 0});
 
@@ -2441,11 +2703,11 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
         pageTable.copyImageWrappedRange(0, {4, 0, 0}, 1, srcPageTable, 0, {4, 0, 0});
 
         REQUIRE_FALSE(pageTable.getMipTail().mappings[0].hasSingleMapping());
-        CHECK(pageTable.getMipTail().mappings[0].pages[0] == Sparse::Page({mem0, 0 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[1] == Sparse::Page({mem0, 1 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[2] == Sparse::Page({mem0, 2 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[3] == Sparse::Page({mem0, 3 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[4] == Sparse::Page({mem0, 4 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(0, 64) == Sparse::Page({mem0, 0 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(1, 64) == Sparse::Page({mem0, 1 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(2, 64) == Sparse::Page({mem0, 2 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(3, 64) == Sparse::Page({mem0, 3 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(4, 64) == Sparse::Page({mem0, 4 * 64}));
       };
 
       SECTION("Source larger")
@@ -2468,11 +2730,11 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
 
         CHECK(srcPageTable.getMipTail().mappings[0].hasSingleMapping());
         REQUIRE_FALSE(pageTable.getMipTail().mappings[0].hasSingleMapping());
-        CHECK(pageTable.getMipTail().mappings[0].pages[0] == Sparse::Page({mem0, 0 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[1] == Sparse::Page({mem0, 1 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[2] == Sparse::Page({mem0, 2 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[3] == Sparse::Page({mem0, 3 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[4] == Sparse::Page({mem0, 4 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(0, 64) == Sparse::Page({mem0, 0 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(1, 64) == Sparse::Page({mem0, 1 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(2, 64) == Sparse::Page({mem0, 2 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(3, 64) == Sparse::Page({mem0, 3 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(4, 64) == Sparse::Page({mem0, 4 * 64}));
 
         pageTable.copyImageWrappedRange(0, {0, 0, 0}, 5, srcPageTable, 0, {0, 0, 0});
 
@@ -2484,11 +2746,11 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
         pageTable.copyImageWrappedRange(0, {4, 0, 0}, 1, srcPageTable, 0, {4, 0, 0});
 
         REQUIRE_FALSE(pageTable.getMipTail().mappings[0].hasSingleMapping());
-        CHECK(pageTable.getMipTail().mappings[0].pages[0] == Sparse::Page({mem0, 0 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[1] == Sparse::Page({mem0, 1 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[2] == Sparse::Page({mem0, 2 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[3] == Sparse::Page({mem0, 3 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[4] == Sparse::Page({mem0, 4 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(0, 64) == Sparse::Page({mem0, 0 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(1, 64) == Sparse::Page({mem0, 1 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(2, 64) == Sparse::Page({mem0, 2 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(3, 64) == Sparse::Page({mem0, 3 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(4, 64) == Sparse::Page({mem0, 4 * 64}));
       };
 
       SECTION("Destination larger")
@@ -2502,61 +2764,61 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
 
         CHECK(srcPageTable.getMipTail().mappings[0].hasSingleMapping());
         REQUIRE_FALSE(pageTable.getMipTail().mappings[0].hasSingleMapping());
-        CHECK(pageTable.getMipTail().mappings[0].pages[0] == Sparse::Page({mem0, 0 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[1] == Sparse::Page({mem0, 1 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[2] == Sparse::Page({mem0, 2 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[3] == Sparse::Page({mem0, 3 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[4] == Sparse::Page({mem0, 4 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[5] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[6] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[7] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[8] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[9] == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(0, 64) == Sparse::Page({mem0, 0 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(1, 64) == Sparse::Page({mem0, 1 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(2, 64) == Sparse::Page({mem0, 2 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(3, 64) == Sparse::Page({mem0, 3 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(4, 64) == Sparse::Page({mem0, 4 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(5, 64) == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(6, 64) == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(7, 64) == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(8, 64) == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(9, 64) == Sparse::Page({ResourceId(), 0}));
 
         // copying two separate boxes won't coalesce
         pageTable.copyImageBoxRange(0, {0, 0, 0}, {4, 1, 1}, srcPageTable, 0, {0, 0, 0});
         pageTable.copyImageBoxRange(0, {4, 0, 0}, {1, 1, 1}, srcPageTable, 0, {4, 0, 0});
 
         REQUIRE_FALSE(pageTable.getMipTail().mappings[0].hasSingleMapping());
-        CHECK(pageTable.getMipTail().mappings[0].pages[0] == Sparse::Page({mem0, 0 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[1] == Sparse::Page({mem0, 1 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[2] == Sparse::Page({mem0, 2 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[3] == Sparse::Page({mem0, 3 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[4] == Sparse::Page({mem0, 4 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[5] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[6] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[7] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[8] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[9] == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(0, 64) == Sparse::Page({mem0, 0 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(1, 64) == Sparse::Page({mem0, 1 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(2, 64) == Sparse::Page({mem0, 2 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(3, 64) == Sparse::Page({mem0, 3 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(4, 64) == Sparse::Page({mem0, 4 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(5, 64) == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(6, 64) == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(7, 64) == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(8, 64) == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(9, 64) == Sparse::Page({ResourceId(), 0}));
 
         pageTable.copyImageWrappedRange(0, {0, 0, 0}, 5, srcPageTable, 0, {0, 0, 0});
 
         REQUIRE_FALSE(pageTable.getMipTail().mappings[0].hasSingleMapping());
-        CHECK(pageTable.getMipTail().mappings[0].pages[0] == Sparse::Page({mem0, 0 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[1] == Sparse::Page({mem0, 1 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[2] == Sparse::Page({mem0, 2 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[3] == Sparse::Page({mem0, 3 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[4] == Sparse::Page({mem0, 4 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[5] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[6] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[7] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[8] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[9] == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(0, 64) == Sparse::Page({mem0, 0 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(1, 64) == Sparse::Page({mem0, 1 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(2, 64) == Sparse::Page({mem0, 2 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(3, 64) == Sparse::Page({mem0, 3 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(4, 64) == Sparse::Page({mem0, 4 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(5, 64) == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(6, 64) == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(7, 64) == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(8, 64) == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(9, 64) == Sparse::Page({ResourceId(), 0}));
 
         pageTable.copyImageWrappedRange(0, {0, 0, 0}, 4, srcPageTable, 0, {0, 0, 0});
         pageTable.copyImageWrappedRange(0, {4, 0, 0}, 1, srcPageTable, 0, {4, 0, 0});
 
         REQUIRE_FALSE(pageTable.getMipTail().mappings[0].hasSingleMapping());
-        CHECK(pageTable.getMipTail().mappings[0].pages[0] == Sparse::Page({mem0, 0 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[1] == Sparse::Page({mem0, 1 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[2] == Sparse::Page({mem0, 2 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[3] == Sparse::Page({mem0, 3 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[4] == Sparse::Page({mem0, 4 * 64}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[5] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[6] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[7] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[8] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getMipTail().mappings[0].pages[9] == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(0, 64) == Sparse::Page({mem0, 0 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(1, 64) == Sparse::Page({mem0, 1 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(2, 64) == Sparse::Page({mem0, 2 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(3, 64) == Sparse::Page({mem0, 3 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(4, 64) == Sparse::Page({mem0, 4 * 64}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(5, 64) == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(6, 64) == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(7, 64) == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(8, 64) == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getMipTail().mappings[0].getPage(9, 64) == Sparse::Page({ResourceId(), 0}));
       };
     };
 
@@ -2590,70 +2852,91 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
 #undef _idx
 #define _idx(x, y) (y * 8 + x)
 
-        CHECK(pageTable.getSubresource(0).pages[_idx(0, 0)] == Sparse::Page({mem3, _idx(0, 0) * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(1, 0)] == Sparse::Page({mem3, _idx(1, 0) * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(2, 0)] == Sparse::Page({mem3, _idx(2, 0) * 64}));
-
-        CHECK(pageTable.getSubresource(0).pages[_idx(5, 0)] == Sparse::Page({mem0, _idx(5, 0) * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(6, 0)] == Sparse::Page({mem0, _idx(6, 0) * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(7, 0)] == Sparse::Page({mem0, _idx(7, 0) * 64}));
-
-        CHECK(pageTable.getSubresource(0).pages[_idx(0, 1)] == Sparse::Page({mem3, _idx(0, 1) * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(1, 1)] == Sparse::Page({mem3, _idx(1, 1) * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(2, 1)] == Sparse::Page({mem3, _idx(2, 1) * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(0, 0), 64) ==
+              Sparse::Page({mem3, _idx(0, 0) * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(1, 0), 64) ==
+              Sparse::Page({mem3, _idx(1, 0) * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(2, 0), 64) ==
+              Sparse::Page({mem3, _idx(2, 0) * 64}));
+
+        CHECK(pageTable.getSubresource(0).getPage(_idx(5, 0), 64) ==
+              Sparse::Page({mem0, _idx(5, 0) * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(6, 0), 64) ==
+              Sparse::Page({mem0, _idx(6, 0) * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(7, 0), 64) ==
+              Sparse::Page({mem0, _idx(7, 0) * 64}));
+
+        CHECK(pageTable.getSubresource(0).getPage(_idx(0, 1), 64) ==
+              Sparse::Page({mem3, _idx(0, 1) * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(1, 1), 64) ==
+              Sparse::Page({mem3, _idx(1, 1) * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(2, 1), 64) ==
+              Sparse::Page({mem3, _idx(2, 1) * 64}));
 
         pageTable.copyImageBoxRange(0, {0, 0, 0}, {4, 4, 1}, srcPageTable, 1, {0, 0, 0});
 
         REQUIRE_FALSE(pageTable.getSubresource(0).hasSingleMapping());
-        CHECK(pageTable.getSubresource(0).pages[_idx(0, 0)] == Sparse::Page({mem1, 0 * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(1, 0)] == Sparse::Page({mem1, 1 * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(2, 0)] == Sparse::Page({mem1, 2 * 64}));
-
-        CHECK(pageTable.getSubresource(0).pages[_idx(5, 0)] == Sparse::Page({mem0, _idx(5, 0) * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(6, 0)] == Sparse::Page({mem0, _idx(6, 0) * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(7, 0)] == Sparse::Page({mem0, _idx(7, 0) * 64}));
-
-        CHECK(pageTable.getSubresource(0).pages[_idx(0, 1)] == Sparse::Page({mem1, 4 * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(1, 1)] == Sparse::Page({mem1, 5 * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(2, 1)] == Sparse::Page({mem1, 6 * 64}));
-
-        CHECK(pageTable.getSubresource(0).pages[_idx(0, 3)] == Sparse::Page({mem1, 12 * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(1, 3)] == Sparse::Page({mem1, 13 * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(2, 3)] == Sparse::Page({mem1, 14 * 64}));
-
-        CHECK(pageTable.getSubresource(0).pages[_idx(4, 4)] == Sparse::Page({mem0, _idx(4, 4) * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(5, 4)] == Sparse::Page({mem0, _idx(5, 4) * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(6, 4)] == Sparse::Page({mem0, _idx(6, 4) * 64}));
-
-        CHECK(pageTable.getSubresource(0).pages[_idx(4, 5)] == Sparse::Page({mem0, _idx(4, 5) * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(5, 5)] == Sparse::Page({mem0, _idx(5, 5) * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(6, 5)] == Sparse::Page({mem0, _idx(6, 5) * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(0, 0), 64) == Sparse::Page({mem1, 0 * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(1, 0), 64) == Sparse::Page({mem1, 1 * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(2, 0), 64) == Sparse::Page({mem1, 2 * 64}));
+
+        CHECK(pageTable.getSubresource(0).getPage(_idx(5, 0), 64) ==
+              Sparse::Page({mem0, _idx(5, 0) * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(6, 0), 64) ==
+              Sparse::Page({mem0, _idx(6, 0) * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(7, 0), 64) ==
+              Sparse::Page({mem0, _idx(7, 0) * 64}));
+
+        CHECK(pageTable.getSubresource(0).getPage(_idx(0, 1), 64) == Sparse::Page({mem1, 4 * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(1, 1), 64) == Sparse::Page({mem1, 5 * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(2, 1), 64) == Sparse::Page({mem1, 6 * 64}));
+
+        CHECK(pageTable.getSubresource(0).getPage(_idx(0, 3), 64) == Sparse::Page({mem1, 12 * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(1, 3), 64) == Sparse::Page({mem1, 13 * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(2, 3), 64) == Sparse::Page({mem1, 14 * 64}));
+
+        CHECK(pageTable.getSubresource(0).getPage(_idx(4, 4), 64) ==
+              Sparse::Page({mem0, _idx(4, 4) * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(5, 4), 64) ==
+              Sparse::Page({mem0, _idx(5, 4) * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(6, 4), 64) ==
+              Sparse::Page({mem0, _idx(6, 4) * 64}));
+
+        CHECK(pageTable.getSubresource(0).getPage(_idx(4, 5), 64) ==
+              Sparse::Page({mem0, _idx(4, 5) * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(5, 5), 64) ==
+              Sparse::Page({mem0, _idx(5, 5) * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(6, 5), 64) ==
+              Sparse::Page({mem0, _idx(6, 5) * 64}));
 
         pageTable.copyImageBoxRange(0, {4, 4, 0}, {4, 4, 1}, srcPageTable, 1, {0, 0, 0});
 
-        CHECK(pageTable.getSubresource(0).pages[_idx(0, 0)] == Sparse::Page({mem1, 0 * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(1, 0)] == Sparse::Page({mem1, 1 * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(2, 0)] == Sparse::Page({mem1, 2 * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(0, 0), 64) == Sparse::Page({mem1, 0 * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(1, 0), 64) == Sparse::Page({mem1, 1 * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(2, 0), 64) == Sparse::Page({mem1, 2 * 64}));
 
-        CHECK(pageTable.getSubresource(0).pages[_idx(5, 0)] == Sparse::Page({mem0, _idx(5, 0) * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(6, 0)] == Sparse::Page({mem0, _idx(6, 0) * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(7, 0)] == Sparse::Page({mem0, _idx(7, 0) * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(5, 0), 64) ==
+              Sparse::Page({mem0, _idx(5, 0) * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(6, 0), 64) ==
+              Sparse::Page({mem0, _idx(6, 0) * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(7, 0), 64) ==
+              Sparse::Page({mem0, _idx(7, 0) * 64}));
 
-        CHECK(pageTable.getSubresource(0).pages[_idx(0, 1)] == Sparse::Page({mem1, 4 * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(1, 1)] == Sparse::Page({mem1, 5 * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(2, 1)] == Sparse::Page({mem1, 6 * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(0, 1), 64) == Sparse::Page({mem1, 4 * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(1, 1), 64) == Sparse::Page({mem1, 5 * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(2, 1), 64) == Sparse::Page({mem1, 6 * 64}));
 
-        CHECK(pageTable.getSubresource(0).pages[_idx(0, 3)] == Sparse::Page({mem1, 12 * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(1, 3)] == Sparse::Page({mem1, 13 * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(2, 3)] == Sparse::Page({mem1, 14 * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(0, 3), 64) == Sparse::Page({mem1, 12 * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(1, 3), 64) == Sparse::Page({mem1, 13 * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(2, 3), 64) == Sparse::Page({mem1, 14 * 64}));
 
-        CHECK(pageTable.getSubresource(0).pages[_idx(4, 4)] == Sparse::Page({mem1, 0 * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(5, 4)] == Sparse::Page({mem1, 1 * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(6, 4)] == Sparse::Page({mem1, 2 * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(4, 4), 64) == Sparse::Page({mem1, 0 * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(5, 4), 64) == Sparse::Page({mem1, 1 * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(6, 4), 64) == Sparse::Page({mem1, 2 * 64}));
 
-        CHECK(pageTable.getSubresource(0).pages[_idx(4, 5)] == Sparse::Page({mem1, 4 * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(5, 5)] == Sparse::Page({mem1, 5 * 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(6, 5)] == Sparse::Page({mem1, 6 * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(4, 5), 64) == Sparse::Page({mem1, 4 * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(5, 5), 64) == Sparse::Page({mem1, 5 * 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(6, 5), 64) == Sparse::Page({mem1, 6 * 64}));
       };
 
       SECTION("Wrapped copies preserving single mapping")
@@ -2699,55 +2982,79 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
 
         pageTable.copyImageWrappedRange(0, {5, 0, 0}, 2, srcPageTable, 0, {0, 0, 0});
 
-        CHECK(pageTable.getSubresource(0).pages[_idx(0, 0)] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(1, 0)] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(2, 0)] == Sparse::Page({ResourceId(), 0}));
-
-        CHECK(pageTable.getSubresource(0).pages[_idx(5, 0)] == Sparse::Page({mem0, 0}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(6, 0)] == Sparse::Page({mem0, 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(7, 0)] == Sparse::Page({ResourceId(), 0}));
-
-        CHECK(pageTable.getSubresource(0).pages[_idx(0, 1)] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(1, 1)] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(2, 1)] == Sparse::Page({ResourceId(), 0}));
-
-        CHECK(pageTable.getSubresource(0).pages[_idx(0, 3)] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(1, 3)] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(2, 3)] == Sparse::Page({ResourceId(), 0}));
-
-        CHECK(pageTable.getSubresource(0).pages[_idx(5, 3)] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(6, 3)] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(7, 3)] == Sparse::Page({ResourceId(), 0}));
-
-        CHECK(pageTable.getSubresource(0).pages[_idx(0, 4)] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(1, 4)] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(2, 4)] == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(0, 0), 64) ==
+              Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(1, 0), 64) ==
+              Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(2, 0), 64) ==
+              Sparse::Page({ResourceId(), 0}));
+
+        CHECK(pageTable.getSubresource(0).getPage(_idx(5, 0), 64) == Sparse::Page({mem0, 0}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(6, 0), 64) == Sparse::Page({mem0, 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(7, 0), 64) ==
+              Sparse::Page({ResourceId(), 0}));
+
+        CHECK(pageTable.getSubresource(0).getPage(_idx(0, 1), 64) ==
+              Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(1, 1), 64) ==
+              Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(2, 1), 64) ==
+              Sparse::Page({ResourceId(), 0}));
+
+        CHECK(pageTable.getSubresource(0).getPage(_idx(0, 3), 64) ==
+              Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(1, 3), 64) ==
+              Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(2, 3), 64) ==
+              Sparse::Page({ResourceId(), 0}));
+
+        CHECK(pageTable.getSubresource(0).getPage(_idx(5, 3), 64) ==
+              Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(6, 3), 64) ==
+              Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(7, 3), 64) ==
+              Sparse::Page({ResourceId(), 0}));
+
+        CHECK(pageTable.getSubresource(0).getPage(_idx(0, 4), 64) ==
+              Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(1, 4), 64) ==
+              Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(2, 4), 64) ==
+              Sparse::Page({ResourceId(), 0}));
 
         pageTable.copyImageWrappedRange(0, {0, 3, 0}, 10, srcPageTable, 1, {0, 0, 0});
 
-        CHECK(pageTable.getSubresource(0).pages[_idx(0, 0)] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(1, 0)] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(2, 0)] == Sparse::Page({ResourceId(), 0}));
-
-        CHECK(pageTable.getSubresource(0).pages[_idx(5, 0)] == Sparse::Page({mem0, 0}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(6, 0)] == Sparse::Page({mem0, 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(7, 0)] == Sparse::Page({ResourceId(), 0}));
-
-        CHECK(pageTable.getSubresource(0).pages[_idx(0, 1)] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(1, 1)] == Sparse::Page({ResourceId(), 0}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(2, 1)] == Sparse::Page({ResourceId(), 0}));
-
-        CHECK(pageTable.getSubresource(0).pages[_idx(0, 3)] == Sparse::Page({mem1, 0}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(1, 3)] == Sparse::Page({mem1, 64}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(2, 3)] == Sparse::Page({mem1, 128}));
-
-        CHECK(pageTable.getSubresource(0).pages[_idx(5, 3)] == Sparse::Page({mem1, 320}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(6, 3)] == Sparse::Page({mem1, 384}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(7, 3)] == Sparse::Page({mem1, 448}));
-
-        CHECK(pageTable.getSubresource(0).pages[_idx(0, 4)] == Sparse::Page({mem1, 512}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(1, 4)] == Sparse::Page({mem1, 576}));
-        CHECK(pageTable.getSubresource(0).pages[_idx(2, 4)] == Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(0, 0), 64) ==
+              Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(1, 0), 64) ==
+              Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(2, 0), 64) ==
+              Sparse::Page({ResourceId(), 0}));
+
+        CHECK(pageTable.getSubresource(0).getPage(_idx(5, 0), 64) == Sparse::Page({mem0, 0}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(6, 0), 64) == Sparse::Page({mem0, 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(7, 0), 64) ==
+              Sparse::Page({ResourceId(), 0}));
+
+        CHECK(pageTable.getSubresource(0).getPage(_idx(0, 1), 64) ==
+              Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(1, 1), 64) ==
+              Sparse::Page({ResourceId(), 0}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(2, 1), 64) ==
+              Sparse::Page({ResourceId(), 0}));
+
+        CHECK(pageTable.getSubresource(0).getPage(_idx(0, 3), 64) == Sparse::Page({mem1, 0}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(1, 3), 64) == Sparse::Page({mem1, 64}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(2, 3), 64) == Sparse::Page({mem1, 128}));
+
+        CHECK(pageTable.getSubresource(0).getPage(_idx(5, 3), 64) == Sparse::Page({mem1, 320}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(6, 3), 64) == Sparse::Page({mem1, 384}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(7, 3), 64) == Sparse::Page({mem1, 448}));
+
+        CHECK(pageTable.getSubresource(0).getPage(_idx(0, 4), 64) == Sparse::Page({mem1, 512}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(1, 4), 64) == Sparse::Page({mem1, 576}));
+        CHECK(pageTable.getSubresource(0).getPage(_idx(2, 4), 64) ==
+              Sparse::Page({ResourceId(), 0}));
       };
     };
   };
@@ -2825,4 +3132,262 @@ TEST_CASE("Test sparse page table mapping", "[sparse]")
   };
 };
 
+TEST_CASE("Test sparse page table runs", "[sparse]")
+{
+  Sparse::PageTable pageTable;
+
+  ResourceId mem = ResourceIDGen::GetNewUniqueID();
+  ResourceId mem2 = ResourceIDGen::GetNewUniqueID();
+
+  // count how many runs a range needs by looking for pages that don't continue the previous page
+  auto countRuns = [](const Sparse::PageRangeMapping &mapping, uint32_t pageSize) {
+    size_t ret = 1;
+    Sparse::Page prev = mapping.getPage(0, pageSize);
+    for(uint32_t p = 1; p < mapping.getNumPages(); p++)
+    {
+      Sparse::Page cur = mapping.getPage(p, pageSize);
+      if(cur.memory != prev.memory ||
+         (cur.memory != ResourceId() && cur.offset != prev.offset + pageSize))
+        ret++;
+      prev = cur;
+    }
+    return ret;
+  };
+
+  SECTION("Partial updates split and merge runs")
+  {
+    pageTable.Initialise(64 * 64, 64);
+
+    const Sparse::PageRangeMapping &mapping = pageTable.getMipTail().mappings[0];
+
+    pageTable.setBufferRange(0, mem, 0, 64 * 64, false);
+
+    CHECK(mapping.hasSingleMapping());
+
+    pageTable.setBufferRange(16 * 64, mem2, 0, 16 * 64, false);
+
+    REQUIRE(mapping.runs.size() == 3);
+    CHECK(mapping.getNumPages() == 64);
+    CHECK(mapping.getRunPageCount(0) == 16);
+    CHECK(mapping.getRunPageCount(1) == 16);
+    CHECK(mapping.getRunPageCount(2) == 32);
+    CHECK(mapping.getPage(15, 64) == Sparse::Page({mem, 15 * 64}));
+    CHECK(mapping.getPage(16, 64) == Sparse::Page({mem2, 0}));
+    CHECK(mapping.getPage(31, 64) == Sparse::Page({mem2, 15 * 64}));
+    CHECK(mapping.getPage(32, 64) == Sparse::Page({mem, 32 * 64}));
+
+    // punch a hole in the middle of the second run
+    pageTable.setBufferRange(20 * 64, mem, 20 * 64, 4 * 64, false);
+
+    REQUIRE(mapping.runs.size() == 5);
+    CHECK(mapping.getRunPageCount(1) == 4);
+    CHECK(mapping.getRunPageCount(2) == 4);
+    CHECK(mapping.getRunPageCount(3) == 8);
+    CHECK(mapping.getPage(19, 64) == Sparse::Page({mem2, 3 * 64}));
+    CHECK(mapping.getPage(20, 64) == Sparse::Page({mem, 20 * 64}));
+    CHECK(mapping.getPage(24, 64) == Sparse::Page({mem2, 8 * 64}));
+
+    // putting back the original mapping merges the runs again
+    pageTable.setBufferRange(20 * 64, mem2, 4 * 64, 4 * 64, false);
+
+    REQUIRE(mapping.runs.size() == 3);
+    CHECK(mapping.getRunPageCount(1) == 16);
+
+    // a single repeated page in the middle
+    pageTable.setBufferRange(40 * 64, mem2, 0, 8 * 64, true);
+
+    REQUIRE(mapping.runs.size() == 5);
+    CHECK(mapping.runs[3].singlePageReused);
+    CHECK(mapping.getPage(40, 64) == Sparse::Page({mem2, 0}));
+    CHECK(mapping.getPage(47, 64) == Sparse::Page({mem2, 0}));
+    CHECK(mapping.getPage(48, 64) == Sparse::Page({mem, 48 * 64}));
+
+    // restoring everything leaves one run, which still counts as split
+    pageTable.setBufferRange(16 * 64, mem, 16 * 64, 48 * 64, false);
+
+    REQUIRE(mapping.runs.size() == 1);
+    CHECK_FALSE(mapping.hasSingleMapping());
+    CHECK(mapping.getPage(63, 64) == Sparse::Page({mem, 63 * 64}));
+
+    // unmapping everything in pieces goes back to a single mapping
+    pageTable.setBufferRange(0, ResourceId(), 0, 32 * 64, false);
+
+    REQUIRE(mapping.runs.size() == 2);
+
+    pageTable.setBufferRange(32 * 64, ResourceId(), 0, 32 * 64, false);
+
+    CHECK(mapping.hasSingleMapping());
+    CHECK_FALSE(mapping.isMapped());
+  };
+
+  SECTION("Large buffer streamed in blocks")
+  {
+    // 256GB of 64kB pages
+    const uint32_t pageSize = 64 * 1024;
+    const uint32_t numPages = 4 * 1024 * 1024;
+    const uint32_t blockPages = 64;
+    const uint32_t numBlocks = numPages / blockPages;
+    const uint64_t blockSize = uint64_t(blockPages) * pageSize;
+
+    pageTable.Initialise(uint64_t(numPages) * pageSize, pageSize);
+
+    const Sparse::PageRangeMapping &mapping = pageTable.getMipTail().mappings[0];
+
+    // map every other block in order, as a streaming system would
+    for(uint32_t b = 0; b < numBlocks; b += 2)
+      pageTable.setBufferRange(b * blockSize, mem, b * blockSize, blockSize, false);
+
+    REQUIRE(mapping.getNumPages() == numPages);
+    CHECK(mapping.runs.size() == numBlocks);
+
+    CHECK(mapping.getPage(0, pageSize) == Sparse::Page({mem, 0}));
+    CHECK(mapping.getPage(blockPages - 1, pageSize) ==
+          Sparse::Page({mem, uint64_t(blockPages - 1) * pageSize}));
+    CHECK(mapping.getPage(blockPages, pageSize) == Sparse::Page({ResourceId(), 0}));
+    CHECK(mapping.getPage(1000 * blockPages + 5, pageSize) ==
+          Sparse::Page({mem, (1000 * blockPages + 5) * uint64_t(pageSize)}));
+    CHECK(mapping.getPage(numPages - 1, pageSize) == Sparse::Page({ResourceId(), 0}));
+
+    // the bookkeeping scales with the number of runs, not the number of pages
+    CHECK(pageTable.GetSerialiseSize() < uint64_t(numPages) * sizeof(Sparse::Page) / 16);
+
+    // fill in the gaps from the end so each update merges with both neighbours
+    for(uint32_t b = numBlocks - 1; b < numBlocks; b -= 2)
+      pageTable.setBufferRange(b * blockSize, mem, b * blockSize, blockSize, false);
+
+    REQUIRE(mapping.runs.size() == 1);
+    CHECK(mapping.getPage(numPages - 1, pageSize) ==
+          Sparse::Page({mem, uint64_t(numPages - 1) * pageSize}));
+  };
+
+  SECTION("Large texture mapped in a checkerboard")
+  {
+    // 16384x16384 texture with 128x128 pages, so 128x128 pages in total
+    const uint32_t pageSize = 64 * 1024;
+    const uint32_t pageDim = 128;
+    const uint32_t boxPages = 8;
+    const uint32_t numBoxes = pageDim / boxPages;
+
+    pageTable.Initialise({16384, 16384, 1}, 1, 1, pageSize, {128, 128, 1}, 1, 0, 0, 0);
+
+    const Sparse::PageRangeMapping &mapping = pageTable.getSubresource(0);
+
+    // map boxes of 8x8 pages with each page at the memory offset matching its index
+    auto mapBoxes = [&](uint32_t parity) {
+      for(uint32_t by = 0; by < numBoxes; by++)
+      {
+        for(uint32_t bx = 0; bx < numBoxes; bx++)
+        {
+          if(((bx + by) % 2) != parity)
+            continue;
+
+          const uint32_t firstPage = (by * boxPages) * pageDim + bx * boxPages;
+
+          for(uint32_t y = 0; y < boxPages; y++)
+            pageTable.setImageBoxRange(
+                0, {bx * boxPages * 128, (by * boxPages + y) * 128, 0}, {boxPages * 128, 128, 1},
+                mem, uint64_t(firstPage + y * pageDim) * pageSize, false);
+        }
+      }
+    };
+
+    mapBoxes(0);
+
+    REQUIRE(mapping.getNumPages() == pageDim * pageDim);
+
+    // each row of pages alternates between mapped and unmapped boxes. Rows don't merge except at
+    // the boundary between rows of boxes, where the boxes at either end have the same state.
+    CHECK(mapping.runs.size() == pageDim * numBoxes - (numBoxes - 1));
+    CHECK(mapping.runs.size() == countRuns(mapping, pageSize));
+
+    CHECK(mapping.getPage(5 * pageDim + 3, pageSize) ==
+          Sparse::Page({mem, uint64_t(5 * pageDim + 3) * pageSize}));
+    CHECK(mapping.getPage(5 * pageDim + 10, pageSize) == Sparse::Page({ResourceId(), 0}));
+    CHECK(mapping.getPage(10 * pageDim + 10, pageSize) ==
+          Sparse::Page({mem, uint64_t(10 * pageDim + 10) * pageSize}));
+
+    // mapping the other half makes the whole texture one contiguous run
+    mapBoxes(1);
+
+    REQUIRE(mapping.runs.size() == 1);
+    CHECK(mapping.getPage(pageDim * pageDim - 1, pageSize) ==
+          Sparse::Page({mem, uint64_t(pageDim * pageDim - 1) * pageSize}));
+
+    pageTable.setImageBoxRange(0, {0, 0, 0}, {16384, 16384, 1}, ResourceId(), 0, false);
+
+    CHECK(mapping.hasSingleMapping());
+    CHECK_FALSE(mapping.isMapped());
+  };
+
+  SECTION("Serialise round trip")
+  {
+    pageTable.Initialise(64 * 64, 64);
+    pageTable.setBufferRange(0, mem, 0, 64 * 64, false);
+    pageTable.setBufferRange(16 * 64, mem2, 0, 16 * 64, false);
+    pageTable.setBufferRange(40 * 64, mem2, 0, 8 * 64, true);
+    pageTable.setBufferRange(56 * 64, ResourceId(), 0, 4 * 64, false);
+
+    const Sparse::PageRangeMapping &mapping = pageTable.getMipTail().mappings[0];
+
+    REQUIRE(mapping.runs.size() == 7);
+
+    StreamWriter *buf = new StreamWriter(StreamWriter::DefaultScratchSize);
+
+    {
+      WriteSerialiser ser(buf, Ownership::Nothing);
+
+      {
+        SCOPED_SERIALISE_CHUNK(5);
+
+        Sparse::LegacyPageTable legacy;
+        legacy.table = pageTable;
+
+        SERIALISE_ELEMENT(pageTable);
+        SERIALISE_ELEMENT(legacy);
+      }
+
+      REQUIRE_FALSE(ser.IsErrored());
+    }
+
+    {
+      ReadSerialiser ser(new StreamReader(buf->GetData(), buf->GetOffset()), Ownership::Stream);
+
+      CHECK(ser.ReadChunk<uint32_t>() == 5);
+
+      Sparse::PageTable readTable;
+      Sparse::LegacyPageTable legacy;
+
+      ser.Serialise("pageTable"_lit, readTable);
+      ser.Serialise("legacy"_lit, legacy);
+
+      ser.EndChunk();
+
+      REQUIRE_FALSE(ser.IsErrored());
+
+      // the legacy format stores every page, converting it back must give the same runs
+      for(const Sparse::PageTable *table : {&readTable, &legacy.table})
+      {
+        const Sparse::PageRangeMapping &readMapping = table->getMipTail().mappings[0];
+
+        CHECK(table->getPageByteSize() == 64);
+        CHECK(table->getMipTail().totalPackedByteSize == 64 * 64);
+        REQUIRE(readMapping.getNumPages() == 64);
+        REQUIRE(readMapping.runs.size() == mapping.runs.size());
+
+        for(size_t r = 0; r < mapping.runs.size(); r++)
+        {
+          CHECK(readMapping.runs[r].firstPage == mapping.runs[r].firstPage);
+          CHECK(readMapping.runs[r].singlePageReused == mapping.runs[r].singlePageReused);
+          CHECK(readMapping.runs[r].mapping == mapping.runs[r].mapping);
+        }
+
+        for(uint32_t p = 0; p < 64; p++)
+          CHECK(readMapping.getPage(p, 64) == mapping.getPage(p, 64));
+      }
+    }
+
+    delete buf;
+  };
+};
+
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -33,11 +33,14 @@
 namespace Sparse
 {
 class PageTable;
+struct LegacyPageTable;
 };    // namespace Sparse
 
-// we pre-declare this function so we can make it a friend inside the PageTable implementation
+// we pre-declare these functions so we can make them friends inside the PageTable implementation
 template <class SerialiserType>
 void DoSerialise(SerialiserType &ser, Sparse::PageTable &el);
+template <class SerialiserType>
+void DoSerialise(SerialiserType &ser, Sparse::LegacyPageTable &el);
 
 namespace Sparse
 {
@@ -57,52 +60,97 @@ struct Page
   bool operator==(const Page &o) const { return memory == o.memory && offset == o.offset; }
 };
 
+// a run of consecutive resource pages with the same kind of mapping. The run covers all pages from
+// firstPage up to the next run's firstPage (or the end of the range).
+struct PageRun
+{
+  // the first resource page in this run
+  uint32_t firstPage;
+
+  // if set, every page in the run is mapped to the same memory page. Otherwise the pages are mapped
+  // to consecutive memory pages starting at mapping. Unmapped runs always set this.
+  bool singlePageReused;
+
+  // the memory mapping of firstPage
+  Page mapping;
+
+  bool operator==(const PageRun &o) const
+  {
+    return firstPage == o.firstPage && singlePageReused == o.singlePageReused &&
+           mapping == o.mapping;
+  }
+};
+
 struct PageRangeMapping
 {
-  bool hasSingleMapping() const { return pages.empty(); }
-  // the memory mapping if there's a single mapping. Only valid if pages below is empty
+  bool hasSingleMapping() const { return runs.empty(); }
+  // the memory mapping if there's a single mapping. Only valid if runs below is empty
   Page singleMapping;
 
   // since with a single mapping we only store the 'base' page, we need an additional bool to
   // indicate if it's a single page re-used or if it's all subsequent pages used.
   bool singlePageReused = false;
 
-  // the memory mappings per-page if there are different mappings per-page
-  rdcarray<Page> pages;
+  // the number of pages covered by runs, only valid if runs is not empty
+  uint32_t numPages = 0;
 
-  bool isMapped() const { return !pages.empty() || singleMapping.memory != ResourceId(); }
+  // if there are different mappings for different pages, the range is split into runs sorted by
+  // their first page. Neighbouring runs that continue each other are always merged, so this stays
+  // small unless the mapping is truly fragmented.
+  rdcarray<PageRun> runs;
+
+  bool isMapped() const { return !runs.empty() || singleMapping.memory != ResourceId(); }
   void simplifyUnmapped()
   {
-    // if we're already using singleMapping, don't check anything
-    if(pages.empty())
-      return;
-
-    // if we find a single page with memory mapped, we're not entirely unmapped
-    for(size_t i = 0; i < pages.size(); i++)
-      if(pages[i].memory != ResourceId())
-        return;
-
-    // we're entirely unmapped - revert back to a single page mapping
-    pages.clear();
-    singleMapping = Page();
-    singlePageReused = false;
+    // since neighbouring runs are merged, if we're entirely unmapped we have one unmapped run. In
+    // that case revert back to a single page mapping
+    if(runs.size() == 1 && runs[0].mapping.memory == ResourceId())
+    {
+      runs.clear();
+      numPages = 0;
+      singleMapping = Page();
+      singlePageReused = false;
+    }
+  }
+
+  // the number of pages that are individually addressable, or 0 with a single mapping
+  uint32_t getNumPages() const { return runs.empty() ? 0 : numPages; }
+  // the number of pages in a given run
+  uint32_t getRunPageCount(size_t run) const
+  {
+    return (run + 1 < runs.size() ? runs[run + 1].firstPage : numPages) - runs[run].firstPage;
   }
+  // the index of the run containing a page, found with a binary search
+  size_t findRun(uint32_t page) const;
+
   Page getPage(uint32_t idx, uint32_t pageSize) const
   {
-    if(pages.empty())
+    if(runs.empty())
     {
       if(singlePageReused)
         return singleMapping;
 
       Page ret = singleMapping;
-      ret.offset += pageSize * idx;
+      ret.offset += uint64_t(pageSize) * idx;
       return ret;
     }
 
-    return pages[idx];
+    const PageRun &run = runs[findRun(idx)];
+    Page ret = run.mapping;
+    if(!run.singlePageReused)
+      ret.offset += uint64_t(pageSize) * (idx - run.firstPage);
+    return ret;
   }
 
-  void createPages(uint32_t numPages, uint32_t pageSize);
+  // split a single mapping into runs so that pages can be updated individually
+  void createPages(uint32_t pageCount, uint32_t pageSize);
+  // map count pages from firstPage onwards. This must only be called after createPages
+  void setPages(uint32_t firstPage, uint32_t count, Page page, bool useSinglePage,
+                uint32_t pageSize);
+
+private:
+  void splitRun(uint32_t page, uint32_t pageSize);
+  bool mergeRuns(size_t run, uint32_t pageSize);
 };
 
 struct MipTail
@@ -129,8 +177,9 @@ struct MipTail
 // shadows the page table for a sparse resource - buffer or texture - and handles updates and
 // retrieval. Currently the system is simple - we first store a page mapping per subresource. This
 // should hopefully cover most applications and avoids needing to allocate, update, and store/apply
-// a whole page table. If we detect a partial update we allocate a full page table and store the
-// mapping for each page.
+// a whole page table. If we detect a partial update we split the subresource into runs of pages
+// with contiguous mappings, so the cost scales with how fragmented the mapping is rather than with
+// the size of the resource.
 class PageTable
 {
 public:
@@ -297,12 +346,30 @@ private:
 
   template <typename SerialiserType>
   friend void ::DoSerialise(SerialiserType &ser, PageTable &el);
+  template <typename SerialiserType>
+  friend void ::DoSerialise(SerialiserType &ser, Sparse::LegacyPageTable &el);
+};
+
+// captures from before page ranges were stored as runs serialised every page of a partially mapped
+// range individually. Drivers serialise through this instead when reading those captures, and it
+// converts to and from the current table.
+struct LegacyPageTable
+{
+  PageTable table;
 };
 
 };    // namespace Sparse
 
 DECLARE_REFLECTION_STRUCT(Sparse::Coord);
 DECLARE_REFLECTION_STRUCT(Sparse::Page);
+DECLARE_REFLECTION_STRUCT(Sparse::PageRun);
 DECLARE_REFLECTION_STRUCT(Sparse::PageRangeMapping);
 DECLARE_REFLECTION_STRUCT(Sparse::MipTail);
 DECLARE_REFLECTION_STRUCT(Sparse::PageTable);
+
+// the legacy table keeps the original type name so structured data looks the same as it did
+template <>
+inline rdcliteral TypeName<Sparse::LegacyPageTable>()
+{
+  return STRING_LITERAL("Sparse::PageTable");
+}
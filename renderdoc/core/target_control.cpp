@@ -111,6 +111,13 @@ rdcstr DoStringise(const PacketType &el)
 #define WRITE_DATA_SCOPE() WriteSerialiser &ser = writer;
 #define READ_DATA_SCOPE() ReadSerialiser &ser = reader;
 
+void RenderDoc::WakeControlClientThread()
+{
+  SCOPED_LOCK(RenderDoc::Inst().m_SingleClientLock);
+  if(RenderDoc::Inst().m_ControlClientReactor)
+    RenderDoc::Inst().m_ControlClientReactor->Wake();
+}
+
 void RenderDoc::TargetControlClientThread(uint32_t version, Network::Socket *client)
 {
   Threading::SetCurrentThreadName("TargetControlClientThread");
@@ -147,6 +154,14 @@ void RenderDoc::TargetControlClientThread(uint32_t version, Network::Socket *cli
     return;
   }
 
+  Network::SocketReactor reactor;
+  reactor.Add(client);
+
+  {
+    SCOPED_LOCK(RenderDoc::Inst().m_SingleClientLock);
+    RenderDoc::Inst().m_ControlClientReactor = &reactor;
+  }
+
   float captureProgress = -1.0f;
   RenderDoc::Inst().SetProgressCallback<CaptureProgress>(
       [&captureProgress](float p) { captureProgress = p; });
@@ -172,8 +187,15 @@ void RenderDoc::TargetControlClientThread(uint32_t version, Network::Socket *cli
       break;
     }
 
-    Threading::Sleep(ticktime);
-    curtime += ticktime;
+    // wait until the next tick, but wake up as soon as the client sends us anything
+    {
+      PerformanceTimer tickTimer;
+
+      if(reader.GetReader()->AtEnd())
+        reactor.Wait(ticktime);
+
+      curtime += RDCMAX(1, (int)tickTimer.GetMilliseconds());
+    }
 
     std::map<RDCDriver, RDCDriverStatus> curdrivers = RenderDoc::Inst().GetActiveDrivers();
 
@@ -416,6 +438,7 @@ void RenderDoc::TargetControlClientThread(uint32_t version, Network::Socket *cli
   {
     SCOPED_LOCK(RenderDoc::Inst().m_SingleClientLock);
     RenderDoc::Inst().m_SingleClientName = "";
+    RenderDoc::Inst().m_ControlClientReactor = NULL;
   }
 
   Threading::ReleaseModuleExitThread();
@@ -435,7 +458,8 @@ void RenderDoc::TargetControlServerThread(Network::Socket *sock)
 
   while(!RenderDoc::Inst().m_TargetControlThreadShutdown)
   {
-    Network::Socket *client = sock->AcceptClient(0);
+    // block until a client connects. The timeout only bounds how long it takes to notice shutdown
+    Network::Socket *client = sock->AcceptClient(20);
 
     if(client == NULL)
     {
@@ -448,8 +472,6 @@ void RenderDoc::TargetControlServerThread(Network::Socket *sock)
         return;
       }
 
-      Threading::Sleep(5);
-
       continue;
     }
 
@@ -494,6 +516,7 @@ void RenderDoc::TargetControlServerThread(Network::Socket *sock)
     {
       // forcibly close communication thread which will kill the connection
       RenderDoc::Inst().m_ControlClientThreadShutdown = true;
+      WakeControlClientThread();
       Threading::JoinThread(clientThread);
       Threading::CloseThread(clientThread);
       clientThread = 0;
@@ -536,6 +559,7 @@ void RenderDoc::TargetControlServerThread(Network::Socket *sock)
   }
 
   RenderDoc::Inst().m_ControlClientThreadShutdown = true;
+  WakeControlClientThread();
   // don't join, just close the thread, as we can't wait while in the middle of module unloading
   Threading::CloseThread(clientThread);
   clientThread = 0;
@@ -621,6 +645,9 @@ public:
     {
       RDCLOG("Got remote busy signal: %s owned by %s", m_Target.c_str(), m_BusyClient.c_str());
     }
+
+    // ReceiveMessage waits on the socket for messages, it's registered once for the connection
+    m_Reactor.Add(m_Socket);
   }
 
   virtual ~TargetControl() {}
@@ -708,18 +735,21 @@ public:
 
     if(!m_Socket->IsRecvDataWaiting() && reader.GetReader()->AtEnd())
     {
+      // wait a little while for a message, but return it as soon as it arrives
+      if(m_Socket->Connected())
+        m_Reactor.Wait(2);
+
       if(!m_Socket->Connected())
       {
         SAFE_DELETE(m_Socket);
         msg.type = TargetControlMessageType::Disconnected;
+        return msg;
       }
-      else
+      else if(!m_Socket->IsRecvDataWaiting())
       {
-        Threading::Sleep(2);
         msg.type = TargetControlMessageType::Noop;
+        return msg;
       }
-
-      return msg;
     }
 
     PacketType type = reader.ReadChunk<PacketType>();
@@ -929,6 +959,7 @@ public:
 
 private:
   Network::Socket *m_Socket;
+  Network::SocketReactor m_Reactor;
   WriteSerialiser writer;
   ReadSerialiser reader;
   rdcstr m_Target, m_API, m_BusyClient;
@@ -984,3 +1015,151 @@ extern "C" RENDERDOC_API ITargetControl *RENDERDOC_CC RENDERDOC_CreateTargetCont
   delete remote;
   return NULL;
 }
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "catch/catch.hpp"
+
+TEST_CASE("Target control trigger capture round-trip", "[targetcontrol][network]")
+{
+  uint16_t port = 8265;
+  Network::Socket *server = NULL;
+
+  for(uint16_t probe = 0; probe < 20; probe++)
+  {
+    server = Network::CreateServerSocket("localhost", port, 1);
+
+    if(server)
+      break;
+
+    port++;
+  }
+
+  REQUIRE(server);
+
+  const uint32_t numTriggers = 100;
+
+  // number of times the target's wait ran to its timeout instead of being woken by incoming data
+  uint32_t timeouts = 0;
+
+  // stand in for the target. Like TargetControlClientThread it waits on its socket between ticks,
+  // and acknowledges each trigger with a progress message so the client sees the round-trip.
+  Threading::ThreadHandle targetThread = Threading::CreateThread([server, numTriggers, &timeouts]() {
+    Network::Socket *client = server->AcceptClient(5000);
+    if(!client)
+      return;
+
+    WriteSerialiser writer(new StreamWriter(client, Ownership::Nothing), Ownership::Stream);
+    ReadSerialiser reader(new StreamReader(client, Ownership::Nothing), Ownership::Stream);
+
+    writer.SetStreamingMode(true);
+    reader.SetStreamingMode(true);
+
+    if(reader.ReadChunk<PacketType>() != ePacket_Handshake)
+    {
+      delete client;
+      return;
+    }
+
+    {
+      uint32_t version = 0;
+      rdcstr clientName;
+      bool kick = false;
+
+      READ_DATA_SCOPE();
+      SERIALISE_ELEMENT(version);
+      SERIALISE_ELEMENT(clientName);
+      SERIALISE_ELEMENT(kick);
+    }
+    reader.EndChunk();
+
+    {
+      WRITE_DATA_SCOPE();
+      SCOPED_SERIALISE_CHUNK(ePacket_Handshake);
+      rdcstr target = "test";
+      uint32_t pid = Process::GetCurrentPID();
+      SERIALISE_ELEMENT(TargetControlProtocolVersion);
+      SERIALISE_ELEMENT(target);
+      SERIALISE_ELEMENT(pid);
+    }
+
+    Network::SocketReactor reactor;
+    reactor.Add(client);
+
+    for(uint32_t i = 0; i < numTriggers && client->Connected();)
+    {
+      if(!client->IsRecvDataWaiting() && reader.GetReader()->AtEnd())
+      {
+        // nothing else wakes this reactor, so returning false means the timeout expired
+        if(!reactor.Wait(5000))
+          timeouts++;
+        continue;
+      }
+
+      if(reader.ReadChunk<PacketType>() != ePacket_TriggerCapture)
+        break;
+
+      uint32_t numFrames = 0;
+      {
+        READ_DATA_SCOPE();
+        SERIALISE_ELEMENT(numFrames);
+      }
+      reader.EndChunk();
+
+      {
+        WRITE_DATA_SCOPE();
+        SCOPED_SERIALISE_CHUNK(ePacket_CaptureProgress);
+        float progress = float(numFrames);
+        SERIALISE_ELEMENT(progress);
+      }
+
+      i++;
+    }
+
+    delete client;
+  });
+
+  ITargetControl *control = RENDERDOC_CreateTargetControl("localhost", port, "test", true);
+
+  REQUIRE(control);
+
+  double total = 0.0, worst = 0.0;
+
+  for(uint32_t i = 1; i <= numTriggers; i++)
+  {
+    PerformanceTimer timer;
+
+    control->TriggerCapture(i);
+
+    TargetControlMessage msg;
+    while(timer.GetMilliseconds() < 5000.0)
+    {
+      msg = control->ReceiveMessage(NULL);
+      if(msg.type != TargetControlMessageType::Noop)
+        break;
+    }
+
+    double ms = timer.GetMilliseconds();
+    total += ms;
+    worst = RDCMAX(worst, ms);
+
+    REQUIRE((uint32_t)msg.type == (uint32_t)TargetControlMessageType::CaptureProgress);
+    CHECK(msg.capProgress == float(i));
+  }
+
+  control->Shutdown();
+
+  Threading::JoinThread(targetThread);
+  Threading::CloseThread(targetThread);
+
+  delete server;
+
+  RDCLOG("Trigger capture round-trip: %.3lf ms average, %.3lf ms worst over %u triggers",
+         total / numTriggers, worst, numTriggers);
+
+  // the client sends each trigger as soon as the previous one is acknowledged, so the target's waits
+  // should always be woken by the incoming data rather than falling back to their timeout.
+  CHECK(timeouts == 0);
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -1042,12 +1042,10 @@ void WrappedID3D12CommandQueue::ExecuteCommandListsInternal(UINT NumCommandLists
               }
               else
               {
-                // this is a huge perf cliff as we've lost any batching and we perform as badly as
-                // if every page was mapped to a different resource, so we hope applications don't
-                // hit this often.
-                for(const Sparse::Page &page : mapping.pages)
+                // each run of pages is in a single heap, so we only need to look at the runs
+                for(const Sparse::PageRun &run : mapping.runs)
                 {
-                  sparsePageHeaps.insert(page.memory);
+                  sparsePageHeaps.insert(run.mapping.memory);
                 }
               }
 
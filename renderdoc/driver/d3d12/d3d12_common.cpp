@@ -239,6 +239,10 @@ bool D3D12InitParams::IsSupportedVersion(uint64_t ver)
   if(ver == 0xD)
     return true;
 
+  // 0xE -> 0xF - Sparse page tables serialised as runs of pages
+  if(ver == 0xE)
+    return true;
+
   return false;
 }
 
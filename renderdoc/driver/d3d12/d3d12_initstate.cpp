@@ -480,11 +480,13 @@ SparseBinds::SparseBinds(const Sparse::PageTable &table)
       Sparse::Coord texelShape = table.calcSubresourcePageDim(sub);
 
       // march the pages for this subresource in linear order
-      for(uint32_t page = 0; page < mapping.pages.size(); page++)
+      for(uint32_t page = 0; page < mapping.getNumPages(); page++)
       {
+        const Sparse::Page pageMapping = mapping.getPage(page, pageSize);
+
         Bind bind;
-        bind.heap = mapping.pages[page].memory;
-        bind.rangeOffset = uint32_t(mapping.pages[page].offset / pageSize);
+        bind.heap = pageMapping.memory;
+        bind.rangeOffset = uint32_t(pageMapping.offset / pageSize);
 
         // do simple coalescing. If the previous bind was in the same heap, one tile back, make it
         // cover this tile
@@ -672,12 +674,25 @@ bool D3D12ResourceManager::Serialise_InitialState(SerialiserType &ser, ResourceI
 
     if(ser.VersionAtLeast(0xB))
     {
-      Sparse::PageTable *sparseTable = initial ? initial->sparseTable : NULL;
+      // older captures stored every page of partially mapped ranges
+      if(ser.VersionLess(0xF))
+      {
+        Sparse::LegacyPageTable *sparseTable = NULL;
+
+        SERIALISE_ELEMENT_OPT(sparseTable);
+
+        if(sparseTable)
+          sparseBinds = new SparseBinds(sparseTable->table);
+      }
+      else
+      {
+        Sparse::PageTable *sparseTable = initial ? initial->sparseTable : NULL;
 
-      SERIALISE_ELEMENT_OPT(sparseTable);
+        SERIALISE_ELEMENT_OPT(sparseTable);
 
-      if(sparseTable)
-        sparseBinds = new SparseBinds(*sparseTable);
+        if(sparseTable)
+          sparseBinds = new SparseBinds(*sparseTable);
+      }
     }
 
     if(ser.IsWriting())
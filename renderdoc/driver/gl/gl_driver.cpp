@@ -2465,6 +2465,7 @@ bool WrappedOpenGL::EndFrameCapture(DeviceOwnedWindow devWnd)
       GLResourceRecord *record = *it;
 
       record->FreeShadowStorage();
+      WriteWatch::MarkAllDirty(record->Map.writeWatch);
     }
 
     // if we changed contexts above, pop back to where we were
@@ -2528,6 +2529,7 @@ bool WrappedOpenGL::EndFrameCapture(DeviceOwnedWindow devWnd)
       GLResourceRecord *record = *it;
 
       record->FreeShadowStorage();
+      WriteWatch::MarkAllDirty(record->Map.writeWatch);
     }
 
     // if it's a capture triggered from application code, immediately
@@ -2609,6 +2611,7 @@ bool WrappedOpenGL::DiscardFrameCapture(DeviceOwnedWindow devWnd)
     GLResourceRecord *record = *it;
 
     record->FreeShadowStorage();
+    WriteWatch::MarkAllDirty(record->Map.writeWatch);
   }
 
   m_CapturedFrames.pop_back();
@@ -244,6 +244,8 @@ struct GLResourceRecord : public ResourceRecord
     bool orphaned;
     bool persistent;
     byte *ptr;
+    // for coherent persistent maps, tracks written pages so only those need to be flushed
+    WriteWatch::Region *writeWatch;
   } Map;
 
   void VerifyDataType(GLenum target)
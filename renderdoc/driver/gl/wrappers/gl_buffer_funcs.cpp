@@ -25,9 +25,16 @@
 
 #include "../gl_driver.h"
 #include "common/common.h"
+#include "core/settings.h"
 #include "strings/string_utils.h"
 #include "tinyfiledialogs/tinyfiledialogs.h"
 
+RDOC_CONFIG(bool, OpenGL_PageTrackCoherentMaps, false,
+            "Track writes to persistent coherent maps by write-protecting their pages, instead of "
+            "comparing the whole map against a shadow copy at each barrier. Only supported on "
+            "Linux. Applications that pass mapped pointers directly to system calls may see them "
+            "fail.");
+
 enum GLbufferbitfield
 {
   DYNAMIC_STORAGE_BIT = 0x0100,
@@ -2326,6 +2333,10 @@ void WrappedOpenGL::glInvalidateBufferSubData(GLuint buffer, GLintptr offset, GL
  * Coherent persistent maps have their shadow storage freed at the end of every frame capture, to
  * ensure it does not hang around and pollute captures after that with stale data.
  *
+ * Optionally (OpenGL_PageTrackCoherentMaps) coherent persistent maps can instead have their pages
+ * write-protected, so that PersistentMapMemoryBarrier() knows exactly which pages were written and
+ * never needs shadow storage or a comparison over the whole map.
+ *
  ************************************************************************/
 
 void *WrappedOpenGL::glMapNamedBufferRangeEXT(GLuint buffer, GLintptr offset, GLsizeiptr length,
@@ -2433,6 +2444,16 @@ void *WrappedOpenGL::glMapNamedBufferRangeEXT(GLuint buffer, GLintptr offset, GL
       record->Map.ptr = (byte *)GL.glMapNamedBufferRangeEXT(buffer, offset, length, access);
       record->Map.status = GLResourceRecord::Mapped_Direct;
 
+      if(record->Map.ptr && persistent && (access & GL_MAP_WRITE_BIT) &&
+         (access & GL_MAP_COHERENT_BIT) && OpenGL_PageTrackCoherentMaps() &&
+         WriteWatch::IsSupported())
+      {
+        record->Map.writeWatch = WriteWatch::Watch(record->Map.ptr, (size_t)length);
+
+        // the whole map is written the first time, as it would be with no shadow storage
+        WriteWatch::MarkAllDirty(record->Map.writeWatch);
+      }
+
       return record->Map.ptr;
     }
 
@@ -2712,6 +2733,9 @@ GLboolean WrappedOpenGL::glUnmapNamedBufferEXT(GLuint buffer)
 
     GLboolean ret = GL_TRUE;
 
+    WriteWatch::Unwatch(record->Map.writeWatch);
+    record->Map.writeWatch = NULL;
+
     switch(status)
     {
       case GLResourceRecord::Unmapped:
@@ -3063,7 +3087,21 @@ void WrappedOpenGL::PersistentMapMemoryBarrier(const std::set<GLResourceRecord *
 
     RDCASSERT(record && record->Map.ptr);
 
-    if(record->Map.ptr)
+    if(record->Map.ptr && record->Map.writeWatch)
+    {
+      // only pages written since the last barrier need flushing. Pages are re-protected before
+      // being serialised so any later write is seen next time.
+      rdcarray<rdcpair<size_t, size_t>> dirtyRanges;
+      WriteWatch::GetAndResetDirty(record->Map.writeWatch, dirtyRanges);
+
+      for(const rdcpair<size_t, size_t> &dirty : dirtyRanges)
+      {
+        gl_CurChunk = GLChunk::CoherentMapWrite;
+        glFlushMappedNamedBufferRangeEXT(record->Resource.name, GLintptr(dirty.first),
+                                         GLsizeiptr(dirty.second));
+      }
+    }
+    else if(record->Map.ptr)
     {
       size_t diffStart = 0, diffEnd = record->Map.length;
       bool found = true;
@@ -5154,6 +5192,9 @@ void WrappedOpenGL::glDeleteBuffers(GLsizei n, const GLuint *buffers)
           m_PersistentMaps.erase(record);
           if(record->Map.access & GL_MAP_COHERENT_BIT)
             m_CoherentMaps.erase(record);
+
+          WriteWatch::Unwatch(record->Map.writeWatch);
+          record->Map.writeWatch = NULL;
         }
 
         // free any shadow storage
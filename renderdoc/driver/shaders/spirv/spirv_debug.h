@@ -356,6 +356,9 @@ class Debugger : public Processor, public ShaderDebugger
 public:
   Debugger();
   ~Debugger();
+  // copies a parsed debugger that hasn't begun debugging, to debug several invocations without
+  // parsing again. The copy refers to debug info owned by the original, so must be freed first.
+  Debugger(const Debugger &o) = default;
   virtual void Parse(const rdcarray<uint32_t> &spirvWords);
   ShaderDebugTrace *BeginDebug(DebugAPIWrapper *apiWrapper, const ShaderStage stage,
                                const rdcstr &entryPoint, const rdcarray<SpecConstant> &specInfo,
@@ -0,0 +1,541 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2022 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include <algorithm>
+#include "core/settings.h"
+#include "vk_core.h"
+
+RDOC_CONFIG(bool, Vulkan_ReplayCheckpoints, false,
+            "Snapshot device memory at queue submission boundaries during replay, so that later "
+            "replays can skip re-executing the submissions before the snapshot.");
+RDOC_CONFIG(uint32_t, Vulkan_ReplayCheckpointBudgetMB, 1024,
+            "The maximum amount of GPU memory in megabytes used for replay checkpoints. The "
+            "least recently used checkpoints are evicted when the budget is exceeded.");
+RDOC_CONFIG(uint32_t, Vulkan_ReplayCheckpointInterval, 500,
+            "The minimum number of events between replay checkpoints. A new checkpoint is only "
+            "taken if it would skip at least this many events beyond the nearest existing one.");
+
+// Replay checkpoints work by 'fast-forwarding' rather than by seeking in the capture. Every chunk is
+// still processed so that descriptor set updates, memory map writes and command buffer recording
+// state are exactly as they would be normally, but queue submissions which end before the
+// checkpoint are not re-recorded or submitted. Once the replay passes the checkpoint the snapshot
+// of all memory contents, image contents and image layouts is restored, which overwrites anything
+// written by the CPU-side chunks before it, and the replay continues normally.
+//
+// Memory is snapshotted raw through its whole-memory buffer, which is only meaningful for buffers
+// and linear images. Every image with memory bound is also copied to an image of its own, and
+// those are restored after the memory so that images with an opaque layout get well-defined
+// contents back. Images that can't be copied that way mean no checkpoint is taken.
+
+// one region per mip, covering every layer and aspect
+static void GetCheckpointImageRegions(const ImageInfo &info, rdcarray<VkImageCopy> &regions)
+{
+  regions.clear();
+
+  for(uint32_t m = 0; m < info.levelCount; m++)
+  {
+    VkImageSubresourceLayers sub = {info.aspects, m, 0, info.layerCount};
+    VkExtent3D extent = {
+        RDCMAX(1U, info.extent.width >> m), RDCMAX(1U, info.extent.height >> m),
+        RDCMAX(1U, info.extent.depth >> m),
+    };
+
+    regions.push_back({sub, {0, 0, 0}, sub, {0, 0, 0}, extent});
+  }
+}
+
+bool WrappedVulkan::ReplayCheckpointsEnabled()
+{
+  // checkpoints can't be used when callbacks need to see every event, or when the replay is
+  // modified in other ways. Sparse resources get their memory from page bindings which aren't
+  // snapshotted, so those captures can't use them either.
+  return Vulkan_ReplayCheckpoints() && m_ActionCallback == NULL && m_SubmitChain == NULL &&
+         !m_SubmitBoundaryEvents.empty() && !APIProps.SparseResources;
+}
+
+void WrappedVulkan::PrepareReplayCheckpoint(uint32_t lastEventID)
+{
+  m_RestoreCheckpoint = NULL;
+  m_CheckpointSkipEventID = 0;
+  m_CheckpointCreateEventID = 0;
+
+  if(!ReplayCheckpointsEnabled())
+    return;
+
+  // find the latest checkpoint at or before the last event we're replaying
+  for(ReplayCheckpoint *checkpoint : m_ReplayCheckpoints)
+  {
+    if(checkpoint->eventId <= lastEventID)
+      m_RestoreCheckpoint = checkpoint;
+  }
+
+  uint32_t startEventID = 0;
+
+  if(m_RestoreCheckpoint)
+  {
+    m_RestoreCheckpoint->lastUse = ++m_ReplayCheckpointUse;
+    m_CheckpointSkipEventID = startEventID = m_RestoreCheckpoint->eventId;
+  }
+
+  // find the latest submission boundary we'll replay past, and take a checkpoint there if it's far
+  // enough past where we're starting from
+  auto it = std::upper_bound(m_SubmitBoundaryEvents.begin(), m_SubmitBoundaryEvents.end(),
+                             lastEventID);
+  if(it == m_SubmitBoundaryEvents.begin())
+    return;
+
+  --it;
+
+  if(*it >= startEventID + RDCMAX(1U, Vulkan_ReplayCheckpointInterval()))
+    m_CheckpointCreateEventID = *it;
+}
+
+void WrappedVulkan::CreateReplayCheckpoint(uint32_t eventId)
+{
+  VkDevice dev = GetDev();
+
+  const VkDeviceSize budget = VkDeviceSize(Vulkan_ReplayCheckpointBudgetMB()) * 1024 * 1024;
+
+  ReplayCheckpoint *checkpoint = new ReplayCheckpoint;
+  checkpoint->eventId = eventId;
+
+  for(auto it = m_CreationInfo.m_Memory.begin(); it != m_CreationInfo.m_Memory.end(); ++it)
+  {
+    // memory without a whole-memory buffer can only have images bound, which are copied below
+    if(it->second.wholeMemBuf == VK_NULL_HANDLE || it->second.wholeMemBufSize == 0)
+      continue;
+
+    checkpoint->size = AlignUp(checkpoint->size, (VkDeviceSize)256);
+    checkpoint->memory.push_back({it->first, checkpoint->size, it->second.wholeMemBufSize});
+    checkpoint->size += it->second.wholeMemBufSize;
+  }
+
+  uint32_t imageMemoryTypes = ~0U;
+
+  for(auto it = m_ImageStates.begin(); it != m_ImageStates.end(); ++it)
+  {
+    LockedConstImageStateRef state = it->second.LockRead();
+
+    if(!state->isMemoryBound)
+      continue;
+
+    const ImageInfo &info = state->GetImageInfo();
+
+    // the planes of multi-planar images would each need their own copies
+    if(GetYUVPlaneCount(info.format) > 1)
+    {
+      RDCDEBUG("Not taking replay checkpoint at %u, multi-planar image %s can't be copied",
+               eventId, ToStr(it->first).c_str());
+      FreeReplayCheckpoint(checkpoint);
+      return;
+    }
+
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
+    // multisampled images need an attachment usage to be allowed more than one sample
+    if(info.sampleCount > 1)
+      usage |= IsDepthOrStencilFormat(info.format) ? VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT
+                                                   : VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+    VkImageCreateInfo imInfo = {
+        VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        NULL,
+        0,
+        info.imageType,
+        info.format,
+        info.extent,
+        info.levelCount,
+        info.layerCount,
+        (VkSampleCountFlagBits)info.sampleCount,
+        VK_IMAGE_TILING_OPTIMAL,
+        usage,
+        VK_SHARING_MODE_EXCLUSIVE,
+        0,
+        NULL,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+
+    ReplayCheckpoint::ImageCopy copy;
+    copy.image = it->first;
+
+    VkResult vkr = ObjDisp(dev)->CreateImage(Unwrap(dev), &imInfo, NULL, &copy.copy);
+
+    if(vkr != VK_SUCCESS)
+    {
+      RDCWARN("Couldn't create replay checkpoint copy of %s: %s", ToStr(it->first).c_str(),
+              ToStr(vkr).c_str());
+      FreeReplayCheckpoint(checkpoint);
+      return;
+    }
+
+    VkMemoryRequirements mrq = {};
+    ObjDisp(dev)->GetImageMemoryRequirements(Unwrap(dev), copy.copy, &mrq);
+
+    copy.offset = AlignUp(checkpoint->imageSize, mrq.alignment);
+    checkpoint->imageSize = copy.offset + mrq.size;
+    imageMemoryTypes &= mrq.memoryTypeBits;
+
+    checkpoint->images.push_back(copy);
+  }
+
+  const VkDeviceSize totalSize = checkpoint->size + checkpoint->imageSize;
+
+  if(checkpoint->memory.empty() || totalSize > budget || imageMemoryTypes == 0)
+  {
+    RDCDEBUG("Not taking replay checkpoint at %u, size %llu is over budget %llu", eventId,
+             totalSize, budget);
+    FreeReplayCheckpoint(checkpoint);
+    return;
+  }
+
+  // evict least recently used checkpoints until this one fits
+  while(m_ReplayCheckpointTotalSize + totalSize > budget && !m_ReplayCheckpoints.empty())
+  {
+    ReplayCheckpoint *lru = m_ReplayCheckpoints[0];
+    for(ReplayCheckpoint *c : m_ReplayCheckpoints)
+      if(c->lastUse < lru->lastUse)
+        lru = c;
+
+    // never evict the checkpoint this replay is using
+    if(lru == m_RestoreCheckpoint)
+      break;
+
+    RDCLOG("Evicted replay checkpoint at %u: %llu bytes, to stay within budget of %llu bytes",
+           lru->eventId, lru->size + lru->imageSize, budget);
+
+    m_ReplayCheckpoints.removeOne(lru);
+    m_ReplayCheckpointTotalSize -= lru->size + lru->imageSize;
+    FreeReplayCheckpoint(lru);
+  }
+
+  if(m_ReplayCheckpointTotalSize + totalSize > budget)
+  {
+    FreeReplayCheckpoint(checkpoint);
+    return;
+  }
+
+  VkBufferCreateInfo bufInfo = {
+      VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+      NULL,
+      0,
+      checkpoint->size,
+      VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+  };
+
+  VkResult vkr = ObjDisp(dev)->CreateBuffer(Unwrap(dev), &bufInfo, NULL, &checkpoint->buf);
+
+  if(vkr != VK_SUCCESS)
+  {
+    RDCWARN("Couldn't create replay checkpoint buffer: %s", ToStr(vkr).c_str());
+    FreeReplayCheckpoint(checkpoint);
+    return;
+  }
+
+  VkMemoryRequirements mrq = {};
+  ObjDisp(dev)->GetBufferMemoryRequirements(Unwrap(dev), checkpoint->buf, &mrq);
+
+  VkMemoryAllocateInfo allocInfo = {
+      VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+      NULL,
+      mrq.size,
+      GetGPULocalMemoryIndex(mrq.memoryTypeBits),
+  };
+
+  vkr = ObjDisp(dev)->AllocateMemory(Unwrap(dev), &allocInfo, NULL, &checkpoint->mem);
+
+  if(vkr == VK_SUCCESS && !checkpoint->images.empty())
+  {
+    allocInfo.allocationSize = checkpoint->imageSize;
+    allocInfo.memoryTypeIndex = GetGPULocalMemoryIndex(imageMemoryTypes);
+
+    vkr = ObjDisp(dev)->AllocateMemory(Unwrap(dev), &allocInfo, NULL, &checkpoint->imageMem);
+  }
+
+  if(vkr != VK_SUCCESS)
+  {
+    // running out of memory here isn't fatal, we just don't get a checkpoint
+    RDCWARN("Couldn't allocate %llu bytes for replay checkpoint: %s", totalSize,
+            ToStr(vkr).c_str());
+    FreeReplayCheckpoint(checkpoint);
+    return;
+  }
+
+  vkr = ObjDisp(dev)->BindBufferMemory(Unwrap(dev), checkpoint->buf, checkpoint->mem, 0);
+  CheckVkResult(vkr);
+
+  for(const ReplayCheckpoint::ImageCopy &copy : checkpoint->images)
+  {
+    vkr = ObjDisp(dev)->BindImageMemory(Unwrap(dev), copy.copy, checkpoint->imageMem, copy.offset);
+    CheckVkResult(vkr);
+  }
+
+  VkCommandBuffer cmd = GetNextCmd();
+
+  if(cmd == VK_NULL_HANDLE)
+  {
+    FreeReplayCheckpoint(checkpoint);
+    return;
+  }
+
+  // the submission we're checkpointing may have gone to any queue, so idle the whole device
+  ObjDisp(dev)->DeviceWaitIdle(Unwrap(dev));
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+  CheckVkResult(vkr);
+
+  VkMarkerRegion::Begin(StringFormat::Fmt("Replay checkpoint at %u", eventId), cmd);
+
+  VkMemoryBarrier memBarrier = {
+      VK_STRUCTURE_TYPE_MEMORY_BARRIER, NULL, VK_ACCESS_ALL_WRITE_BITS, VK_ACCESS_TRANSFER_READ_BIT,
+  };
+
+  DoPipelineBarrier(cmd, 1, &memBarrier);
+
+  for(const ReplayCheckpoint::MemoryRange &range : checkpoint->memory)
+  {
+    VkBufferCopy region = {0, range.offset, range.size};
+    ObjDisp(cmd)->CmdCopyBuffer(Unwrap(cmd), Unwrap(m_CreationInfo.m_Memory[range.mem].wholeMemBuf),
+                                checkpoint->buf, 1, &region);
+  }
+
+  // copy every image while it's temporarily in the transfer source layout, into copies that stay
+  // in that layout afterwards ready to be restored from
+  ImageBarrierSequence setupBarriers, cleanupBarriers;
+  rdcarray<VkImageMemoryBarrier> copyBarriers;
+
+  for(const ReplayCheckpoint::ImageCopy &copy : checkpoint->images)
+  {
+    LockedImageStateRef state = FindImageState(copy.image);
+
+    state->TempTransition(m_QueueFamilyIdx, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                          VK_ACCESS_TRANSFER_READ_BIT, setupBarriers, cleanupBarriers,
+                          GetImageTransitionInfo());
+
+    copyBarriers.push_back({
+        VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        NULL,
+        0,
+        VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        copy.copy,
+        {state->GetImageInfo().aspects, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS},
+    });
+  }
+
+  InlineSetupImageBarriers(cmd, setupBarriers);
+  SubmitAndFlushImageStateBarriers(setupBarriers);
+  DoPipelineBarrier(cmd, copyBarriers.size(), copyBarriers.data());
+
+  rdcarray<VkImageCopy> regions;
+
+  for(const ReplayCheckpoint::ImageCopy &copy : checkpoint->images)
+  {
+    LockedImageStateRef state = FindImageState(copy.image);
+
+    GetCheckpointImageRegions(state->GetImageInfo(), regions);
+    ObjDisp(cmd)->CmdCopyImage(Unwrap(cmd), Unwrap(state->wrappedHandle),
+                               VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, copy.copy,
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)regions.size(),
+                               regions.data());
+  }
+
+  for(VkImageMemoryBarrier &barrier : copyBarriers)
+  {
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+  }
+
+  DoPipelineBarrier(cmd, copyBarriers.size(), copyBarriers.data());
+  InlineCleanupImageBarriers(cmd, cleanupBarriers);
+
+  VkMarkerRegion::End(cmd);
+
+  vkr = ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
+  CheckVkResult(vkr);
+
+  SubmitCmds();
+  FlushQ();
+
+  SubmitAndFlushImageStateBarriers(cleanupBarriers);
+
+  for(auto it = m_ImageStates.begin(); it != m_ImageStates.end(); ++it)
+    checkpoint->imageStates[it->first] = *it->second.LockRead();
+
+  checkpoint->lastUse = ++m_ReplayCheckpointUse;
+  m_ReplayCheckpointTotalSize += totalSize;
+
+  m_ReplayCheckpoints.push_back(checkpoint);
+  std::sort(m_ReplayCheckpoints.begin(), m_ReplayCheckpoints.end(),
+            [](const ReplayCheckpoint *a, const ReplayCheckpoint *b) {
+              return a->eventId < b->eventId;
+            });
+
+  RDCLOG("Took replay checkpoint at %u: %llu bytes of memory, %zu images", eventId, totalSize,
+         checkpoint->images.size());
+}
+
+void WrappedVulkan::RestoreReplayCheckpoint(ReplayCheckpoint *checkpoint)
+{
+  VkDevice dev = GetDev();
+
+  ObjDisp(dev)->DeviceWaitIdle(Unwrap(dev));
+
+  // transition images to their layouts at the checkpoint first. The memory contents were copied
+  // while the images were in those layouts, so we copy them back over the top afterwards.
+  ImageBarrierSequence barriers;
+
+  for(auto it = checkpoint->imageStates.begin(); it != checkpoint->imageStates.end(); ++it)
+  {
+    LockedImageStateRef state = FindImageState(it->first);
+    if(!state)
+      continue;
+
+    state->Transition(it->second, VK_ACCESS_ALL_WRITE_BITS, VK_ACCESS_ALL_READ_BITS, barriers,
+                      GetImageTransitionInfo());
+    *state = it->second;
+  }
+
+  SubmitAndFlushImageStateBarriers(barriers);
+
+  VkCommandBuffer cmd = GetNextCmd();
+
+  if(cmd == VK_NULL_HANDLE)
+    return;
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  VkResult vkr = ObjDisp(cmd)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+  CheckVkResult(vkr);
+
+  VkMarkerRegion::Begin(StringFormat::Fmt("Restore replay checkpoint at %u", checkpoint->eventId),
+                        cmd);
+
+  VkMemoryBarrier memBarrier = {
+      VK_STRUCTURE_TYPE_MEMORY_BARRIER, NULL, VK_ACCESS_ALL_WRITE_BITS, VK_ACCESS_ALL_WRITE_BITS,
+  };
+
+  DoPipelineBarrier(cmd, 1, &memBarrier);
+
+  for(const ReplayCheckpoint::MemoryRange &range : checkpoint->memory)
+  {
+    auto it = m_CreationInfo.m_Memory.find(range.mem);
+    if(it == m_CreationInfo.m_Memory.end() || it->second.wholeMemBuf == VK_NULL_HANDLE)
+      continue;
+
+    VkBufferCopy region = {range.offset, 0, RDCMIN(range.size, it->second.wholeMemBufSize)};
+    ObjDisp(cmd)->CmdCopyBuffer(Unwrap(cmd), checkpoint->buf, Unwrap(it->second.wholeMemBuf), 1,
+                                &region);
+  }
+
+  DoPipelineBarrier(cmd, 1, &memBarrier);
+
+  // writing the memory leaves any image with an opaque layout in it undefined, so the images are
+  // copied back afterwards
+  ImageBarrierSequence setupBarriers, cleanupBarriers;
+
+  for(const ReplayCheckpoint::ImageCopy &copy : checkpoint->images)
+  {
+    LockedImageStateRef state = FindImageState(copy.image);
+    if(!state)
+      continue;
+
+    state->TempTransition(m_QueueFamilyIdx, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                          VK_ACCESS_TRANSFER_WRITE_BIT, setupBarriers, cleanupBarriers,
+                          GetImageTransitionInfo());
+  }
+
+  InlineSetupImageBarriers(cmd, setupBarriers);
+  SubmitAndFlushImageStateBarriers(setupBarriers);
+
+  rdcarray<VkImageCopy> regions;
+
+  for(const ReplayCheckpoint::ImageCopy &copy : checkpoint->images)
+  {
+    LockedImageStateRef state = FindImageState(copy.image);
+    if(!state)
+      continue;
+
+    GetCheckpointImageRegions(state->GetImageInfo(), regions);
+    ObjDisp(cmd)->CmdCopyImage(Unwrap(cmd), copy.copy, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                               Unwrap(state->wrappedHandle), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               (uint32_t)regions.size(), regions.data());
+  }
+
+  InlineCleanupImageBarriers(cmd, cleanupBarriers);
+
+  memBarrier.dstAccessMask = VK_ACCESS_ALL_READ_BITS;
+  DoPipelineBarrier(cmd, 1, &memBarrier);
+
+  VkMarkerRegion::End(cmd);
+
+  vkr = ObjDisp(cmd)->EndCommandBuffer(Unwrap(cmd));
+  CheckVkResult(vkr);
+
+  SubmitCmds();
+  FlushQ();
+
+  SubmitAndFlushImageStateBarriers(cleanupBarriers);
+}
+
+void WrappedVulkan::FreeReplayCheckpoint(ReplayCheckpoint *checkpoint)
+{
+  VkDevice dev = GetDev();
+
+  for(const ReplayCheckpoint::ImageCopy &copy : checkpoint->images)
+    ObjDisp(dev)->DestroyImage(Unwrap(dev), copy.copy, NULL);
+  if(checkpoint->imageMem != VK_NULL_HANDLE)
+    ObjDisp(dev)->FreeMemory(Unwrap(dev), checkpoint->imageMem, NULL);
+
+  if(checkpoint->buf != VK_NULL_HANDLE)
+    ObjDisp(dev)->DestroyBuffer(Unwrap(dev), checkpoint->buf, NULL);
+  if(checkpoint->mem != VK_NULL_HANDLE)
+    ObjDisp(dev)->FreeMemory(Unwrap(dev), checkpoint->mem, NULL);
+
+  delete checkpoint;
+}
+
+void WrappedVulkan::ClearReplayCheckpoints()
+{
+  if(m_ReplayCheckpoints.empty())
+    return;
+
+  VkDevice dev = GetDev();
+  ObjDisp(dev)->DeviceWaitIdle(Unwrap(dev));
+
+  for(ReplayCheckpoint *checkpoint : m_ReplayCheckpoints)
+    FreeReplayCheckpoint(checkpoint);
+
+  m_ReplayCheckpoints.clear();
+  m_RestoreCheckpoint = NULL;
+  m_ReplayCheckpointTotalSize = 0;
+}
@@ -356,6 +356,10 @@ bool VkInitParams::IsSupportedVersion(uint64_t ver)
   if(ver == CurrentVersion)
     return true;
 
+  // 0x15 -> 0x16 - sparse page tables serialised as runs of pages
+  if(ver == 0x15)
+    return true;
+
   // 0x14 -> 0x15 - added support for mutable descriptors
   if(ver == 0x14)
     return true;
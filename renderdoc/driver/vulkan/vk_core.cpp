@@ -25,6 +25,7 @@
 #include "vk_core.h"
 #include <ctype.h>
 #include <algorithm>
+#include "common/profiler.h"
 #include "core/settings.h"
 #include "driver/ihv/amd/amd_rgp.h"
 #include "driver/shaders/spirv/spirv_compile.h"
@@ -39,6 +40,15 @@
 
 RDOC_EXTERN_CONFIG(bool, Vulkan_Debug_VerboseCommandRecording);
 
+RDOC_CONFIG(bool, Vulkan_Debug_SerialCaptureLoad, false,
+            "Parse shaders on the loading thread instead of on worker threads while loading a "
+            "capture.");
+
+RDOC_CONFIG(bool, Vulkan_SkipNoOpReplayChunks, true,
+            "Skip past recorded commands that would be no-ops when replaying a command buffer that "
+            "isn't being re-recorded. Disable to replay every chunk when diagnosing replay "
+            "issues.");
+
 uint64_t VkInitParams::GetSerialiseSize()
 {
   // misc bytes and fixed integer members
@@ -165,6 +175,8 @@ WrappedVulkan::WrappedVulkan()
     m_FrameCaptureRecord = NULL;
 
     ResourceIDGen::SetReplayResourceIDs();
+
+    m_CreationInfo.m_ReflectionCache = new VulkanReflectionCache;
   }
 }
 
@@ -183,6 +195,10 @@ WrappedVulkan::~WrappedVulkan()
 
   SAFE_DELETE(m_StoredStructuredData);
 
+  // nothing can be reflecting in the background while the cache is destroyed
+  m_CreationInfo.WaitForShaderPrefetch();
+  SAFE_DELETE(m_CreationInfo.m_ReflectionCache);
+
   // in case the application leaked some objects, avoid crashing trying
   // to release them ourselves by clearing the resource manager.
   // In a well-behaved application, this should be a no-op.
@@ -1833,6 +1849,8 @@ void WrappedVulkan::StartFrameCapture(DeviceOwnedWindow devWnd)
   if(!IsBackgroundCapturing(m_State))
     return;
 
+  RDCPROFILE_ZONE("Vulkan StartFrameCapture");
+
   RDCLOG("Starting capture");
 
   if(m_Queue == VK_NULL_HANDLE && m_QueueFamilyIdx != ~0U)
@@ -1863,11 +1881,17 @@ void WrappedVulkan::StartFrameCapture(DeviceOwnedWindow devWnd)
   GetResourceManager()->ClearReferencedResources();
   GetResourceManager()->ClearReferencedMemory();
 
+  {
+    SCOPED_LOCK(m_CachedBindRefsLock);
+    m_CachedBindRefs.clear();
+    GetResourceManager()->ClearReleasedDescriptorResources();
+  }
+
   // need to do all this atomically so that no other commands
   // will check to see if they need to markdirty or markpendingdirty
   // and go into the frame record.
   {
-    SCOPED_WRITELOCK(m_CapTransitionLock);
+    SCOPED_EPOCH_WRITELOCK(m_CapTransitionLock);
 
     // wait for all work to finish and apply a memory barrier to ensure all memory is visible
     for(size_t i = 0; i < m_QueueFamilies.size(); i++)
@@ -1900,11 +1924,9 @@ void WrappedVulkan::StartFrameCapture(DeviceOwnedWindow devWnd)
       CheckVkResult(vkr);
     }
 
+    BeginInitialStateBatching();
     GetResourceManager()->PrepareInitialContents();
-    SubmitAndFlushImageStateBarriers(m_setupImageBarriers);
-    SubmitCmds();
-    FlushQ();
-    SubmitAndFlushImageStateBarriers(m_cleanupImageBarriers);
+    EndInitialStateBatching();
 
     {
       SCOPED_LOCK(m_CapDescriptorsLock);
@@ -1949,6 +1971,8 @@ bool WrappedVulkan::EndFrameCapture(DeviceOwnedWindow devWnd)
   if(!IsActiveCapturing(m_State))
     return true;
 
+  RDCPROFILE_ZONE("Vulkan EndFrameCapture");
+
   VkSwapchainKHR swap = VK_NULL_HANDLE;
 
   if(devWnd.windowHandle)
@@ -2037,7 +2061,7 @@ bool WrappedVulkan::EndFrameCapture(DeviceOwnedWindow devWnd)
 
   // transition back to IDLE atomically
   {
-    SCOPED_WRITELOCK(m_CapTransitionLock);
+    SCOPED_EPOCH_WRITELOCK(m_CapTransitionLock);
     EndCaptureFrame(backbuffer);
 
     m_State = CaptureState::BackgroundCapturing;
@@ -2053,6 +2077,7 @@ bool WrappedVulkan::EndFrameCapture(DeviceOwnedWindow devWnd)
         FreeAlignedBuffer((*it)->memMapState->refData);
         (*it)->memMapState->refData = NULL;
         (*it)->memMapState->needRefData = false;
+        WriteWatch::MarkAllDirty((*it)->memMapState->writeWatch);
       }
     }
 
@@ -2397,6 +2422,12 @@ bool WrappedVulkan::EndFrameCapture(DeviceOwnedWindow devWnd)
 
   GetResourceManager()->ClearReferencedResources();
 
+  {
+    SCOPED_LOCK(m_CachedBindRefsLock);
+    m_CachedBindRefs.clear();
+    GetResourceManager()->ClearReleasedDescriptorResources();
+  }
+
   GetResourceManager()->FreeInitialContents();
 
   FreeAllMemory(MemoryScope::InitialContents);
@@ -2417,7 +2448,7 @@ bool WrappedVulkan::DiscardFrameCapture(DeviceOwnedWindow devWnd)
 
   // transition back to IDLE atomically
   {
-    SCOPED_WRITELOCK(m_CapTransitionLock);
+    SCOPED_EPOCH_WRITELOCK(m_CapTransitionLock);
 
     m_State = CaptureState::BackgroundCapturing;
 
@@ -2432,6 +2463,7 @@ bool WrappedVulkan::DiscardFrameCapture(DeviceOwnedWindow devWnd)
         FreeAlignedBuffer((*it)->memMapState->refData);
         (*it)->memMapState->refData = NULL;
         (*it)->memMapState->needRefData = false;
+        WriteWatch::MarkAllDirty((*it)->memMapState->writeWatch);
       }
     }
   }
@@ -2451,6 +2483,12 @@ bool WrappedVulkan::DiscardFrameCapture(DeviceOwnedWindow devWnd)
 
   GetResourceManager()->ClearReferencedResources();
 
+  {
+    SCOPED_LOCK(m_CachedBindRefsLock);
+    m_CachedBindRefs.clear();
+    GetResourceManager()->ClearReleasedDescriptorResources();
+  }
+
   GetResourceManager()->FreeInitialContents();
 
   FreeAllMemory(MemoryScope::InitialContents);
@@ -2561,6 +2599,17 @@ void WrappedVulkan::DerivedResource(ResourceId parentLive, ResourceId child)
   GetReplay()->GetResourceDesc(child).parentResources.push_back(parentId);
 }
 
+void WrappedVulkan::FinishLoadJobs()
+{
+  if(!m_CreationInfo.m_LoadJobs)
+    return;
+
+  RDCPROFILE_ZONE("Finish load jobs");
+
+  m_CreationInfo.m_LoadJobs->WaitAll();
+  SAFE_DELETE(m_CreationInfo.m_LoadJobs);
+}
+
 void WrappedVulkan::AddResourceCurChunk(ResourceDescription &descr)
 {
   descr.initialisationChunks.push_back((uint32_t)m_StructuredFile->chunks.size() - 1);
@@ -2573,6 +2622,8 @@ void WrappedVulkan::AddResourceCurChunk(ResourceId id)
 
 RDResult WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStructuredBuffers)
 {
+  RDCPROFILE_ZONE("Vulkan ReadLogInitialisation");
+
   int sectionIdx = rdc->SectionIndex(SectionType::FrameCapture);
 
   GetResourceManager()->SetState(m_State);
@@ -2606,6 +2657,9 @@ RDResult WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStructured
   ser.SetStringDatabase(&m_StringDB);
   ser.SetUserData(GetResourceManager());
 
+  // nothing deserialised is kept past the end of its chunk, so temporaries come from an arena
+  ser.SetScratchArenaEnabled(true);
+
   ser.ConfigureStructuredExport(&GetChunkName, storeStructuredBuffers, m_TimeBase, m_TimeFrequency);
 
   m_StructuredFile = &ser.GetStructuredFile();
@@ -2634,6 +2688,14 @@ RDResult WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStructured
   if(m_ReplayOptions.apiValidation)
     sink = new ScopedDebugMessageSink(this);
 
+  // shaders are parsed and reflected on worker threads while the rest of the chunks are processed,
+  // they must all be finished before the frame is replayed or we return.
+  // Pipelines are still created on this thread. Deferring them would need a deep copy of each
+  // create info, since deserialised data only lives as long as its chunk. It would also need a
+  // wrapper created before the real handle exists, for later chunks that refer to the pipeline.
+  if(!IsStructuredExporting(m_State) && !Vulkan_Debug_SerialCaptureLoad())
+    m_CreationInfo.m_LoadJobs = new Threading::JobPool();
+
   for(;;)
   {
     PerformanceTimer timer;
@@ -2646,6 +2708,7 @@ RDResult WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStructured
 
     if(reader->IsErrored())
     {
+      FinishLoadJobs();
       SAFE_DELETE(sink);
       return RDResult(ResultCode::APIDataCorrupted, ser.GetError().message);
     }
@@ -2654,12 +2717,15 @@ RDResult WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStructured
     if(sink)
       firstMessage = sink->msgs.size();
 
+    ProfileZone chunkZone(Profiler::IsRecording() ? Profiler::Intern(ToStr(context)) : "Chunk");
+
     bool success = ProcessChunk(ser, context);
 
     ser.EndChunk();
 
     if(reader->IsErrored())
     {
+      FinishLoadJobs();
       SAFE_DELETE(sink);
       return RDResult(ResultCode::APIDataCorrupted, ser.GetError().message);
     }
@@ -2686,6 +2752,7 @@ RDResult WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStructured
             "\n\nMore debugging information may be available by enabling API validation on replay";
       }
 
+      FinishLoadJobs();
       SAFE_DELETE(sink);
       m_FailedReplayResult.message = rdcstr(m_FailedReplayResult.message) + extra;
       return m_FailedReplayResult;
@@ -2730,8 +2797,13 @@ RDResult WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStructured
       for(auto it = m_CreationInfo.m_Memory.begin(); it != m_CreationInfo.m_Memory.end(); ++it)
         it->second.SimplifyBindings();
 
+      FinishLoadJobs();
+
       RDResult status = ContextReplayLog(m_State, 0, 0, false);
 
+      // we don't know what the loading pass wrote, so the first replay applies everything
+      m_InitialContentsDirtyEID = ~0U;
+
       if(status != ResultCode::Succeeded)
       {
         SAFE_DELETE(sink);
@@ -2747,6 +2819,8 @@ RDResult WrappedVulkan::ReadLogInitialisation(RDCFile *rdc, bool storeStructured
       break;
   }
 
+  FinishLoadJobs();
+
   SAFE_DELETE(sink);
 
 #if ENABLED(RDOC_DEVEL)
@@ -2813,6 +2887,7 @@ RDResult WrappedVulkan::ContextReplayLog(CaptureState readType, uint32_t startEv
   ser.SetStringDatabase(&m_StringDB);
   ser.SetUserData(GetResourceManager());
   ser.SetVersion(m_SectionVersion);
+  ser.SetScratchArenaEnabled(true);
 
   SDFile *prevFile = m_StructuredFile;
 
@@ -2903,8 +2978,21 @@ RDResult WrappedVulkan::ContextReplayLog(CaptureState readType, uint32_t startEv
 
   uint64_t startOffset = ser.GetReader()->GetOffset();
 
+  size_t chunkIdx = 0;
+
+  if(IsLoading(m_State))
+    m_ReplayChunks.clear();
+
   for(;;)
   {
+    // once we're past a replay checkpoint's event, restore the state it captured over anything
+    // the skipped submissions would have produced
+    if(m_RestoreCheckpoint && m_RootEventID > m_RestoreCheckpoint->eventId)
+    {
+      RestoreReplayCheckpoint(m_RestoreCheckpoint);
+      m_RestoreCheckpoint = NULL;
+    }
+
     if(IsActiveReplaying(m_State) && m_RootEventID > endEventID)
     {
       // we can just break out if we've done all the events desired.
@@ -2914,6 +3002,26 @@ RDResult WrappedVulkan::ContextReplayLog(CaptureState readType, uint32_t startEv
 
     m_CurChunkOffset = ser.GetReader()->GetOffset();
 
+    // full replays visit the same chunks in the same order as loading did, so if this chunk would
+    // be a no-op we can jump straight past it
+    if(!partial && IsActiveReplaying(m_State) && chunkIdx < m_ReplayChunks.size())
+    {
+      const ReplayChunkInfo &info = m_ReplayChunks[chunkIdx++];
+
+      if(info.offset == m_CurChunkOffset && CanSkipReplayChunk(info))
+      {
+        ser.GetReader()->SetOffset(info.endOffset);
+
+        m_LastChunk = info.type;
+        m_BakedCmdBufferInfo[info.cmd].curEventID++;
+
+        if(ser.GetReader()->AtEnd())
+          break;
+
+        continue;
+      }
+    }
+
     VulkanChunk chunktype = ser.ReadChunk<VulkanChunk>();
 
     if(ser.GetReader()->IsErrored())
@@ -2927,6 +3035,10 @@ RDResult WrappedVulkan::ContextReplayLog(CaptureState readType, uint32_t startEv
 
     ser.EndChunk();
 
+    if(IsLoading(m_State))
+      m_ReplayChunks.push_back(
+          {m_CurChunkOffset, ser.GetReader()->GetOffset(), m_LastCmdBufferID, chunktype});
+
     if(ser.GetReader()->IsErrored())
       return RDResult(ResultCode::APIDataCorrupted, ser.GetError().message);
 
@@ -2971,6 +3083,18 @@ RDResult WrappedVulkan::ContextReplayLog(CaptureState readType, uint32_t startEv
 
     m_LastChunk = chunktype;
 
+    if(m_LastCmdBufferID == ResourceId() &&
+       (chunktype == VulkanChunk::vkQueueSubmit || chunktype == VulkanChunk::vkQueueSubmit2))
+    {
+      // every event up to and including this one has been submitted, so it's a valid point to
+      // snapshot from during replay
+      if(IsLoading(m_State))
+        m_SubmitBoundaryEvents.push_back(m_RootEventID);
+      else if(IsActiveReplaying(m_State) && m_RootEventID == m_CheckpointCreateEventID &&
+              m_RestoreCheckpoint == NULL)
+        CreateReplayCheckpoint(m_RootEventID);
+    }
+
     // increment root event ID either if we didn't just replay a cmd
     // buffer event, OR if we are doing a frame sub-section replay,
     // in which case it's up to the calling code to make sure we only
@@ -2992,6 +3116,12 @@ RDResult WrappedVulkan::ContextReplayLog(CaptureState readType, uint32_t startEv
     }
   }
 
+  if(m_RestoreCheckpoint && m_RootEventID > m_RestoreCheckpoint->eventId)
+  {
+    RestoreReplayCheckpoint(m_RestoreCheckpoint);
+    m_RestoreCheckpoint = NULL;
+  }
+
   if(!partial && !IsStructuredExporting(m_State))
     AddFrameTerminator(AMDRGPControl::GetEndTag());
 
@@ -3113,9 +3243,14 @@ void WrappedVulkan::ApplyInitialContents()
   SubmitCmds();
   FlushQ();
 
+  // find which memory was written through images before we lose track of the replayed range
+  GatherWrittenImageMemory();
+
   // actually apply the initial contents here
   GetResourceManager()->ApplyInitialContents();
 
+  m_InitialContentsDirtyEID = 0;
+
   // close the final command buffer
   if(initStateCurCmd != VK_NULL_HANDLE)
   {
@@ -3805,6 +3940,8 @@ VkResourceRecord *WrappedVulkan::RegisterSurface(WindowingSystem system, void *h
 
 void WrappedVulkan::ReplayLog(uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType)
 {
+  RDCPROFILE_ZONE("Vulkan ReplayLog");
+
   bool partial = true;
 
   if(startEventID == 0 && (replayType == eReplay_WithoutDraw || replayType == eReplay_Full))
@@ -3820,6 +3957,9 @@ void WrappedVulkan::ReplayLog(uint32_t startEventID, uint32_t endEventID, Replay
     VkMarkerRegion::End();
   }
 
+  // anything written up to here will need its initial contents re-applied on the next full replay
+  m_InitialContentsDirtyEID = RDCMAX(m_InitialContentsDirtyEID, endEventID);
+
   m_State = CaptureState::ActiveReplaying;
 
   VkMarkerRegion::Set(StringFormat::Fmt("!!!!RenderDoc Internal: RenderDoc Replay %d (%d): %u->%u",
@@ -3923,6 +4063,12 @@ void WrappedVulkan::ReplayLog(uint32_t startEventID, uint32_t endEventID, Replay
 
     RDResult status = ResultCode::Succeeded;
 
+    if(!partial)
+      PrepareReplayCheckpoint(replayType == eReplay_Full ? endEventID
+                                                         : RDCMAX(1U, endEventID) - 1);
+
+    PerformanceTimer timer;
+
     if(replayType == eReplay_Full)
       status = ContextReplayLog(m_State, startEventID, endEventID, partial);
     else if(replayType == eReplay_WithoutDraw)
@@ -3934,6 +4080,24 @@ void WrappedVulkan::ReplayLog(uint32_t startEventID, uint32_t endEventID, Replay
 
     RDCASSERTEQUAL(status.code, ResultCode::Succeeded);
 
+    // summarise what each full replay cost so the benefit of checkpoints can be judged
+    if(!partial && ReplayCheckpointsEnabled())
+    {
+      if(m_CheckpointSkipEventID > 0)
+        RDCLOG("Replay to %u took %.2lf ms from the checkpoint at %u, %zu checkpoints using "
+               "%llu bytes",
+               endEventID, timer.GetMilliseconds(), m_CheckpointSkipEventID,
+               m_ReplayCheckpoints.size(), m_ReplayCheckpointTotalSize);
+      else
+        RDCLOG("Replay to %u took %.2lf ms from the start, %zu checkpoints using %llu bytes",
+               endEventID, timer.GetMilliseconds(), m_ReplayCheckpoints.size(),
+               m_ReplayCheckpointTotalSize);
+    }
+
+    m_RestoreCheckpoint = NULL;
+    m_CheckpointSkipEventID = 0;
+    m_CheckpointCreateEventID = 0;
+
     if(m_OutsideCmdBuffer != VK_NULL_HANDLE)
     {
       VkCommandBuffer cmd = m_OutsideCmdBuffer;
@@ -4443,6 +4607,30 @@ bool WrappedVulkan::InRerecordRange(ResourceId cmdid)
   return m_RerecordCmds.find(cmdid) != m_RerecordCmds.end();
 }
 
+bool WrappedVulkan::CanSkipReplayChunk(const ReplayChunkInfo &info)
+{
+  if(!Vulkan_SkipNoOpReplayChunks())
+    return false;
+
+  // only commands recorded into a command buffer can be skipped, and never the begin/end which
+  // decide whether the command buffer is re-recorded
+  if(info.cmd == ResourceId() || info.type == VulkanChunk::vkBeginCommandBuffer ||
+     info.type == VulkanChunk::vkEndCommandBuffer)
+    return false;
+
+  if(m_OutsideCmdBuffer != VK_NULL_HANDLE)
+    return false;
+
+  // partial command buffers track state even outside of their replay range
+  for(int p = 0; p < ePartialNum; p++)
+    if(info.cmd == m_Partial[p].partialParent)
+      return false;
+
+  // commands for command buffers that aren't being re-recorded only update tracking that is reset
+  // the next time the command buffer is begun
+  return m_RerecordCmds.find(info.cmd) == m_RerecordCmds.end();
+}
+
 bool WrappedVulkan::HasRerecordCmdBuf(ResourceId cmdid)
 {
   if(m_OutsideCmdBuffer != VK_NULL_HANDLE)
@@ -4692,19 +4880,22 @@ void WrappedVulkan::AddUsage(VulkanActionTreeNode &actionNode, rdcarray<DebugMes
     const rdcarray<VulkanStatePipeline::DescriptorAndOffsets> &descSets =
         (compute ? state.compute.descSets : state.graphics.descSets);
 
-    RDCASSERT(sh.mapping);
+    const ShaderReflection *refl = sh.GetReflection();
+    const ShaderBindpointMapping *mapping = sh.GetMapping();
+
+    RDCASSERT(mapping);
 
     struct ResUsageType
     {
-      ResUsageType(rdcarray<Bindpoint> &a, ResourceUsage u) : bindmap(a), usage(u) {}
-      rdcarray<Bindpoint> &bindmap;
+      ResUsageType(const rdcarray<Bindpoint> &a, ResourceUsage u) : bindmap(a), usage(u) {}
+      const rdcarray<Bindpoint> &bindmap;
       ResourceUsage usage;
     };
 
     ResUsageType types[] = {
-        ResUsageType(sh.mapping->readOnlyResources, ResourceUsage::VS_Resource),
-        ResUsageType(sh.mapping->readWriteResources, ResourceUsage::VS_RWResource),
-        ResUsageType(sh.mapping->constantBlocks, ResourceUsage::VS_Constants),
+        ResUsageType(mapping->readOnlyResources, ResourceUsage::VS_Resource),
+        ResUsageType(mapping->readWriteResources, ResourceUsage::VS_RWResource),
+        ResUsageType(mapping->constantBlocks, ResourceUsage::VS_Constants),
     };
 
     DebugMessage msg;
@@ -4722,7 +4913,7 @@ void WrappedVulkan::AddUsage(VulkanActionTreeNode &actionNode, rdcarray<DebugMes
           continue;
 
         // ignore push constants
-        if(t == 2 && !sh.refl->constantBlocks[i].bufferBacked)
+        if(t == 2 && !refl->constantBlocks[i].bufferBacked)
           continue;
 
         int32_t bindset = types[t].bindmap[i].bindset;
@@ -4784,6 +4975,8 @@ void WrappedVulkan::AddUsage(VulkanActionTreeNode &actionNode, rdcarray<DebugMes
           if(!hugeRangeWarned)
             RDCWARN("Skipping large, most likely 'bindless', descriptor range");
           hugeRangeWarned = true;
+          if(types[t].usage == ResourceUsage::VS_RWResource)
+            m_UntrackedImageWrites = true;
           continue;
         }
 
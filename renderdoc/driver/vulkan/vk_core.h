@@ -53,7 +53,7 @@ struct VkInitParams
   uint64_t GetSerialiseSize();
 
   // check if a frame capture section version is supported
-  static const uint64_t CurrentVersion = 0x15;
+  static const uint64_t CurrentVersion = 0x16;
   static bool IsSupportedVersion(uint64_t ver);
 };
 
@@ -359,6 +359,47 @@ private:
   Threading::CriticalSection m_CapDescriptorsLock;
   std::set<rdcpair<ResourceId, VkResourceRecord *>> m_CapDescriptors;
 
+  // bind refs gathered from descriptor sets submitted during the current capture, reused on later
+  // submits. Slots written after the refs were gathered are noted and added in on the next submit.
+  // That never removes the refs from whatever was overwritten, so the refs are gathered from
+  // scratch once the writes add up to more than the whole set, when the set is reallocated, or when
+  // a resource they refer to is released.
+  struct CachedBindRefs
+  {
+    int64_t generation = -1;
+    size_t releasedPosition = 0;
+    uint32_t descriptorCount = 0;
+    uint32_t dirtyCount = 0;
+    bool regather = false;
+    rdcarray<rdcpair<const DescriptorSetSlot *, uint32_t>> dirty;
+    DescriptorBindRefs refs;
+
+    void MarkDirty(const DescriptorSetSlot &slot)
+    {
+      if(regather)
+        return;
+
+      if(++dirtyCount > descriptorCount)
+      {
+        regather = true;
+        dirty.clear();
+        return;
+      }
+
+      // consecutive slots in a binding are contiguous, so most writes extend the last range
+      if(!dirty.empty() && dirty.back().first + dirty.back().second == &slot)
+        dirty.back().second++;
+      else
+        dirty.push_back({&slot, 1U});
+    }
+  };
+  Threading::CriticalSection m_CachedBindRefsLock;
+  std::unordered_map<ResourceId, CachedBindRefs> m_CachedBindRefs;
+
+  // m_CachedBindRefsLock must be held. Returns NULL if the set has nothing cached that writes
+  // could be added to
+  CachedBindRefs *GetDirtyBindRefs(VkResourceRecord *setrecord);
+
   VkResourceRecord *m_FrameCaptureRecord;
   Chunk *m_HeaderChunk;
 
@@ -376,7 +417,7 @@ private:
   VulkanShaderCache *m_ShaderCache = NULL;
   VulkanTextRenderer *m_TextRenderer = NULL;
 
-  Threading::RWLock m_CapTransitionLock;
+  Threading::EpochLock m_CapTransitionLock;
 
   VulkanActionCallback *m_ActionCallback;
   void *m_SubmitChain;
@@ -489,6 +530,22 @@ private:
   ImageBarrierSequence m_setupImageBarriers;
   ImageBarrierSequence m_cleanupImageBarriers;
 
+  // initial state readbacks that are recorded or in flight while batching, see vk_initstate.cpp
+  struct InitialStateBatch
+  {
+    rdcarray<VkBuffer> buffers;
+    VkDeviceSize size = 0;
+    ImageBarrierSequence cleanupBarriers;
+  };
+
+  bool m_BatchingInitialStates = false;
+  InitialStateBatch m_InitialStateRecording, m_InitialStateInFlight;
+
+  // returns false if not batching, in which case the caller flushes the readback itself
+  bool AddToInitialStateBatch(VkBuffer readbackBuf, VkDeviceSize size);
+  void CompleteInitialStateBatch();
+  void DestroyInitialStateBatchBuffers(InitialStateBatch &batch);
+
   // a small amount of helper code during capture for handling resources on different queues in init
   // states
   struct ExternalQueue
@@ -971,10 +1028,90 @@ private:
   uint32_t m_FirstEventID, m_LastEventID;
   VulkanChunk m_LastChunk;
 
+  // the location of each chunk in the frame and the command buffer it was recorded into, gathered
+  // while loading. Full replays use this to skip over chunks for command buffers that aren't being
+  // re-recorded without deserialising them at all.
+  struct ReplayChunkInfo
+  {
+    uint64_t offset;
+    uint64_t endOffset;
+    ResourceId cmd;
+    VulkanChunk type;
+  };
+  rdcarray<ReplayChunkInfo> m_ReplayChunks;
+
+  bool CanSkipReplayChunk(const ReplayChunkInfo &info);
+
+  // a snapshot of all device memory contents, image contents and image layouts after every event
+  // up to and including eventId has executed. Only taken at queue submission boundaries, where no
+  // command buffer is partially executed.
+  struct ReplayCheckpoint
+  {
+    struct MemoryRange
+    {
+      ResourceId mem;
+      VkDeviceSize offset;
+      VkDeviceSize size;
+    };
+
+    struct ImageCopy
+    {
+      ResourceId image;
+      VkImage copy = VK_NULL_HANDLE;
+      VkDeviceSize offset = 0;
+    };
+
+    uint32_t eventId = 0;
+    uint64_t lastUse = 0;
+    VkDeviceSize size = 0;
+    VkBuffer buf = VK_NULL_HANDLE;
+    VkDeviceMemory mem = VK_NULL_HANDLE;
+    rdcarray<MemoryRange> memory;
+    VkDeviceSize imageSize = 0;
+    VkDeviceMemory imageMem = VK_NULL_HANDLE;
+    rdcarray<ImageCopy> images;
+    std::map<ResourceId, ImageState> imageStates;
+  };
+
+  // the event IDs at the end of each queue submission, which are the candidates for checkpoints
+  rdcarray<uint32_t> m_SubmitBoundaryEvents;
+  // checkpoints sorted by event ID
+  rdcarray<ReplayCheckpoint *> m_ReplayCheckpoints;
+  uint64_t m_ReplayCheckpointUse = 0;
+  VkDeviceSize m_ReplayCheckpointTotalSize = 0;
+  // while replaying from a checkpoint, submissions that finish before the checkpoint are skipped
+  // and the checkpoint is restored once the replay passes its event
+  ReplayCheckpoint *m_RestoreCheckpoint = NULL;
+  uint32_t m_CheckpointSkipEventID = 0;
+  // the submission boundary at which to take a new checkpoint during this replay, if any
+  uint32_t m_CheckpointCreateEventID = 0;
+
+  bool ReplayCheckpointsEnabled();
+  void PrepareReplayCheckpoint(uint32_t lastEventID);
+  void CreateReplayCheckpoint(uint32_t eventId);
+  void RestoreReplayCheckpoint(ReplayCheckpoint *checkpoint);
+  void FreeReplayCheckpoint(ReplayCheckpoint *checkpoint);
+
   ResourceId m_LastPresentedImage;
 
   std::set<ResourceId> m_SparseBindResources;
 
+  // the highest event replayed since initial contents were last applied. Images with no write usage
+  // up to this event still hold their initial contents and don't need them re-applied. ~0U means
+  // the state is unknown and everything must be applied.
+  uint32_t m_InitialContentsDirtyEID = ~0U;
+  // set if some image writes can't be tracked through m_ResourceUses, e.g. from bindless storage
+  // image arrays that are too large to record usage for
+  bool m_UntrackedImageWrites = false;
+  // memory ranges bound to images written by the events above, gathered before initial contents
+  // are applied so that images aliasing the same memory are also treated as written.
+  std::map<ResourceId, rdcarray<rdcpair<VkDeviceSize, VkDeviceSize>>> m_WrittenImageMemory;
+
+  bool HasWriteUsage(ResourceId liveid);
+  void GatherWrittenImageMemory();
+  bool ImageWrittenInReplay(ResourceId liveid, ResourceId boundMemory, VkDeviceSize offset,
+                            VkDeviceSize size);
+
   RDResult m_FailedReplayResult = ResultCode::APIReplayFailed;
 
   VulkanActionTreeNode m_ParentAction;
@@ -1007,6 +1144,7 @@ private:
   }
 
   bool ProcessChunk(ReadSerialiser &ser, VulkanChunk chunk);
+  void FinishLoadJobs();
   RDResult ContextReplayLog(CaptureState readType, uint32_t startEventID, uint32_t endEventID,
                             bool partial);
   bool ContextProcessChunk(ReadSerialiser &ser, VulkanChunk chunk);
@@ -1074,6 +1212,8 @@ public:
   VulkanReplay *GetReplay() { return m_Replay; }
   // replay interface
   bool Prepare_InitialState(WrappedVkRes *res);
+  void BeginInitialStateBatching();
+  void EndInitialStateBatching();
   uint64_t GetSize_InitialState(ResourceId id, const VkInitialContents &initial);
   template <typename SerialiserType>
   bool Serialise_InitialState(SerialiserType &ser, ResourceId id, VkResourceRecord *record,
@@ -1096,6 +1236,7 @@ public:
   }
   void Shutdown();
   void ReplayLog(uint32_t startEventID, uint32_t endEventID, ReplayLogType replayType);
+  void ClearReplayCheckpoints();
   void ReplayDraw(VkCommandBuffer cmd, const ActionDescription &action);
   RDResult ReadLogInitialisation(RDCFile *rdc, bool storeStructuredBuffers);
 
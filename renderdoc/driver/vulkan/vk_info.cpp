@@ -23,9 +23,11 @@
  ******************************************************************************/
 
 #include "vk_info.h"
+#include "common/profiler.h"
 #include "core/settings.h"
 #include "lz4/lz4.h"
 #include "vk_core.h"
+#include "vk_shader_cache.h"
 
 // for compatibility we use the same DXBC name since it's now configured by the UI
 RDOC_EXTERN_CONFIG(rdcarray<rdcstr>, DXBC_Debug_SearchDirPaths);
@@ -871,11 +873,9 @@ void VulkanCreationInfo::Pipeline::Init(VulkanResourceManager *resourceMan,
     ShaderModuleReflection &reflData = info.m_ShaderModule[shadid].m_Reflections[key];
 
     reflData.Init(resourceMan, shadid, info.m_ShaderModule[shadid].spirv, shad.entryPoint,
-                  pCreateInfo->pStages[i].stage, shad.specialization);
+                  pCreateInfo->pStages[i].stage, shad.specialization, info.m_ReflectionCache);
 
-    shad.refl = reflData.refl;
-    shad.mapping = &reflData.mapping;
-    shad.patchData = &reflData.patchData;
+    shad.reflData = &reflData;
   }
 
   if(pCreateInfo->pVertexInputState)
@@ -1458,11 +1458,9 @@ void VulkanCreationInfo::Pipeline::Init(VulkanResourceManager *resourceMan, Vulk
     ShaderModuleReflection &reflData = info.m_ShaderModule[shadid].m_Reflections[key];
 
     reflData.Init(resourceMan, shadid, info.m_ShaderModule[shadid].spirv, shad.entryPoint,
-                  pCreateInfo->stage.stage, shad.specialization);
+                  pCreateInfo->stage.stage, shad.specialization, info.m_ReflectionCache);
 
-    shad.refl = reflData.refl;
-    shad.mapping = &reflData.mapping;
-    shad.patchData = &reflData.patchData;
+    shad.reflData = &reflData;
   }
 
   topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
@@ -2077,8 +2075,22 @@ void VulkanCreationInfo::ShaderModule::Init(VulkanResourceManager *resourceMan,
   else
   {
     RDCASSERT(pCreateInfo->codeSize % sizeof(uint32_t) == 0);
-    spirv.Parse(rdcarray<uint32_t>((uint32_t *)(pCreateInfo->pCode),
-                                   pCreateInfo->codeSize / sizeof(uint32_t)));
+    rdcarray<uint32_t> code((uint32_t *)(pCreateInfo->pCode),
+                            pCreateInfo->codeSize / sizeof(uint32_t));
+
+    if(info.m_LoadJobs)
+    {
+      // the create info is only valid for this call so the job takes its own copy of the code.
+      // Nothing waits on it individually, it's finished along with every other load job.
+      info.m_LoadJobs->Release(info.m_LoadJobs->Add([this, code]() {
+        RDCPROFILE_ZONE("Parse SPIR-V");
+        spirv.Parse(code);
+      }));
+    }
+    else
+    {
+      spirv.Parse(code);
+    }
   }
 }
 
@@ -2207,26 +2219,111 @@ void VulkanCreationInfo::ShaderModuleReflection::Init(VulkanResourceManager *res
                                                       ResourceId id, const rdcspv::Reflector &spv,
                                                       const rdcstr &entry,
                                                       VkShaderStageFlagBits stage,
-                                                      const rdcarray<SpecConstant> &specInfo)
+                                                      const rdcarray<SpecConstant> &specInfo,
+                                                      VulkanReflectionCache *reflCache)
 {
   if(entryPoint.empty())
   {
     entryPoint = entry;
     stageIndex = StageIndex(stage);
 
-    spv.MakeReflection(GraphicsAPI::Vulkan, ShaderStage(stageIndex), entryPoint, specInfo, *refl,
-                       mapping, patchData);
+    source = &spv;
+    specialization = specInfo;
+    originalId = resourceMan->GetOriginalID(id);
+    cache = reflCache;
+  }
+}
+
+void VulkanCreationInfo::ShaderModuleReflection::EnsureReflection()
+{
+  if(Atomic::CmpExch32(&reflected, 1, 1) == 1)
+    return;
+
+  SCOPED_LOCK(lock);
+
+  // nothing to reflect until Init() has been called
+  if(reflected || !source)
+    return;
+
+  RDCPROFILE_ZONE("Reflect SPIR-V");
+
+  VulkanReflectionCache::Key key = {};
+  bool cached = false;
+
+  if(cache)
+  {
+    const rdcarray<uint32_t> &spirv = source->GetSPIRV();
+
+    key = VulkanReflectionCache::MakeKey(spirv, ShaderStage(stageIndex), entryPoint,
+                                         specialization);
+    cached = cache->Fetch(key, *refl, mapping, patchData);
+
+    if(cached)
+      refl->rawBytes.assign((const byte *)spirv.data(), spirv.byteSize());
+  }
+
+  if(!cached)
+  {
+    source->MakeReflection(GraphicsAPI::Vulkan, ShaderStage(stageIndex), entryPoint,
+                           specialization, *refl, mapping, patchData);
 
-    refl->resourceId = resourceMan->GetOriginalID(id);
+    if(cache)
+      cache->Store(key, *refl, mapping, patchData);
   }
+
+  refl->resourceId = originalId;
+
+  Atomic::CmpExch32(&reflected, 0, 1);
 }
 
 void VulkanCreationInfo::ShaderModuleReflection::PopulateDisassembly(const rdcspv::Reflector &spirv)
 {
+  EnsureReflection();
+
+  SCOPED_LOCK(lock);
+
   if(disassembly.empty())
     disassembly = spirv.Disassemble(refl->entryPoint, instructionLines);
 }
 
+void VulkanCreationInfo::PrefetchDisassembly(const rdcarray<ResourceId> &pipes)
+{
+  WaitForShaderPrefetch();
+
+  rdcarray<rdcpair<ShaderModuleReflection *, const rdcspv::Reflector *>> work;
+
+  for(ResourceId id : pipes)
+  {
+    auto it = m_Pipeline.find(id);
+    if(it == m_Pipeline.end())
+      continue;
+
+    for(const Pipeline::Shader &shad : it->second.shaders)
+    {
+      if(shad.reflData && shad.reflData->disassembly.empty())
+        work.push_back({shad.reflData, &m_ShaderModule[shad.module].spirv});
+    }
+  }
+
+  if(work.empty())
+    return;
+
+  m_PrefetchThread = Threading::CreateThread([work]() {
+    for(const rdcpair<ShaderModuleReflection *, const rdcspv::Reflector *> &w : work)
+      w.first->PopulateDisassembly(*w.second);
+  });
+}
+
+void VulkanCreationInfo::WaitForShaderPrefetch()
+{
+  if(m_PrefetchThread)
+  {
+    Threading::JoinThread(m_PrefetchThread);
+    Threading::CloseThread(m_PrefetchThread);
+    m_PrefetchThread = 0;
+  }
+}
+
 void VulkanCreationInfo::QueryPool::Init(VulkanResourceManager *resourceMan, VulkanCreationInfo &info,
                                          const VkQueryPoolCreateInfo *pCreateInfo)
 {
@@ -2507,3 +2604,184 @@ void DescUpdateTemplate::Apply(const void *pData, DescUpdateTemplateApplication
       application.writes.push_back(write);
   }
 }
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "catch/catch.hpp"
+
+TEST_CASE("Vulkan reflection cache", "[vulkan][reflection]")
+{
+  rdcspv::Init();
+  RenderDoc::Inst().RegisterShutdownFunction(&rdcspv::Shutdown);
+
+  rdcstr source = R"(
+#version 450 core
+
+layout(constant_id = 3) const int spec = 4;
+
+layout(binding = 0, std140) uniform constsbuf
+{
+  vec4 col;
+};
+
+layout(binding = 1) uniform sampler2D tex;
+
+layout(location = 0) in vec2 uv;
+layout(location = 0) out vec4 Color;
+
+void main()
+{
+  Color = col * texture(tex, uv) * float(spec);
+}
+)";
+
+  rdcarray<uint32_t> spirv;
+  rdcspv::CompilationSettings settings(rdcspv::InputLanguage::VulkanGLSL,
+                                       rdcspv::ShaderStage::Fragment);
+  settings.debugInfo = true;
+  rdcstr errors = rdcspv::Compile(settings, {source}, spirv);
+
+  INFO("SPIR-V compile output: " << errors);
+
+  REQUIRE(!spirv.empty());
+
+  rdcspv::Reflector spv;
+  spv.Parse(spirv);
+
+  rdcarray<SpecConstant> specInfo = {SpecConstant(3, 7, sizeof(int32_t))};
+
+  ShaderReflection refl;
+  ShaderBindpointMapping mapping;
+  SPIRVPatchData patchData;
+  spv.MakeReflection(GraphicsAPI::Vulkan, ShaderStage::Fragment, "main", specInfo, refl, mapping,
+                     patchData);
+
+  VulkanReflectionCache::Key key =
+      VulkanReflectionCache::MakeKey(spirv, ShaderStage::Fragment, "main", specInfo);
+
+  SECTION("Keys depend on everything the reflection does")
+  {
+    auto differs = [&key](const VulkanReflectionCache::Key &other) {
+      return key < other || other < key;
+    };
+
+    CHECK_FALSE(differs(VulkanReflectionCache::MakeKey(spirv, ShaderStage::Fragment, "main",
+                                                       specInfo)));
+
+    CHECK(differs(VulkanReflectionCache::MakeKey(spirv, ShaderStage::Vertex, "main", specInfo)));
+    CHECK(differs(VulkanReflectionCache::MakeKey(spirv, ShaderStage::Fragment, "main2", specInfo)));
+    CHECK(differs(VulkanReflectionCache::MakeKey(spirv, ShaderStage::Fragment, "main", {})));
+    CHECK(differs(VulkanReflectionCache::MakeKey(spirv, ShaderStage::Fragment, "main",
+                                                 {SpecConstant(3, 8, sizeof(int32_t))})));
+
+    rdcarray<uint32_t> modified = spirv;
+    modified.back() ^= 1;
+    CHECK(differs(VulkanReflectionCache::MakeKey(modified, ShaderStage::Fragment, "main",
+                                                 specInfo)));
+  };
+
+  SECTION("Reflection round-trips through the cache")
+  {
+    VulkanReflectionCache cache(false);
+
+    ShaderReflection cachedRefl;
+    ShaderBindpointMapping cachedMapping;
+    SPIRVPatchData cachedPatchData;
+
+    CHECK_FALSE(cache.Fetch(key, cachedRefl, cachedMapping, cachedPatchData));
+
+    const bytebuf rawBytes = refl.rawBytes;
+    cache.Store(key, refl, mapping, patchData);
+
+    // the caller's reflection is left as it was
+    CHECK(refl.rawBytes == rawBytes);
+
+    REQUIRE(cache.Fetch(key, cachedRefl, cachedMapping, cachedPatchData));
+
+    // the SPIR-V isn't stored
+    CHECK(cachedRefl.rawBytes.empty());
+
+    CHECK(cachedRefl.entryPoint == refl.entryPoint);
+    CHECK(cachedRefl.stage == refl.stage);
+    CHECK(cachedRefl.debugInfo.files.size() == refl.debugInfo.files.size());
+
+    REQUIRE(cachedRefl.inputSignature.size() == refl.inputSignature.size());
+    for(size_t i = 0; i < refl.inputSignature.size(); i++)
+      CHECK(cachedRefl.inputSignature[i].varName == refl.inputSignature[i].varName);
+
+    REQUIRE(cachedRefl.constantBlocks.size() == refl.constantBlocks.size());
+    for(size_t i = 0; i < refl.constantBlocks.size(); i++)
+    {
+      CHECK(cachedRefl.constantBlocks[i].name == refl.constantBlocks[i].name);
+      CHECK(cachedRefl.constantBlocks[i].variables.size() ==
+            refl.constantBlocks[i].variables.size());
+    }
+
+    REQUIRE(cachedRefl.readOnlyResources.size() == refl.readOnlyResources.size());
+    for(size_t i = 0; i < refl.readOnlyResources.size(); i++)
+      CHECK(cachedRefl.readOnlyResources[i].name == refl.readOnlyResources[i].name);
+
+    REQUIRE(cachedMapping.constantBlocks.size() == mapping.constantBlocks.size());
+    for(size_t i = 0; i < mapping.constantBlocks.size(); i++)
+    {
+      CHECK(cachedMapping.constantBlocks[i].bindset == mapping.constantBlocks[i].bindset);
+      CHECK(cachedMapping.constantBlocks[i].bind == mapping.constantBlocks[i].bind);
+    }
+    REQUIRE(cachedMapping.readOnlyResources.size() == mapping.readOnlyResources.size());
+
+    REQUIRE(cachedPatchData.inputs.size() == patchData.inputs.size());
+    for(size_t i = 0; i < patchData.inputs.size(); i++)
+    {
+      CHECK(cachedPatchData.inputs[i].ID == patchData.inputs[i].ID);
+      CHECK(cachedPatchData.inputs[i].accessChain == patchData.inputs[i].accessChain);
+    }
+    CHECK(cachedPatchData.outputs.size() == patchData.outputs.size());
+    CHECK(cachedPatchData.specIDs == patchData.specIDs);
+    CHECK(cachedPatchData.outTopo == patchData.outTopo);
+  };
+
+  SECTION("The least recently used entries are evicted once the cache is full")
+  {
+    SDObject *maxMB = RenderDoc::Inst().SetConfigSetting("Vulkan_ReflectionCacheMaxMB");
+    REQUIRE(maxMB);
+
+    const uint64_t prevMaxMB = maxMB->data.basic.u;
+    maxMB->data.basic.u = 1;
+
+    VulkanReflectionCache cache(false);
+
+    ShaderReflection cachedRefl;
+    ShaderBindpointMapping cachedMapping;
+    SPIRVPatchData cachedPatchData;
+
+    auto makeKey = [&spirv](uint32_t i) {
+      return VulkanReflectionCache::MakeKey(spirv, ShaderStage::Fragment, "main",
+                                            {SpecConstant(3, i, sizeof(int32_t))});
+    };
+
+    // the first entry is used after every store so it's never the oldest, the second never is
+    cache.Store(makeKey(0), refl, mapping, patchData);
+    cache.Store(makeKey(1), refl, mapping, patchData);
+
+    // each entry is a few kB, so this is several times the 1MB limit
+    const uint32_t count = 4096;
+    for(uint32_t i = 2; i < count; i++)
+    {
+      cache.Store(makeKey(i), refl, mapping, patchData);
+      REQUIRE(cache.Fetch(makeKey(0), cachedRefl, cachedMapping, cachedPatchData));
+    }
+
+    CHECK_FALSE(cache.Fetch(makeKey(1), cachedRefl, cachedMapping, cachedPatchData));
+    CHECK_FALSE(cache.Fetch(makeKey(2), cachedRefl, cachedMapping, cachedPatchData));
+    CHECK(cache.Fetch(makeKey(count - 1), cachedRefl, cachedMapping, cachedPatchData));
+
+    // a full cache still takes new entries
+    CHECK_FALSE(cache.Fetch(makeKey(count), cachedRefl, cachedMapping, cachedPatchData));
+    cache.Store(makeKey(count), refl, mapping, patchData);
+    CHECK(cache.Fetch(makeKey(count), cachedRefl, cachedMapping, cachedPatchData));
+
+    maxMB->data.basic.u = prevMaxMB;
+  };
+}
+
+#endif
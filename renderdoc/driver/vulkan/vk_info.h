@@ -25,11 +25,13 @@
 #pragma once
 
 #include <unordered_map>
+#include "common/job_pool.h"
 #include "driver/shaders/spirv/spirv_reflect.h"
 #include "vk_common.h"
 #include "vk_manager.h"
 
 struct VulkanCreationInfo;
+class VulkanReflectionCache;
 
 // linearised version of VkDynamicState
 enum VulkanDynamicStateIndex
@@ -268,6 +270,10 @@ struct VulkanCreationInfo
     ResourceId specialisingPipe;
   };
 
+  // reflection for one entry point in a shader module with one set of specialisation constants.
+  // Init() only records what to reflect - most shaders in a capture are never looked at, so the
+  // reflection is generated on first use by EnsureReflection(). refl, mapping and patchData don't
+  // move so they can be referenced before they're filled in.
   struct ShaderModuleReflection
   {
     ShaderModuleReflection() { refl = new ShaderReflection; }
@@ -283,11 +289,25 @@ struct VulkanCreationInfo
     SPIRVPatchData patchData;
     std::map<size_t, uint32_t> instructionLines;
 
+    // reflCache is optional, to share reflection between sessions
     void Init(VulkanResourceManager *resourceMan, ResourceId id, const rdcspv::Reflector &spv,
               const rdcstr &entry, VkShaderStageFlagBits stage,
-              const rdcarray<SpecConstant> &specInfo);
+              const rdcarray<SpecConstant> &specInfo, VulkanReflectionCache *reflCache);
 
+    // these can be called from any thread, and do nothing if the work has already been done.
+    // The SPIR-V must have finished parsing before either is called.
+    void EnsureReflection();
     void PopulateDisassembly(const rdcspv::Reflector &spirv);
+
+  private:
+    // what to reflect, recorded by Init()
+    const rdcspv::Reflector *source = NULL;
+    rdcarray<SpecConstant> specialization;
+    ResourceId originalId;
+    VulkanReflectionCache *cache = NULL;
+
+    Threading::CriticalSection lock;
+    int32_t reflected = 0;
   };
 
   struct Pipeline
@@ -338,13 +358,34 @@ struct VulkanCreationInfo
     // VkPipelineShaderStageCreateInfo
     struct Shader
     {
-      Shader() : refl(NULL), mapping(NULL), patchData(NULL) {}
       ResourceId module;
       ShaderStage stage;
       rdcstr entryPoint;
-      ShaderReflection *refl;
-      ShaderBindpointMapping *mapping;
-      SPIRVPatchData *patchData;
+
+      // these return NULL if the stage isn't used, and generate the reflection if needed
+      ShaderReflection *GetReflection() const
+      {
+        if(!reflData)
+          return NULL;
+        reflData->EnsureReflection();
+        return reflData->refl;
+      }
+      const ShaderBindpointMapping *GetMapping() const
+      {
+        if(!reflData)
+          return NULL;
+        reflData->EnsureReflection();
+        return &reflData->mapping;
+      }
+      const SPIRVPatchData *GetPatchData() const
+      {
+        if(!reflData)
+          return NULL;
+        reflData->EnsureReflection();
+        return &reflData->patchData;
+      }
+
+      ShaderModuleReflection *reflData = NULL;
 
       rdcarray<SpecConstant> specialization;
     };
@@ -716,17 +757,25 @@ struct VulkanCreationInfo
 
     void Reinit();
 
+    // the reflection is generated if it hasn't been already, unless this entry point hasn't been
+    // initialised yet
     ShaderModuleReflection &GetReflection(ShaderStage stage, const rdcstr &entry, ResourceId pipe)
     {
       // look for one from this pipeline specifically, if it was specialised
       auto it = m_Reflections.find({stage, entry, pipe});
       if(it != m_Reflections.end())
+      {
+        it->second.EnsureReflection();
         return it->second;
+      }
 
       // if not, just return the non-specialised version
-      return m_Reflections[{stage, entry, ResourceId()}];
+      ShaderModuleReflection &ret = m_Reflections[{stage, entry, ResourceId()}];
+      ret.EnsureReflection();
+      return ret;
     }
 
+    // while loading this may still be being parsed on m_LoadJobs
     rdcspv::Reflector spirv;
 
     rdcstr unstrippedPath;
@@ -769,8 +818,24 @@ struct VulkanCreationInfo
   // just contains the queueFamilyIndex (after remapping)
   std::unordered_map<ResourceId, uint32_t> m_Queue;
 
+  // set while loading a capture, to parse shaders off the loading thread. Pipeline creation isn't
+  // done on it, see ReadLogInitialisation
+  Threading::JobPool *m_LoadJobs = NULL;
+
+  // set when replaying, owned by the driver
+  VulkanReflectionCache *m_ReflectionCache = NULL;
+
+  // disassembles pipelines' shaders on a background thread, ahead of them being displayed.
+  // Shader modules can't be modified or erased until WaitForShaderPrefetch() has returned.
+  void PrefetchDisassembly(const rdcarray<ResourceId> &pipes);
+  void WaitForShaderPrefetch();
+
+  ~VulkanCreationInfo() { WaitForShaderPrefetch(); }
+
   void erase(ResourceId id)
   {
+    WaitForShaderPrefetch();
+
     m_QueryPool.erase(id);
     m_Pipeline.erase(id);
     m_PipelineLayout.erase(id);
@@ -791,4 +856,7 @@ struct VulkanCreationInfo
     m_DescUpdateTemplate.erase(id);
     m_Queue.erase(id);
   }
+
+private:
+  Threading::ThreadHandle m_PrefetchThread = 0;
 };
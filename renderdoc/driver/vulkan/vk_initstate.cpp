@@ -29,18 +29,105 @@
 // VKTODOLOW there's a lot of duplicated code in this file for creating a buffer to do
 // a memory copy and saving to disk.
 
-// VKTODOLOW in general we do a lot of "create buffer, use it, flush/sync then destroy".
-// I don't know what the exact cost is, but it would be nice to batch up the buffers/etc
-// used across init state use, and only do a single flush. Also we could then get some
-// nice command buffer reuse (although need to be careful we don't create too large a
-// command buffer that stalls the GPU).
-// See INITSTATEBATCH
+// When preparing all dirty resources at the start of a capture, readback copies are batched up
+// rather than each doing a "create buffer, use it, flush/sync then destroy". Once a batch reaches
+// Vulkan_InitialStateBatchMB it is submitted, and the next batch is recorded while the GPU copies
+// it. At most one batch is in flight so we don't stall the GPU with one huge submission. Outside of
+// that (e.g. a postponed resource prepared mid-frame) each readback is still flushed immediately.
+
+RDOC_CONFIG(uint32_t, Vulkan_InitialStateBatchMB, 256,
+            "The amount of initial state readback in MB to record before submitting it to the GPU, "
+            "when preparing resources at the start of a capture. 0 disables batching.");
 
 template <typename SerialiserType>
 void DoSerialise(SerialiserType &ser, AspectSparseTable &el)
 {
   SERIALISE_MEMBER(aspectMask);
-  SERIALISE_MEMBER(table);
+
+  // older captures stored every page of partially mapped ranges
+  if(ser.VersionLess(0x16))
+  {
+    Sparse::LegacyPageTable table;
+    ser.Serialise("table"_lit, table);
+    el.table = table.table;
+  }
+  else
+  {
+    SERIALISE_MEMBER(table);
+  }
+}
+
+void WrappedVulkan::BeginInitialStateBatching()
+{
+  m_BatchingInitialStates = Vulkan_InitialStateBatchMB() > 0;
+}
+
+void WrappedVulkan::EndInitialStateBatching()
+{
+  // with batching disabled every readback was already flushed as it was recorded
+  if(!m_BatchingInitialStates)
+    return;
+
+  m_BatchingInitialStates = false;
+
+  CompleteInitialStateBatch();
+
+  SubmitAndFlushImageStateBarriers(m_setupImageBarriers);
+  SubmitCmds();
+  FlushQ();
+  SubmitAndFlushImageStateBarriers(m_cleanupImageBarriers);
+
+  DestroyInitialStateBatchBuffers(m_InitialStateRecording);
+}
+
+bool WrappedVulkan::AddToInitialStateBatch(VkBuffer readbackBuf, VkDeviceSize size)
+{
+  if(!m_BatchingInitialStates)
+    return false;
+
+  m_InitialStateRecording.buffers.push_back(readbackBuf);
+  m_InitialStateRecording.size += size;
+
+  if(m_InitialStateRecording.size < uint64_t(Vulkan_InitialStateBatchMB()) * 1024 * 1024)
+    return true;
+
+  // wait for the previous batch first so only one is ever in flight. The recorded batch's commands
+  // are still pending so this doesn't wait for them.
+  CompleteInitialStateBatch();
+
+  SubmitAndFlushImageStateBarriers(m_setupImageBarriers);
+  SubmitCmds();
+
+  // this batch is now in flight, its cleanup happens once it has completed
+  std::swap(m_InitialStateInFlight.buffers, m_InitialStateRecording.buffers);
+  m_InitialStateInFlight.cleanupBarriers = m_cleanupImageBarriers;
+  m_cleanupImageBarriers = ImageBarrierSequence();
+  m_InitialStateRecording.size = 0;
+
+  return true;
+}
+
+void WrappedVulkan::CompleteInitialStateBatch()
+{
+  if(m_InitialStateInFlight.buffers.empty())
+    return;
+
+  FlushQ();
+  SubmitAndFlushImageStateBarriers(m_InitialStateInFlight.cleanupBarriers);
+
+  DestroyInitialStateBatchBuffers(m_InitialStateInFlight);
+}
+
+void WrappedVulkan::DestroyInitialStateBatchBuffers(InitialStateBatch &batch)
+{
+  for(VkBuffer buf : batch.buffers)
+  {
+    ObjDisp(GetDev())->DestroyBuffer(Unwrap(GetDev()), Unwrap(buf), NULL);
+    GetResourceManager()->ReleaseWrappedResource(buf);
+  }
+
+  batch.buffers.clear();
+  batch.size = 0;
 }
 
 bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
@@ -113,7 +200,6 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
     }
 
     VkDevice d = GetDev();
-    // INITSTATEBATCH
     VkCommandBuffer cmd = GetNextCmd();
 
     // must ensure offset remains valid. Must be multiple of block size, or 4, depending on format
@@ -373,13 +459,16 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
     vkr = ObjDisp(d)->EndCommandBuffer(Unwrap(cmd));
     CheckVkResult(vkr);
 
-    SubmitAndFlushImageStateBarriers(m_setupImageBarriers);
-    SubmitCmds();
-    FlushQ();
-    SubmitAndFlushImageStateBarriers(m_cleanupImageBarriers);
+    if(!AddToInitialStateBatch(dstBuf, readbackmem.size))
+    {
+      SubmitAndFlushImageStateBarriers(m_setupImageBarriers);
+      SubmitCmds();
+      FlushQ();
+      SubmitAndFlushImageStateBarriers(m_cleanupImageBarriers);
 
-    ObjDisp(d)->DestroyBuffer(Unwrap(d), Unwrap(dstBuf), NULL);
-    GetResourceManager()->ReleaseWrappedResource(dstBuf);
+      ObjDisp(d)->DestroyBuffer(Unwrap(d), Unwrap(dstBuf), NULL);
+      GetResourceManager()->ReleaseWrappedResource(dstBuf);
+    }
 
     VkInitialContents initialContents(type, readbackmem);
 
@@ -408,7 +497,6 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
     VkResult vkr = VK_SUCCESS;
 
     VkDevice d = GetDev();
-    // INITSTATEBATCH
     VkCommandBuffer cmd = GetNextCmd();
 
     VkDeviceMemory datamem = ToUnwrappedHandle<VkDeviceMemory>(res);
@@ -478,12 +566,14 @@ bool WrappedVulkan::Prepare_InitialState(WrappedVkRes *res)
     vkr = ObjDisp(d)->EndCommandBuffer(Unwrap(cmd));
     CheckVkResult(vkr);
 
-    // INITSTATEBATCH
-    SubmitCmds();
-    FlushQ();
+    if(!AddToInitialStateBatch(dstBuf, readbackmem.size))
+    {
+      SubmitCmds();
+      FlushQ();
 
-    ObjDisp(d)->DestroyBuffer(Unwrap(d), Unwrap(dstBuf), NULL);
-    GetResourceManager()->ReleaseWrappedResource(dstBuf);
+      ObjDisp(d)->DestroyBuffer(Unwrap(d), Unwrap(dstBuf), NULL);
+      GetResourceManager()->ReleaseWrappedResource(dstBuf);
+    }
 
     GetResourceManager()->SetInitialContents(id, VkInitialContents(type, readbackmem));
 
@@ -601,47 +691,36 @@ SparseBinding::SparseBinding(WrappedVulkan *vk, VkBuffer unwrappedBuffer,
   }
   else
   {
-    // always bind a page at once
+    // runs are already coalesced, so bind each run at once
     VkSparseMemoryBind bind = {};
     bind.flags = 0;
-    bind.size = mrq.alignment;
 
-    opaqueBinds.reserve(mapping.pages.size());
-    for(size_t i = 0; i < mapping.pages.size(); i++)
+    opaqueBinds.reserve(mapping.runs.size());
+    for(size_t r = 0; r < mapping.runs.size(); r++)
     {
+      const Sparse::PageRun &run = mapping.runs[r];
+      const uint32_t count = mapping.getRunPageCount(r);
+
       bind.memory =
-          Unwrap(vk->GetResourceManager()->GetLiveHandle<VkDeviceMemory>(mapping.pages[i].memory));
-      bind.memoryOffset = mapping.pages[i].offset;
-
-      VkSparseMemoryBind &previousBind = opaqueBinds.back();
-
-      // simple coalescing for consecutive binds.
-      // We know the previous bind was for the previous resource page so we don't have to compare
-      // resourceOffset, just memory properties
-      if(
-          // if there's a previous bind already - guaranteed after i==0
-          i > 0
-          // and the memory is the same (either both NULL or both the same memory object)
-          && bind.memory == previousBind.memory
-          // and either
-          && (
-                 // the memory is NULL (then offsets don't matter)
-                 bind.memory == VK_NULL_HANDLE
-                 // or the offset immediately follows the last
-                 || bind.memoryOffset == previousBind.memoryOffset + mrq.alignment
-                 //
-                 )
-          //
-          )
+          Unwrap(vk->GetResourceManager()->GetLiveHandle<VkDeviceMemory>(run.mapping.memory));
+      bind.memoryOffset = run.mapping.offset;
+      bind.resourceOffset = run.firstPage * mrq.alignment;
+
+      // NULL memory or consecutive pages can be bound in one go
+      if(bind.memory == VK_NULL_HANDLE || !run.singlePageReused)
       {
-        // apply the previous bind for one more page
-        previousBind.size += mrq.alignment;
+        bind.size = count * mrq.alignment;
+        opaqueBinds.push_back(bind);
         continue;
       }
 
-      // otherwise push a new binding for this memory
-      bind.resourceOffset = i * mrq.alignment;
-      opaqueBinds.push_back(bind);
+      // otherwise a single memory page is reused, which needs a bind per resource page
+      bind.size = mrq.alignment;
+      for(uint32_t i = 0; i < count; i++)
+      {
+        opaqueBinds.push_back(bind);
+        bind.resourceOffset += mrq.alignment;
+      }
     }
   }
 
@@ -861,9 +940,12 @@ SparseBinding::SparseBinding(WrappedVulkan *vk, VkImage unwrappedImage,
                   if(x == dim.x - 1)
                     bind.extent.width = RDCMIN(bind.extent.width, mipDim.x - bind.offset.x);
 
+                  const Sparse::Page pageMapping =
+                      mapping.getPage(page, table.getPageByteSize());
+
                   bind.memory = Unwrap(vk->GetResourceManager()->GetLiveHandle<VkDeviceMemory>(
-                      mapping.pages[page].memory));
-                  bind.memoryOffset = mapping.pages[page].offset;
+                      pageMapping.memory));
+                  bind.memoryOffset = pageMapping.offset;
 
                   page++;
 
@@ -917,11 +999,13 @@ SparseBinding::SparseBinding(WrappedVulkan *vk, VkImage unwrappedImage,
           // bind a block at a time
           bind.size = mrq.alignment;
 
-          for(size_t i = 0; i < mapping.pages.size(); i++)
+          for(uint32_t i = 0; i < mapping.getNumPages(); i++)
           {
+            const Sparse::Page pageMapping = mapping.getPage(i, table.getPageByteSize());
+
             bind.memory = Unwrap(
-                vk->GetResourceManager()->GetLiveHandle<VkDeviceMemory>(mapping.pages[i].memory));
-            bind.memoryOffset = mapping.pages[i].offset;
+                vk->GetResourceManager()->GetLiveHandle<VkDeviceMemory>(pageMapping.memory));
+            bind.memoryOffset = pageMapping.offset;
 
             opaqueBinds.push_back(bind);
             bind.resourceOffset += bind.size;
@@ -1565,6 +1649,92 @@ void WrappedVulkan::Create_InitialState(ResourceId id, WrappedVkRes *live, bool)
   }
 }
 
+bool WrappedVulkan::HasWriteUsage(ResourceId liveid)
+{
+  auto it = m_ResourceUses.find(liveid);
+  if(it == m_ResourceUses.end())
+    return false;
+
+  for(const EventUsage &u : it->second)
+  {
+    if(u.eventId > m_InitialContentsDirtyEID)
+      continue;
+
+    switch(u.usage)
+    {
+      case ResourceUsage::VertexBuffer:
+      case ResourceUsage::IndexBuffer:
+      case ResourceUsage::VS_Constants:
+      case ResourceUsage::HS_Constants:
+      case ResourceUsage::DS_Constants:
+      case ResourceUsage::GS_Constants:
+      case ResourceUsage::PS_Constants:
+      case ResourceUsage::CS_Constants:
+      case ResourceUsage::All_Constants:
+      case ResourceUsage::VS_Resource:
+      case ResourceUsage::HS_Resource:
+      case ResourceUsage::DS_Resource:
+      case ResourceUsage::GS_Resource:
+      case ResourceUsage::PS_Resource:
+      case ResourceUsage::CS_Resource:
+      case ResourceUsage::All_Resource:
+      case ResourceUsage::InputTarget:
+      case ResourceUsage::Indirect:
+      case ResourceUsage::ResolveSrc:
+      case ResourceUsage::CopySrc: break;
+      // anything else, including barriers which may discard contents, counts as a write
+      default: return true;
+    }
+  }
+
+  return false;
+}
+
+void WrappedVulkan::GatherWrittenImageMemory()
+{
+  m_WrittenImageMemory.clear();
+
+  if(m_InitialContentsDirtyEID == ~0U)
+    return;
+
+  for(auto it = m_ResourceUses.begin(); it != m_ResourceUses.end(); ++it)
+  {
+    if(!HasWriteUsage(it->first))
+      continue;
+
+    LockedConstImageStateRef state = FindConstImageState(it->first);
+    if(!state || state->boundMemory == ResourceId())
+      continue;
+
+    m_WrittenImageMemory[state->boundMemory].push_back(
+        {state->boundMemoryOffset, state->boundMemorySize});
+  }
+}
+
+bool WrappedVulkan::ImageWrittenInReplay(ResourceId liveid, ResourceId boundMemory,
+                                         VkDeviceSize offset, VkDeviceSize size)
+{
+  if(m_InitialContentsDirtyEID == ~0U || m_UntrackedImageWrites ||
+     GetResourceManager()->HasReplacements())
+    return true;
+
+  if(HasWriteUsage(liveid))
+    return true;
+
+  // a write to any image aliasing the same memory also clobbers this image's contents
+  auto it = m_WrittenImageMemory.find(boundMemory);
+  if(it != m_WrittenImageMemory.end())
+  {
+    for(const rdcpair<VkDeviceSize, VkDeviceSize> &range : it->second)
+    {
+      if(range.first < offset + size && offset < range.first + range.second)
+        return true;
+    }
+  }
+
+  return false;
+}
+
 void WrappedVulkan::Apply_InitialState(WrappedVkRes *live, const VkInitialContents &initial)
 {
   if(HasFatalError())
@@ -1710,6 +1880,13 @@ void WrappedVulkan::Apply_InitialState(WrappedVkRes *live, const VkInitialConten
       }
     }
 
+    // if the image's memory isn't touched by anything else and neither the image itself nor any
+    // image aliasing its memory has been written by any event replayed since the last time we
+    // applied initial contents, it still holds them.
+    if(initialized &&
+       !ImageWrittenInReplay(id, boundMemory, boundMemoryOffset, boundMemorySize))
+      return;
+
     // handle any 'created' initial states, without an actual image with contents
     if(initial.tag != VkInitialContents::BufferCopy)
     {
@@ -628,12 +628,16 @@ void VulkanResourceManager::MarkSparseMapReferenced(const ResourceInfo *sparse)
       }
       else
       {
-        // this is a huge perf cliff as we've lost any batching and we perform as badly as if every
-        // page was mapped to a different resource, so we hope applications don't hit this often.
-        for(const Sparse::Page &page : mapping.pages)
+        // mark each run of pages at once. This only degrades to per-page if the mapping is very
+        // fragmented, which we hope applications don't do often.
+        for(size_t r = 0; r < mapping.runs.size(); r++)
         {
-          MarkMemoryFrameReferenced(page.memory, page.offset, table.getPageByteSize(),
-                                    eFrameRef_Read);
+          const Sparse::PageRun &run = mapping.runs[r];
+          MarkMemoryFrameReferenced(
+              run.mapping.memory, run.mapping.offset,
+              run.singlePageReused ? table.getPageByteSize()
+                                   : uint64_t(mapping.getRunPageCount(r)) * table.getPageByteSize(),
+              eFrameRef_Read);
         }
       }
     }
@@ -946,7 +950,8 @@ void VulkanResourceManager::RemoveDeviceMemory(ResourceId mem)
     m_DeviceMemories.erase(mem);
 }
 
-void VulkanResourceManager::MergeReferencedMemory(std::unordered_map<ResourceId, MemRefs> &memRefs)
+void VulkanResourceManager::MergeReferencedMemory(
+    const std::unordered_map<ResourceId, MemRefs> &memRefs)
 {
   SCOPED_LOCK_OPTIONAL(m_Lock, m_Capturing);
 
@@ -986,6 +991,40 @@ void VulkanResourceManager::ClearReferencedMemory()
   m_MemFrameRefs.clear();
 }
 
+bool VulkanResourceManager::CheckReleasedDescriptorResources(
+    size_t &position, const std::unordered_map<ResourceId, FrameRefType> &refs)
+{
+  SCOPED_LOCK(m_ReleasedDescriptorResourcesLock);
+
+  // the log was cleared since the position was taken, we can't tell what was released
+  if(position > m_ReleasedDescriptorResources.size())
+  {
+    position = m_ReleasedDescriptorResources.size();
+    return true;
+  }
+
+  bool ret = false;
+
+  for(; position < m_ReleasedDescriptorResources.size(); position++)
+    ret |= refs.find(m_ReleasedDescriptorResources[position]) != refs.end();
+
+  return ret;
+}
+
+size_t VulkanResourceManager::GetReleasedDescriptorResourceCount()
+{
+  SCOPED_LOCK(m_ReleasedDescriptorResourcesLock);
+
+  return m_ReleasedDescriptorResources.size();
+}
+
+void VulkanResourceManager::ClearReleasedDescriptorResources()
+{
+  SCOPED_LOCK(m_ReleasedDescriptorResourcesLock);
+
+  m_ReleasedDescriptorResources.clear();
+}
+
 MemRefs *VulkanResourceManager::FindMemRefs(ResourceId mem)
 {
   auto it = m_MemFrameRefs.find(mem);
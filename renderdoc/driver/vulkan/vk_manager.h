@@ -332,6 +332,26 @@ public:
 
     ResourceManager::ReleaseCurrentResource(id);
     VkResourceRecord *record = GetRecord(obj);
+
+    // anything that can be referenced from a descriptor might be in cached bind refs, which could
+    // point to this record. Note it while capturing so those refs can be checked against it
+    switch(ToTypedHandle(obj).type)
+    {
+      case eResDeviceMemory:
+      case eResBuffer:
+      case eResBufferView:
+      case eResImage:
+      case eResImageView:
+      case eResSampler:
+        if(IsActiveCapturing(m_State))
+        {
+          SCOPED_LOCK(m_ReleasedDescriptorResourcesLock);
+          m_ReleasedDescriptorResources.push_back(id);
+        }
+        break;
+      default: break;
+    }
+
     if(record)
     {
       // we need to lock here because the app could be creating
@@ -425,7 +445,7 @@ public:
   void AddDeviceMemory(ResourceId mem);
   void RemoveDeviceMemory(ResourceId mem);
 
-  void MergeReferencedMemory(std::unordered_map<ResourceId, MemRefs> &memRefs);
+  void MergeReferencedMemory(const std::unordered_map<ResourceId, MemRefs> &memRefs);
   void FixupStorageBufferMemory(const std::unordered_set<VkResourceRecord *> &storageBuffers);
   void ClearReferencedMemory();
   MemRefs *FindMemRefs(ResourceId mem);
@@ -448,6 +468,13 @@ public:
 
   bool IsResourceTrackedForPersistency(WrappedVkRes *const &res);
 
+  // resources that could be bound in a descriptor set and have been released while capturing.
+  // Returns true if any released since position is in refs, and moves position to the end
+  bool CheckReleasedDescriptorResources(size_t &position,
+                                        const std::unordered_map<ResourceId, FrameRefType> &refs);
+  size_t GetReleasedDescriptorResourceCount();
+  void ClearReleasedDescriptorResources();
+
 private:
   bool ResourceTypeRelease(WrappedVkRes *res);
 
@@ -464,4 +491,6 @@ private:
   std::set<ResourceId> m_DeviceMemories;
   rdcarray<ResourceId> m_DeadDeviceMemories;
   InitPolicy m_InitPolicy = eInitPolicy_CopyAll;
+  Threading::CriticalSection m_ReleasedDescriptorResourcesLock;
+  rdcarray<ResourceId> m_ReleasedDescriptorResources;
 };
@@ -81,6 +81,10 @@
  *
  * We slot the per frament data correctly accounting for the fragments that were discarded.
  *
+ * When history is requested for several pixels at once, the first four callbacks are shared
+ * between the pixels: each replay records the draws and copies for every pixel an event touched,
+ * scissored to that pixel. Only the discarded fragments callback runs once per pixel.
+ *
  * Current Limitations:
  *
  * - Multiple subpasses
@@ -159,6 +163,7 @@ struct PixelHistoryResources
 {
   VkBuffer dstBuffer;
   VkDeviceMemory bufferMemory;
+  VkDeviceSize bufferSize;
 
   // Used for offscreen rendering for draw call events.
   VkImage colorImage;
@@ -230,6 +235,27 @@ struct PerFragmentInfo
   PixelHistoryValue postMod;
 };
 
+// Per-pixel state carried between the replay passes, each of which is shared between all pixels in
+// a batch.
+struct PixelHistoryPixel
+{
+  uint32_t x = 0;
+  uint32_t y = 0;
+  // Events that could have modified this pixel, found by the occlusion pass.
+  rdcarray<uint32_t> modEvents;
+  // The subset of modEvents that are draws, which get the tests failed pass.
+  rdcarray<uint32_t> drawEvents;
+  rdcarray<PixelModification> history;
+  // Number of fragments for each event that wrote to this pixel.
+  std::map<uint32_t, uint32_t> eventsWithFrags;
+  // Pre-modification values for those events.
+  std::map<uint32_t, ModificationValue> eventPremods;
+  // Depth format bound at each event.
+  std::map<uint32_t, VkFormat> depthFormats;
+  // Test flags for each draw event, from the tests failed pass.
+  std::map<uint32_t, uint32_t> eventFlags;
+};
+
 struct PipelineReplacements
 {
   VkPipeline fixedShaderStencil;
@@ -1432,8 +1458,9 @@ struct VulkanOcclusionCallback : public VulkanPixelHistoryCallback
 {
   VulkanOcclusionCallback(WrappedVulkan *vk, PixelHistoryShaderCache *shaderCache,
                           const PixelHistoryCallbackInfo &callbackInfo, VkQueryPool occlusionPool,
-                          const rdcarray<EventUsage> &allEvents)
-      : VulkanPixelHistoryCallback(vk, shaderCache, callbackInfo, occlusionPool)
+                          const rdcarray<EventUsage> &allEvents,
+                          const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels)
+      : VulkanPixelHistoryCallback(vk, shaderCache, callbackInfo, occlusionPool), m_Pixels(pixels)
   {
     for(size_t i = 0; i < allEvents.size(); i++)
       m_Events.push_back(allEvents[i].eventId);
@@ -1454,15 +1481,26 @@ struct VulkanOcclusionCallback : public VulkanPixelHistoryCallback
 
     VkPipeline pipe = GetPixelOcclusionPipeline(eid, prevState.graphics.pipeline,
                                                 GetColorAttachmentIndex(prevState));
-    // set the scissor
-    for(uint32_t i = 0; i < pipestate.views.size(); i++)
-      ScissorToPixel(pipestate.views[i], pipestate.scissors[i]);
-    // set stencil state (though it's unused here)
-    pipestate.front.compare = pipestate.front.write = 0xff;
-    pipestate.front.ref = 0;
-    pipestate.back = pipestate.front;
-    pipestate.graphics.pipeline = GetResID(pipe);
-    ReplayDrawWithQuery(cmd, eid);
+
+    // the pipeline is shared, and the scissor is dynamic, so each pixel only needs its own draw
+    // and query
+    for(uint32_t p = 0; p < m_Pixels.size(); p++)
+    {
+      pipestate = prevState;
+
+      m_CallbackInfo.x = m_Pixels[p].first;
+      m_CallbackInfo.y = m_Pixels[p].second;
+
+      // set the scissor
+      for(uint32_t i = 0; i < pipestate.views.size(); i++)
+        ScissorToPixel(pipestate.views[i], pipestate.scissors[i]);
+      // set stencil state (though it's unused here)
+      pipestate.front.compare = pipestate.front.write = 0xff;
+      pipestate.front.ref = 0;
+      pipestate.back = pipestate.front;
+      pipestate.graphics.pipeline = GetResID(pipe);
+      ReplayDrawWithQuery(cmd, eid, p);
+    }
 
     m_pDriver->GetCmdRenderState() = prevState;
     m_pDriver->GetCmdRenderState().BindPipeline(m_pDriver, cmd, VulkanRenderState::BindGraphics,
@@ -1505,9 +1543,9 @@ struct VulkanOcclusionCallback : public VulkanPixelHistoryCallback
     m_pDriver->CheckVkResult(vkr);
   }
 
-  uint64_t GetOcclusionResult(uint32_t eventId)
+  uint64_t GetOcclusionResult(uint32_t eventId, uint32_t pixelIndex) const
   {
-    auto it = m_OcclusionQueries.find(eventId);
+    auto it = m_OcclusionQueries.find(make_rdcpair(eventId, pixelIndex));
     if(it == m_OcclusionQueries.end())
       return 0;
     RDCASSERT(it->second < m_OcclusionResults.size());
@@ -1516,8 +1554,8 @@ struct VulkanOcclusionCallback : public VulkanPixelHistoryCallback
 
 private:
   // ReplayDrawWithQuery binds the pipeline in the current state, and replays a single
-  // draw with an occlusion query.
-  void ReplayDrawWithQuery(VkCommandBuffer cmd, uint32_t eventId)
+  // draw with an occlusion query for the given pixel.
+  void ReplayDrawWithQuery(VkCommandBuffer cmd, uint32_t eventId, uint32_t pixelIndex)
   {
     const ActionDescription *action = m_pDriver->GetAction(eventId);
     m_pDriver->GetCmdRenderState().BindPipeline(m_pDriver, cmd, VulkanRenderState::BindGraphics,
@@ -1529,7 +1567,7 @@ private:
     m_pDriver->ReplayDraw(cmd, *action);
 
     ObjDisp(cmd)->CmdEndQuery(Unwrap(cmd), m_OcclusionPool, occlIndex);
-    m_OcclusionQueries.insert(std::make_pair(eventId, occlIndex));
+    m_OcclusionQueries.insert(std::make_pair(make_rdcpair(eventId, pixelIndex), occlIndex));
   }
 
   VkPipeline GetPixelOcclusionPipeline(uint32_t eid, ResourceId pipeline, uint32_t outputIndex)
@@ -1562,8 +1600,9 @@ private:
 private:
   std::map<ResourceId, VkPipeline> m_PipeCache;
   rdcarray<uint32_t> m_Events;
-  // Key is event ID, and value is an index of where the occlusion result.
-  std::map<uint32_t, uint32_t> m_OcclusionQueries;
+  rdcarray<rdcpair<uint32_t, uint32_t>> m_Pixels;
+  // Key is event ID and pixel index, and value is an index of where the occlusion result.
+  std::map<rdcpair<uint32_t, uint32_t>, uint32_t> m_OcclusionQueries;
   rdcarray<uint64_t> m_OcclusionResults;
 };
 
@@ -1571,11 +1610,14 @@ struct VulkanColorAndStencilCallback : public VulkanPixelHistoryCallback
 {
   VulkanColorAndStencilCallback(WrappedVulkan *vk, PixelHistoryShaderCache *shaderCache,
                                 const PixelHistoryCallbackInfo &callbackInfo,
-                                const rdcarray<uint32_t> &events)
+                                const rdcarray<PixelHistoryPixel *> &pixels)
       : VulkanPixelHistoryCallback(vk, shaderCache, callbackInfo, VK_NULL_HANDLE),
-        m_Events(events),
+        m_Pixels(pixels),
         multipleSubpassWarningPrinted(false)
   {
+    m_EventIndices.resize(pixels.size());
+    for(const PixelHistoryPixel *pixel : pixels)
+      m_Events.insert(pixel->modEvents.begin(), pixel->modEvents.end());
   }
 
   ~VulkanColorAndStencilCallback()
@@ -1589,7 +1631,7 @@ struct VulkanColorAndStencilCallback : public VulkanPixelHistoryCallback
 
   void PreDraw(uint32_t eid, VkCommandBuffer cmd)
   {
-    if(!m_Events.contains(eid) || !m_pDriver->IsCmdPrimary())
+    if(!HasEvent(eid) || !m_pDriver->IsCmdPrimary())
       return;
 
     if(HasMultipleSubpasses())
@@ -1602,6 +1644,22 @@ struct VulkanColorAndStencilCallback : public VulkanPixelHistoryCallback
       return;
     }
 
+    // the replay is shared between all pixels, so each pixel this event could have written to gets
+    // its own copies and stencil counting draws scissored to that pixel.
+    for(uint32_t p = 0; p < m_Pixels.size(); p++)
+    {
+      if(!m_Pixels[p]->modEvents.contains(eid))
+        continue;
+
+      m_CallbackInfo.x = m_Pixels[p]->x;
+      m_CallbackInfo.y = m_Pixels[p]->y;
+
+      PixelPreDraw(eid, cmd, GetStoreOffset(eid, p));
+    }
+  }
+
+  void PixelPreDraw(uint32_t eid, VkCommandBuffer cmd, size_t storeOffset)
+  {
     VulkanRenderState prevState = m_pDriver->GetCmdRenderState();
     VulkanRenderState &pipestate = m_pDriver->GetCmdRenderState();
 
@@ -1611,8 +1669,6 @@ struct VulkanColorAndStencilCallback : public VulkanPixelHistoryCallback
     pipestate.FinishSuspendedRenderPass(cmd);
 
     // Get pre-modification values
-    size_t storeOffset = m_EventIndices.size() * sizeof(EventInfo);
-
     CopyPixel(eid, cmd, storeOffset);
 
     {
@@ -1667,7 +1723,7 @@ struct VulkanColorAndStencilCallback : public VulkanPixelHistoryCallback
 
   bool PostDraw(uint32_t eid, VkCommandBuffer cmd)
   {
-    if(!m_Events.contains(eid) || !m_pDriver->IsCmdPrimary())
+    if(!HasEvent(eid) || !m_pDriver->IsCmdPrimary())
       return false;
 
     if(HasMultipleSubpasses())
@@ -1685,15 +1741,12 @@ struct VulkanColorAndStencilCallback : public VulkanPixelHistoryCallback
     // really finished. This will just store as we always patch the load/store ops.
     m_pDriver->GetCmdRenderState().FinishSuspendedRenderPass(cmd);
 
-    size_t storeOffset = m_EventIndices.size() * sizeof(EventInfo);
-
-    CopyPixel(eid, cmd, storeOffset + offsetof(struct EventInfo, postmod));
+    // Get post-modification values
+    CopyPixels(eid, cmd, offsetof(struct EventInfo, postmod));
 
     m_pDriver->GetCmdRenderState().BeginRenderPassAndApplyState(
         m_pDriver, cmd, VulkanRenderState::BindGraphics, true);
 
-    // Get post-modification values
-    m_EventIndices.insert(std::make_pair(eid, m_EventIndices.size()));
     return false;
   }
 
@@ -1705,19 +1758,9 @@ struct VulkanColorAndStencilCallback : public VulkanPixelHistoryCallback
   void PreCmdExecute(uint32_t baseEid, uint32_t secondaryFirst, uint32_t secondaryLast,
                      VkCommandBuffer cmd)
   {
-    uint32_t eventId = 0;
-    if(m_Events.size() == 0)
-      return;
-    for(size_t i = 0; i < m_Events.size(); i++)
-    {
-      // Find the first event in range
-      if(m_Events[i] >= secondaryFirst && m_Events[i] <= secondaryLast)
-      {
-        eventId = m_Events[i];
-        break;
-      }
-    }
-    if(eventId == 0)
+    // Find the first event in range for each pixel
+    rdcarray<uint32_t> eventIds = FindSecondaryEvents(secondaryFirst, secondaryLast, true);
+    if(eventIds.isEmpty())
       return;
 
     if(HasMultipleSubpasses())
@@ -1739,9 +1782,15 @@ struct VulkanColorAndStencilCallback : public VulkanPixelHistoryCallback
     }
 
     // Copy
-    size_t storeOffset = m_EventIndices.size() * sizeof(EventInfo);
-    CopyPixel(eventId, cmd, storeOffset);
-    m_EventIndices.insert(std::make_pair(eventId, m_EventIndices.size()));
+    for(uint32_t p = 0; p < m_Pixels.size(); p++)
+    {
+      if(eventIds[p] == 0)
+        continue;
+
+      m_CallbackInfo.x = m_Pixels[p]->x;
+      m_CallbackInfo.y = m_Pixels[p]->y;
+      CopyPixel(eventIds[p], cmd, GetStoreOffset(eventIds[p], p));
+    }
 
     if(m_pDriver->GetCmdRenderState().ActiveRenderPass())
       m_pDriver->GetCmdRenderState().BeginRenderPassAndApplyState(
@@ -1751,19 +1800,9 @@ struct VulkanColorAndStencilCallback : public VulkanPixelHistoryCallback
   void PostCmdExecute(uint32_t baseEid, uint32_t secondaryFirst, uint32_t secondaryLast,
                       VkCommandBuffer cmd)
   {
-    uint32_t eventId = 0;
-    if(m_Events.size() == 0)
-      return;
-    for(int32_t i = (int32_t)m_Events.size() - 1; i >= 0; i--)
-    {
-      // Find the last event in range.
-      if(m_Events[i] >= secondaryFirst && m_Events[i] <= secondaryLast)
-      {
-        eventId = m_Events[i];
-        break;
-      }
-    }
-    if(eventId == 0)
+    // Find the last event in range for each pixel
+    rdcarray<uint32_t> eventIds = FindSecondaryEvents(secondaryFirst, secondaryLast, false);
+    if(eventIds.isEmpty())
       return;
 
     if(HasMultipleSubpasses())
@@ -1785,18 +1824,16 @@ struct VulkanColorAndStencilCallback : public VulkanPixelHistoryCallback
       m_pDriver->GetCmdRenderState().FinishSuspendedRenderPass(cmd);
     }
 
-    size_t storeOffset = 0;
-    auto it = m_EventIndices.find(eventId);
-    if(it != m_EventIndices.end())
-    {
-      storeOffset = it->second * sizeof(EventInfo);
-    }
-    else
+    for(uint32_t p = 0; p < m_Pixels.size(); p++)
     {
-      storeOffset = m_EventIndices.size() * sizeof(EventInfo);
-      m_EventIndices.insert(std::make_pair(eventId, m_EventIndices.size()));
+      if(eventIds[p] == 0)
+        continue;
+
+      m_CallbackInfo.x = m_Pixels[p]->x;
+      m_CallbackInfo.y = m_Pixels[p]->y;
+      CopyPixel(eventIds[p], cmd,
+                GetStoreOffset(eventIds[p], p) + offsetof(struct EventInfo, postmod));
     }
-    CopyPixel(eventId, cmd, storeOffset + offsetof(struct EventInfo, postmod));
 
     if(m_pDriver->GetCmdRenderState().ActiveRenderPass())
       m_pDriver->GetCmdRenderState().BeginRenderPassAndApplyState(
@@ -1805,24 +1842,21 @@ struct VulkanColorAndStencilCallback : public VulkanPixelHistoryCallback
 
   void PreDispatch(uint32_t eid, VkCommandBuffer cmd)
   {
-    if(!m_Events.contains(eid))
+    if(!HasEvent(eid))
       return;
-    size_t storeOffset = m_EventIndices.size() * sizeof(EventInfo);
-    CopyPixel(eid, cmd, storeOffset);
+    CopyPixels(eid, cmd, 0);
   }
   bool PostDispatch(uint32_t eid, VkCommandBuffer cmd)
   {
-    if(!m_Events.contains(eid))
+    if(!HasEvent(eid))
       return false;
-    size_t storeOffset = m_EventIndices.size() * sizeof(EventInfo);
-    CopyPixel(eid, cmd, storeOffset + offsetof(struct EventInfo, postmod));
-    m_EventIndices.insert(std::make_pair(eid, m_EventIndices.size()));
+    CopyPixels(eid, cmd, offsetof(struct EventInfo, postmod));
     return false;
   }
   void PostRedispatch(uint32_t eid, VkCommandBuffer cmd) {}
   void PreMisc(uint32_t eid, ActionFlags flags, VkCommandBuffer cmd)
   {
-    if(!m_Events.contains(eid))
+    if(!HasEvent(eid))
       return;
     if(HasMultipleSubpasses())
     {
@@ -1837,7 +1871,7 @@ struct VulkanColorAndStencilCallback : public VulkanPixelHistoryCallback
   }
   bool PostMisc(uint32_t eid, ActionFlags flags, VkCommandBuffer cmd)
   {
-    if(!m_Events.contains(eid))
+    if(!HasEvent(eid))
       return false;
     if(HasMultipleSubpasses())
     {
@@ -1878,14 +1912,13 @@ struct VulkanColorAndStencilCallback : public VulkanPixelHistoryCallback
         primary, alias);
   }
 
-  int32_t GetEventIndex(uint32_t eventId)
+  int32_t GetEventIndex(uint32_t eventId, uint32_t pixelIndex)
   {
-    auto it = m_EventIndices.find(eventId);
-    if(it == m_EventIndices.end())
+    auto it = m_EventIndices[pixelIndex].find(eventId);
+    if(it == m_EventIndices[pixelIndex].end())
       // Most likely a secondary command buffer event for which there is no
       // information.
       return -1;
-    RDCASSERT(it != m_EventIndices.end());
     return (int32_t)it->second;
   }
 
@@ -2050,10 +2083,69 @@ private:
     return replacements;
   }
 
+  bool HasEvent(uint32_t eid) const { return m_Events.find(eid) != m_Events.end(); }
+
+  // Returns where the event data for the given event and pixel is stored, allocating the next slot
+  // in the buffer the first time the pair is seen.
+  size_t GetStoreOffset(uint32_t eid, uint32_t pixelIndex)
+  {
+    auto it = m_EventIndices[pixelIndex].find(eid);
+    if(it == m_EventIndices[pixelIndex].end())
+      it = m_EventIndices[pixelIndex].insert(std::make_pair(eid, m_NumEventInfos++)).first;
+    return it->second * sizeof(EventInfo);
+  }
+
+  // Copies the target pixel for every pixel this event could have written to, at the given offset
+  // into each pixel's event data.
+  void CopyPixels(uint32_t eid, VkCommandBuffer cmd, size_t offset)
+  {
+    for(uint32_t p = 0; p < m_Pixels.size(); p++)
+    {
+      if(!m_Pixels[p]->modEvents.contains(eid))
+        continue;
+
+      m_CallbackInfo.x = m_Pixels[p]->x;
+      m_CallbackInfo.y = m_Pixels[p]->y;
+      CopyPixel(eid, cmd, GetStoreOffset(eid, p) + offset);
+    }
+  }
+
+  // For each pixel returns the first (or last) of its events in the given secondary command buffer
+  // range, or 0 if there is none. Returns an empty list if no pixel has an event in the range.
+  rdcarray<uint32_t> FindSecondaryEvents(uint32_t secondaryFirst, uint32_t secondaryLast, bool first)
+  {
+    rdcarray<uint32_t> eventIds;
+    eventIds.resize(m_Pixels.size());
+
+    bool any = false;
+    for(uint32_t p = 0; p < m_Pixels.size(); p++)
+    {
+      const rdcarray<uint32_t> &events = m_Pixels[p]->modEvents;
+      for(size_t i = 0; i < events.size(); i++)
+      {
+        uint32_t eid = first ? events[i] : events[events.size() - 1 - i];
+        if(eid >= secondaryFirst && eid <= secondaryLast)
+        {
+          eventIds[p] = eid;
+          any = true;
+          break;
+        }
+      }
+    }
+
+    if(!any)
+      eventIds.clear();
+    return eventIds;
+  }
+
   std::map<ResourceId, PipelineReplacements> m_PipeCache;
-  rdcarray<uint32_t> m_Events;
-  // Key is event ID, and value is an index of where the event data is stored.
-  std::map<uint32_t, size_t> m_EventIndices;
+  rdcarray<PixelHistoryPixel *> m_Pixels;
+  // All events that any pixel needs information for.
+  std::set<uint32_t> m_Events;
+  // For each pixel, key is event ID, and value is an index of where the event data is stored.
+  rdcarray<std::map<uint32_t, size_t>> m_EventIndices;
+  // Number of event data slots used so far, shared between all pixels.
+  size_t m_NumEventInfos = 0;
   bool multipleSubpassWarningPrinted;
   std::map<uint32_t, VkFormat> m_DepthFormats;
 };
@@ -2064,34 +2156,51 @@ struct TestsFailedCallback : public VulkanPixelHistoryCallback
 {
   TestsFailedCallback(WrappedVulkan *vk, PixelHistoryShaderCache *shaderCache,
                       const PixelHistoryCallbackInfo &callbackInfo, VkQueryPool occlusionPool,
-                      rdcarray<uint32_t> events)
-      : VulkanPixelHistoryCallback(vk, shaderCache, callbackInfo, occlusionPool), m_Events(events)
+                      const rdcarray<PixelHistoryPixel *> &pixels)
+      : VulkanPixelHistoryCallback(vk, shaderCache, callbackInfo, occlusionPool), m_Pixels(pixels)
   {
+    m_EventFlags.resize(pixels.size());
+    m_OcclusionQueries.resize(pixels.size());
+    for(const PixelHistoryPixel *pixel : pixels)
+      m_Events.insert(pixel->drawEvents.begin(), pixel->drawEvents.end());
   }
 
   ~TestsFailedCallback() {}
   void PreDraw(uint32_t eid, VkCommandBuffer cmd)
   {
-    if(!m_Events.contains(eid))
+    if(m_Events.find(eid) == m_Events.end())
       return;
 
-    VulkanRenderState &pipestate = m_pDriver->GetCmdRenderState();
-    const VulkanCreationInfo::Pipeline &p =
-        m_pDriver->GetDebugManager()->GetPipelineInfo(pipestate.graphics.pipeline);
-    uint32_t eventFlags = CalculateEventFlags(p, pipestate);
-    m_EventFlags[eid] = eventFlags;
+    const VulkanCreationInfo::Pipeline &p = m_pDriver->GetDebugManager()->GetPipelineInfo(
+        m_pDriver->GetCmdRenderState().graphics.pipeline);
 
     // TODO: figure out if the shader has early fragments tests turned on,
     // based on the currently bound fragment shader.
     bool earlyFragmentTests = false;
     m_HasEarlyFragments[eid] = earlyFragmentTests;
 
-    ResourceId curPipeline = pipestate.graphics.pipeline;
     VulkanRenderState prevState = m_pDriver->GetCmdRenderState();
+    ResourceId curPipeline = prevState.graphics.pipeline;
+    uint32_t outputIndex = GetColorAttachmentIndex(prevState);
 
-    ReplayDrawWithTests(cmd, eid, eventFlags, curPipeline, GetColorAttachmentIndex(prevState));
+    // the replay is shared between all pixels, so each pixel this draw touched gets its own set of
+    // test draws and queries, scissored to that pixel.
+    for(uint32_t pix = 0; pix < m_Pixels.size(); pix++)
+    {
+      if(!m_Pixels[pix]->drawEvents.contains(eid))
+        continue;
+
+      m_CallbackInfo.x = m_Pixels[pix]->x;
+      m_CallbackInfo.y = m_Pixels[pix]->y;
+
+      uint32_t eventFlags = CalculateEventFlags(p, prevState);
+      m_EventFlags[pix][eid] = eventFlags;
+
+      ReplayDrawWithTests(cmd, eid, pix, eventFlags, curPipeline, outputIndex);
+
+      m_pDriver->GetCmdRenderState() = prevState;
+    }
 
-    m_pDriver->GetCmdRenderState() = prevState;
     m_pDriver->GetCmdRenderState().BindPipeline(m_pDriver, cmd, VulkanRenderState::BindGraphics,
                                                 false);
   }
@@ -2124,20 +2233,26 @@ struct TestsFailedCallback : public VulkanPixelHistoryCallback
   {
   }
   void PreEndCommandBuffer(VkCommandBuffer cmd) {}
-  bool HasEventFlags(uint32_t eventId) { return m_EventFlags.find(eventId) != m_EventFlags.end(); }
-  uint32_t GetEventFlags(uint32_t eventId)
+  const std::map<uint32_t, uint32_t> &GetEventFlags(uint32_t pixelIndex) const
+  {
+    return m_EventFlags[pixelIndex];
+  }
+  uint32_t GetEventFlags(uint32_t eventId, uint32_t pixelIndex) const
   {
-    auto it = m_EventFlags.find(eventId);
-    if(it == m_EventFlags.end())
+    auto it = m_EventFlags[pixelIndex].find(eventId);
+    if(it == m_EventFlags[pixelIndex].end())
+    {
       RDCERR("Can't find event flags for event %u", eventId);
+      return 0;
+    }
     return it->second;
   }
 
   void FetchOcclusionResults()
   {
-    if(m_OcclusionQueries.empty())
+    if(m_NumOcclusionQueries == 0)
       return;
-    m_OcclusionResults.resize(m_OcclusionQueries.size());
+    m_OcclusionResults.resize(m_NumOcclusionQueries);
     VkResult vkr =
         ObjDisp(m_pDriver->GetDev())
             ->GetQueryPoolResults(Unwrap(m_pDriver->GetDev()), m_OcclusionPool, 0,
@@ -2147,11 +2262,15 @@ struct TestsFailedCallback : public VulkanPixelHistoryCallback
     m_pDriver->CheckVkResult(vkr);
   }
 
-  uint64_t GetOcclusionResult(uint32_t eventId, uint32_t test) const
+  uint64_t GetOcclusionResult(uint32_t eventId, uint32_t pixelIndex, uint32_t test) const
   {
-    auto it = m_OcclusionQueries.find(rdcpair<uint32_t, uint32_t>(eventId, test));
-    if(it == m_OcclusionQueries.end())
+    const std::map<rdcpair<uint32_t, uint32_t>, uint32_t> &queries = m_OcclusionQueries[pixelIndex];
+    auto it = queries.find(rdcpair<uint32_t, uint32_t>(eventId, test));
+    if(it == queries.end())
+    {
       RDCERR("Can't locate occlusion query for event id %u and test flags %u", eventId, test);
+      return 0;
+    }
     if(it->second >= m_OcclusionResults.size())
       RDCERR("Event %u, occlusion index is %u, and the total # of occlusion query data %zu",
              eventId, it->second, m_OcclusionResults.size());
@@ -2331,8 +2450,8 @@ private:
     PipelineCreationFlags_IntersectOriginalScissor = 1 << 6,
   };
 
-  void ReplayDrawWithTests(VkCommandBuffer cmd, uint32_t eid, uint32_t eventFlags,
-                           ResourceId basePipeline, uint32_t outputIndex)
+  void ReplayDrawWithTests(VkCommandBuffer cmd, uint32_t eid, uint32_t pixelIndex,
+                           uint32_t eventFlags, ResourceId basePipeline, uint32_t outputIndex)
   {
     // Backface culling
     if(eventFlags & TestMustFail_Culling)
@@ -2369,7 +2488,7 @@ private:
           PipelineCreationFlags_FixedColorShader;
       VkPipeline pipe = CreatePipeline(basePipeline, pipeFlags, replacementShaders, outputIndex);
       VkMarkerRegion::Set(StringFormat::Fmt("Test culling on %u", eid), cmd);
-      ReplayDraw(cmd, pipe, eid, TestEnabled_Culling);
+      ReplayDraw(cmd, pipe, eid, pixelIndex, TestEnabled_Culling);
     }
 
     if(eventFlags & TestEnabled_DepthClipping)
@@ -2379,7 +2498,7 @@ private:
           PipelineCreationFlags_DisableStencilTest | PipelineCreationFlags_FixedColorShader;
       VkPipeline pipe = CreatePipeline(basePipeline, pipeFlags, replacementShaders, outputIndex);
       VkMarkerRegion::Set(StringFormat::Fmt("Test depth clipping on %u", eid), cmd);
-      ReplayDraw(cmd, pipe, eid, TestEnabled_DepthClipping);
+      ReplayDraw(cmd, pipe, eid, pixelIndex, TestEnabled_DepthClipping);
     }
 
     // Scissor
@@ -2398,7 +2517,7 @@ private:
       for(uint32_t i = 0; i < pipestate.views.size(); i++)
         IntersectScissors(prevScissors[i], pipestate.scissors[i]);
       VkMarkerRegion::Set(StringFormat::Fmt("Test scissor on %u", eid), cmd);
-      ReplayDraw(cmd, pipe, eid, TestEnabled_Scissor);
+      ReplayDraw(cmd, pipe, eid, pixelIndex, TestEnabled_Scissor);
     }
 
     // Sample mask
@@ -2412,7 +2531,7 @@ private:
           PipelineCreationFlags_DisableDepthTest | PipelineCreationFlags_FixedColorShader;
       VkPipeline pipe = CreatePipeline(basePipeline, pipeFlags, replacementShaders, outputIndex);
       VkMarkerRegion::Set(StringFormat::Fmt("Test sample mask on %u", eid), cmd);
-      ReplayDraw(cmd, pipe, eid, TestEnabled_SampleMask);
+      ReplayDraw(cmd, pipe, eid, pixelIndex, TestEnabled_SampleMask);
     }
 
     // Depth bounds
@@ -2423,7 +2542,7 @@ private:
                            PipelineCreationFlags_FixedColorShader;
       VkPipeline pipe = CreatePipeline(basePipeline, pipeFlags, replacementShaders, outputIndex);
       VkMarkerRegion::Set(StringFormat::Fmt("Test depth bounds on %u", eid), cmd);
-      ReplayDraw(cmd, pipe, eid, TestEnabled_DepthBounds);
+      ReplayDraw(cmd, pipe, eid, pixelIndex, TestEnabled_DepthBounds);
     }
 
     // Stencil test
@@ -2436,7 +2555,7 @@ private:
           PipelineCreationFlags_DisableDepthTest | PipelineCreationFlags_FixedColorShader;
       VkPipeline pipe = CreatePipeline(basePipeline, pipeFlags, replacementShaders, outputIndex);
       VkMarkerRegion::Set(StringFormat::Fmt("Test stencil on %u", eid), cmd);
-      ReplayDraw(cmd, pipe, eid, TestEnabled_StencilTesting);
+      ReplayDraw(cmd, pipe, eid, pixelIndex, TestEnabled_StencilTesting);
     }
 
     // Depth test
@@ -2452,7 +2571,7 @@ private:
 
       VkPipeline pipe = CreatePipeline(basePipeline, pipeFlags, replacementShaders, outputIndex);
       VkMarkerRegion::Set(StringFormat::Fmt("Test depth on %u", eid), cmd);
-      ReplayDraw(cmd, pipe, eid, TestEnabled_DepthTesting);
+      ReplayDraw(cmd, pipe, eid, pixelIndex, TestEnabled_DepthTesting);
     }
 
     // Shader discard
@@ -2466,7 +2585,7 @@ private:
                            PipelineCreationFlags_DisableDepthTest;
       VkPipeline pipe = CreatePipeline(basePipeline, pipeFlags, replacementShaders, outputIndex);
       VkMarkerRegion::Set(StringFormat::Fmt("Test shader discard on %u", eid), cmd);
-      ReplayDraw(cmd, pipe, eid, TestEnabled_FragmentDiscard);
+      ReplayDraw(cmd, pipe, eid, pixelIndex, TestEnabled_FragmentDiscard);
     }
   }
 
@@ -2552,16 +2671,18 @@ private:
     return pipe;
   }
 
-  void ReplayDraw(VkCommandBuffer cmd, VkPipeline pipe, int eventId, uint32_t test)
+  void ReplayDraw(VkCommandBuffer cmd, VkPipeline pipe, int eventId, uint32_t pixelIndex,
+                  uint32_t test)
   {
     m_pDriver->GetCmdRenderState().graphics.pipeline = GetResID(pipe);
     m_pDriver->GetCmdRenderState().BindPipeline(m_pDriver, cmd, VulkanRenderState::BindGraphics,
                                                 false);
 
-    uint32_t index = (uint32_t)m_OcclusionQueries.size();
-    if(m_OcclusionQueries.find(rdcpair<uint32_t, uint32_t>(eventId, test)) != m_OcclusionQueries.end())
+    std::map<rdcpair<uint32_t, uint32_t>, uint32_t> &queries = m_OcclusionQueries[pixelIndex];
+    uint32_t index = m_NumOcclusionQueries++;
+    if(queries.find(rdcpair<uint32_t, uint32_t>(eventId, test)) != queries.end())
       RDCERR("A query already exist for event id %u and test %u", eventId, test);
-    m_OcclusionQueries.insert(std::make_pair(rdcpair<uint32_t, uint32_t>(eventId, test), index));
+    queries.insert(std::make_pair(rdcpair<uint32_t, uint32_t>(eventId, test), index));
 
     ObjDisp(cmd)->CmdBeginQuery(Unwrap(cmd), m_OcclusionPool, index, m_QueryFlags);
 
@@ -2571,14 +2692,17 @@ private:
     ObjDisp(cmd)->CmdEndQuery(Unwrap(cmd), m_OcclusionPool, index);
   }
 
-  rdcarray<uint32_t> m_Events;
-  // Key is event ID, value is the flags for that event.
-  std::map<uint32_t, uint32_t> m_EventFlags;
+  rdcarray<PixelHistoryPixel *> m_Pixels;
+  // All draw events that any pixel needs tests for.
+  std::set<uint32_t> m_Events;
+  // For each pixel, key is event ID, value is the flags for that event.
+  rdcarray<std::map<uint32_t, uint32_t>> m_EventFlags;
   // Key is a pair <Base pipeline, pipeline flags>
   std::map<rdcpair<ResourceId, uint32_t>, VkPipeline> m_PipeCache;
-  // Key: pair <event ID, test>
+  // For each pixel, key: pair <event ID, test>
   // value: the index where occlusion query is in m_OcclusionResults
-  std::map<rdcpair<uint32_t, uint32_t>, uint32_t> m_OcclusionQueries;
+  rdcarray<std::map<rdcpair<uint32_t, uint32_t>, uint32_t>> m_OcclusionQueries;
+  uint32_t m_NumOcclusionQueries = 0;
   std::map<uint32_t, bool> m_HasEarlyFragments;
   rdcarray<uint64_t> m_OcclusionResults;
 };
@@ -2588,11 +2712,8 @@ struct VulkanPixelHistoryPerFragmentCallback : VulkanPixelHistoryCallback
 {
   VulkanPixelHistoryPerFragmentCallback(WrappedVulkan *vk, PixelHistoryShaderCache *shaderCache,
                                         const PixelHistoryCallbackInfo &callbackInfo,
-                                        const std::map<uint32_t, uint32_t> &eventFragments,
-                                        const std::map<uint32_t, ModificationValue> &eventPremods)
-      : VulkanPixelHistoryCallback(vk, shaderCache, callbackInfo, VK_NULL_HANDLE),
-        m_EventFragments(eventFragments),
-        m_EventPremods(eventPremods)
+                                        const rdcarray<PixelHistoryPixel *> &pixels)
+      : VulkanPixelHistoryCallback(vk, shaderCache, callbackInfo, VK_NULL_HANDLE), m_Pixels(pixels)
   {
   }
 
@@ -2615,9 +2736,24 @@ struct VulkanPixelHistoryPerFragmentCallback : VulkanPixelHistoryCallback
 
   void PreDraw(uint32_t eid, VkCommandBuffer cmd)
   {
-    if(m_EventFragments.find(eid) == m_EventFragments.end())
-      return;
+    // the replay is shared between all pixels, so each pixel with fragments from this event gets
+    // its own set of draws scissored to that pixel.
+    for(uint32_t p = 0; p < m_Pixels.size(); p++)
+    {
+      auto it = m_Pixels[p]->eventsWithFrags.find(eid);
+      if(it == m_Pixels[p]->eventsWithFrags.end())
+        continue;
 
+      m_CallbackInfo.x = m_Pixels[p]->x;
+      m_CallbackInfo.y = m_Pixels[p]->y;
+
+      PixelPreDraw(eid, cmd, p, it->second, m_Pixels[p]->eventPremods[eid]);
+    }
+  }
+
+  void PixelPreDraw(uint32_t eid, VkCommandBuffer cmd, uint32_t pixelIndex,
+                    uint32_t numFragmentsInEvent, const ModificationValue &premod)
+  {
     VulkanRenderState prevState = m_pDriver->GetCmdRenderState();
     VulkanRenderState &state = m_pDriver->GetCmdRenderState();
     ResourceId curPipeline = state.graphics.pipeline;
@@ -2626,8 +2762,6 @@ struct VulkanPixelHistoryPerFragmentCallback : VulkanPixelHistoryCallback
     // really finished. This will just store as we always patch the load/store ops.
     state.FinishSuspendedRenderPass(cmd);
 
-    uint32_t numFragmentsInEvent = m_EventFragments[eid];
-
     uint32_t framebufferIndex = 0;
     uint32_t colorOutputIndex = GetColorAttachmentIndex(prevState, &framebufferIndex);
 
@@ -2860,7 +2994,6 @@ struct VulkanPixelHistoryPerFragmentCallback : VulkanPixelHistoryCallback
         GetResID(m_CallbackInfo.targetImage), aspect, m_CallbackInfo.targetSubresource.mip,
         m_CallbackInfo.targetSubresource.slice);
 
-    const ModificationValue &premod = m_EventPremods[eid];
     // For every fragment except the last one, retrieve post-modification
     // value.
     for(uint32_t f = 0; f < numFragmentsInEvent - 1; f++)
@@ -2924,7 +3057,7 @@ struct VulkanPixelHistoryPerFragmentCallback : VulkanPixelHistoryCallback
       }
     }
 
-    m_EventIndices[eid] = fragsProcessed;
+    m_EventIndices[make_rdcpair(eid, pixelIndex)] = fragsProcessed;
     fragsProcessed += numFragmentsInEvent;
 
     m_pDriver->GetCmdRenderState() = prevState;
@@ -3149,21 +3282,19 @@ struct VulkanPixelHistoryPerFragmentCallback : VulkanPixelHistoryCallback
   {
   }
 
-  uint32_t GetEventOffset(uint32_t eid)
+  uint32_t GetEventOffset(uint32_t eid, uint32_t pixelIndex)
   {
-    auto it = m_EventIndices.find(eid);
+    auto it = m_EventIndices.find(make_rdcpair(eid, pixelIndex));
     RDCASSERT(it != m_EventIndices.end());
     return it->second;
   }
 
 private:
-  // For each event, specifies where the occlusion query results start.
-  std::map<uint32_t, uint32_t> m_EventIndices;
-  // Number of fragments for each event.
-  std::map<uint32_t, uint32_t> m_EventFragments;
-  // Pre-modification values for events to initialize attachments to,
-  // so that we can get blended post-modification values.
-  std::map<uint32_t, ModificationValue> m_EventPremods;
+  // For each event and pixel index, specifies where the per-fragment results start.
+  std::map<rdcpair<uint32_t, uint32_t>, uint32_t> m_EventIndices;
+  // The pixels to replay, with the number of fragments and the pre-modification values for each
+  // event, to initialize attachments to so that we can get blended post-modification values.
+  rdcarray<PixelHistoryPixel *> m_Pixels;
   // Number of fragments processed so far.
   uint32_t fragsProcessed = 0;
 
@@ -3469,6 +3600,7 @@ bool VulkanDebugManager::PixelHistorySetupResources(PixelHistoryResources &resou
   resources.gpuMem = gpuMem;
 
   resources.bufferMemory = bufferMemory;
+  resources.bufferSize = bufferInfo.size;
   resources.dstBuffer = dstBuffer;
 
   return true;
@@ -3558,18 +3690,9 @@ bool VulkanDebugManager::PixelHistoryDestroyResources(const PixelHistoryResource
   return true;
 }
 
-void CreateOcclusionPool(WrappedVulkan *vk, uint32_t poolSize, VkQueryPool *pQueryPool)
+void ResetOcclusionPool(WrappedVulkan *vk, VkQueryPool queryPool, uint32_t poolSize)
 {
-  VkMarkerRegion region(StringFormat::Fmt("CreateOcclusionPool %u", poolSize));
-
   VkDevice dev = vk->GetDev();
-  VkQueryPoolCreateInfo occlusionPoolCreateInfo = {VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
-  occlusionPoolCreateInfo.queryType = VK_QUERY_TYPE_OCCLUSION;
-  occlusionPoolCreateInfo.queryCount = poolSize;
-  // TODO: check that occlusion feature is available
-  VkResult vkr =
-      ObjDisp(dev)->CreateQueryPool(Unwrap(dev), &occlusionPoolCreateInfo, NULL, pQueryPool);
-  vk->CheckVkResult(vkr);
   VkCommandBuffer cmd = vk->GetNextCmd();
   VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
                                         VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
@@ -3577,15 +3700,31 @@ void CreateOcclusionPool(WrappedVulkan *vk, uint32_t poolSize, VkQueryPool *pQue
   if(cmd == VK_NULL_HANDLE)
     return;
 
-  vkr = ObjDisp(dev)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+  VkResult vkr = ObjDisp(dev)->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
   vk->CheckVkResult(vkr);
-  ObjDisp(dev)->CmdResetQueryPool(Unwrap(cmd), *pQueryPool, 0, poolSize);
+  ObjDisp(dev)->CmdResetQueryPool(Unwrap(cmd), queryPool, 0, poolSize);
   vkr = ObjDisp(dev)->EndCommandBuffer(Unwrap(cmd));
   vk->CheckVkResult(vkr);
   vk->SubmitCmds();
   vk->FlushQ();
 }
 
+void CreateOcclusionPool(WrappedVulkan *vk, uint32_t poolSize, VkQueryPool *pQueryPool)
+{
+  VkMarkerRegion region(StringFormat::Fmt("CreateOcclusionPool %u", poolSize));
+
+  VkDevice dev = vk->GetDev();
+  VkQueryPoolCreateInfo occlusionPoolCreateInfo = {VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+  occlusionPoolCreateInfo.queryType = VK_QUERY_TYPE_OCCLUSION;
+  occlusionPoolCreateInfo.queryCount = poolSize;
+  // TODO: check that occlusion feature is available
+  VkResult vkr =
+      ObjDisp(dev)->CreateQueryPool(Unwrap(dev), &occlusionPoolCreateInfo, NULL, pQueryPool);
+  vk->CheckVkResult(vkr);
+
+  ResetOcclusionPool(vk, *pQueryPool, poolSize);
+}
+
 VkImageLayout VulkanDebugManager::GetImageLayout(ResourceId image, VkImageAspectFlagBits aspect,
                                                  uint32_t mip, uint32_t slice)
 {
@@ -3608,14 +3747,14 @@ VkImageLayout VulkanDebugManager::GetImageLayout(ResourceId image, VkImageAspect
   return ret;
 }
 
-void UpdateTestsFailed(const TestsFailedCallback *tfCb, uint32_t eventId, uint32_t eventFlags,
-                       PixelModification &mod)
+void UpdateTestsFailed(const TestsFailedCallback *tfCb, uint32_t pixelIndex, uint32_t eventId,
+                       uint32_t eventFlags, PixelModification &mod)
 {
   bool earlyFragmentTests = tfCb->HasEarlyFragments(eventId);
 
   if((eventFlags & (TestEnabled_Culling | TestMustFail_Culling)) == TestEnabled_Culling)
   {
-    uint64_t occlData = tfCb->GetOcclusionResult(eventId, TestEnabled_Culling);
+    uint64_t occlData = tfCb->GetOcclusionResult(eventId, pixelIndex, TestEnabled_Culling);
     mod.backfaceCulled = (occlData == 0);
   }
 
@@ -3624,7 +3763,7 @@ void UpdateTestsFailed(const TestsFailedCallback *tfCb, uint32_t eventId, uint32
 
   if(eventFlags & TestEnabled_DepthClipping)
   {
-    uint64_t occlData = tfCb->GetOcclusionResult(eventId, TestEnabled_DepthClipping);
+    uint64_t occlData = tfCb->GetOcclusionResult(eventId, pixelIndex, TestEnabled_DepthClipping);
     mod.depthClipped = (occlData == 0);
   }
 
@@ -3634,7 +3773,7 @@ void UpdateTestsFailed(const TestsFailedCallback *tfCb, uint32_t eventId, uint32
   if((eventFlags & (TestEnabled_Scissor | TestMustPass_Scissor | TestMustFail_Scissor)) ==
      TestEnabled_Scissor)
   {
-    uint64_t occlData = tfCb->GetOcclusionResult(eventId, TestEnabled_Scissor);
+    uint64_t occlData = tfCb->GetOcclusionResult(eventId, pixelIndex, TestEnabled_Scissor);
     mod.scissorClipped = (occlData == 0);
   }
   if(mod.scissorClipped)
@@ -3644,7 +3783,7 @@ void UpdateTestsFailed(const TestsFailedCallback *tfCb, uint32_t eventId, uint32
 
   if((eventFlags & (TestEnabled_SampleMask | TestMustFail_SampleMask)) == TestEnabled_SampleMask)
   {
-    uint64_t occlData = tfCb->GetOcclusionResult(eventId, TestEnabled_SampleMask);
+    uint64_t occlData = tfCb->GetOcclusionResult(eventId, pixelIndex, TestEnabled_SampleMask);
     mod.sampleMasked = (occlData == 0);
   }
   if(mod.sampleMasked)
@@ -3653,7 +3792,7 @@ void UpdateTestsFailed(const TestsFailedCallback *tfCb, uint32_t eventId, uint32
   // Shader discard with default fragment tests order.
   if(!earlyFragmentTests)
   {
-    uint64_t occlData = tfCb->GetOcclusionResult(eventId, TestEnabled_FragmentDiscard);
+    uint64_t occlData = tfCb->GetOcclusionResult(eventId, pixelIndex, TestEnabled_FragmentDiscard);
     mod.shaderDiscarded = (occlData == 0);
     if(mod.shaderDiscarded)
       return;
@@ -3661,7 +3800,7 @@ void UpdateTestsFailed(const TestsFailedCallback *tfCb, uint32_t eventId, uint32
 
   if(eventFlags & TestEnabled_DepthBounds)
   {
-    uint64_t occlData = tfCb->GetOcclusionResult(eventId, TestEnabled_DepthBounds);
+    uint64_t occlData = tfCb->GetOcclusionResult(eventId, pixelIndex, TestEnabled_DepthBounds);
     mod.depthBoundsFailed = (occlData == 0);
   }
   if(mod.depthBoundsFailed)
@@ -3670,7 +3809,7 @@ void UpdateTestsFailed(const TestsFailedCallback *tfCb, uint32_t eventId, uint32
   if((eventFlags & (TestEnabled_StencilTesting | TestMustFail_StencilTesting)) ==
      TestEnabled_StencilTesting)
   {
-    uint64_t occlData = tfCb->GetOcclusionResult(eventId, TestEnabled_StencilTesting);
+    uint64_t occlData = tfCb->GetOcclusionResult(eventId, pixelIndex, TestEnabled_StencilTesting);
     mod.stencilTestFailed = (occlData == 0);
   }
   if(mod.stencilTestFailed)
@@ -3678,7 +3817,7 @@ void UpdateTestsFailed(const TestsFailedCallback *tfCb, uint32_t eventId, uint32
 
   if((eventFlags & (TestEnabled_DepthTesting | TestMustFail_DepthTesting)) == TestEnabled_DepthTesting)
   {
-    uint64_t occlData = tfCb->GetOcclusionResult(eventId, TestEnabled_DepthTesting);
+    uint64_t occlData = tfCb->GetOcclusionResult(eventId, pixelIndex, TestEnabled_DepthTesting);
     mod.depthTestFailed = (occlData == 0);
   }
   if(mod.depthTestFailed)
@@ -3687,7 +3826,7 @@ void UpdateTestsFailed(const TestsFailedCallback *tfCb, uint32_t eventId, uint32
   // Shader discard with early fragment tests order.
   if(earlyFragmentTests)
   {
-    uint64_t occlData = tfCb->GetOcclusionResult(eventId, TestEnabled_FragmentDiscard);
+    uint64_t occlData = tfCb->GetOcclusionResult(eventId, pixelIndex, TestEnabled_FragmentDiscard);
     mod.shaderDiscarded = (occlData == 0);
   }
 }
@@ -3708,18 +3847,47 @@ rdcarray<PixelModification> VulkanReplay::PixelHistory(rdcarray<EventUsage> even
                                                        ResourceId target, uint32_t x, uint32_t y,
                                                        const Subresource &sub, CompType typeCast)
 {
-  rdcarray<PixelModification> history;
+  rdcarray<PixelHistoryResult> history =
+      PixelHistoryBatch(events, target, {make_rdcpair(x, y)}, sub, typeCast);
 
-  if(events.empty())
+  if(history.empty())
+    return {};
+
+  return history[0].modifications;
+}
+
+rdcarray<PixelHistoryResult> VulkanReplay::PixelHistoryBatch(
+    rdcarray<EventUsage> events, ResourceId target,
+    const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels, const Subresource &sub, CompType typeCast)
+{
+  rdcarray<PixelHistoryResult> history;
+  history.resize(pixels.size());
+  for(size_t p = 0; p < pixels.size(); p++)
+  {
+    history[p].x = pixels[p].first;
+    history[p].y = pixels[p].second;
+  }
+
+  if(events.empty() || pixels.empty())
     return history;
 
   const VulkanCreationInfo::Image &imginfo = GetDebugManager()->GetImageInfo(target);
   if(imginfo.format == VK_FORMAT_UNDEFINED)
     return history;
 
+  // the occlusion pass needs one query per event per pixel, so pixels are processed in chunks to
+  // keep the query pool bounded. A single pixel always needs one query per event however many
+  // events there are, so with more events than the bound pixels are processed one at a time.
+  const size_t maxOcclusionQueries = 4096;
+  const size_t chunkSize =
+      RDCMAX((size_t)1, RDCMIN(pixels.size(), maxOcclusionQueries / events.size()));
+  const uint32_t poolSize = uint32_t(events.size() * chunkSize);
+
   rdcstr regionName = StringFormat::Fmt(
-      "PixelHistory: pixel: (%u, %u) on %s subresource (%u, %u, %u) cast to %s with %zu events", x, y,
-      ToStr(target).c_str(), sub.mip, sub.slice, sub.sample, ToStr(typeCast).c_str(), events.size());
+      "PixelHistory: %zu pixel(s) from (%u, %u) on %s subresource (%u, %u, %u) cast to %s with %zu "
+      "events",
+      pixels.size(), pixels[0].first, pixels[0].second, ToStr(target).c_str(), sub.mip, sub.slice,
+      sub.sample, ToStr(typeCast).c_str(), events.size());
 
   RDCDEBUG("%s", regionName.c_str());
 
@@ -3742,9 +3910,11 @@ rdcarray<PixelModification> VulkanReplay::PixelHistory(rdcarray<EventUsage> even
   if(sampleIdx == ~0U || !multisampled)
     sampleIdx = 0;
 
+  // everything below is shared between all pixels in the batch - only the callback info's pixel
+  // co-ordinates change.
   VkDevice dev = m_pDriver->GetDev();
   VkQueryPool occlusionPool;
-  CreateOcclusionPool(m_pDriver, (uint32_t)events.size(), &occlusionPool);
+  CreateOcclusionPool(m_pDriver, poolSize, &occlusionPool);
 
   PixelHistoryResources resources = {};
   // TODO: perhaps should do this after making an occlusion query, since we will
@@ -3764,8 +3934,8 @@ rdcarray<PixelModification> VulkanReplay::PixelHistory(rdcarray<EventUsage> even
   callbackInfo.samples = imginfo.samples;
   callbackInfo.extent = imginfo.extent;
   callbackInfo.targetSubresource = sub;
-  callbackInfo.x = x;
-  callbackInfo.y = y;
+  callbackInfo.x = pixels[0].first;
+  callbackInfo.y = pixels[0].second;
   callbackInfo.sampleMask = sampleMask;
   callbackInfo.subImage = resources.colorImage;
   callbackInfo.subImageView = resources.colorImageView;
@@ -3774,19 +3944,63 @@ rdcarray<PixelModification> VulkanReplay::PixelHistory(rdcarray<EventUsage> even
   callbackInfo.dsImageView = resources.dsImageView;
   callbackInfo.dstBuffer = resources.dstBuffer;
 
-  VulkanOcclusionCallback occlCb(m_pDriver, shaderCache, callbackInfo, occlusionPool, events);
+  for(size_t chunkStart = 0; chunkStart < pixels.size(); chunkStart += chunkSize)
   {
-    VkMarkerRegion occlRegion("VulkanOcclusionCallback");
-    m_pDriver->ReplayLog(0, events.back().eventId, eReplay_Full);
-    m_pDriver->SubmitCmds();
-    m_pDriver->FlushQ();
-    occlCb.FetchOcclusionResults();
+    rdcarray<rdcpair<uint32_t, uint32_t>> chunk;
+    chunk.assign(pixels.data() + chunkStart, RDCMIN(chunkSize, pixels.size() - chunkStart));
+
+    if(chunkStart > 0)
+      ResetOcclusionPool(m_pDriver, occlusionPool, poolSize);
+
+    rdcarray<PixelHistoryPixel> chunkPixels;
+    chunkPixels.resize(chunk.size());
+
+    // the occlusion pass is done for every pixel in the chunk at once, with one query per event
+    // per pixel. This is also where most events are culled, so the later passes for each pixel
+    // only touch events that actually wrote to that pixel.
+    {
+      VulkanOcclusionCallback occlCb(m_pDriver, shaderCache, callbackInfo, occlusionPool, events,
+                                     chunk);
+      {
+        VkMarkerRegion occlRegion("VulkanOcclusionCallback");
+        m_pDriver->ReplayLog(0, events.back().eventId, eReplay_Full);
+        m_pDriver->SubmitCmds();
+        m_pDriver->FlushQ();
+        occlCb.FetchOcclusionResults();
+      }
+
+      for(uint32_t p = 0; p < chunk.size(); p++)
+      {
+        chunkPixels[p].x = chunk[p].first;
+        chunkPixels[p].y = chunk[p].second;
+
+        PixelHistoryGatherEvents(events, sub, occlCb, p, chunkPixels[p]);
+      }
+    }
+
+    // the colour and tests passes, then the per-fragment pass, are shared between all pixels in
+    // the chunk
+    PixelHistoryColorAndTests(events, resources, shaderCache, callbackInfo, chunkPixels);
+    PixelHistoryPerFragment(resources, shaderCache, callbackInfo, chunkPixels);
+
+    for(size_t p = 0; p < chunkPixels.size(); p++)
+      history[chunkStart + p].modifications.swap(chunkPixels[p].history);
   }
 
+  GetDebugManager()->PixelHistoryDestroyResources(resources);
+  ObjDisp(dev)->DestroyQueryPool(Unwrap(dev), occlusionPool, NULL);
+  delete shaderCache;
+
+  return history;
+}
+
+void VulkanReplay::PixelHistoryGatherEvents(const rdcarray<EventUsage> &events,
+                                            const Subresource &sub,
+                                            const VulkanOcclusionCallback &occlCb,
+                                            uint32_t pixelIndex, PixelHistoryPixel &pixel)
+{
   // Gather all draw events that could have written to pixel for another replay pass,
   // to determine if these draws failed for some reason (for ex., depth test).
-  rdcarray<uint32_t> modEvents;
-  rdcarray<uint32_t> drawEvents;
   for(size_t ev = 0; ev < events.size(); ev++)
   {
     bool clear = (events[ev].usage == ResourceUsage::Clear);
@@ -3808,332 +4022,443 @@ rdcarray<PixelModification> VulkanReplay::PixelHistory(rdcarray<EventUsage> even
 
     if(directWrite || clear)
     {
-      modEvents.push_back(events[ev].eventId);
+      pixel.modEvents.push_back(events[ev].eventId);
     }
     else
     {
-      uint64_t occlData = occlCb.GetOcclusionResult((uint32_t)events[ev].eventId);
-      VkMarkerRegion::Set(StringFormat::Fmt("%u has occl %llu", events[ev].eventId, occlData));
+      uint64_t occlData = occlCb.GetOcclusionResult((uint32_t)events[ev].eventId, pixelIndex);
+      VkMarkerRegion::Set(StringFormat::Fmt("%u has occl %llu at (%u, %u)", events[ev].eventId,
+                                            occlData, pixel.x, pixel.y));
       if(occlData > 0)
       {
-        drawEvents.push_back(events[ev].eventId);
-        modEvents.push_back(events[ev].eventId);
+        pixel.drawEvents.push_back(events[ev].eventId);
+        pixel.modEvents.push_back(events[ev].eventId);
       }
     }
   }
+}
 
-  VulkanColorAndStencilCallback cb(m_pDriver, shaderCache, callbackInfo, modEvents);
-  {
-    VkMarkerRegion colorStencilRegion("VulkanColorAndStencilCallback");
-    m_pDriver->ReplayLog(0, events.back().eventId, eReplay_Full);
-    m_pDriver->SubmitCmds();
-    m_pDriver->FlushQ();
-  }
+void VulkanReplay::PixelHistoryColorAndTests(const rdcarray<EventUsage> &events,
+                                             const PixelHistoryResources &resources,
+                                             PixelHistoryShaderCache *shaderCache,
+                                             const PixelHistoryCallbackInfo &callbackInfo,
+                                             rdcarray<PixelHistoryPixel> &pixels)
+{
+  VkDevice dev = m_pDriver->GetDev();
 
-  // If there are any draw events, do another replay pass, in order to figure out
-  // which tests failed for each draw event.
-  TestsFailedCallback *tfCb = NULL;
-  if(drawEvents.size() > 0)
-  {
-    VkMarkerRegion testsRegion("TestsFailedCallback");
-    VkQueryPool tfOcclusionPool;
-    CreateOcclusionPool(m_pDriver, (uint32_t)drawEvents.size() * 6, &tfOcclusionPool);
-
-    tfCb = new TestsFailedCallback(m_pDriver, shaderCache, callbackInfo, tfOcclusionPool, drawEvents);
-    m_pDriver->ReplayLog(0, events.back().eventId, eReplay_Full);
-    m_pDriver->SubmitCmds();
-    m_pDriver->FlushQ();
-    tfCb->FetchOcclusionResults();
-    ObjDisp(dev)->DestroyQueryPool(Unwrap(dev), tfOcclusionPool, NULL);
-  }
+  bool multisampled = (callbackInfo.samples > 1);
 
-  for(size_t ev = 0; ev < events.size(); ev++)
-  {
-    uint32_t eventId = events[ev].eventId;
-    bool clear = (events[ev].usage == ResourceUsage::Clear);
-    bool directWrite = isDirectWrite(events[ev].usage);
+  ResourceFormat fmt = MakeResourceFormat(callbackInfo.targetImageFormat);
 
-    if(drawEvents.contains(events[ev].eventId) || clear || directWrite)
+  // the readback buffer holds one EventInfo per event, so a single pixel always fits
+  const size_t maxEventInfos = size_t(resources.bufferSize / sizeof(EventInfo));
+
+  size_t p = 0;
+  while(p < pixels.size())
+  {
+    // gather as many pixels as have their event data fit in the readback buffer into one replay.
+    // Pixels that nothing touched don't need to be replayed at all.
+    rdcarray<PixelHistoryPixel *> group;
+    size_t groupEvents = 0;
+    size_t groupDraws = 0;
+    for(; p < pixels.size(); p++)
     {
-      PixelModification mod;
-      RDCEraseEl(mod);
+      if(pixels[p].modEvents.empty())
+        continue;
 
-      mod.eventId = eventId;
-      mod.directShaderWrite = directWrite;
-      mod.unboundPS = false;
+      if(!group.empty() && groupEvents + pixels[p].modEvents.size() > maxEventInfos)
+        break;
 
-      if(!clear && !directWrite)
-      {
-        RDCASSERT(tfCb != NULL);
-        uint32_t flags = tfCb->GetEventFlags(eventId);
-        VkMarkerRegion::Set(StringFormat::Fmt("%u has flags %x", eventId, flags));
-        if(flags & TestMustFail_Culling)
-          mod.backfaceCulled = true;
-        if(flags & TestMustFail_DepthTesting)
-          mod.depthTestFailed = true;
-        if(flags & TestMustFail_Scissor)
-          mod.scissorClipped = true;
-        if(flags & TestMustFail_SampleMask)
-          mod.sampleMasked = true;
-        if(flags & UnboundFragmentShader)
-          mod.unboundPS = true;
-
-        UpdateTestsFailed(tfCb, eventId, flags, mod);
-      }
-      history.push_back(mod);
+      group.push_back(&pixels[p]);
+      groupEvents += pixels[p].modEvents.size();
+      groupDraws += pixels[p].drawEvents.size();
     }
-  }
 
-  // Try to read memory back
+    if(group.empty())
+      break;
 
-  EventInfo *eventsInfo;
-  VkResult vkr =
-      m_pDriver->vkMapMemory(dev, resources.bufferMemory, 0, VK_WHOLE_SIZE, 0, (void **)&eventsInfo);
-  CheckVkResult(vkr);
-  if(vkr != VK_SUCCESS)
-    return history;
-  if(!eventsInfo)
-  {
-    RDCERR("Manually reporting failed memory map");
-    CheckVkResult(VK_ERROR_MEMORY_MAP_FAILED);
-    return history;
-  }
+    VkMarkerRegion region(StringFormat::Fmt("PixelHistory for %zu pixels from (%u, %u)",
+                                            group.size(), group[0]->x, group[0]->y));
 
-  std::map<uint32_t, uint32_t> eventsWithFrags;
-  std::map<uint32_t, ModificationValue> eventPremods;
-  ResourceFormat fmt = MakeResourceFormat(imginfo.format);
-
-  for(size_t h = 0; h < history.size();)
-  {
-    PixelModification &mod = history[h];
-
-    int32_t eventIndex = cb.GetEventIndex(mod.eventId);
-    if(eventIndex == -1)
+    VulkanColorAndStencilCallback cb(m_pDriver, shaderCache, callbackInfo, group);
     {
-      // There is no information, skip the event.
-      mod.preMod.SetInvalid();
-      mod.postMod.SetInvalid();
-      mod.shaderOut.SetInvalid();
-      h++;
-      continue;
+      VkMarkerRegion colorStencilRegion("VulkanColorAndStencilCallback");
+      m_pDriver->ReplayLog(0, events.back().eventId, eReplay_Full);
+      m_pDriver->SubmitCmds();
+      m_pDriver->FlushQ();
     }
-    const EventInfo &ei = eventsInfo[eventIndex];
-    FillInColor(fmt, ei.premod, mod.preMod);
-    FillInColor(fmt, ei.postmod, mod.postMod);
-    VkFormat depthFormat = cb.GetDepthFormat(mod.eventId);
-    if(depthFormat != VK_FORMAT_UNDEFINED)
+
+    // If there are any draw events, do another replay pass, in order to figure out
+    // which tests failed for each draw event.
+    TestsFailedCallback *tfCb = NULL;
+    if(groupDraws > 0)
     {
-      mod.preMod.stencil = ei.premod.stencil;
-      mod.postMod.stencil = ei.postmod.stencil;
-      if(multisampled)
-      {
-        mod.preMod.depth = ei.premod.depth.fdepth;
-        mod.postMod.depth = ei.postmod.depth.fdepth;
-      }
-      else
-      {
-        mod.preMod.depth = GetDepthValue(depthFormat, ei.premod);
-        mod.postMod.depth = GetDepthValue(depthFormat, ei.postmod);
-      }
+      VkMarkerRegion testsRegion("TestsFailedCallback");
+      VkQueryPool tfOcclusionPool;
+      CreateOcclusionPool(m_pDriver, (uint32_t)groupDraws * 6, &tfOcclusionPool);
+
+      tfCb = new TestsFailedCallback(m_pDriver, shaderCache, callbackInfo, tfOcclusionPool, group);
+      m_pDriver->ReplayLog(0, events.back().eventId, eReplay_Full);
+      m_pDriver->SubmitCmds();
+      m_pDriver->FlushQ();
+      tfCb->FetchOcclusionResults();
+      ObjDisp(dev)->DestroyQueryPool(Unwrap(dev), tfOcclusionPool, NULL);
     }
 
-    int32_t frags = int32_t(ei.dsWithoutShaderDiscard[4]);
-    int32_t fragsClipped = int32_t(ei.dsWithShaderDiscard[4]);
-    mod.shaderOut.col.intValue[0] = frags;
-    mod.shaderOut.col.intValue[1] = fragsClipped;
-    bool someFragsClipped = (fragsClipped < frags);
-    mod.primitiveID = someFragsClipped;
-    // Draws in secondary command buffers will fail this check,
-    // so nothing else needs to be checked in the callback itself.
-    if(frags > 0)
+    // Try to read memory back
+
+    EventInfo *eventsInfo;
+    VkResult vkr = m_pDriver->vkMapMemory(dev, resources.bufferMemory, 0, VK_WHOLE_SIZE, 0,
+                                          (void **)&eventsInfo);
+    CheckVkResult(vkr);
+    if(vkr != VK_SUCCESS)
+    {
+      SAFE_DELETE(tfCb);
+      return;
+    }
+    if(!eventsInfo)
     {
-      eventsWithFrags[mod.eventId] = frags;
-      eventPremods[mod.eventId] = mod.preMod;
+      RDCERR("Manually reporting failed memory map");
+      CheckVkResult(VK_ERROR_MEMORY_MAP_FAILED);
+      SAFE_DELETE(tfCb);
+      return;
     }
 
-    if(frags > 1)
+    for(uint32_t g = 0; g < group.size(); g++)
     {
-      PixelModification duplicate = mod;
-      for(int32_t f = 1; f < frags; f++)
+      PixelHistoryPixel &pixel = *group[g];
+      rdcarray<PixelModification> &history = pixel.history;
+
+      for(size_t ev = 0; ev < events.size(); ev++)
+      {
+        uint32_t eventId = events[ev].eventId;
+        bool clear = (events[ev].usage == ResourceUsage::Clear);
+        bool directWrite = isDirectWrite(events[ev].usage);
+
+        if(pixel.drawEvents.contains(events[ev].eventId) || clear || directWrite)
+        {
+          PixelModification mod;
+          RDCEraseEl(mod);
+
+          mod.eventId = eventId;
+          mod.directShaderWrite = directWrite;
+          mod.unboundPS = false;
+
+          if(!clear && !directWrite)
+          {
+            RDCASSERT(tfCb != NULL);
+            uint32_t flags = tfCb->GetEventFlags(eventId, g);
+            VkMarkerRegion::Set(StringFormat::Fmt("%u has flags %x", eventId, flags));
+            if(flags & TestMustFail_Culling)
+              mod.backfaceCulled = true;
+            if(flags & TestMustFail_DepthTesting)
+              mod.depthTestFailed = true;
+            if(flags & TestMustFail_Scissor)
+              mod.scissorClipped = true;
+            if(flags & TestMustFail_SampleMask)
+              mod.sampleMasked = true;
+            if(flags & UnboundFragmentShader)
+              mod.unboundPS = true;
+
+            UpdateTestsFailed(tfCb, g, eventId, flags, mod);
+          }
+          history.push_back(mod);
+        }
+      }
+
+      if(tfCb)
+        pixel.eventFlags = tfCb->GetEventFlags(g);
+
+      std::map<uint32_t, uint32_t> &eventsWithFrags = pixel.eventsWithFrags;
+      std::map<uint32_t, ModificationValue> &eventPremods = pixel.eventPremods;
+
+      for(size_t h = 0; h < history.size();)
       {
-        history.insert(h + 1, duplicate);
+        PixelModification &mod = history[h];
+
+        VkFormat depthFormat = cb.GetDepthFormat(mod.eventId);
+        pixel.depthFormats[mod.eventId] = depthFormat;
+
+        int32_t eventIndex = cb.GetEventIndex(mod.eventId, g);
+        if(eventIndex == -1)
+        {
+          // There is no information, skip the event.
+          mod.preMod.SetInvalid();
+          mod.postMod.SetInvalid();
+          mod.shaderOut.SetInvalid();
+          h++;
+          continue;
+        }
+        const EventInfo &ei = eventsInfo[eventIndex];
+        FillInColor(fmt, ei.premod, mod.preMod);
+        FillInColor(fmt, ei.postmod, mod.postMod);
+        if(depthFormat != VK_FORMAT_UNDEFINED)
+        {
+          mod.preMod.stencil = ei.premod.stencil;
+          mod.postMod.stencil = ei.postmod.stencil;
+          if(multisampled)
+          {
+            mod.preMod.depth = ei.premod.depth.fdepth;
+            mod.postMod.depth = ei.postmod.depth.fdepth;
+          }
+          else
+          {
+            mod.preMod.depth = GetDepthValue(depthFormat, ei.premod);
+            mod.postMod.depth = GetDepthValue(depthFormat, ei.postmod);
+          }
+        }
+
+        int32_t frags = int32_t(ei.dsWithoutShaderDiscard[4]);
+        int32_t fragsClipped = int32_t(ei.dsWithShaderDiscard[4]);
+        mod.shaderOut.col.intValue[0] = frags;
+        mod.shaderOut.col.intValue[1] = fragsClipped;
+        bool someFragsClipped = (fragsClipped < frags);
+        mod.primitiveID = someFragsClipped;
+        // Draws in secondary command buffers will fail this check,
+        // so nothing else needs to be checked in the callback itself.
+        if(frags > 0)
+        {
+          eventsWithFrags[mod.eventId] = frags;
+          eventPremods[mod.eventId] = mod.preMod;
+        }
+
+        if(frags > 1)
+        {
+          PixelModification duplicate = mod;
+          for(int32_t f = 1; f < frags; f++)
+          {
+            history.insert(h + 1, duplicate);
+          }
+        }
+        for(int32_t f = 0; f < frags; f++)
+          history[h + f].fragIndex = f;
+        h += RDCMAX(1, frags);
+        RDCDEBUG(
+            "PixelHistory event id: %u, fixed shader stencilValue = %u, original shader "
+            "stencilValue = %u",
+            mod.eventId, ei.dsWithoutShaderDiscard[4], ei.dsWithShaderDiscard[4]);
       }
     }
-    for(int32_t f = 0; f < frags; f++)
-      history[h + f].fragIndex = f;
-    h += RDCMAX(1, frags);
-    RDCDEBUG(
-        "PixelHistory event id: %u, fixed shader stencilValue = %u, original shader stencilValue = "
-        "%u",
-        mod.eventId, ei.dsWithoutShaderDiscard[4], ei.dsWithShaderDiscard[4]);
+
+    m_pDriver->vkUnmapMemory(dev, resources.bufferMemory);
+    SAFE_DELETE(tfCb);
   }
-  m_pDriver->vkUnmapMemory(dev, resources.bufferMemory);
+}
+
+void VulkanReplay::PixelHistoryPerFragment(const PixelHistoryResources &resources,
+                                           PixelHistoryShaderCache *shaderCache,
+                                           const PixelHistoryCallbackInfo &baseCallbackInfo,
+                                           rdcarray<PixelHistoryPixel> &pixels)
+{
+  VkDevice dev = m_pDriver->GetDev();
+
+  ResourceFormat fmt = MakeResourceFormat(baseCallbackInfo.targetImageFormat);
+  ResourceFormat shaderOutFormat = MakeResourceFormat(VK_FORMAT_R32G32B32A32_SFLOAT);
 
-  if(eventsWithFrags.size() > 0)
+  size_t p = 0;
+  while(p < pixels.size())
   {
+    // gather as many pixels with fragments as fit in the readback buffer into one replay. A
+    // single pixel is always processed even if it overflows, as before batching.
+    rdcarray<PixelHistoryPixel *> group;
+    size_t groupFrags = 0;
+    uint32_t lastEvent = 0;
+    for(; p < pixels.size(); p++)
+    {
+      if(pixels[p].eventsWithFrags.empty())
+        continue;
+
+      size_t pixelFrags = 0;
+      for(auto it = pixels[p].eventsWithFrags.begin(); it != pixels[p].eventsWithFrags.end(); ++it)
+        pixelFrags += it->second;
+
+      if(!group.empty() &&
+         (groupFrags + pixelFrags) * sizeof(PerFragmentInfo) > resources.bufferSize)
+        break;
+
+      group.push_back(&pixels[p]);
+      groupFrags += pixelFrags;
+      lastEvent = RDCMAX(lastEvent, pixels[p].eventsWithFrags.rbegin()->first);
+    }
+
+    if(group.empty())
+      break;
+
     // Replay to get shader output value, post modification value and primitive ID for every
-    // fragment.
-    VulkanPixelHistoryPerFragmentCallback perFragmentCB(m_pDriver, shaderCache, callbackInfo,
-                                                        eventsWithFrags, eventPremods);
+    // fragment of every pixel in the group.
+    VulkanPixelHistoryPerFragmentCallback perFragmentCB(m_pDriver, shaderCache, baseCallbackInfo,
+                                                        group);
     {
-      VkMarkerRegion perFragmentRegion("VulkanPixelHistoryPerFragmentCallback");
-      m_pDriver->ReplayLog(0, eventsWithFrags.rbegin()->first, eReplay_Full);
+      VkMarkerRegion perFragmentRegion(
+          StringFormat::Fmt("VulkanPixelHistoryPerFragmentCallback for %zu pixels", group.size()));
+      m_pDriver->ReplayLog(0, lastEvent, eReplay_Full);
       m_pDriver->SubmitCmds();
       m_pDriver->FlushQ();
     }
 
     PerFragmentInfo *bp = NULL;
-    vkr = m_pDriver->vkMapMemory(dev, resources.bufferMemory, 0, VK_WHOLE_SIZE, 0, (void **)&bp);
+    VkResult vkr =
+        m_pDriver->vkMapMemory(dev, resources.bufferMemory, 0, VK_WHOLE_SIZE, 0, (void **)&bp);
     CheckVkResult(vkr);
     if(vkr != VK_SUCCESS)
-      return history;
+      return;
     if(!bp)
     {
       RDCERR("Manually reporting failed memory map");
       CheckVkResult(VK_ERROR_MEMORY_MAP_FAILED);
-      return history;
+      return;
     }
 
-    // Retrieve primitive ID values where fragment shader discarded some
-    // fragments. For these primitives we are going to perform an occlusion
-    // query to see if a primitive was discarded.
-    std::map<uint32_t, rdcarray<int32_t> > discardedPrimsEvents;
-    uint32_t primitivesToCheck = 0;
-    for(size_t h = 0; h < history.size(); h++)
+    for(uint32_t g = 0; g < group.size(); g++)
     {
-      uint32_t eid = history[h].eventId;
-      if(eventsWithFrags.find(eid) == eventsWithFrags.end())
-        continue;
-      uint32_t f = history[h].fragIndex;
-      bool someFragsClipped = (history[h].primitiveID == 1);
-      int32_t primId = bp[perFragmentCB.GetEventOffset(eid) + f].primitiveID;
-      history[h].primitiveID = primId;
-      if(someFragsClipped)
+      PixelHistoryPixel &pixel = *group[g];
+      rdcarray<PixelModification> &history = pixel.history;
+      const std::map<uint32_t, uint32_t> &eventsWithFrags = pixel.eventsWithFrags;
+      const std::map<uint32_t, uint32_t> &eventFlags = pixel.eventFlags;
+
+      PixelHistoryCallbackInfo callbackInfo = baseCallbackInfo;
+      callbackInfo.x = pixel.x;
+      callbackInfo.y = pixel.y;
+
+      VkMarkerRegion region(
+          StringFormat::Fmt("PixelHistory fragments for (%u, %u)", callbackInfo.x, callbackInfo.y));
+
+      // Retrieve primitive ID values where fragment shader discarded some
+      // fragments. For these primitives we are going to perform an occlusion
+      // query to see if a primitive was discarded.
+      std::map<uint32_t, rdcarray<int32_t> > discardedPrimsEvents;
+      uint32_t primitivesToCheck = 0;
+      for(size_t h = 0; h < history.size(); h++)
       {
-        discardedPrimsEvents[eid].push_back(primId);
-        primitivesToCheck++;
+        uint32_t eid = history[h].eventId;
+        if(eventsWithFrags.find(eid) == eventsWithFrags.end())
+          continue;
+        uint32_t f = history[h].fragIndex;
+        bool someFragsClipped = (history[h].primitiveID == 1);
+        int32_t primId = bp[perFragmentCB.GetEventOffset(eid, g) + f].primitiveID;
+        history[h].primitiveID = primId;
+        if(someFragsClipped)
+        {
+          discardedPrimsEvents[eid].push_back(primId);
+          primitivesToCheck++;
+        }
       }
-    }
 
-    // without the geometry shader feature we can't get the primitive ID, so we can't establish
-    // discard per-primitive so we assume all shaders don't discard.
-    if(m_pDriver->GetDeviceEnabledFeatures().geometryShader)
-    {
-      if(primitivesToCheck > 0)
+      // without the geometry shader feature we can't get the primitive ID, so we can't establish
+      // discard per-primitive so we assume all shaders don't discard.
+      if(m_pDriver->GetDeviceEnabledFeatures().geometryShader)
       {
-        VkMarkerRegion discardedRegion("VulkanPixelHistoryDiscardedFragmentsCallback");
-        VkQueryPool occlPool;
-        CreateOcclusionPool(m_pDriver, primitivesToCheck, &occlPool);
-
-        // Replay to see which primitives were discarded.
-        VulkanPixelHistoryDiscardedFragmentsCallback discardedCb(
-            m_pDriver, shaderCache, callbackInfo, discardedPrimsEvents, occlPool);
-        m_pDriver->ReplayLog(0, eventsWithFrags.rbegin()->first, eReplay_Full);
-        m_pDriver->SubmitCmds();
-        m_pDriver->FlushQ();
-        discardedCb.FetchOcclusionResults();
-        ObjDisp(dev)->DestroyQueryPool(Unwrap(dev), occlPool, NULL);
-
+        if(primitivesToCheck > 0)
+        {
+          VkMarkerRegion discardedRegion("VulkanPixelHistoryDiscardedFragmentsCallback");
+          VkQueryPool occlPool;
+          CreateOcclusionPool(m_pDriver, primitivesToCheck, &occlPool);
+
+          // Replay to see which primitives were discarded.
+          VulkanPixelHistoryDiscardedFragmentsCallback discardedCb(
+              m_pDriver, shaderCache, callbackInfo, discardedPrimsEvents, occlPool);
+          m_pDriver->ReplayLog(0, eventsWithFrags.rbegin()->first, eReplay_Full);
+          m_pDriver->SubmitCmds();
+          m_pDriver->FlushQ();
+          discardedCb.FetchOcclusionResults();
+          ObjDisp(dev)->DestroyQueryPool(Unwrap(dev), occlPool, NULL);
+
+          for(size_t h = 0; h < history.size(); h++)
+            history[h].shaderDiscarded =
+                discardedCb.PrimitiveDiscarded(history[h].eventId, history[h].primitiveID);
+        }
+      }
+      else
+      {
+        // mark that we have no primitive IDs
         for(size_t h = 0; h < history.size(); h++)
-          history[h].shaderDiscarded =
-              discardedCb.PrimitiveDiscarded(history[h].eventId, history[h].primitiveID);
+          history[h].primitiveID = ~0U;
       }
-    }
-    else
-    {
-      // mark that we have no primitive IDs
-      for(size_t h = 0; h < history.size(); h++)
-        history[h].primitiveID = ~0U;
-    }
 
-    uint32_t discardOffset = 0;
-    ResourceFormat shaderOutFormat = MakeResourceFormat(VK_FORMAT_R32G32B32A32_SFLOAT);
-    for(size_t h = 0; h < history.size(); h++)
-    {
-      uint32_t eid = history[h].eventId;
-      uint32_t f = history[h].fragIndex;
-      // Reset discard offset if this is a new event.
-      if(h > 0 && (eid != history[h - 1].eventId))
-        discardOffset = 0;
-      if(eventsWithFrags.find(eid) != eventsWithFrags.end())
+      uint32_t discardOffset = 0;
+      for(size_t h = 0; h < history.size(); h++)
       {
-        if(history[h].shaderDiscarded)
+        uint32_t eid = history[h].eventId;
+        uint32_t f = history[h].fragIndex;
+        // Reset discard offset if this is a new event.
+        if(h > 0 && (eid != history[h - 1].eventId))
+          discardOffset = 0;
+        if(eventsWithFrags.find(eid) != eventsWithFrags.end())
         {
-          discardOffset++;
-          // Copy previous post-mod value if its not the first event
-          if(h > 0)
-            history[h].postMod = history[h - 1].postMod;
-          continue;
-        }
-        uint32_t offset = perFragmentCB.GetEventOffset(eid) + f - discardOffset;
-        FillInColor(shaderOutFormat, bp[offset].shaderOut, history[h].shaderOut);
-        history[h].shaderOut.depth = bp[offset].shaderOut.depth.fdepth;
+          if(history[h].shaderDiscarded)
+          {
+            discardOffset++;
+            // Copy previous post-mod value if its not the first event
+            if(h > 0)
+              history[h].postMod = history[h - 1].postMod;
+            continue;
+          }
+          uint32_t offset = perFragmentCB.GetEventOffset(eid, g) + f - discardOffset;
+          FillInColor(shaderOutFormat, bp[offset].shaderOut, history[h].shaderOut);
+          history[h].shaderOut.depth = bp[offset].shaderOut.depth.fdepth;
 
-        if((h < history.size() - 1) && (history[h].eventId == history[h + 1].eventId))
-        {
-          // Get post-modification value if this is not the last fragment for the event.
-          FillInColor(fmt, bp[offset].postMod, history[h].postMod);
-          // MSAA depth is expanded out to floats in the compute shader
-          if((uint32_t)callbackInfo.samples > 1)
-            history[h].postMod.depth = bp[offset].postMod.depth.fdepth;
-          else
-            history[h].postMod.depth = GetDepthValue(cb.GetDepthFormat(eid), bp[offset].postMod);
+          if((h < history.size() - 1) && (history[h].eventId == history[h + 1].eventId))
+          {
+            // Get post-modification value if this is not the last fragment for the event.
+            FillInColor(fmt, bp[offset].postMod, history[h].postMod);
+            // MSAA depth is expanded out to floats in the compute shader
+            if((uint32_t)callbackInfo.samples > 1)
+              history[h].postMod.depth = bp[offset].postMod.depth.fdepth;
+            else
+              history[h].postMod.depth =
+                  GetDepthValue(pixel.depthFormats[eid], bp[offset].postMod);
+          }
+          // If it is not the first fragment for the event, set the preMod to the
+          // postMod of the previous fragment.
+          if(h > 0 && (history[h].eventId == history[h - 1].eventId))
+          {
+            history[h].preMod = history[h - 1].postMod;
+          }
         }
-        // If it is not the first fragment for the event, set the preMod to the
-        // postMod of the previous fragment.
-        if(h > 0 && (history[h].eventId == history[h - 1].eventId))
+
+        // check the depth value between premod/shaderout against the known test if we have valid
+        // depth values, as we don't have per-fragment depth test information.
+        auto flagsIt = eventFlags.find(history[h].eventId);
+        if(history[h].preMod.depth >= 0.0f && history[h].shaderOut.depth >= 0.0f &&
+           flagsIt != eventFlags.end())
         {
-          history[h].preMod = history[h - 1].postMod;
-        }
-      }
+          uint32_t flags = flagsIt->second;
 
-      // check the depth value between premod/shaderout against the known test if we have valid
-      // depth values, as we don't have per-fragment depth test information.
-      if(history[h].preMod.depth >= 0.0f && history[h].shaderOut.depth >= 0.0f && tfCb &&
-         tfCb->HasEventFlags(history[h].eventId))
-      {
-        uint32_t flags = tfCb->GetEventFlags(history[h].eventId);
+          flags &= 0x7 << DepthTest_Shift;
 
-        flags &= 0x7 << DepthTest_Shift;
+          VkFormat dfmt = pixel.depthFormats[eid];
+          float shadDepth = history[h].shaderOut.depth;
 
-        VkFormat dfmt = cb.GetDepthFormat(eid);
-        float shadDepth = history[h].shaderOut.depth;
+          // quantise depth to match before comparing
+          if(dfmt == VK_FORMAT_D24_UNORM_S8_UINT || dfmt == VK_FORMAT_X8_D24_UNORM_PACK32)
+          {
+            shadDepth = float(uint32_t(float(shadDepth * 0xffffff))) / float(0xffffff);
+          }
+          else if(dfmt == VK_FORMAT_D16_UNORM || dfmt == VK_FORMAT_D16_UNORM_S8_UINT)
+          {
+            shadDepth = float(uint32_t(float(shadDepth * 0xffff))) / float(0xffff);
+          }
 
-        // quantise depth to match before comparing
-        if(dfmt == VK_FORMAT_D24_UNORM_S8_UINT || dfmt == VK_FORMAT_X8_D24_UNORM_PACK32)
-        {
-          shadDepth = float(uint32_t(float(shadDepth * 0xffffff))) / float(0xffffff);
-        }
-        else if(dfmt == VK_FORMAT_D16_UNORM || dfmt == VK_FORMAT_D16_UNORM_S8_UINT)
-        {
-          shadDepth = float(uint32_t(float(shadDepth * 0xffff))) / float(0xffff);
+          bool passed = true;
+          if(flags == DepthTest_Equal)
+            passed = (shadDepth == history[h].preMod.depth);
+          else if(flags == DepthTest_NotEqual)
+            passed = (shadDepth != history[h].preMod.depth);
+          else if(flags == DepthTest_Less)
+            passed = (shadDepth < history[h].preMod.depth);
+          else if(flags == DepthTest_LessEqual)
+            passed = (shadDepth <= history[h].preMod.depth);
+          else if(flags == DepthTest_Greater)
+            passed = (shadDepth > history[h].preMod.depth);
+          else if(flags == DepthTest_GreaterEqual)
+            passed = (shadDepth >= history[h].preMod.depth);
+
+          if(!passed)
+            history[h].depthTestFailed = true;
         }
-
-        bool passed = true;
-        if(flags == DepthTest_Equal)
-          passed = (shadDepth == history[h].preMod.depth);
-        else if(flags == DepthTest_NotEqual)
-          passed = (shadDepth != history[h].preMod.depth);
-        else if(flags == DepthTest_Less)
-          passed = (shadDepth < history[h].preMod.depth);
-        else if(flags == DepthTest_LessEqual)
-          passed = (shadDepth <= history[h].preMod.depth);
-        else if(flags == DepthTest_Greater)
-          passed = (shadDepth > history[h].preMod.depth);
-        else if(flags == DepthTest_GreaterEqual)
-          passed = (shadDepth >= history[h].preMod.depth);
-
-        if(!passed)
-          history[h].depthTestFailed = true;
       }
     }
-  }
-
-  SAFE_DELETE(tfCb);
-
-  GetDebugManager()->PixelHistoryDestroyResources(resources);
-  ObjDisp(dev)->DestroyQueryPool(Unwrap(dev), occlusionPool, NULL);
-  delete shaderCache;
 
-  return history;
+    m_pDriver->vkUnmapMemory(dev, resources.bufferMemory);
+  }
 }
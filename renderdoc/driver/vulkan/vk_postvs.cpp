@@ -25,6 +25,7 @@
 #include <float.h>
 #include <math.h>
 #include <algorithm>
+#include "api/replay/version.h"
 #include "core/settings.h"
 #include "driver/shaders/spirv/spirv_editor.h"
 #include "driver/shaders/spirv/spirv_op_helpers.h"
@@ -35,6 +36,12 @@
 
 RDOC_CONFIG(rdcstr, Vulkan_Debug_PostVSDumpDirPath, "",
             "Path to dump gnerated SPIR-V compute shaders for fetching post-vs.");
+RDOC_CONFIG(uint32_t, Vulkan_PostVSCacheBudgetMB, 1024,
+            "The amount of memory in MB that cached post-transform mesh data may use before the "
+            "least recently used draws are discarded. 0 means the cache is unbounded.");
+RDOC_CONFIG(bool, Vulkan_PostVSCachePersist, false,
+            "Save cached post-transform mesh data next to the capture when it's closed, and load "
+            "it when the same capture is opened again on the same GPU and driver.");
 RDOC_EXTERN_CONFIG(bool, Vulkan_Debug_DisableBufferDeviceAddress);
 
 #undef None
@@ -1454,28 +1461,441 @@ static void ConvertToMeshOutputCompute(const ShaderReflection &refl,
   }
 }
 
-void VulkanReplay::ClearPostVSCache()
+void VulkanReplay::FreePostVSData(VulkanPostVSData &data)
 {
   VkDevice dev = m_Device;
 
+  if(data.vsout.idxbuf != VK_NULL_HANDLE)
+  {
+    m_pDriver->vkDestroyBuffer(dev, data.vsout.idxbuf, NULL);
+    m_pDriver->vkFreeMemory(dev, data.vsout.idxbufmem, NULL);
+  }
+  m_pDriver->vkDestroyBuffer(dev, data.vsout.buf, NULL);
+  m_pDriver->vkFreeMemory(dev, data.vsout.bufmem, NULL);
+
+  if(data.gsout.buf != VK_NULL_HANDLE)
+  {
+    m_pDriver->vkDestroyBuffer(dev, data.gsout.buf, NULL);
+    m_pDriver->vkFreeMemory(dev, data.gsout.bufmem, NULL);
+  }
+
+  m_PostVS.CacheSize -= RDCMIN(m_PostVS.CacheSize, data.cacheSize);
+  data.cacheSize = 0;
+}
+
+void VulkanReplay::ClearPostVSCache()
+{
+  for(auto it = m_PostVS.Data.begin(); it != m_PostVS.Data.end(); ++it)
+    FreePostVSData(it->second);
+
+  m_PostVS.Data.clear();
+  m_PostVS.CacheSize = 0;
+}
+
+void VulkanReplay::TrimPostVSCache()
+{
+  const VkDeviceSize budget = VkDeviceSize(Vulkan_PostVSCacheBudgetMB()) * 1024 * 1024;
+
+  if(budget == 0 || m_PostVS.CacheSize <= budget)
+    return;
+
+  // gather everything that can be evicted, least recently used first. Entries used in the current
+  // request are skipped, as are entries without any memory (e.g. draws that failed to fetch) which
+  // are cheap to keep and remember not to try again.
+  rdcarray<rdcpair<uint64_t, uint32_t>> lru;
   for(auto it = m_PostVS.Data.begin(); it != m_PostVS.Data.end(); ++it)
   {
-    if(it->second.vsout.idxbuf != VK_NULL_HANDLE)
+    if(it->second.cacheSize == 0 || it->second.lastUse == m_PostVS.UseCounter)
+      continue;
+
+    lru.push_back({it->second.lastUse, it->first});
+  }
+
+  std::sort(lru.begin(), lru.end());
+
+  // if we run out of candidates everything left is in use, and we have to go over budget
+  for(size_t i = 0; i < lru.size() && m_PostVS.CacheSize > budget; i++)
+  {
+    auto it = m_PostVS.Data.find(lru[i].second);
+
+    RDCDEBUG("Evicting post-transform data for %u to stay in %llu MB budget", it->first,
+             (uint64_t)Vulkan_PostVSCacheBudgetMB());
+
+    FreePostVSData(it->second);
+    m_PostVS.Data.erase(it);
+  }
+}
+
+enum PostVSCacheChunk
+{
+  PostVSCacheChunk_Header = 1,
+  PostVSCacheChunk_Alias,
+  PostVSCacheChunk_Data,
+};
+
+// bump when anything stored in the persisted cache changes
+static const uint32_t PostVSCacheVersion = 1;
+
+// the persisted cache is only used if all of this matches
+struct PostVSCacheHeader
+{
+  uint32_t version = 0;
+  rdcstr build;
+  uint64_t captureSize = 0;
+  uint64_t captureTimestamp = 0;
+  uint32_t vendorID = 0;
+  uint32_t deviceID = 0;
+  uint32_t driverVersion = 0;
+
+  bool operator==(const PostVSCacheHeader &o) const
+  {
+    return version == o.version && build == o.build && captureSize == o.captureSize &&
+           captureTimestamp == o.captureTimestamp && vendorID == o.vendorID &&
+           deviceID == o.deviceID && driverVersion == o.driverVersion;
+  }
+  bool operator!=(const PostVSCacheHeader &o) const { return !(*this == o); }
+};
+
+DECLARE_STRINGISE_TYPE(PostVSCacheHeader);
+
+template <class SerialiserType>
+void DoSerialise(SerialiserType &ser, PostVSCacheHeader &el)
+{
+  SERIALISE_MEMBER(version);
+  SERIALISE_MEMBER(build);
+  SERIALISE_MEMBER(captureSize);
+  SERIALISE_MEMBER(captureTimestamp);
+  SERIALISE_MEMBER(vendorID);
+  SERIALISE_MEMBER(deviceID);
+  SERIALISE_MEMBER(driverVersion);
+}
+
+static VkBuffer UploadPostVSData(WrappedVulkan *driver, const bytebuf &data,
+                                 VkBufferUsageFlags usage, VkDeviceMemory &mem)
+{
+  VkDevice dev = driver->GetDev();
+
+  mem = VK_NULL_HANDLE;
+
+  VkBufferCreateInfo bufInfo = {VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+  bufInfo.size = RDCMAX((VkDeviceSize)64, (VkDeviceSize)data.size());
+  bufInfo.usage = usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+  VkBuffer buf = VK_NULL_HANDLE;
+  VkResult vkr = driver->vkCreateBuffer(dev, &bufInfo, NULL, &buf);
+  if(vkr != VK_SUCCESS)
+    return VK_NULL_HANDLE;
+
+  VkMemoryRequirements mrq = {};
+  driver->vkGetBufferMemoryRequirements(dev, buf, &mrq);
+
+  VkMemoryAllocateInfo allocInfo = {
+      VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+      NULL,
+      mrq.size,
+      driver->GetUploadMemoryIndex(mrq.memoryTypeBits),
+  };
+
+  byte *ptr = NULL;
+
+  vkr = driver->vkAllocateMemory(dev, &allocInfo, NULL, &mem);
+  if(vkr == VK_SUCCESS)
+    vkr = driver->vkBindBufferMemory(dev, buf, mem, 0);
+  if(vkr == VK_SUCCESS)
+    vkr = driver->vkMapMemory(dev, mem, 0, VK_WHOLE_SIZE, 0, (void **)&ptr);
+
+  if(vkr != VK_SUCCESS || !ptr)
+  {
+    driver->vkDestroyBuffer(dev, buf, NULL);
+    if(mem != VK_NULL_HANDLE)
+      driver->vkFreeMemory(dev, mem, NULL);
+    mem = VK_NULL_HANDLE;
+    return VK_NULL_HANDLE;
+  }
+
+  memcpy(ptr, data.data(), data.size());
+
+  VkMappedMemoryRange range = {VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE, NULL, mem, 0, VK_WHOLE_SIZE};
+  driver->vkFlushMappedMemoryRanges(dev, 1, &range);
+  driver->vkUnmapMemory(dev, mem);
+
+  return buf;
+}
+
+// the buffers are read back when writing, and recreated from the data when reading
+template <typename SerialiserType>
+static bool SerialisePostVSStage(SerialiserType &ser, WrappedVulkan *driver,
+                                 VulkanPostVSData::StageData &stage)
+{
+  bytebuf data, indices;
+  rdcarray<uint32_t> instData;
+
+  if(ser.IsWriting())
+  {
+    if(stage.buf != VK_NULL_HANDLE)
+      driver->GetDebugManager()->GetBufferData(GetResID(stage.buf), 0, 0, data);
+    if(stage.useIndices && stage.idxbuf != VK_NULL_HANDLE)
+      driver->GetDebugManager()->GetBufferData(GetResID(stage.idxbuf), 0, 0, indices);
+
+    for(const VulkanPostVSData::InstData &inst : stage.instData)
     {
-      m_pDriver->vkDestroyBuffer(dev, it->second.vsout.idxbuf, NULL);
-      m_pDriver->vkFreeMemory(dev, it->second.vsout.idxbufmem, NULL);
+      instData.push_back(inst.numVerts);
+      instData.push_back(inst.bufOffset);
     }
-    m_pDriver->vkDestroyBuffer(dev, it->second.vsout.buf, NULL);
-    m_pDriver->vkFreeMemory(dev, it->second.vsout.bufmem, NULL);
+  }
 
-    if(it->second.gsout.buf != VK_NULL_HANDLE)
+  ser.Serialise("topo"_lit, stage.topo);
+  ser.Serialise("baseVertex"_lit, stage.baseVertex);
+  ser.Serialise("numVerts"_lit, stage.numVerts);
+  ser.Serialise("vertStride"_lit, stage.vertStride);
+  ser.Serialise("instStride"_lit, stage.instStride);
+  ser.Serialise("instData"_lit, instData);
+  ser.Serialise("numViews"_lit, stage.numViews);
+  ser.Serialise("useIndices"_lit, stage.useIndices);
+  ser.Serialise("idxFmt"_lit, stage.idxFmt);
+  ser.Serialise("hasPosOut"_lit, stage.hasPosOut);
+  ser.Serialise("flipY"_lit, stage.flipY);
+  ser.Serialise("nearPlane"_lit, stage.nearPlane);
+  ser.Serialise("farPlane"_lit, stage.farPlane);
+  ser.Serialise("status"_lit, stage.status);
+  ser.Serialise("data"_lit, data);
+  ser.Serialise("indices"_lit, indices);
+
+  if(ser.IsReading())
+  {
+    stage.buf = stage.idxbuf = VK_NULL_HANDLE;
+    stage.bufmem = stage.idxbufmem = VK_NULL_HANDLE;
+
+    if(ser.IsErrored())
+      return false;
+
+    stage.instData.resize(instData.size() / 2);
+    for(size_t i = 0; i < stage.instData.size(); i++)
     {
-      m_pDriver->vkDestroyBuffer(dev, it->second.gsout.buf, NULL);
-      m_pDriver->vkFreeMemory(dev, it->second.gsout.bufmem, NULL);
+      stage.instData[i].numVerts = instData[i * 2 + 0];
+      stage.instData[i].bufOffset = instData[i * 2 + 1];
+    }
+
+    if(!data.empty())
+    {
+      stage.buf = UploadPostVSData(
+          driver, data, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+          stage.bufmem);
+      if(stage.buf == VK_NULL_HANDLE)
+        return false;
+    }
+
+    if(!indices.empty())
+    {
+      stage.idxbuf =
+          UploadPostVSData(driver, indices, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, stage.idxbufmem);
+      if(stage.idxbuf == VK_NULL_HANDLE)
+        return false;
     }
   }
 
-  m_PostVS.Data.clear();
+  return true;
+}
+
+void VulkanReplay::LoadPostVSCache()
+{
+  if(m_PostVS.PersistLoaded || !Vulkan_PostVSCachePersist() || m_PostVS.PersistPath.empty())
+    return;
+
+  // anything fetched while shaders are replaced is thrown away, so wait until they aren't
+  if(m_pDriver->GetResourceManager()->HasReplacements())
+    return;
+
+  m_PostVS.PersistLoaded = true;
+
+  if(!FileIO::exists(m_PostVS.PersistPath))
+    return;
+
+  const VkPhysicalDeviceProperties &props = m_pDriver->GetDeviceProps();
+
+  PostVSCacheHeader expected;
+  expected.version = PostVSCacheVersion;
+  expected.build = GitVersionHash;
+  expected.captureSize = m_PostVS.CaptureSize;
+  expected.captureTimestamp = m_PostVS.CaptureTimestamp;
+  expected.vendorID = props.vendorID;
+  expected.deviceID = props.deviceID;
+  expected.driverVersion = props.driverVersion;
+
+  ReadSerialiser ser(new StreamReader(FileIO::fopen(m_PostVS.PersistPath, FileIO::ReadBinary)),
+                     Ownership::Stream);
+  ser.SetStreamingMode(true);
+
+  PostVSCacheHeader header;
+
+  if(ser.ReadChunk<PostVSCacheChunk>() == PostVSCacheChunk_Header)
+    ser.Serialise("header"_lit, header);
+  ser.EndChunk();
+
+  if(ser.IsErrored() || header != expected)
+  {
+    RDCLOG("Ignoring post-transform data in %s from a different capture, GPU or build",
+           m_PostVS.PersistPath.c_str());
+    return;
+  }
+
+  // we handle out-of-memory errors while loading, just stop and leave the rest to be fetched
+  ScopedOOMHandleVk oom(m_pDriver);
+
+  const VkDeviceSize budget = VkDeviceSize(Vulkan_PostVSCacheBudgetMB()) * 1024 * 1024;
+
+  uint32_t loaded = 0;
+
+  while(!ser.GetReader()->AtEnd() && !ser.IsErrored())
+  {
+    PostVSCacheChunk chunk = ser.ReadChunk<PostVSCacheChunk>();
+
+    if(chunk == PostVSCacheChunk_Alias)
+    {
+      uint32_t alias = 0, eventId = 0;
+      ser.Serialise("alias"_lit, alias);
+      ser.Serialise("eventId"_lit, eventId);
+
+      if(!ser.IsErrored())
+        m_PostVS.Alias[alias] = eventId;
+    }
+    else if(chunk == PostVSCacheChunk_Data)
+    {
+      uint32_t eventId = 0;
+      VulkanPostVSData data;
+
+      ser.Serialise("eventId"_lit, eventId);
+      ser.Serialise("topo"_lit, data.vsin.topo);
+
+      bool success = SerialisePostVSStage(ser, m_pDriver, data.vsout);
+      success &= SerialisePostVSStage(ser, m_pDriver, data.gsout);
+
+      VkBuffer bufs[] = {data.vsout.buf, data.vsout.idxbuf, data.gsout.buf};
+      for(VkBuffer buf : bufs)
+      {
+        if(buf == VK_NULL_HANDLE)
+          continue;
+
+        VkMemoryRequirements mrq = {};
+        m_pDriver->vkGetBufferMemoryRequirements(m_Device, buf, &mrq);
+        data.cacheSize += mrq.size;
+      }
+
+      // stop once the budget is full or we're out of memory
+      bool stop = !success || (budget > 0 && m_PostVS.CacheSize + data.cacheSize > budget);
+
+      m_PostVS.CacheSize += data.cacheSize;
+
+      // anything fetched before the load is kept
+      if(stop || m_PostVS.Data.find(eventId) != m_PostVS.Data.end())
+      {
+        FreePostVSData(data);
+      }
+      else
+      {
+        m_PostVS.Data[eventId] = data;
+        loaded++;
+      }
+
+      if(stop)
+      {
+        ser.EndChunk();
+        break;
+      }
+    }
+
+    ser.EndChunk();
+  }
+
+  RDCLOG("Loaded post-transform data for %u draws from %s", loaded, m_PostVS.PersistPath.c_str());
+}
+
+void VulkanReplay::SavePostVSCache()
+{
+  if(!m_PostVS.PersistDirty || !Vulkan_PostVSCachePersist() || m_PostVS.PersistPath.empty())
+    return;
+
+  // data fetched with replaced shaders doesn't belong to the capture
+  if(m_pDriver->GetResourceManager()->HasReplacements())
+    return;
+
+  FILE *f = FileIO::fopen(m_PostVS.PersistPath, FileIO::WriteBinary);
+
+  if(!f)
+  {
+    RDCWARN("Couldn't open %s to save post-transform data", m_PostVS.PersistPath.c_str());
+    return;
+  }
+
+  const VkPhysicalDeviceProperties &props = m_pDriver->GetDeviceProps();
+
+  PostVSCacheHeader header;
+  header.version = PostVSCacheVersion;
+  header.build = GitVersionHash;
+  header.captureSize = m_PostVS.CaptureSize;
+  header.captureTimestamp = m_PostVS.CaptureTimestamp;
+  header.vendorID = props.vendorID;
+  header.deviceID = props.deviceID;
+  header.driverVersion = props.driverVersion;
+
+  size_t saved = 0;
+  bool errored = false;
+
+  // the serialiser closes the file when it goes out of scope
+  {
+    WriteSerialiser ser(new StreamWriter(f, Ownership::Stream), Ownership::Stream);
+    ser.SetStreamingMode(true);
+
+    {
+      SCOPED_SERIALISE_CHUNK(PostVSCacheChunk_Header);
+      ser.Serialise("header"_lit, header);
+    }
+
+    for(auto it = m_PostVS.Alias.begin(); it != m_PostVS.Alias.end(); ++it)
+    {
+      SCOPED_SERIALISE_CHUNK(PostVSCacheChunk_Alias);
+      uint32_t alias = it->first, eventId = it->second;
+      ser.Serialise("alias"_lit, alias);
+      ser.Serialise("eventId"_lit, eventId);
+    }
+
+    // save the most recently used first, so if the budget is smaller when loading those are the
+    // ones that are kept. Draws that failed aren't saved, the failure might not happen next time
+    rdcarray<rdcpair<uint64_t, uint32_t>> mru;
+    for(auto it = m_PostVS.Data.begin(); it != m_PostVS.Data.end(); ++it)
+    {
+      if(it->second.vsout.buf != VK_NULL_HANDLE)
+        mru.push_back({~it->second.lastUse, it->first});
+    }
+
+    std::sort(mru.begin(), mru.end());
+
+    for(const rdcpair<uint64_t, uint32_t> &entry : mru)
+    {
+      uint32_t eventId = entry.second;
+      VulkanPostVSData &data = m_PostVS.Data[eventId];
+
+      SCOPED_SERIALISE_CHUNK(PostVSCacheChunk_Data);
+      ser.Serialise("eventId"_lit, eventId);
+      ser.Serialise("topo"_lit, data.vsin.topo);
+      SerialisePostVSStage(ser, m_pDriver, data.vsout);
+      SerialisePostVSStage(ser, m_pDriver, data.gsout);
+    }
+
+    saved = mru.size();
+    errored = ser.IsErrored();
+  }
+
+  if(errored)
+  {
+    RDCWARN("Failed to save post-transform data to %s", m_PostVS.PersistPath.c_str());
+    FileIO::Delete(m_PostVS.PersistPath);
+    return;
+  }
+
+  m_PostVS.PersistDirty = false;
+
+  RDCLOG("Saved post-transform data for %zu draws to %s", saved, m_PostVS.PersistPath.c_str());
 }
 
 void VulkanReplay::FetchVSOut(uint32_t eventId, VulkanRenderState &state)
@@ -1489,7 +1909,7 @@ void VulkanReplay::FetchVSOut(uint32_t eventId, VulkanRenderState &state)
   const VulkanCreationInfo::ShaderModule &moduleInfo =
       creationInfo.m_ShaderModule[pipeInfo.shaders[0].module];
 
-  ShaderReflection *refl = pipeInfo.shaders[0].refl;
+  ShaderReflection *refl = pipeInfo.shaders[0].GetReflection();
 
   VulkanPostVSData &ret = m_PostVS.Data[eventId];
 
@@ -2427,7 +2847,7 @@ void VulkanReplay::FetchVSOut(uint32_t eventId, VulkanRenderState &state)
   if(!Vulkan_Debug_PostVSDumpDirPath().empty())
     FileIO::WriteAll(Vulkan_Debug_PostVSDumpDirPath() + "/debug_postvs_vert.spv", modSpirv);
 
-  ConvertToMeshOutputCompute(*refl, *pipeInfo.shaders[0].patchData,
+  ConvertToMeshOutputCompute(*refl, *pipeInfo.shaders[0].GetPatchData(),
                              pipeInfo.shaders[0].entryPoint.c_str(), storageMode, attrInstDivisor,
                              action, numVerts, numViews, baseSpecConstant, modSpirv, bufStride);
 
@@ -2933,21 +3353,22 @@ void VulkanReplay::FetchTessGSOut(uint32_t eventId, VulkanRenderState &state)
   int stageIndex = 3;
 
   // if there is no such shader bound, try tessellation
-  if(!pipeInfo.shaders[stageIndex].refl)
+  if(!pipeInfo.shaders[stageIndex].GetReflection())
     stageIndex = 2;
 
   // if still nothing, do vertex
-  if(!pipeInfo.shaders[stageIndex].refl)
+  if(!pipeInfo.shaders[stageIndex].GetReflection())
     stageIndex = 0;
 
-  ShaderReflection *lastRefl = pipeInfo.shaders[stageIndex].refl;
+  ShaderReflection *lastRefl = pipeInfo.shaders[stageIndex].GetReflection();
+  const SPIRVPatchData &lastPatchData = *pipeInfo.shaders[stageIndex].GetPatchData();
 
   RDCASSERT(lastRefl);
 
   uint32_t primitiveMultiplier = 1;
 
   // transform feedback expands strips to lists
-  switch(pipeInfo.shaders[stageIndex].patchData->outTopo)
+  switch(lastPatchData.outTopo)
   {
     case Topology::PointList: ret.gsout.topo = VK_PRIMITIVE_TOPOLOGY_POINT_LIST; break;
     case Topology::LineList:
@@ -2957,7 +3378,7 @@ void VulkanReplay::FetchTessGSOut(uint32_t eventId, VulkanRenderState &state)
       break;
     default:
       RDCERR("Unexpected output topology %s",
-             ToStr(pipeInfo.shaders[stageIndex].patchData->outTopo).c_str());
+             ToStr(lastPatchData.outTopo).c_str());
       DELIBERATE_FALLTHROUGH();
     case Topology::TriangleList:
     case Topology::TriangleStrip:
@@ -3003,7 +3424,7 @@ void VulkanReplay::FetchTessGSOut(uint32_t eventId, VulkanRenderState &state)
     FileIO::WriteAll(Vulkan_Debug_PostVSDumpDirPath() + "/debug_postgs_before.spv", modSpirv);
 
   // adds XFB annotations in order of the output signature (with the position first)
-  AddXFBAnnotations(*lastRefl, *pipeInfo.shaders[stageIndex].patchData, pipeInfo.rasterizationStream,
+  AddXFBAnnotations(*lastRefl, lastPatchData, pipeInfo.rasterizationStream,
                     pipeInfo.shaders[stageIndex].entryPoint.c_str(), modSpirv, xfbStride);
 
   if(!Vulkan_Debug_PostVSDumpDirPath().empty())
@@ -3453,12 +3874,42 @@ void VulkanReplay::InitPostVSBuffers(uint32_t eventId, VulkanRenderState state)
   if(m_PostVS.Alias.find(eventId) != m_PostVS.Alias.end())
     eventId = m_PostVS.Alias[eventId];
 
-  if(m_PostVS.Data.find(eventId) != m_PostVS.Data.end())
-    return;
+  {
+    auto it = m_PostVS.Data.find(eventId);
+    if(it != m_PostVS.Data.end())
+    {
+      it->second.lastUse = m_PostVS.UseCounter;
+      return;
+    }
+  }
 
   // we handle out-of-memory errors while processing postvs, don't treat it as a fatal error
   ScopedOOMHandleVk oom(m_pDriver);
 
+  FetchPostVSData(eventId, state);
+
+  VulkanPostVSData &ret = m_PostVS.Data[eventId];
+  ret.lastUse = m_PostVS.UseCounter;
+
+  VkBuffer bufs[] = {ret.vsout.buf, ret.vsout.idxbuf, ret.gsout.buf};
+  for(VkBuffer buf : bufs)
+  {
+    if(buf == VK_NULL_HANDLE)
+      continue;
+
+    VkMemoryRequirements mrq = {};
+    m_pDriver->vkGetBufferMemoryRequirements(m_Device, buf, &mrq);
+    ret.cacheSize += mrq.size;
+  }
+
+  m_PostVS.CacheSize += ret.cacheSize;
+
+  if(ret.vsout.buf != VK_NULL_HANDLE && !m_pDriver->GetResourceManager()->HasReplacements())
+    m_PostVS.PersistDirty = true;
+}
+
+void VulkanReplay::FetchPostVSData(uint32_t eventId, VulkanRenderState &state)
+{
   VulkanCreationInfo &creationInfo = m_pDriver->m_CreationInfo;
 
   VulkanPostVSData &ret = m_PostVS.Data[eventId];
@@ -3520,7 +3971,13 @@ void VulkanReplay::InitPostVSBuffers(uint32_t eventId, VulkanRenderState state)
 
 void VulkanReplay::InitPostVSBuffers(uint32_t eventId)
 {
+  LoadPostVSCache();
+
+  m_PostVS.UseCounter++;
+
   InitPostVSBuffers(eventId, m_pDriver->GetRenderState());
+
+  TrimPostVSCache();
 }
 
 struct VulkanInitPostVSCallback : public VulkanActionCallback
@@ -3570,6 +4027,35 @@ struct VulkanInitPostVSCallback : public VulkanActionCallback
 
 void VulkanReplay::InitPostVSBuffers(const rdcarray<uint32_t> &events)
 {
+  LoadPostVSCache();
+
+  m_PostVS.UseCounter++;
+
+  // if every draw in the pass is already cached there's no need to replay the pass at all
+  bool allCached = true;
+  for(uint32_t eid : events)
+  {
+    const ActionDescription *action = m_pDriver->GetAction(eid);
+    if(!action || !(action->flags & ActionFlags::Drawcall))
+      continue;
+
+    auto alias = m_PostVS.Alias.find(eid);
+    if(alias != m_PostVS.Alias.end())
+      eid = alias->second;
+
+    auto it = m_PostVS.Data.find(eid);
+    if(it == m_PostVS.Data.end())
+    {
+      allCached = false;
+      break;
+    }
+
+    it->second.lastUse = m_PostVS.UseCounter;
+  }
+
+  if(allCached)
+    return;
+
   size_t first = 0;
 
   for(; first < events.size(); first++)
@@ -3591,6 +4077,9 @@ void VulkanReplay::InitPostVSBuffers(const rdcarray<uint32_t> &events)
   // GetPassEvents above) to come from the same command buffer, so the event IDs are
   // still locally continuous, even if we jump into replaying.
   m_pDriver->ReplayLog(events[first], events.back(), eReplay_Full);
+
+  // only trim once the whole pass is fetched, everything fetched for it is in use
+  TrimPostVSCache();
 }
 
 MeshFormat VulkanReplay::GetPostVSBuffers(uint32_t eventId, uint32_t instID, uint32_t viewID,
@@ -3603,8 +4092,12 @@ MeshFormat VulkanReplay::GetPostVSBuffers(uint32_t eventId, uint32_t instID, uin
   VulkanPostVSData postvs;
   RDCEraseEl(postvs);
 
-  if(m_PostVS.Data.find(eventId) != m_PostVS.Data.end())
-    postvs = m_PostVS.Data[eventId];
+  auto it = m_PostVS.Data.find(eventId);
+  if(it != m_PostVS.Data.end())
+  {
+    it->second.lastUse = m_PostVS.UseCounter;
+    postvs = it->second;
+  }
 
   const ActionDescription *action = m_pDriver->GetAction(eventId);
 
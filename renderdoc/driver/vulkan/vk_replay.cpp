@@ -44,6 +44,10 @@
 #define VULKAN 1
 #include "data/glsl/glsl_ubos_cpp.h"
 
+RDOC_CONFIG(bool, Vulkan_PrefetchShaderDisassembly, true,
+            "Disassemble the shaders bound at the selected event on a background thread, so they "
+            "are ready when viewed.");
+
 static const char *SPIRVDisassemblyTarget = "SPIR-V (RenderDoc)";
 static const char *AMDShaderInfoTarget = "AMD_shader_info";
 static const char *KHRExecutablePropertiesTarget = "KHR_pipeline_executable_properties";
@@ -80,6 +84,8 @@ void VulkanReplay::Shutdown()
 {
   SAFE_DELETE(m_RGP);
 
+  SavePostVSCache();
+
   m_pDriver->Shutdown();
   delete m_pDriver;
 }
@@ -91,6 +97,8 @@ RDResult VulkanReplay::FatalErrorCheck()
 
 IReplayDriver *VulkanReplay::MakeDummyDriver()
 {
+  m_pDriver->m_CreationInfo.WaitForShaderPrefetch();
+
   // gather up the shaders we've allocated to pass to the dummy driver
   rdcarray<ShaderReflection *> shaders;
   for(auto it = m_pDriver->m_CreationInfo.m_ShaderModule.begin();
@@ -222,6 +230,14 @@ APIProperties VulkanReplay::GetAPIProperties()
 
 RDResult VulkanReplay::ReadLogInitialisation(RDCFile *rdc, bool storeStructuredBuffers)
 {
+  // don't trust anything stored next to an untrusted capture
+  if(rdc && !rdc->GetFilename().empty() && !rdc->IsUntrusted())
+  {
+    m_PostVS.PersistPath = rdc->GetFilename() + ".postvs";
+    m_PostVS.CaptureSize = FileIO::GetFileSize(rdc->GetFilename());
+    m_PostVS.CaptureTimestamp = FileIO::GetModifiedTimestamp(rdc->GetFilename());
+  }
+
   return m_pDriver->ReadLogInitialisation(rdc, storeStructuredBuffers);
 }
 
@@ -461,7 +477,8 @@ ShaderReflection *VulkanReplay::GetShader(ResourceId pipeline, ResourceId shader
   // this will be ignored if it was already prepared.
   shad->second.GetReflection(entry.stage, entry.name, pipeline)
       .Init(GetResourceManager(), shader, shad->second.spirv, entry.name,
-            VkShaderStageFlagBits(1 << uint32_t(entry.stage)), {});
+            VkShaderStageFlagBits(1 << uint32_t(entry.stage)), {},
+            m_pDriver->m_CreationInfo.m_ReflectionCache);
 
   return shad->second.GetReflection(entry.stage, entry.name, pipeline).refl;
 }
@@ -1109,10 +1126,14 @@ void VulkanReplay::SavePipelineState(uint32_t eventId)
       stage.entryPoint = p.shaders[i].entryPoint;
 
       stage.stage = ShaderStage::Compute;
-      if(p.shaders[i].mapping)
-        stage.bindpointMapping = *p.shaders[i].mapping;
-      if(p.shaders[i].refl)
-        stage.reflection = p.shaders[i].refl;
+      const ShaderBindpointMapping *mapping = p.shaders[i].GetMapping();
+      ShaderReflection *refl = p.shaders[i].GetReflection();
+      const SPIRVPatchData *patchData = p.shaders[i].GetPatchData();
+
+      if(mapping)
+        stage.bindpointMapping = *mapping;
+      if(refl)
+        stage.reflection = refl;
 
       stage.pushConstantRangeByteOffset = stage.pushConstantRangeByteSize = 0;
       for(const VkPushConstantRange &pr : c.m_PipelineLayout[p.compLayout].pushRanges)
@@ -1128,13 +1149,13 @@ void VulkanReplay::SavePipelineState(uint32_t eventId)
       stage.specializationData.clear();
 
       // set up the defaults
-      if(p.shaders[i].mapping && p.shaders[i].refl)
+      if(mapping && refl)
       {
-        for(size_t cb = 0; cb < p.shaders[i].mapping->constantBlocks.size(); cb++)
+        for(size_t cb = 0; cb < mapping->constantBlocks.size(); cb++)
         {
-          if(p.shaders[i].mapping->constantBlocks[cb].bindset == SpecializationConstantBindSet)
+          if(mapping->constantBlocks[cb].bindset == SpecializationConstantBindSet)
           {
-            for(const ShaderConstant &sc : p.shaders[i].refl->constantBlocks[cb].variables)
+            for(const ShaderConstant &sc : refl->constantBlocks[cb].variables)
             {
               stage.specializationData.resize_for_index(sc.byteOffset + sizeof(uint64_t));
               memcpy(stage.specializationData.data() + sc.byteOffset, &sc.defaultValue,
@@ -1148,7 +1169,7 @@ void VulkanReplay::SavePipelineState(uint32_t eventId)
       // apply any specializations
       for(const SpecConstant &s : p.shaders[i].specialization)
       {
-        int32_t idx = p.shaders[i].patchData->specIDs.indexOf(s.specID);
+        int32_t idx = patchData->specIDs.indexOf(s.specID);
 
         if(idx == -1)
         {
@@ -1161,8 +1182,8 @@ void VulkanReplay::SavePipelineState(uint32_t eventId)
         stage.specializationData.resize_for_index(offs + sizeof(uint64_t));
         memcpy(stage.specializationData.data() + offs, &s.value, s.dataSize);
       }
-      if(p.shaders[i].patchData)
-        stage.specializationIds = p.shaders[i].patchData->specIDs;
+      if(patchData)
+        stage.specializationIds = patchData->specIDs;
     }
   }
   else
@@ -1229,10 +1250,14 @@ void VulkanReplay::SavePipelineState(uint32_t eventId)
       stages[i]->entryPoint = p.shaders[i].entryPoint;
 
       stages[i]->stage = StageFromIndex(i);
-      if(p.shaders[i].mapping)
-        stages[i]->bindpointMapping = *p.shaders[i].mapping;
-      if(p.shaders[i].refl)
-        stages[i]->reflection = p.shaders[i].refl;
+      const ShaderBindpointMapping *mapping = p.shaders[i].GetMapping();
+      ShaderReflection *refl = p.shaders[i].GetReflection();
+      const SPIRVPatchData *patchData = p.shaders[i].GetPatchData();
+
+      if(mapping)
+        stages[i]->bindpointMapping = *mapping;
+      if(refl)
+        stages[i]->reflection = refl;
 
       stages[i]->pushConstantRangeByteOffset = stages[i]->pushConstantRangeByteSize = 0;
       // don't have to handle separate vert/frag layouts as push constant ranges must be identical
@@ -1249,13 +1274,13 @@ void VulkanReplay::SavePipelineState(uint32_t eventId)
       stages[i]->specializationData.clear();
 
       // set up the defaults
-      if(p.shaders[i].mapping && p.shaders[i].refl)
+      if(mapping && refl)
       {
-        for(size_t cb = 0; cb < p.shaders[i].mapping->constantBlocks.size(); cb++)
+        for(size_t cb = 0; cb < mapping->constantBlocks.size(); cb++)
         {
-          if(p.shaders[i].mapping->constantBlocks[cb].bindset == SpecializationConstantBindSet)
+          if(mapping->constantBlocks[cb].bindset == SpecializationConstantBindSet)
           {
-            for(const ShaderConstant &sc : p.shaders[i].refl->constantBlocks[cb].variables)
+            for(const ShaderConstant &sc : refl->constantBlocks[cb].variables)
             {
               stages[i]->specializationData.resize_for_index(sc.byteOffset + sizeof(uint64_t));
               memcpy(stages[i]->specializationData.data() + sc.byteOffset, &sc.defaultValue,
@@ -1269,7 +1294,7 @@ void VulkanReplay::SavePipelineState(uint32_t eventId)
       // apply any specializations
       for(const SpecConstant &s : p.shaders[i].specialization)
       {
-        int32_t idx = p.shaders[i].patchData->specIDs.indexOf(s.specID);
+        int32_t idx = patchData->specIDs.indexOf(s.specID);
 
         if(idx == -1)
         {
@@ -1282,8 +1307,8 @@ void VulkanReplay::SavePipelineState(uint32_t eventId)
         stages[i]->specializationData.resize_for_index(offs + sizeof(uint64_t));
         memcpy(stages[i]->specializationData.data() + offs, &s.value, s.dataSize);
       }
-      if(p.shaders[i].patchData)
-        stages[i]->specializationIds = p.shaders[i].patchData->specIDs;
+      if(patchData)
+        stages[i]->specializationIds = patchData->specIDs;
     }
 
     // Tessellation
@@ -2293,6 +2318,10 @@ void VulkanReplay::SavePipelineState(uint32_t eventId)
     if(ret.conditionalRendering.isInverted)
       ret.conditionalRendering.isPassing = !ret.conditionalRendering.isPassing;
   }
+
+  // the shaders bound here are the ones most likely to be viewed next
+  if(Vulkan_PrefetchShaderDisassembly())
+    c.PrefetchDisassembly({state.graphics.pipeline, state.compute.pipeline});
 }
 
 void VulkanReplay::FillCBufferVariables(ResourceId pipeline, ResourceId shader, ShaderStage stage,
@@ -4376,6 +4405,10 @@ void VulkanReplay::ReplaceResource(ResourceId from, ResourceId to)
 
   ClearPostVSCache();
   ClearFeedbackCache();
+  m_pDriver->ClearReplayCheckpoints();
+
+  // the persisted post-transform data is still valid without replacements, reload it then
+  m_PostVS.PersistLoaded = false;
 }
 
 void VulkanReplay::RemoveReplacement(ResourceId id)
@@ -4388,6 +4421,10 @@ void VulkanReplay::RemoveReplacement(ResourceId id)
 
     ClearPostVSCache();
     ClearFeedbackCache();
+    m_pDriver->ClearReplayCheckpoints();
+
+    // the persisted post-transform data is still valid without replacements, reload it then
+    m_PostVS.PersistLoaded = false;
   }
 }
 
@@ -151,6 +151,16 @@ class VulkanDebugManager;
 class VulkanResourceManager;
 struct VulkanStatePipeline;
 struct VulkanAMDActionCallback;
+struct PixelHistoryResources;
+struct PixelHistoryShaderCache;
+struct PixelHistoryCallbackInfo;
+struct VulkanOcclusionCallback;
+struct PixelHistoryPixel;
+
+namespace rdcspv
+{
+class Debugger;
+};
 
 struct VulkanPostVSData
 {
@@ -191,6 +201,10 @@ struct VulkanPostVSData
     rdcstr status;
   } vsin, vsout, gsout;
 
+  // the device memory used by this data's buffers, and when it was last used for LRU eviction
+  VkDeviceSize cacheSize = 0;
+  uint64_t lastUse = 0;
+
   VulkanPostVSData()
   {
     RDCEraseEl(vsin);
@@ -298,6 +312,12 @@ public:
   rdcarray<EventUsage> GetUsage(ResourceId id);
 
   ShaderDebugData &GetShaderDebugData() { return m_ShaderDebugData; }
+  // while a batch of invocations is being debugged in parallel, serialises their access to the
+  // device. NULL outside of a batch.
+  Threading::CriticalSection *GetShaderDebugBatchLock()
+  {
+    return m_DebugBatch.active ? &m_DebugBatch.lock : NULL;
+  }
   FrameRecord &WriteFrameRecord() { return m_FrameRecord; }
   FrameRecord GetFrameRecord() { return m_FrameRecord; }
   rdcarray<DebugMessage> GetDebugMessages();
@@ -399,6 +419,9 @@ public:
 
   rdcarray<PixelModification> PixelHistory(rdcarray<EventUsage> events, ResourceId target, uint32_t x,
                                            uint32_t y, const Subresource &sub, CompType typeCast);
+  rdcarray<PixelHistoryResult> PixelHistoryBatch(rdcarray<EventUsage> events, ResourceId target,
+                                                 const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels,
+                                                 const Subresource &sub, CompType typeCast);
   ShaderDebugTrace *DebugVertex(uint32_t eventId, uint32_t vertid, uint32_t instid, uint32_t idx,
                                 uint32_t view);
   ShaderDebugTrace *DebugPixel(uint32_t eventId, uint32_t x, uint32_t y, uint32_t sample,
@@ -407,6 +430,12 @@ public:
                                 const rdcfixedarray<uint32_t, 3> &threadid);
   rdcarray<ShaderDebugState> ContinueDebug(ShaderDebugger *debugger);
   void FreeDebugger(ShaderDebugger *debugger);
+  rdcarray<ShaderDebugResult> DebugPixelBatch(uint32_t eventId,
+                                              const rdcarray<DebugPixelInvocation> &pixels,
+                                              const rdcarray<rdcstr> &variables);
+  rdcarray<ShaderDebugResult> DebugThreadBatch(uint32_t eventId,
+                                               const rdcarray<DebugThreadInvocation> &threads,
+                                               const rdcarray<rdcstr> &variables);
 
   uint32_t PickVertex(uint32_t eventId, int32_t width, int32_t height, const MeshDisplay &cfg,
                       uint32_t x, uint32_t y);
@@ -456,9 +485,27 @@ private:
                                 const VkDescriptorSetLayoutBinding *newBindings,
                                 size_t newBindingsCount);
 
+  void FetchPostVSData(uint32_t eventId, VulkanRenderState &state);
   void FetchVSOut(uint32_t eventId, VulkanRenderState &state);
   void FetchTessGSOut(uint32_t eventId, VulkanRenderState &state);
   void ClearPostVSCache();
+  void FreePostVSData(VulkanPostVSData &data);
+  void TrimPostVSCache();
+  void LoadPostVSCache();
+  void SavePostVSCache();
+
+  void PixelHistoryGatherEvents(const rdcarray<EventUsage> &events, const Subresource &sub,
+                                const VulkanOcclusionCallback &occlCb, uint32_t pixelIndex,
+                                PixelHistoryPixel &pixel);
+  void PixelHistoryColorAndTests(const rdcarray<EventUsage> &events,
+                                 const PixelHistoryResources &resources,
+                                 PixelHistoryShaderCache *shaderCache,
+                                 const PixelHistoryCallbackInfo &callbackInfo,
+                                 rdcarray<PixelHistoryPixel> &pixels);
+  void PixelHistoryPerFragment(const PixelHistoryResources &resources,
+                               PixelHistoryShaderCache *shaderCache,
+                               const PixelHistoryCallbackInfo &callbackInfo,
+                               rdcarray<PixelHistoryPixel> &pixels);
 
   void RefreshDerivedReplacements();
 
@@ -744,6 +791,21 @@ private:
 
     std::map<uint32_t, VulkanPostVSData> Data;
     std::map<uint32_t, uint32_t> Alias;
+
+    // data is cached per event, with re-submitted command buffers sharing an entry through Alias.
+    // UseCounter is incremented for each request for post-transform data, and entries last used in
+    // the current request are never evicted.
+    uint64_t UseCounter = 0;
+    VkDeviceSize CacheSize = 0;
+
+    // where the cache is persisted next to the capture, and the capture's size and modified time
+    // when it was opened, which the persisted cache must match to be loaded. The cache is loaded
+    // on first use and only saved if something was fetched since.
+    rdcstr PersistPath;
+    uint64_t CaptureSize = 0;
+    uint64_t CaptureTimestamp = 0;
+    bool PersistLoaded = false;
+    bool PersistDirty = false;
   } m_PostVS;
 
   struct Feedback
@@ -757,6 +819,22 @@ private:
 
   ShaderDebugData m_ShaderDebugData;
 
+  // set while debugging a batch of invocations of one event. Each shader module is only parsed
+  // once, with every invocation's debugger copied from it, and the replay is left in the state
+  // before the event for all of them rather than reset around each one.
+  struct
+  {
+    bool active = false;
+    Threading::CriticalSection lock;
+    std::map<ResourceId, rdcspv::Debugger *> parsed;
+  } m_DebugBatch;
+
+  rdcspv::Debugger *CreateShaderDebugger(ResourceId module, const rdcarray<uint32_t> &spirv);
+  void PrepareShaderDebugDescriptors();
+  rdcarray<ShaderDebugResult> FinishDebugBatch(uint32_t eventId,
+                                               const rdcarray<ShaderDebugTrace *> &traces,
+                                               const rdcarray<rdcstr> &variables);
+
   rdcarray<ResourceDescription> m_Resources;
   std::map<ResourceId, size_t> m_ResourceIdx;
 
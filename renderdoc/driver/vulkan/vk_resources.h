@@ -1028,8 +1028,8 @@ struct MemRefs
     return Update(offset, size, refType, ComposeFrameRefs);
   }
   template <typename Compose>
-  FrameRefType Merge(MemRefs &other, Compose comp);
-  inline FrameRefType Merge(MemRefs &other) { return Merge(other, ComposeFrameRefs); }
+  FrameRefType Merge(const MemRefs &other, Compose comp);
+  inline FrameRefType Merge(const MemRefs &other) { return Merge(other, ComposeFrameRefs); }
 };
 
 struct ImgRefs;
@@ -1109,12 +1109,18 @@ struct DescriptorSetData
   // descriptor set bindings for this descriptor set. Filled out on
   // create from the layout.
   BindingStorage data;
+
+  // incremented atomically whenever the set is allocated or reset, so that anything derived from or
+  // pointing into the contents above can cheaply check if it's stale.
+  int64_t generation = 0;
 };
 
 // we used to cache these bindrefs at update time, but unfortunately many applications have
 // extremely high numbers of descriptors and update them almost a 1:1 rate with their use (or
 // sometimes higher). It's not feasible to do any per-descriptor tracking in the background, so we
 // gather the data we need from the descriptor contents at capture time only into this struct.
+// While capturing these are cached per set and only the descriptors written since are added on later
+// submits, so a large set is only walked in full on its first submit.
 struct DescriptorBindRefs
 {
   std::unordered_map<ResourceId, FrameRefType> bindFrameRefs;
@@ -1150,6 +1156,9 @@ struct MemMapState
   // flush this may point to the readback memory so that we read from that fast copy instead of the
   // slow actual pointer.
   byte *cpuReadPtr = NULL;
+  // if set, writes to a coherent map are tracked by page protection and only dirty pages are
+  // flushed, with no refData needed for comparison.
+  WriteWatch::Region *writeWatch = NULL;
   Threading::CriticalSection mrLock;
 };
 
@@ -2097,7 +2106,7 @@ FrameRefType MemRefs::Update(VkDeviceSize offset, VkDeviceSize size, FrameRefTyp
 }
 
 template <typename Compose>
-FrameRefType MemRefs::Merge(MemRefs &other, Compose comp)
+FrameRefType MemRefs::Merge(const MemRefs &other, Compose comp)
 {
   FrameRefType maxRefType = eFrameRef_None;
   rangeRefs.merge(other.rangeRefs,
@@ -1786,7 +1786,7 @@ static void SerialiseNext(SerialiserType &ser, VkStructureType &sType, const voi
 
     // delete the type itself. Any pNext we serialised is saved in the pNext pointer and will be
     // deleted in DeserialiseNext()
-    delete nextType;
+    ser.FreeDeserialisedNullable(nextType);
 
     // note, we don't have to serialise more of the chain - this is recursive, if there was more of
     // the pNext chain it would be done recursively above
@@ -23,10 +23,18 @@
  ******************************************************************************/
 
 #include "vk_shader_cache.h"
+#include <algorithm>
+#include "api/replay/version.h"
 #include "common/shader_cache.h"
+#include "core/settings.h"
 #include "data/glsl_shaders.h"
+#include "md5/md5.h"
 #include "strings/string_utils.h"
 
+RDOC_CONFIG(uint32_t, Vulkan_ReflectionCacheMaxMB, 64,
+            "The maximum size of the on-disk cache of shader reflection. Once it's full the least "
+            "recently used entries are evicted. 0 disables the cache.");
+
 enum class FeatureCheck
 {
   NoCheck = 0x0,
@@ -206,6 +214,275 @@ struct VulkanBlobShaderCallbacks
   const byte *GetData(SPIRVBlob blob) const { return (const byte *)blob->data(); }
 } VulkanShaderCacheCallbacks;
 
+struct VulkanReflectionCacheCallbacks
+{
+  bool Create(uint32_t size, byte *data, bytebuf **ret) const
+  {
+    RDCASSERT(ret);
+
+    *ret = new bytebuf(data, size);
+
+    return true;
+  }
+
+  void Destroy(bytebuf *blob) const { delete blob; }
+  uint32_t GetSize(bytebuf *blob) const { return (uint32_t)blob->size(); }
+  const byte *GetData(bytebuf *blob) const { return blob->data(); }
+} VulkanReflectionCacheCallbacks;
+
+DECLARE_STRINGISE_TYPE(SPIRVInterfaceAccess);
+DECLARE_STRINGISE_TYPE(SPIRVPatchData);
+
+template <class SerialiserType>
+void DoSerialise(SerialiserType &ser, SPIRVInterfaceAccess &el)
+{
+  uint32_t ID = el.ID.value();
+  uint32_t structID = el.structID.value();
+
+  ser.Serialise("ID"_lit, ID);
+  ser.Serialise("structID"_lit, structID);
+  SERIALISE_MEMBER(structMemberIndex);
+  SERIALISE_MEMBER(accessChain);
+  SERIALISE_MEMBER(isArraySubsequentElement);
+
+  el.ID = rdcspv::Id::fromWord(ID);
+  el.structID = rdcspv::Id::fromWord(structID);
+}
+
+template <class SerialiserType>
+void DoSerialise(SerialiserType &ser, SPIRVPatchData &el)
+{
+  SERIALISE_MEMBER(inputs);
+  SERIALISE_MEMBER(outputs);
+  SERIALISE_MEMBER(specIDs);
+  SERIALISE_MEMBER(outTopo);
+  SERIALISE_MEMBER(usesPrintf);
+}
+
+// each entry starts with the use counter from when it was last used, so the order entries were
+// used in is saved with them and restored the next time the cache is loaded
+static const size_t ReflectionUseHeaderSize = sizeof(uint64_t);
+
+VulkanReflectionCache::VulkanReflectionCache(bool persistent)
+{
+  m_Persistent = persistent;
+
+  if(!m_Persistent || Vulkan_ReflectionCacheMaxMB() == 0)
+    return;
+
+  bool success = LoadShaderCache("vkreflection.cache", m_ReflectionCacheMagic, GetVersion(),
+                                 m_Cache, VulkanReflectionCacheCallbacks);
+
+  // if we failed to load, write out a fresh cache
+  m_CacheDirty = !success;
+
+  rdcarray<rdcpair<uint64_t, Key>> loadOrder;
+
+  for(auto it = m_Cache.begin(); it != m_Cache.end();)
+  {
+    if(it->second->size() < ReflectionUseHeaderSize)
+    {
+      VulkanReflectionCacheCallbacks.Destroy(it->second);
+      it = m_Cache.erase(it);
+      m_CacheDirty = true;
+      continue;
+    }
+
+    uint64_t lastUse = 0;
+    memcpy(&lastUse, it->second->data(), sizeof(lastUse));
+
+    loadOrder.push_back({lastUse, it->first});
+    m_CacheSize += it->second->size();
+    ++it;
+  }
+
+  std::sort(loadOrder.begin(), loadOrder.end(),
+            [](const rdcpair<uint64_t, Key> &a, const rdcpair<uint64_t, Key> &b) {
+              return a.first < b.first;
+            });
+
+  for(const rdcpair<uint64_t, Key> &entry : loadOrder)
+    Touch(entry.second);
+}
+
+VulkanReflectionCache::~VulkanReflectionCache()
+{
+  if(m_Persistent && m_CacheDirty)
+  {
+    SaveShaderCache("vkreflection.cache", m_ReflectionCacheMagic, GetVersion(), m_Cache,
+                    VulkanReflectionCacheCallbacks);
+  }
+  else
+  {
+    for(auto it = m_Cache.begin(); it != m_Cache.end(); ++it)
+      VulkanReflectionCacheCallbacks.Destroy(it->second);
+  }
+}
+
+uint32_t VulkanReflectionCache::GetVersion()
+{
+  // the reflection can change with any build, so don't share the cache between them
+  return strhash(GitVersionHash, m_ReflectionCacheVersion);
+}
+
+VulkanReflectionCache::Key VulkanReflectionCache::MakeKey(const rdcarray<uint32_t> &spirv,
+                                                          ShaderStage stage,
+                                                          const rdcstr &entryPoint,
+                                                          const rdcarray<SpecConstant> &specInfo)
+{
+  MD5_CTX md5ctx = {};
+  MD5_Init(&md5ctx);
+
+  MD5_Update(&md5ctx, spirv.data(), (unsigned long)spirv.byteSize());
+  MD5_Update(&md5ctx, &stage, sizeof(stage));
+  // include the NULL terminator so the entry point can't run into the constants
+  MD5_Update(&md5ctx, entryPoint.c_str(), (unsigned long)entryPoint.size() + 1);
+
+  for(const SpecConstant &spec : specInfo)
+  {
+    uint64_t data[3] = {spec.specID, spec.value, spec.dataSize};
+    MD5_Update(&md5ctx, data, sizeof(data));
+  }
+
+  Key ret;
+  MD5_Final(ret.hash, &md5ctx);
+  return ret;
+}
+
+void VulkanReflectionCache::Touch(const Key &key)
+{
+  auto it = m_LastUse.find(key);
+  if(it != m_LastUse.end())
+    m_UseOrder.erase(it->second);
+
+  m_LastUse[key] = ++m_UseCounter;
+  m_UseOrder[m_UseCounter] = key;
+
+  auto entry = m_Cache.find(key);
+  if(entry != m_Cache.end())
+    memcpy(entry->second->data(), &m_UseCounter, sizeof(m_UseCounter));
+}
+
+void VulkanReflectionCache::Remove(const Key &key)
+{
+  auto it = m_Cache.find(key);
+  if(it != m_Cache.end())
+  {
+    m_CacheSize -= it->second->size();
+    VulkanReflectionCacheCallbacks.Destroy(it->second);
+    m_Cache.erase(it);
+  }
+
+  auto use = m_LastUse.find(key);
+  if(use != m_LastUse.end())
+  {
+    m_UseOrder.erase(use->second);
+    m_LastUse.erase(use);
+  }
+
+  m_CacheDirty = true;
+}
+
+bool VulkanReflectionCache::Fetch(const Key &key, ShaderReflection &refl,
+                                  ShaderBindpointMapping &mapping, SPIRVPatchData &patchData)
+{
+  SCOPED_LOCK(m_Lock);
+
+  auto it = m_Cache.find(key);
+  if(it == m_Cache.end())
+    return false;
+
+  ShaderReflection cachedRefl;
+  ShaderBindpointMapping cachedMapping;
+  SPIRVPatchData cachedPatchData;
+
+  {
+    ReadSerialiser ser(new StreamReader(it->second->data() + ReflectionUseHeaderSize,
+                                        it->second->size() - ReflectionUseHeaderSize),
+                       Ownership::Stream);
+
+    ser.ReadChunk<uint32_t>();
+    ser.Serialise("refl"_lit, cachedRefl);
+    ser.Serialise("mapping"_lit, cachedMapping);
+    ser.Serialise("patchData"_lit, cachedPatchData);
+    ser.EndChunk();
+
+    if(ser.IsErrored())
+    {
+      RDCWARN("Corrupt entry in reflection cache, discarding");
+      Remove(key);
+      return false;
+    }
+  }
+
+  // the order entries were used in is saved, so save if this changes it
+  if(m_LastUse[key] != m_UseCounter)
+  {
+    Touch(key);
+    m_CacheDirty = true;
+  }
+
+  // the cache doesn't store the SPIR-V itself, keep whatever the caller already has
+  cachedRefl.rawBytes.swap(refl.rawBytes);
+
+  refl = cachedRefl;
+  mapping = cachedMapping;
+  patchData = cachedPatchData;
+
+  return true;
+}
+
+void VulkanReflectionCache::Store(const Key &key, ShaderReflection &refl,
+                                  const ShaderBindpointMapping &mapping,
+                                  const SPIRVPatchData &patchData)
+{
+  const uint64_t maxSize = uint64_t(Vulkan_ReflectionCacheMaxMB()) * 1024 * 1024;
+
+  if(maxSize == 0)
+    return;
+
+  // the raw bytes are the SPIR-V which is already in the capture, so they're not stored
+  bytebuf rawBytes;
+  rawBytes.swap(refl.rawBytes);
+
+  StreamWriter writer(StreamWriter::DefaultScratchSize);
+
+  {
+    WriteSerialiser ser(&writer, Ownership::Nothing);
+
+    SCOPED_SERIALISE_CHUNK(1);
+    ser.Serialise("refl"_lit, refl);
+    ser.Serialise("mapping"_lit, (ShaderBindpointMapping &)mapping);
+    ser.Serialise("patchData"_lit, (SPIRVPatchData &)patchData);
+  }
+
+  rawBytes.swap(refl.rawBytes);
+
+  const uint64_t size = ReflectionUseHeaderSize + writer.GetOffset();
+
+  SCOPED_LOCK(m_Lock);
+
+  if(size > maxSize || m_Cache.find(key) != m_Cache.end())
+    return;
+
+  // make room by evicting whatever was used longest ago
+  while(m_CacheSize + size > maxSize && !m_UseOrder.empty())
+  {
+    const Key oldest = m_UseOrder.begin()->second;
+    Remove(oldest);
+  }
+
+  bytebuf *entry = new bytebuf;
+  entry->resize((size_t)size);
+  memcpy(entry->data() + ReflectionUseHeaderSize, writer.GetData(), (size_t)writer.GetOffset());
+
+  m_Cache[key] = entry;
+  m_CacheSize += size;
+  m_CacheDirty = true;
+
+  Touch(key);
+}
+
 struct VkPipeCacheHeader
 {
   uint32_t length;
@@ -88,6 +88,54 @@ enum class BuiltinShaderTextureType
 
 ITERABLE_OPERATORS(BuiltinShaderTextureType);
 
+// reflection generated from SPIR-V, kept on disk between sessions so that captures which are
+// opened repeatedly don't re-reflect the same shaders each time. Entries are keyed by a hash of
+// everything the reflection depends on. This is only used when replaying, and is thread-safe.
+class VulkanReflectionCache
+{
+public:
+  // a non-persistent cache is neither loaded from nor saved to disk
+  explicit VulkanReflectionCache(bool persistent = true);
+  ~VulkanReflectionCache();
+
+  struct Key
+  {
+    byte hash[16];
+    bool operator<(const Key &o) const { return memcmp(hash, o.hash, sizeof(hash)) < 0; }
+  };
+
+  static Key MakeKey(const rdcarray<uint32_t> &spirv, ShaderStage stage, const rdcstr &entryPoint,
+                     const rdcarray<SpecConstant> &specInfo);
+
+  // returns false if there's no entry for key, leaving the outputs unmodified
+  bool Fetch(const Key &key, ShaderReflection &refl, ShaderBindpointMapping &mapping,
+             SPIRVPatchData &patchData);
+  // refl.rawBytes isn't stored, since it's the SPIR-V itself. Fetch() leaves it untouched.
+  void Store(const Key &key, ShaderReflection &refl, const ShaderBindpointMapping &mapping,
+             const SPIRVPatchData &patchData);
+
+private:
+  static const uint32_t m_ReflectionCacheMagic = 0xf00d2ef1;
+  static const uint32_t m_ReflectionCacheVersion = 2;
+
+  static uint32_t GetVersion();
+
+  // must be called with m_Lock held
+  void Touch(const Key &key);
+  void Remove(const Key &key);
+
+  Threading::CriticalSection m_Lock;
+  std::map<Key, bytebuf *> m_Cache;
+  // entries ordered from least to most recently used, so the oldest can be evicted once the cache
+  // is full. The order is saved with the entries, and entries loaded from disk are older than any
+  // used in this session.
+  std::map<uint64_t, Key> m_UseOrder;
+  std::map<Key, uint64_t> m_LastUse;
+  uint64_t m_UseCounter = 0;
+  uint64_t m_CacheSize = 0;
+  bool m_Persistent = false, m_CacheDirty = false;
+};
+
 class VulkanShaderCache
 {
 public:
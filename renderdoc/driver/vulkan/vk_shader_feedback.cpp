@@ -1421,7 +1421,7 @@ void VulkanReplay::FetchShaderFeedback(uint32_t eventId)
 
   if(result.compute)
   {
-    usesPrintf = pipeInfo.shaders[5].patchData->usesPrintf;
+    usesPrintf = pipeInfo.shaders[5].GetPatchData()->usesPrintf;
   }
   else
   {
@@ -1432,7 +1432,7 @@ void VulkanReplay::FetchShaderFeedback(uint32_t eventId)
 
       int idx = StageIndex(stage.stage);
 
-      usesPrintf |= pipeInfo.shaders[idx].patchData->usesPrintf;
+      usesPrintf |= pipeInfo.shaders[idx].GetPatchData()->usesPrintf;
     }
   }
 
@@ -1642,7 +1642,7 @@ void VulkanReplay::FetchShaderFeedback(uint32_t eventId)
     if(!Vulkan_Debug_FeedbackDumpDirPath().empty())
       FileIO::WriteAll(Vulkan_Debug_FeedbackDumpDirPath() + "/before_" + filename[5], modSpirv);
 
-    AnnotateShader(*pipeInfo.shaders[5].refl, *pipeInfo.shaders[5].patchData,
+    AnnotateShader(*pipeInfo.shaders[5].GetReflection(), *pipeInfo.shaders[5].GetPatchData(),
                    ShaderStage(StageIndex(stage.stage)), stage.pName, offsetMap, maxSlot, false,
                    bufferAddress, useBufferAddressKHR, false, modSpirv, printfData[5]);
 
@@ -1708,7 +1708,7 @@ void VulkanReplay::FetchShaderFeedback(uint32_t eventId)
       if(!Vulkan_Debug_FeedbackDumpDirPath().empty())
         FileIO::WriteAll(Vulkan_Debug_FeedbackDumpDirPath() + "/before_" + filename[idx], modSpirv);
 
-      AnnotateShader(*pipeInfo.shaders[idx].refl, *pipeInfo.shaders[idx].patchData,
+      AnnotateShader(*pipeInfo.shaders[idx].GetReflection(), *pipeInfo.shaders[idx].GetPatchData(),
                      ShaderStage(StageIndex(stage.stage)), stage.pName, offsetMap, maxSlot,
                      usePrimitiveID, bufferAddress, useBufferAddressKHR, usesMultiview, modSpirv,
                      printfData[idx]);
@@ -1915,7 +1915,7 @@ void VulkanReplay::FetchShaderFeedback(uint32_t eventId)
         {
           for(int x = 0; x < 3; x++)
           {
-            uint32_t threadDimX = sh.refl->dispatchThreadsDimension[x];
+            uint32_t threadDimX = sh.GetReflection()->dispatchThreadsDimension[x];
             msg.location.compute.workgroup[x] = location[x] / threadDimX;
             msg.location.compute.thread[x] = location[x] % threadDimX;
           }
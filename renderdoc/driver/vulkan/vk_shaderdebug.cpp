@@ -22,6 +22,7 @@
  * THE SOFTWARE.
  ******************************************************************************/
 
+#include "common/job_pool.h"
 #include "core/settings.h"
 #include "driver/shaders/spirv/spirv_debug.h"
 #include "driver/shaders/spirv/spirv_editor.h"
@@ -155,6 +156,7 @@ public:
       : m_DebugData(vk->GetReplay()->GetShaderDebugData()), m_Creation(creation), m_EventID(eid)
   {
     m_pDriver = vk;
+    m_BatchLock = vk->GetReplay()->GetShaderDebugBatchLock();
 
     // when we're first setting up, the state is pristine and no replay is needed
     m_ResourcesDirty = false;
@@ -321,6 +323,8 @@ public:
 
   ~VulkanAPIWrapper()
   {
+    Threading::ScopedLock lock(m_BatchLock);
+
     m_pDriver->FlushQ();
 
     VkDevice dev = m_pDriver->GetDev();
@@ -332,6 +336,10 @@ public:
 
   void ResetReplay()
   {
+    // in a batch the replay is reset once for all invocations, and they never dirty resources
+    if(m_BatchLock)
+      return;
+
     if(!m_ResourcesDirty)
     {
       VkMarkerRegion region("ResetReplay");
@@ -345,6 +353,8 @@ public:
   virtual void AddDebugMessage(MessageCategory c, MessageSeverity sv, MessageSource src,
                                rdcstr d) override
   {
+    Threading::ScopedLock lock(m_BatchLock);
+
     m_pDriver->AddDebugMessage(c, sv, src, d);
   }
 
@@ -385,7 +395,7 @@ public:
 
     if(coords[0] > data.width || coords[1] > data.height || coords[2] > data.depth)
     {
-      m_pDriver->AddDebugMessage(
+      AddDebugMessage(
           MessageCategory::Execution, MessageSeverity::High, MessageSource::RuntimeWarning,
           StringFormat::Fmt(
               "Out of bounds access to image, coord %u,%u,%u outside of dimensions %ux%ux%u",
@@ -475,7 +485,7 @@ public:
 
     if(coords[0] > data.width || coords[1] > data.height || coords[2] > data.depth)
     {
-      m_pDriver->AddDebugMessage(
+      AddDebugMessage(
           MessageCategory::Execution, MessageSeverity::High, MessageSource::RuntimeWarning,
           StringFormat::Fmt(
               "Out of bounds access to image, coord %u,%u,%u outside of dimensions %ux%ux%u",
@@ -641,6 +651,8 @@ public:
                              const rdcspv::ImageOperandsAndParamDatas &operands,
                              ShaderVariable &output) override
   {
+    Threading::ScopedLock lock(m_BatchLock);
+
     ShaderConstParameters constParams = {};
     ShaderUniformParameters uniformParams = {};
 
@@ -1375,6 +1387,8 @@ public:
   virtual bool CalculateMathOp(rdcspv::ThreadState &lane, rdcspv::GLSLstd450 op,
                                const rdcarray<ShaderVariable> &params, ShaderVariable &output) override
   {
+    Threading::ScopedLock lock(m_BatchLock);
+
     RDCASSERT(params.size() <= 3, params.size());
 
     int floatSizeIdx = 0;
@@ -1505,6 +1519,7 @@ public:
 
 private:
   WrappedVulkan *m_pDriver = NULL;
+  Threading::CriticalSection *m_BatchLock = NULL;
   ShaderDebugData &m_DebugData;
   VulkanCreationInfo &m_Creation;
 
@@ -1555,7 +1570,7 @@ private:
 
     if(index.bindset < 0 || index.bindset >= m_DescSets.count())
     {
-      m_pDriver->AddDebugMessage(
+      AddDebugMessage(
           MessageCategory::Execution, MessageSeverity::High, MessageSource::RuntimeWarning,
           StringFormat::Fmt(
               "Out of bounds access to unbound descriptor set %u (binding %u) when %s",
@@ -1568,7 +1583,7 @@ private:
 
     if(index.bind < 0 || index.bind >= setData.bindings.count())
     {
-      m_pDriver->AddDebugMessage(
+      AddDebugMessage(
           MessageCategory::Execution, MessageSeverity::High, MessageSource::RuntimeWarning,
           StringFormat::Fmt(
               "Out of bounds access to non-existant descriptor set %u binding %u when %s",
@@ -1583,7 +1598,7 @@ private:
 
     if(elemData.empty())
     {
-      m_pDriver->AddDebugMessage(
+      AddDebugMessage(
           MessageCategory::Execution, MessageSeverity::High, MessageSource::RuntimeWarning,
           StringFormat::Fmt("descriptor set %u binding %u is not bound, when %s", index.bindset,
                             index.bind, access.c_str()));
@@ -1593,12 +1608,12 @@ private:
 
     if(index.arrayIndex >= elemData.size())
     {
-      m_pDriver->AddDebugMessage(MessageCategory::Execution, MessageSeverity::High,
-                                 MessageSource::RuntimeWarning,
-                                 StringFormat::Fmt("descriptor set %u binding %u has %zu "
-                                                   "descriptors, index %u is out of bounds when %s",
-                                                   index.bindset, index.bind, elemData.size(),
-                                                   index.arrayIndex, access.c_str()));
+      AddDebugMessage(MessageCategory::Execution, MessageSeverity::High,
+                      MessageSource::RuntimeWarning,
+                      StringFormat::Fmt("descriptor set %u binding %u has %zu "
+                                        "descriptors, index %u is out of bounds when %s",
+                                        index.bindset, index.bind, elemData.size(),
+                                        index.arrayIndex, access.c_str()));
       valid = false;
       return dummy;
     }
@@ -1612,6 +1627,8 @@ private:
     bytebuf &data = insertIt.first->second;
     if(insertIt.second)
     {
+      Threading::ScopedLock lock(m_BatchLock);
+
       if(bind.bindset == PushConstantBindSet)
       {
         data = pushData;
@@ -1650,6 +1667,8 @@ private:
     ImageData &data = insertIt.first->second;
     if(insertIt.second)
     {
+      Threading::ScopedLock lock(m_BatchLock);
+
       bool valid = true;
       const VkDescriptorImageInfo &imgData =
           GetDescriptor<VkDescriptorImageInfo>("performing image load/store", bind, valid);
@@ -4645,8 +4664,8 @@ ShaderDebugTrace *VulkanReplay::DebugPixel(uint32_t eventId, uint32_t x, uint32_
 
   if(winner)
   {
-    rdcspv::Debugger *debugger = new rdcspv::Debugger;
-    debugger->Parse(shader.spirv.GetSPIRV());
+    rdcspv::Debugger *debugger =
+        CreateShaderDebugger(pipe.shaders[4].module, shader.spirv.GetSPIRV());
 
     // the data immediately follows the PSHit header. Every piece of data is uniformly aligned,
     // either 16-byte by default or 32-byte if larger components exist. The output is in input
@@ -4768,7 +4787,9 @@ ShaderDebugTrace *VulkanReplay::DebugThread(uint32_t eventId,
   }
 
   // get ourselves in pristine state before this dispatch (without any side effects it may have had)
-  m_pDriver->ReplayLog(0, eventId, eReplay_WithoutDraw);
+  // a batch does this once for every thread it debugs
+  if(!m_DebugBatch.active)
+    m_pDriver->ReplayLog(0, eventId, eReplay_WithoutDraw);
 
   const VulkanCreationInfo::Pipeline &pipe = c.m_Pipeline[state.compute.pipeline];
   VulkanCreationInfo::ShaderModule &shader = c.m_ShaderModule[pipe.shaders[5].module];
@@ -4812,8 +4833,8 @@ ShaderDebugTrace *VulkanReplay::DebugThread(uint32_t eventId,
       0U, 0U, 0U);
   builtins[ShaderBuiltin::DeviceIndex] = ShaderVariable(rdcstr(), 0U, 0U, 0U, 0U);
 
-  rdcspv::Debugger *debugger = new rdcspv::Debugger;
-  debugger->Parse(shader.spirv.GetSPIRV());
+  rdcspv::Debugger *debugger =
+      CreateShaderDebugger(pipe.shaders[5].module, shader.spirv.GetSPIRV());
   ShaderDebugTrace *ret = debugger->BeginDebug(apiWrapper, ShaderStage::Compute, entryPoint, spec,
                                                shadRefl.instructionLines, shadRefl.patchData, 0);
   apiWrapper->ResetReplay();
@@ -4828,8 +4849,30 @@ rdcarray<ShaderDebugState> VulkanReplay::ContinueDebug(ShaderDebugger *debugger)
   if(!spvDebugger)
     return {};
 
+  // a batch runs its invocations in parallel, so this can't touch the queue or shared descriptors.
+  // They're prepared once in FinishDebugBatch instead, and each API access locks.
+  if(m_DebugBatch.active)
+    return spvDebugger->ContinueDebug();
+
   VkMarkerRegion region("ContinueDebug Simulation Loop");
 
+  PrepareShaderDebugDescriptors();
+
+  rdcarray<ShaderDebugState> ret = spvDebugger->ContinueDebug();
+
+  VulkanAPIWrapper *api = (VulkanAPIWrapper *)spvDebugger->GetAPIWrapper();
+  api->ResetReplay();
+
+  return ret;
+}
+
+void VulkanReplay::FreeDebugger(ShaderDebugger *debugger)
+{
+  delete debugger;
+}
+
+void VulkanReplay::PrepareShaderDebugDescriptors()
+{
   for(size_t fmt = 0; fmt < ARRAY_COUNT(m_TexRender.DummyImageViews); fmt++)
   {
     for(size_t dim = 0; dim < ARRAY_COUNT(m_TexRender.DummyImageViews[0]); dim++)
@@ -4865,16 +4908,102 @@ rdcarray<ShaderDebugState> VulkanReplay::ContinueDebug(ShaderDebugger *debugger)
     m_ShaderDebugData.DummyWrites[fmt][6].pTexelBufferView =
         UnwrapPtr(m_TexRender.DummyBufferView[fmt]);
   }
+}
 
-  rdcarray<ShaderDebugState> ret = spvDebugger->ContinueDebug();
+rdcspv::Debugger *VulkanReplay::CreateShaderDebugger(ResourceId module,
+                                                     const rdcarray<uint32_t> &spirv)
+{
+  if(!m_DebugBatch.active)
+  {
+    rdcspv::Debugger *debugger = new rdcspv::Debugger;
+    debugger->Parse(spirv);
+    return debugger;
+  }
 
-  VulkanAPIWrapper *api = (VulkanAPIWrapper *)spvDebugger->GetAPIWrapper();
-  api->ResetReplay();
+  rdcspv::Debugger *&parsed = m_DebugBatch.parsed[module];
+  if(!parsed)
+  {
+    parsed = new rdcspv::Debugger;
+    parsed->Parse(spirv);
+  }
+
+  // copies refer to the parsed debug info, so they are all freed before it in FinishDebugBatch
+  return new rdcspv::Debugger(*parsed);
+}
+
+rdcarray<ShaderDebugResult> VulkanReplay::FinishDebugBatch(
+    uint32_t eventId, const rdcarray<ShaderDebugTrace *> &traces, const rdcarray<rdcstr> &variables)
+{
+  rdcarray<ShaderDebugResult> ret;
+  ret.resize(traces.size());
+
+  // every invocation reads resources as they were before the event. Nothing they do modifies them
+  // so this one replay is shared between them all.
+  m_pDriver->ReplayLog(0, eventId, eReplay_WithoutDraw);
+
+  PrepareShaderDebugDescriptors();
+
+  {
+    VkMarkerRegion region(StringFormat::Fmt("Debugging %zu invocations", traces.size()));
+
+    Threading::JobPool jobs;
+
+    for(size_t i = 0; i < traces.size(); i++)
+    {
+      ShaderDebugTrace *trace = traces[i];
+      ShaderDebugResult &result = ret[i];
+      jobs.Release(jobs.Add([this, trace, &result, &variables]() {
+        result = RunDebugToCompletion(this, trace, variables);
+      }));
+    }
+
+    jobs.WaitAll();
+  }
+
+  // replay the event itself to get back to its normal state
+  m_pDriver->ReplayLog(0, eventId, eReplay_OnlyDraw);
+
+  for(auto it = m_DebugBatch.parsed.begin(); it != m_DebugBatch.parsed.end(); ++it)
+    delete it->second;
+  m_DebugBatch.parsed.clear();
+  m_DebugBatch.active = false;
 
   return ret;
 }
 
-void VulkanReplay::FreeDebugger(ShaderDebugger *debugger)
+rdcarray<ShaderDebugResult> VulkanReplay::DebugPixelBatch(
+    uint32_t eventId, const rdcarray<DebugPixelInvocation> &pixels,
+    const rdcarray<rdcstr> &variables)
 {
-  delete debugger;
+  if(!GetAPIProperties().shaderDebugging)
+    return IRemoteDriver::DebugPixelBatch(eventId, pixels, variables);
+
+  m_DebugBatch.active = true;
+
+  // each pixel's inputs are still fetched with their own replay, only the simulation is shared
+  rdcarray<ShaderDebugTrace *> traces;
+  traces.reserve(pixels.size());
+  for(const DebugPixelInvocation &pixel : pixels)
+    traces.push_back(DebugPixel(eventId, pixel.x, pixel.y, pixel.sample, pixel.primitive));
+
+  return FinishDebugBatch(eventId, traces, variables);
+}
+
+rdcarray<ShaderDebugResult> VulkanReplay::DebugThreadBatch(
+    uint32_t eventId, const rdcarray<DebugThreadInvocation> &threads,
+    const rdcarray<rdcstr> &variables)
+{
+  if(!GetAPIProperties().shaderDebugging)
+    return IRemoteDriver::DebugThreadBatch(eventId, threads, variables);
+
+  m_DebugBatch.active = true;
+
+  m_pDriver->ReplayLog(0, eventId, eReplay_WithoutDraw);
+
+  rdcarray<ShaderDebugTrace *> traces;
+  traces.reserve(threads.size());
+  for(const DebugThreadInvocation &thread : threads)
+    traces.push_back(DebugThread(eventId, thread.groupid, thread.threadid));
+
+  return FinishDebugBatch(eventId, traces, variables);
 }
@@ -1110,7 +1110,8 @@ bool WrappedVulkan::Serialise_vkBeginCommandBuffer(SerialiserType &ser, VkComman
             partial = true;
             partialType = p;
           }
-          else if(it->baseEvent <= m_LastEventID)
+          else if(it->baseEvent <= m_LastEventID &&
+                  it->baseEvent + length > m_CheckpointSkipEventID)
           {
 #if ENABLED(VERBOSE_PARTIAL_REPLAY)
             RDCDEBUG("vkBegin - full re-record detected %u < %u <= %u, %s -> %s", it->baseEvent,
@@ -1118,7 +1119,8 @@ bool WrappedVulkan::Serialise_vkBeginCommandBuffer(SerialiserType &ser, VkComman
                      ToStr(BakedCommandBuffer).c_str());
 #endif
 
-            // this submission is completely within the range, so it should still be re-recorded
+            // this submission is completely within the range, so it should still be re-recorded.
+            // Submissions before any replay checkpoint being restored won't be executed at all
             rerecord = true;
           }
         }
@@ -28,6 +28,8 @@
 RDOC_DEBUG_CONFIG(bool, Vulkan_Debug_AllowDescriptorSetReuse, true,
                   "Allow the re-use of descriptor sets via vkResetDescriptorPool.");
 
+RDOC_EXTERN_CONFIG(bool, Vulkan_Debug_CacheDescriptorBindRefs);
+
 template <>
 VkDescriptorSetLayoutCreateInfo WrappedVulkan::UnwrapInfo(const VkDescriptorSetLayoutCreateInfo *info)
 {
@@ -657,6 +659,8 @@ VkResult WrappedVulkan::vkAllocateDescriptorSets(VkDevice device,
       {
         record->descInfo->data.reset();
       }
+
+      Atomic::Inc64(&record->descInfo->generation);
     }
     else
     {
@@ -698,7 +702,7 @@ VkResult WrappedVulkan::vkResetDescriptorPool(VkDevice device, VkDescriptorPool
     // don't reset while capture transition lock is held, so that we can't reset and potentially
     // reuse a record we might be preparing. We do this here rather than in vkAllocateDescriptorSets
     // where we actually modify the record, since that's much higher frequency
-    SCOPED_READLOCK(m_CapTransitionLock);
+    SCOPED_EPOCH_READLOCK(m_CapTransitionLock);
 
     if(IsCaptureMode(m_State))
     {
@@ -710,6 +714,7 @@ VkResult WrappedVulkan::vkResetDescriptorPool(VkDevice device, VkDescriptorPool
         {
           ((WrappedVkNonDispRes *)(*it)->Resource)->real = RealVkRes(0x123456);
           (*it)->descInfo->data.reset();
+          Atomic::Inc64(&(*it)->descInfo->generation);
         }
 
         record->descPoolInfo->freelist.assign(record->pooledChildren);
@@ -1039,6 +1044,18 @@ bool WrappedVulkan::Serialise_vkUpdateDescriptorSets(SerialiserType &ser, VkDevi
   return true;
 }
 
+WrappedVulkan::CachedBindRefs *WrappedVulkan::GetDirtyBindRefs(VkResourceRecord *setrecord)
+{
+  auto it = m_CachedBindRefs.find(setrecord->GetResourceID());
+
+  // nothing to add to if the set hasn't been submitted yet, or will be gathered from scratch anyway
+  if(it == m_CachedBindRefs.end() || it->second.regather ||
+     it->second.generation != Atomic::ExchAdd64(&setrecord->descInfo->generation, 0))
+    return NULL;
+
+  return &it->second;
+}
+
 void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
                                            const VkWriteDescriptorSet *pDescriptorWrites,
                                            uint32_t copyCount,
@@ -1172,7 +1189,7 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
   }
 
   {
-    SCOPED_READLOCK(m_CapTransitionLock);
+    SCOPED_EPOCH_READLOCK(m_CapTransitionLock);
 
     if(IsActiveCapturing(m_State))
     {
@@ -1232,6 +1249,11 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
   // need to track descriptor set contents whether capframing or idle
   if(IsCaptureMode(m_State))
   {
+    // while capturing, writes to sets that have already been submitted are added to their cached
+    // bind refs on the next submit
+    bool dirtyRefs = IsActiveCapturing(m_State) && Vulkan_Debug_CacheDescriptorBindRefs();
+    SCOPED_LOCK_OPTIONAL(m_CachedBindRefsLock, dirtyRefs);
+
     for(uint32_t i = 0; i < writeCount; i++)
     {
       const VkWriteDescriptorSet &descWrite = pDescriptorWrites[i];
@@ -1240,6 +1262,8 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
       RDCASSERT(record->descInfo && record->descInfo->layout);
       const DescSetLayout &layout = *record->descInfo->layout;
 
+      CachedBindRefs *cached = dirtyRefs ? GetDirtyBindRefs(record) : NULL;
+
       RDCASSERT(descWrite.dstBinding < record->descInfo->data.binds.size());
 
       DescriptorSetSlot **binding = &record->descInfo->data.binds[descWrite.dstBinding];
@@ -1326,6 +1350,9 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
         {
           bind.SetBuffer(descWrite.descriptorType, descWrite.pBufferInfo[d]);
         }
+
+        if(cached)
+          cached->MarkDirty(bind);
       }
     }
 
@@ -1343,6 +1370,8 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
       RDCASSERT(srcrecord->descInfo && srcrecord->descInfo->layout);
       const DescSetLayout &srclayout = *srcrecord->descInfo->layout;
 
+      CachedBindRefs *cached = dirtyRefs ? GetDirtyBindRefs(dstrecord) : NULL;
+
       RDCASSERT(pDescriptorCopies[i].dstBinding < dstrecord->descInfo->data.binds.size());
       RDCASSERT(pDescriptorCopies[i].srcBinding < srcrecord->descInfo->data.binds.size());
 
@@ -1397,6 +1426,9 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
         DescriptorSetSlot &bind = (*dstbinding)[curDstIdx];
 
         bind = (*srcbinding)[curSrcIdx];
+
+        if(cached)
+          cached->MarkDirty(bind);
       }
     }
   }
@@ -1620,7 +1652,7 @@ void WrappedVulkan::vkUpdateDescriptorSetWithTemplate(
   }
 
   {
-    SCOPED_READLOCK(m_CapTransitionLock);
+    SCOPED_EPOCH_READLOCK(m_CapTransitionLock);
 
     if(IsActiveCapturing(m_State))
     {
@@ -1643,6 +1675,11 @@ void WrappedVulkan::vkUpdateDescriptorSetWithTemplate(
   // need to track descriptor set contents whether capframing or idle
   if(IsCaptureMode(m_State))
   {
+    bool dirtyRefs = IsActiveCapturing(m_State) && Vulkan_Debug_CacheDescriptorBindRefs();
+    SCOPED_LOCK_OPTIONAL(m_CachedBindRefsLock, dirtyRefs);
+
+    CachedBindRefs *cached = dirtyRefs ? GetDirtyBindRefs(GetRecord(descriptorSet)) : NULL;
+
     for(const VkDescriptorUpdateTemplateEntry &entry : tempInfo->updates)
     {
       VkResourceRecord *record = GetRecord(descriptorSet);
@@ -1720,6 +1757,9 @@ void WrappedVulkan::vkUpdateDescriptorSetWithTemplate(
         {
           bind.SetBuffer(entry.descriptorType, *(const VkDescriptorBufferInfo *)src);
         }
+
+        if(cached)
+          cached->MarkDirty(bind);
       }
     }
   }
@@ -242,7 +242,7 @@ void WrappedVulkan::vkDestroyBuffer(VkDevice device, VkBuffer buffer,
   // artificially extend the lifespan of buffer device address memory or buffers, to ensure their
   // opaque capture address isn't re-used before the capture completes
   {
-    SCOPED_READLOCK(m_CapTransitionLock);
+    SCOPED_EPOCH_READLOCK(m_CapTransitionLock);
     if(IsActiveCapturing(m_State) && m_DeviceAddressResources.IDs.contains(GetResID(buffer)))
     {
       // we can't hold onto the user callback so we'll be freeing with NULL.
@@ -2132,6 +2132,11 @@ bool WrappedVulkan::Serialise_SetShaderDebugPath(SerialiserType &ser, VkShaderMo
 
   if(IsReplayingAndReading())
   {
+    // replacing the SPIR-V can't race with any parsing or disassembly of the stripped module
+    if(m_CreationInfo.m_LoadJobs)
+      m_CreationInfo.m_LoadJobs->WaitAll();
+    m_CreationInfo.WaitForShaderPrefetch();
+
     m_CreationInfo.m_ShaderModule[GetResID(ShaderObject)].unstrippedPath = DebugPath;
     m_CreationInfo.m_ShaderModule[GetResID(ShaderObject)].Reinit();
 
@@ -29,6 +29,40 @@
 
 RDOC_EXTERN_CONFIG(bool, Vulkan_Debug_VerboseCommandRecording);
 
+RDOC_CONFIG(bool, Vulkan_Debug_CacheDescriptorBindRefs, true,
+            "While capturing, reuse the references gathered from a descriptor set on later "
+            "submits and only add in the descriptors written since, instead of walking the whole "
+            "set on every submit.");
+
+static uint32_t GatherBindRefs(VkResourceRecord *setrecord, DescriptorBindRefs &refs,
+                               VulkanResourceManager *rm)
+{
+  DescSetLayout *layout = setrecord->descInfo->layout;
+
+  uint32_t total = 0;
+
+  for(size_t b = 0, num = layout->bindings.size(); b < num; b++)
+  {
+    const DescSetLayout::Binding &bind = layout->bindings[b];
+
+    // skip empty bindings or inline uniform blocks
+    if(bind.layoutDescType == VK_DESCRIPTOR_TYPE_MAX_ENUM ||
+       bind.layoutDescType == VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK)
+      continue;
+
+    uint32_t count = bind.descriptorCount;
+    if(bind.variableSize)
+      count = setrecord->descInfo->data.variableDescriptorCount;
+
+    for(uint32_t a = 0; a < count; a++)
+      setrecord->descInfo->data.binds[b][a].AccumulateBindRefs(refs, rm);
+
+    total += count;
+  }
+
+  return total;
+}
+
 template <typename SerialiserType>
 bool WrappedVulkan::Serialise_vkGetDeviceQueue(SerialiserType &ser, VkDevice device,
                                                uint32_t queueFamilyIndex, uint32_t queueIndex,
@@ -415,6 +449,14 @@ void WrappedVulkan::ReplayQueueSubmit(VkQueue queue, VkSubmitInfo2 submitInfo, r
     {
 #if ENABLED(VERBOSE_PARTIAL_REPLAY)
       RDCDEBUG("Queue Submit no replay %u == %u", m_LastEventID, startEID);
+#endif
+    }
+    else if(m_RootEventID <= m_CheckpointSkipEventID)
+    {
+      // the results of this submission will be restored from a replay checkpoint, so there's no
+      // need to execute it again
+#if ENABLED(VERBOSE_PARTIAL_REPLAY)
+      RDCDEBUG("Queue Submit skipped by checkpoint %u <= %u", m_RootEventID, m_CheckpointSkipEventID);
 #endif
     }
     else
@@ -1001,27 +1043,52 @@ void WrappedVulkan::CaptureQueueSubmit(VkQueue queue,
 
       VkResourceRecord *setrecord = it->second;
 
-      DescriptorBindRefs refs;
+      // walking every descriptor is expensive for large sets, so reuse what was gathered on an
+      // earlier submit where possible. The lock is held while the refs are used, in case another
+      // queue is submitting with the same set.
+      SCOPED_LOCK(m_CachedBindRefsLock);
 
-      DescSetLayout *layout = setrecord->descInfo->layout;
+      DescriptorBindRefs uncached;
+      const DescriptorBindRefs *refsptr = &uncached;
 
-      for(size_t b = 0, num = layout->bindings.size(); b < num; b++)
+      if(Vulkan_Debug_CacheDescriptorBindRefs())
       {
-        const DescSetLayout::Binding &bind = layout->bindings[b];
+        CachedBindRefs &cached = m_CachedBindRefs[it->first];
 
-        // skip empty bindings or inline uniform blocks
-        if(bind.layoutDescType == VK_DESCRIPTOR_TYPE_MAX_ENUM ||
-           bind.layoutDescType == VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK)
-          continue;
+        int64_t generation = Atomic::ExchAdd64(&setrecord->descInfo->generation, 0);
 
-        uint32_t count = bind.descriptorCount;
-        if(bind.variableSize)
-          count = setrecord->descInfo->data.variableDescriptorCount;
+        // the dirty slots point into the set's storage, so they must be dropped without looking at
+        // them if it's been reallocated
+        if(cached.generation != generation || cached.regather ||
+           rm->CheckReleasedDescriptorResources(cached.releasedPosition, cached.refs.bindFrameRefs))
+        {
+          cached.refs = DescriptorBindRefs();
+          cached.generation = generation;
+          cached.releasedPosition = rm->GetReleasedDescriptorResourceCount();
+          cached.dirtyCount = 0;
+          cached.regather = false;
+          cached.dirty.clear();
+
+          cached.descriptorCount = GatherBindRefs(setrecord, cached.refs, rm);
+        }
+        else
+        {
+          for(const rdcpair<const DescriptorSetSlot *, uint32_t> &range : cached.dirty)
+            for(uint32_t a = 0; a < range.second; a++)
+              range.first[a].AccumulateBindRefs(cached.refs, rm);
 
-        for(uint32_t a = 0; a < count; a++)
-          setrecord->descInfo->data.binds[b][a].AccumulateBindRefs(refs, rm);
+          cached.dirty.clear();
+        }
+
+        refsptr = &cached.refs;
+      }
+      else
+      {
+        GatherBindRefs(setrecord, uncached, rm);
       }
 
+      const DescriptorBindRefs &refs = *refsptr;
+
       for(auto refit = refs.bindFrameRefs.begin(); refit != refs.bindFrameRefs.end(); ++refit)
       {
         refdIDs.insert(refit->first);
@@ -1040,10 +1107,7 @@ void WrappedVulkan::CaptureQueueSubmit(VkQueue queue,
       // the first recorded reference is a complete write then a later readbeforewrite won't
       // properly mark it as needing initial states preserved. So we do that here. Images are
       // handled separately
-      for(auto refit = refs.storableRefs.begin(); refit != refs.storableRefs.end(); ++refit)
-      {
-        GetResourceManager()->FixupStorageBufferMemory(refs.storableRefs);
-      }
+      GetResourceManager()->FixupStorageBufferMemory(refs.storableRefs);
     }
 
     // now we can insert frame references from command buffers, to have a conservative ordering vs.
@@ -1088,6 +1152,32 @@ void WrappedVulkan::CaptureQueueSubmit(VkQueue queue,
           continue;
         }
 
+        if(state.writeWatch)
+        {
+          // pages are write-protected so we know exactly which were written since the last flush.
+          // Anything written after the pages are re-protected here faults and is seen next time, so
+          // there's no need for refData.
+          rdcarray<rdcpair<size_t, size_t>> dirtyRanges;
+          WriteWatch::GetAndResetDirty(state.writeWatch, dirtyRanges);
+
+          for(const rdcpair<size_t, size_t> &dirty : dirtyRanges)
+          {
+            RDCDEBUG("Persistent map flush of dirty pages for %s (%llu -> %llu)",
+                     ToStr(record->GetResourceID()).c_str(), (uint64_t)dirty.first,
+                     (uint64_t)(dirty.first + dirty.second));
+            VkMappedMemoryRange range = {
+                VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+                NULL,
+                (VkDeviceMemory)(uint64_t)record->Resource,
+                state.mapOffset + dirty.first,
+                dirty.second,
+            };
+            InternalFlushMemoryRange(GetDev(), range, true, capframe);
+          }
+
+          continue;
+        }
+
         size_t diffStart = 0, diffEnd = 0;
         bool found = true;
 
@@ -1387,7 +1477,7 @@ VkResult WrappedVulkan::vkQueueSubmit(VkQueue queue, uint32_t submitCount,
   }
 
   {
-    SCOPED_READLOCK(m_CapTransitionLock);
+    SCOPED_EPOCH_READLOCK(m_CapTransitionLock);
 
     bool capframe = IsActiveCapturing(m_State);
 
@@ -1555,7 +1645,7 @@ VkResult WrappedVulkan::vkQueueSubmit2(VkQueue queue, uint32_t submitCount,
   }
 
   {
-    SCOPED_READLOCK(m_CapTransitionLock);
+    SCOPED_EPOCH_READLOCK(m_CapTransitionLock);
 
     bool capframe = IsActiveCapturing(m_State);
 
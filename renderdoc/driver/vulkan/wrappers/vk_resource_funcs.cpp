@@ -31,6 +31,12 @@ RDOC_CONFIG(bool, Vulkan_GPUReadbackDeviceLocal, true,
             "When reading back mapped device-local memory from discrete GPUs, use a GPU copy "
             "instead of a CPU side comparison directly to mapped memory.");
 
+RDOC_CONFIG(bool, Vulkan_PageTrackCoherentMaps, false,
+            "Track writes to persistent coherent maps by write-protecting their pages, instead of "
+            "comparing the whole map against a shadow copy on each submit. Only supported on "
+            "Linux. Applications that pass mapped pointers directly to system calls may see them "
+            "fail.");
+
 /************************************************************************
  *
  * Mapping is simpler in Vulkan, at least in concept, but that comes with
@@ -656,7 +662,7 @@ VkResult WrappedVulkan::vkAllocateMemory(VkDevice device, const VkMemoryAllocate
         memFlags->flags |= VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_CAPTURE_REPLAY_BIT;
 
         {
-          SCOPED_READLOCK(m_CapTransitionLock);
+          SCOPED_EPOCH_READLOCK(m_CapTransitionLock);
           m_DeviceAddressResources.IDs.push_back(record->GetResourceID());
         }
       }
@@ -762,7 +768,7 @@ void WrappedVulkan::vkFreeMemory(VkDevice device, VkDeviceMemory memory,
     // artificially extend the lifespan of buffer device address memory or buffers, to ensure their
     // opaque capture address isn't re-used before the capture completes
     {
-      SCOPED_READLOCK(m_CapTransitionLock);
+      SCOPED_EPOCH_READLOCK(m_CapTransitionLock);
       if(IsActiveCapturing(m_State) && m_DeviceAddressResources.IDs.contains(GetResID(memory)))
       {
         // we can't hold onto the user callback so we'll be freeing with NULL.
@@ -784,6 +790,9 @@ void WrappedVulkan::vkFreeMemory(VkDevice device, VkDeviceMemory memory,
         memMapState->refData = NULL;
       }
 
+      WriteWatch::Unwatch(memMapState->writeWatch);
+      memMapState->writeWatch = NULL;
+
       // destroy the wholeMemBuf if it's one we allocated ourselves
       if(!memMapState->dedicated)
         wholeMemDestroy = memMapState->wholeMemBuf;
@@ -859,6 +868,14 @@ VkResult WrappedVulkan::vkMapMemory(VkDevice device, VkDeviceMemory mem, VkDevic
 
       if(state.mapCoherent)
       {
+        if(Vulkan_PageTrackCoherentMaps() && WriteWatch::IsSupported())
+        {
+          state.writeWatch = WriteWatch::Watch(realData, (size_t)state.mapSize);
+
+          // the whole map must be flushed the first time, as it would be without refData
+          WriteWatch::MarkAllDirty(state.writeWatch);
+        }
+
         SCOPED_LOCK(m_CoherentMapsLock);
         m_CoherentMaps.push_back(memrecord);
       }
@@ -1033,7 +1050,7 @@ void WrappedVulkan::vkUnmapMemory(VkDevice device, VkDeviceMemory mem)
 
       bool capframe = false;
       {
-        SCOPED_READLOCK(m_CapTransitionLock);
+        SCOPED_EPOCH_READLOCK(m_CapTransitionLock);
         capframe = IsActiveCapturing(m_State);
 
         if(!capframe)
@@ -1076,6 +1093,9 @@ void WrappedVulkan::vkUnmapMemory(VkDevice device, VkDeviceMemory mem)
       }
 
       state.cpuReadPtr = state.mappedPtr = NULL;
+
+      WriteWatch::Unwatch(state.writeWatch);
+      state.writeWatch = NULL;
     }
 
     FreeAlignedBuffer(state.refData);
@@ -1316,7 +1336,7 @@ VkResult WrappedVulkan::vkFlushMappedMemoryRanges(VkDevice device, uint32_t memR
     bool capframe = false;
 
     {
-      SCOPED_READLOCK(m_CapTransitionLock);
+      SCOPED_EPOCH_READLOCK(m_CapTransitionLock);
       capframe = IsActiveCapturing(m_State);
     }
 
@@ -1767,7 +1787,7 @@ VkResult WrappedVulkan::vkCreateBuffer(VkDevice device, const VkBufferCreateInfo
         AddForcedReference(record);
 
         {
-          SCOPED_READLOCK(m_CapTransitionLock);
+          SCOPED_EPOCH_READLOCK(m_CapTransitionLock);
           m_DeviceAddressResources.IDs.push_back(record->GetResourceID());
         }
       }
@@ -90,6 +90,30 @@ uint32_t GetCurrentPID();
 void Shutdown();
 };
 
+// page-granular tracking of CPU writes to a range of memory. Watched pages are write-protected, and
+// the first write to each page marks it dirty and makes it writeable again, so only touched pages
+// need to be read back. Not available on all platforms, in which case Watch() returns NULL.
+// Watched ranges must not overlap. Writes made by the kernel don't fault, so a system call that
+// writes into a protected page (e.g. read() into a mapped pointer) fails with EFAULT instead of
+// marking it dirty. Only watch memory when that is an acceptable risk, e.g. behind an opt-in
+// config.
+namespace WriteWatch
+{
+struct Region;
+
+bool IsSupported();
+Region *Watch(void *base, size_t size);
+void Unwatch(Region *region);
+
+// mark the whole region as dirty, e.g. when its full contents need to be read next time
+void MarkAllDirty(Region *region);
+
+// fetch the dirty ranges as {offset, size} pairs relative to the watched base, and write-protect
+// them again. The data must be read *after* this returns, so that any write racing with the read is
+// reported next time.
+void GetAndResetDirty(Region *region, rdcarray<rdcpair<size_t, size_t>> &ranges);
+};
+
 namespace Timing
 {
 double GetTickFrequency();
@@ -139,6 +163,27 @@ public:
   data m_Data;
 };
 
+// a counting semaphore, for threads that should sleep until they have work instead of polling
+template <class data>
+class SemaphoreTemplate
+{
+public:
+  SemaphoreTemplate();
+  ~SemaphoreTemplate();
+
+  // increment the count by numToWake, waking up to that many waiting threads
+  void Wake(uint32_t numToWake = 1);
+  // wait until the count is non-zero and then decrement it. Returns false if the timeout expired
+  // before that happened
+  bool WaitForWake(uint32_t timeoutMilliseconds = ~0U);
+
+  // no copying
+  SemaphoreTemplate &operator=(const SemaphoreTemplate &other) = delete;
+  SemaphoreTemplate(const SemaphoreTemplate &other) = delete;
+
+  data m_Data;
+};
+
 void Init();
 void Shutdown();
 uint64_t AllocateTLSSlot();
@@ -146,7 +191,8 @@ uint64_t AllocateTLSSlot();
 void *GetTLSValue(uint64_t slot);
 void SetTLSValue(uint64_t slot, void *value);
 
-// must typedef CriticalSectionTemplate<X> CriticalSection
+// must typedef CriticalSectionTemplate<X> CriticalSection, RWLockTemplate<Y> RWLock and
+// SemaphoreTemplate<Z> Semaphore
 
 void SetCurrentThreadName(const rdcstr &name);
 
@@ -157,6 +203,7 @@ void JoinThread(ThreadHandle handle);
 void DetachThread(ThreadHandle handle);
 void CloseThread(ThreadHandle handle);
 void Sleep(uint32_t milliseconds);
+uint32_t GetProcessorCount();
 
 // kind of windows specific, to handle this case:
 // http://blogs.msdn.com/b/oldnewthing/archive/2013/11/05/10463645.aspx
@@ -189,11 +236,37 @@ public:
   bool RecvDataNonBlocking(void *data, uint32_t &length);
 
 private:
+  friend class SocketReactor;
+
   ptrdiff_t socket;
   uint32_t timeoutMS;
   RDResult m_Error;
 };
 
+// waits on a set of sockets at once until one of them has data waiting to be read (or a
+// connection waiting to be accepted, for server sockets). This avoids polling sockets in a loop
+// with sleeps in between, and the wait can be interrupted at any time from another thread with
+// Wake(). Uses epoll where available and falls back to poll otherwise.
+class SocketReactor
+{
+public:
+  SocketReactor();
+  ~SocketReactor();
+
+  void Add(Socket *sock);
+  void Remove(Socket *sock);
+
+  // returns true if any socket is readable, or false if the timeout expired or Wake() was called.
+  // Sockets that have been disconnected are reported as readable so the caller can notice.
+  bool Wait(uint32_t timeoutMilliseconds);
+  void Wake();
+
+private:
+  rdcarray<Socket *> m_Sockets;
+  ptrdiff_t m_Handle;
+  ptrdiff_t m_WakeRead, m_WakeWrite;
+};
+
 Socket *CreateServerSocket(const rdcstr &addr, uint16_t port, int queuesize);
 Socket *CreateClientSocket(const rdcstr &host, uint16_t port, int timeoutMS);
 
@@ -234,6 +307,10 @@ int64_t Inc64(int64_t *i);
 int64_t Dec64(int64_t *i);
 int64_t ExchAdd64(int64_t *i, int64_t a);
 int32_t CmpExch32(int32_t *dest, int32_t oldVal, int32_t newVal);
+void *CmpExchPtr(void **dest, void *oldVal, void *newVal);
+// plain loads and stores, ordered against the memory accesses after and before them respectively
+int32_t LoadAcquire32(int32_t *i);
+void StoreRelease32(int32_t *i, int32_t val);
 };
 
 namespace Callstack
@@ -475,6 +552,10 @@ enum
 };
 void WriteOutput(int channel, const char *str);
 
+// call callback when the process crashes, before the crash is handled as it would be otherwise.
+// Only the first callback registered is kept, and it must be safe to call from a signal handler.
+void RegisterCrashCallback(void (*callback)());
+
 enum MachineIdentBits
 {
   MachineIdent_Windows = 0x00000001,
@@ -232,8 +232,9 @@ namespace OSUtility
 {
 void WriteOutput(int channel, const char *str)
 {
-  static uint32_t seq = 0;
-  seq++;
+  // messages are written from several threads at once, so they each need their own number
+  static int32_t seqCounter = 0;
+  uint32_t seq = (uint32_t)Atomic::Inc32(&seqCounter);
   if(channel == OSUtility::Output_StdOut)
     fprintf(stdout, "%s", str);
   else if(channel == OSUtility::Output_StdErr)
@@ -28,6 +28,7 @@
 #include <unistd.h>
 #include <algorithm>
 #include <map>
+#include <unordered_map>
 #include "common/threading.h"
 #include "core/core.h"
 #include "core/settings.h"
@@ -44,6 +45,11 @@ static std::map<rdcstr, rdcarray<FunctionLoadCallback>> libraryCallbacks;
 static rdcarray<rdcstr> libraryHooks;
 static rdcarray<FunctionHook> functionHooks;
 
+// function hooks indexed by the hash of their name, so that a library's PLT can be patched in a
+// single pass over its relocations instead of one scan per hooked function.
+typedef std::unordered_multimap<uint32_t, size_t> FunctionHookLookup;
+static FunctionHookLookup functionHookLookup;
+
 void *intercept_dlopen(const char *filename, int flag, void *ret);
 void plthook_lib(void *handle);
 
@@ -291,7 +297,9 @@ __attribute__((visibility("default"))) pid_t fork()
     if(Linux_Debug_PtraceLogging())
       RDCLOG("non-hooked fork()");
 
+    rdclog_prefork();
     pid_t ret = realfork();
+    rdclog_postfork(ret == 0);
     if(ret == 0)
       unsetenv(RENDERDOC_VULKAN_LAYER_VAR);
 
@@ -306,7 +314,9 @@ __attribute__((visibility("default"))) pid_t fork()
   // set up environment variables for hooking now
   PreForkConfigureHooks();
 
+  rdclog_prefork();
   pid_t ret = realfork();
+  rdclog_postfork(ret == 0);
 
   if(ret == 0)
   {
@@ -417,26 +427,92 @@ __attribute__((visibility("default"))) void *dlsym(void *handle, const char *nam
 
 #endif
 
-void plthook_lib(void *handle)
+// hash a symbol name from the PLT, ignoring any @version suffix. Matches strhash() for names
+// without a version.
+static uint32_t plthook_namehash(const char *name, size_t &len)
+{
+  uint32_t hash = 5381;
+  len = 0;
+  while(name[len] != '\0' && name[len] != '@')
+  {
+    hash = ((hash << 5) + hash) + name[len];
+    len++;
+  }
+  return hash;
+}
+
+static void AddFunctionHookLookup(FunctionHookLookup &lookup, const rdcarray<FunctionHook> &hooks,
+                                  size_t idx)
+{
+  size_t len = 0;
+  uint32_t hash = plthook_namehash(hooks[idx].function.c_str(), len);
+
+  // if the same function is hooked twice, the first registration wins
+  auto range = lookup.equal_range(hash);
+  for(auto it = range.first; it != range.second; ++it)
+    if(hooks[it->second].function == hooks[idx].function)
+      return;
+
+  lookup.insert(std::make_pair(hash, idx));
+}
+
+// patch every PLT entry in the library that matches a hook, returning how many patches were made.
+// If dlopenHook is non-NULL, dlopen is redirected to it before any registered dlopen hook.
+static int plthook_hooks(void *handle, rdcarray<FunctionHook> &hooks,
+                         const FunctionHookLookup &lookup, void *dlopenHook)
 {
   plthook_t *plthook = NULL;
 
   // minimal error handling as we can't do much more than log the error, and since this is
   // 'best-effort' attempt to hook the unhookable, we just try and allow it to fail.
   if(plthook_open_by_handle(&plthook, handle))
-    return;
+    return 0;
 
-  plthook_replace(plthook, "dlopen", (void *)dlopen, NULL);
+  int patched = 0;
 
-  for(FunctionHook &hook : functionHooks)
+  unsigned int pos = 0;
+  const char *name = NULL;
+  void **addr = NULL;
+  while(plthook_enum(plthook, &pos, &name, &addr) == 0)
   {
-    void *orig = NULL;
-    plthook_replace(plthook, hook.function.c_str(), hook.hook, &orig);
-    if(hook.orig && *hook.orig == NULL && orig)
-      *hook.orig = orig;
+    size_t len = 0;
+    uint32_t hash = plthook_namehash(name, len);
+
+    // our dlopen goes in first, so that a registered dlopen hook below is patched over it and
+    // chains on to it through its orig pointer, the same as replacing each by name in turn
+    if(dlopenHook && len == 6 && !strncmp(name, "dlopen", len))
+    {
+      if(plthook_patch(plthook, addr, dlopenHook, NULL) == 0)
+        patched++;
+    }
+
+    auto range = lookup.equal_range(hash);
+    for(auto it = range.first; it != range.second; ++it)
+    {
+      FunctionHook &hook = hooks[it->second];
+
+      if(hook.function.length() != len || strncmp(hook.function.c_str(), name, len) != 0)
+        continue;
+
+      void *orig = NULL;
+      if(plthook_patch(plthook, addr, hook.hook, &orig) == 0)
+      {
+        patched++;
+        if(hook.orig && *hook.orig == NULL && orig)
+          *hook.orig = orig;
+      }
+      break;
+    }
   }
 
   plthook_close(plthook);
+
+  return patched;
+}
+
+void plthook_lib(void *handle)
+{
+  plthook_hooks(handle, functionHooks, functionHookLookup, (void *)dlopen);
 }
 
 // multiple libraries names pointing at the same file are declared as hooks
@@ -591,6 +667,7 @@ void LibraryHooks::RegisterFunctionHook(const char *libraryName, const FunctionH
 
   SCOPED_LOCK(libLock);
   functionHooks.push_back(hook);
+  AddFunctionHookLookup(functionHookLookup, functionHooks, functionHooks.size() - 1);
 }
 
 void LibraryHooks::RegisterLibraryHook(char const *name, FunctionLoadCallback cb)
@@ -616,3 +693,197 @@ ScopedSuppressHooking::ScopedSuppressHooking()
 ScopedSuppressHooking::~ScopedSuppressHooking()
 {
 }
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include <link.h>
+#include "catch/catch.hpp"
+#include "common/formatting.h"
+#include "common/timing.h"
+
+static int GatherLibraries(struct dl_phdr_info *info, size_t size, void *data)
+{
+  rdcarray<rdcstr> &libs = *(rdcarray<rdcstr> *)data;
+  if(info->dlpi_name && info->dlpi_name[0])
+    libs.push_back(info->dlpi_name);
+  return 0;
+}
+
+TEST_CASE("Check PLT hooking", "[osspecific]")
+{
+  rdcarray<void *> handles;
+  {
+    rdcarray<rdcstr> libs;
+    dl_iterate_phdr(&GatherLibraries, &libs);
+
+    for(const rdcstr &lib : libs)
+    {
+      void *handle = dlopen(lib.c_str(), RTLD_NOW | RTLD_NOLOAD);
+      if(handle)
+        handles.push_back(handle);
+    }
+  }
+
+  REQUIRE(!handles.empty());
+
+  // a hook set the size of the GL and Vulkan hooks, none of which will match anything
+  rdcarray<FunctionHook> hooks;
+  for(int i = 0; i < 800; i++)
+    hooks.push_back(FunctionHook(StringFormat::Fmt("rdoc_synthetic_hook_%d", i).c_str(), NULL, NULL));
+
+  FunctionHookLookup lookup;
+  for(size_t i = 0; i < hooks.size(); i++)
+    AddFunctionHookLookup(lookup, hooks, i);
+
+  SECTION("Matching entries are patched")
+  {
+    plthook_t *plthook = NULL;
+    void *handle = NULL;
+    for(void *h : handles)
+    {
+      if(plthook_open_by_handle(&plthook, h) == 0)
+      {
+        handle = h;
+        break;
+      }
+    }
+
+    REQUIRE(plthook);
+
+    unsigned int pos = 0;
+    const char *name = NULL;
+    void **addr = NULL;
+    if(plthook_enum(plthook, &pos, &name, &addr) == 0)
+    {
+      // 'hook' the entry to its current value so the process is unaffected
+      void *current = *addr;
+      void *orig = NULL;
+
+      size_t len = 0;
+      plthook_namehash(name, len);
+      rdcstr funcname(name, len);
+      hooks.push_back(FunctionHook(funcname.c_str(), &orig, current));
+      AddFunctionHookLookup(lookup, hooks, hooks.size() - 1);
+
+      CHECK(plthook_hooks(handle, hooks, lookup, NULL) >= 1);
+      CHECK(orig == current);
+      CHECK(*addr == current);
+    }
+
+    plthook_close(plthook);
+  };
+
+  SECTION("Registered dlopen hooks chain onto ours")
+  {
+    for(void *handle : handles)
+    {
+      plthook_t *plthook = NULL;
+      if(plthook_open_by_handle(&plthook, handle))
+        continue;
+
+      unsigned int pos = 0;
+      const char *name = NULL;
+      void **addr = NULL;
+      while(plthook_enum(plthook, &pos, &name, &addr) == 0)
+      {
+        size_t len = 0;
+        plthook_namehash(name, len);
+        if(len != 6 || strncmp(name, "dlopen", len) != 0 || *addr == (void *)&dlopen)
+          continue;
+
+        // register a dlopen hook that is the current target, so the process is unaffected once
+        // it's patched over our dlopen
+        void *current = *addr;
+        void *orig = NULL;
+        hooks.push_back(FunctionHook("dlopen", &orig, current));
+        AddFunctionHookLookup(lookup, hooks, hooks.size() - 1);
+
+        CHECK(plthook_hooks(handle, hooks, lookup, (void *)&dlopen) >= 2);
+        CHECK(orig == (void *)&dlopen);
+        CHECK(*addr == current);
+
+        break;
+      }
+
+      plthook_close(plthook);
+
+      if(hooks.back().function == "dlopen")
+        break;
+    }
+  };
+
+  SECTION("Single pass matches per-function replacement")
+  {
+    // simulate an application that has loaded many plugins by repeatedly processing every loaded
+    // library
+    const int passes = 20;
+
+    // none of the hooks match, so neither method should change any PLT entry
+    rdcarray<void *> before, after;
+    for(void *handle : handles)
+    {
+      plthook_t *plthook = NULL;
+      if(plthook_open_by_handle(&plthook, handle))
+        continue;
+
+      unsigned int pos = 0;
+      const char *name = NULL;
+      void **addr = NULL;
+      while(plthook_enum(plthook, &pos, &name, &addr) == 0)
+        before.push_back(*addr);
+
+      plthook_close(plthook);
+    }
+
+    PerformanceTimer timer;
+    for(int p = 0; p < passes; p++)
+    {
+      for(void *handle : handles)
+      {
+        plthook_t *plthook = NULL;
+        if(plthook_open_by_handle(&plthook, handle))
+          continue;
+
+        for(FunctionHook &hook : hooks)
+          plthook_replace(plthook, hook.function.c_str(), hook.hook, NULL);
+
+        plthook_close(plthook);
+      }
+    }
+    double perFunction = timer.GetMilliseconds();
+
+    timer.Restart();
+    for(int p = 0; p < passes; p++)
+    {
+      for(void *handle : handles)
+        CHECK(plthook_hooks(handle, hooks, lookup, NULL) == 0);
+    }
+    double singlePass = timer.GetMilliseconds();
+
+    for(void *handle : handles)
+    {
+      plthook_t *plthook = NULL;
+      if(plthook_open_by_handle(&plthook, handle))
+        continue;
+
+      unsigned int pos = 0;
+      const char *name = NULL;
+      void **addr = NULL;
+      while(plthook_enum(plthook, &pos, &name, &addr) == 0)
+        after.push_back(*addr);
+
+      plthook_close(plthook);
+    }
+
+    CHECK(before == after);
+
+    // timing depends on the machine, so it's only logged
+    RDCLOG("Hooking %zu functions in %d libraries: %.2f ms per-function, %.2f ms single pass",
+           hooks.size(), int(handles.size() * passes), perFunction, singlePass);
+  };
+
+  for(void *handle : handles)
+    dlclose(handle);
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -27,6 +27,7 @@
 #include <netdb.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
+#include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -42,6 +43,18 @@
 
 #include "posix_network.h"
 
+#if ENABLED(RDOC_LINUX) || ENABLED(RDOC_ANDROID) || ENABLED(RDOC_GGP)
+
+#include <sys/epoll.h>
+
+#define USE_EPOLL OPTION_ON
+
+#else
+
+#define USE_EPOLL OPTION_OFF
+
+#endif
+
 // because strerror_r is a complete mess...
 static rdcstr errno_string(int err)
 {
@@ -104,7 +117,7 @@ bool Socket::Connected() const
 
 Socket *Socket::AcceptClient(uint32_t timeoutMilliseconds)
 {
-  do
+  for(;;)
   {
     int s = accept((int)socket, NULL, NULL);
 
@@ -129,19 +142,181 @@ Socket *Socket::AcceptClient(uint32_t timeoutMilliseconds)
       SET_WARNING_RESULT(m_Error, ResultCode::NetworkIOFailed, "accept failed: %s",
                          errno_string(err).c_str());
       Shutdown();
+      return NULL;
     }
 
-    const uint32_t sleeptime = 4;
+    if(timeoutMilliseconds == 0)
+      return NULL;
 
-    Threading::Sleep(sleeptime);
+    // block until a connection comes in rather than polling, then try to accept it once more
+    pollfd pfd = {(int)socket, POLLIN, 0};
+    int ret = poll(&pfd, 1, (int)RDCMIN(timeoutMilliseconds, (uint32_t)INT32_MAX));
 
-    if(sleeptime < timeoutMilliseconds)
-      timeoutMilliseconds -= sleeptime;
-    else
-      timeoutMilliseconds = 0U;
-  } while(timeoutMilliseconds);
+    if(ret <= 0)
+      return NULL;
 
-  return NULL;
+    timeoutMilliseconds = 0;
+  }
+}
+
+SocketReactor::SocketReactor()
+{
+  m_Handle = -1;
+  m_WakeRead = m_WakeWrite = -1;
+
+  int fds[2] = {-1, -1};
+  if(pipe(fds) == 0)
+  {
+    for(int fd : fds)
+    {
+      int flags = fcntl(fd, F_GETFL, 0);
+      fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+      flags = fcntl(fd, F_GETFD, 0);
+      fcntl(fd, F_SETFD, flags | FD_CLOEXEC);
+    }
+
+    m_WakeRead = fds[0];
+    m_WakeWrite = fds[1];
+  }
+  else
+  {
+    RDCWARN("Couldn't create wake pipe for socket reactor: %s", errno_string(errno).c_str());
+  }
+
+#if ENABLED(USE_EPOLL)
+  int ep = epoll_create1(EPOLL_CLOEXEC);
+
+  if(ep != -1)
+  {
+    m_Handle = ep;
+
+    if(m_WakeRead != -1)
+    {
+      // the wake pipe is identified by a NULL pointer, sockets by their Socket *
+      epoll_event ev = {};
+      ev.events = EPOLLIN;
+      ev.data.ptr = NULL;
+      epoll_ctl(ep, EPOLL_CTL_ADD, (int)m_WakeRead, &ev);
+    }
+  }
+#endif
+}
+
+SocketReactor::~SocketReactor()
+{
+  if(m_Handle != -1)
+    close((int)m_Handle);
+  if(m_WakeRead != -1)
+    close((int)m_WakeRead);
+  if(m_WakeWrite != -1)
+    close((int)m_WakeWrite);
+}
+
+void SocketReactor::Add(Socket *sock)
+{
+  if(m_Sockets.contains(sock))
+    return;
+
+  m_Sockets.push_back(sock);
+
+#if ENABLED(USE_EPOLL)
+  if(m_Handle != -1 && sock->Connected())
+  {
+    epoll_event ev = {};
+    ev.events = EPOLLIN | EPOLLRDHUP;
+    ev.data.ptr = sock;
+    epoll_ctl((int)m_Handle, EPOLL_CTL_ADD, (int)sock->socket, &ev);
+  }
+#endif
+}
+
+void SocketReactor::Remove(Socket *sock)
+{
+  m_Sockets.removeOne(sock);
+
+#if ENABLED(USE_EPOLL)
+  // closed sockets are removed from the epoll set automatically
+  if(m_Handle != -1 && sock->Connected())
+  {
+    epoll_event ev = {};
+    epoll_ctl((int)m_Handle, EPOLL_CTL_DEL, (int)sock->socket, &ev);
+  }
+#endif
+}
+
+bool SocketReactor::Wait(uint32_t timeoutMilliseconds)
+{
+  for(Socket *sock : m_Sockets)
+    if(!sock->Connected())
+      return true;
+
+  int timeout = (int)RDCMIN(timeoutMilliseconds, (uint32_t)INT32_MAX);
+
+  bool readable = false;
+  bool woken = false;
+
+#if ENABLED(USE_EPOLL)
+  if(m_Handle != -1)
+  {
+    epoll_event events[8];
+    int ret = epoll_wait((int)m_Handle, events, ARRAY_COUNT(events), timeout);
+
+    for(int i = 0; i < ret; i++)
+    {
+      if(events[i].data.ptr == NULL)
+        woken = true;
+      else
+        readable = true;
+    }
+  }
+  else
+#endif
+  {
+    rdcarray<pollfd> fds;
+    fds.reserve(m_Sockets.size() + 1);
+
+    if(m_WakeRead != -1)
+      fds.push_back({(int)m_WakeRead, POLLIN, 0});
+
+    for(Socket *sock : m_Sockets)
+      fds.push_back({(int)sock->socket, POLLIN, 0});
+
+    int ret = poll(fds.data(), (nfds_t)fds.size(), timeout);
+
+    for(int i = 0; ret > 0 && i < fds.count(); i++)
+    {
+      if(fds[i].revents == 0)
+        continue;
+
+      if(fds[i].fd == (int)m_WakeRead)
+        woken = true;
+      else
+        readable = true;
+    }
+  }
+
+  if(woken)
+  {
+    // drain the pipe so the next wait blocks again
+    char dummy[64];
+    while(read((int)m_WakeRead, dummy, sizeof(dummy)) > 0)
+    {
+    }
+  }
+
+  return readable;
+}
+
+void SocketReactor::Wake()
+{
+  if(m_WakeWrite == -1)
+    return;
+
+  // if the pipe is full a wake is already pending, so we can ignore any failure
+  char dummy = 0;
+  ssize_t ret = write((int)m_WakeWrite, &dummy, 1);
+  (void)ret;
 }
 
 bool Socket::SendDataBlocking(const void *buf, uint32_t length)
@@ -29,6 +29,7 @@
 #include <signal.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -1043,6 +1044,394 @@ void Process::Shutdown()
   }
 }
 
+#if ENABLED(RDOC_LINUX) || ENABLED(RDOC_GGP)
+
+struct WriteWatch::Region
+{
+  byte *base;
+  size_t size;
+
+  // the page-aligned range covering [base, base+size)
+  byte *pageStart;
+  size_t pageCount;
+
+  // one flag per page, set by the fault handler
+  int32_t *dirty;
+};
+
+// The fault handler can't take locks, since it may interrupt a thread that holds one. Instead the
+// watched regions are published as an immutable list sorted by base address, swapped atomically
+// on every change. Watched ranges never overlap, so their ends are sorted too and the handler can
+// binary search. The list is only modified under writeWatchLock, and an old list (or an unwatched
+// region) is only freed once no handler is running that could still be reading it.
+typedef rdcarray<WriteWatch::Region *> WriteWatchList;
+
+static WriteWatchList *writeWatchList = NULL;
+static int32_t writeWatchHandlers = 0;
+static Threading::CriticalSection writeWatchLock;
+// the action we forward faults that aren't ours to. Replaced actions are kept rather than freed,
+// as a handler may still be forwarding through one.
+static struct sigaction *writeWatchOldAction = NULL;
+static rdcarray<struct sigaction *> writeWatchRetiredActions;
+static size_t writeWatchPageSize = 0;
+
+static void ForwardWriteWatchSignal(int signum, siginfo_t *info, void *context)
+{
+  const struct sigaction *oldPtr =
+      (const struct sigaction *)Atomic::CmpExchPtr((void **)&writeWatchOldAction, NULL, NULL);
+
+  // SIG_IGN would re-execute the faulting instruction forever, so treat it as the default. That
+  // restores the default action, so the faulting instruction will re-execute and crash as normal.
+  if(oldPtr == NULL || (!(oldPtr->sa_flags & SA_SIGINFO) &&
+                        (oldPtr->sa_handler == SIG_DFL || oldPtr->sa_handler == SIG_IGN)))
+  {
+    signal(signum, SIG_DFL);
+    return;
+  }
+
+  const struct sigaction &old = *oldPtr;
+
+  // run the old handler as it would have been run if it was installed directly
+  sigset_t prevMask;
+  pthread_sigmask(SIG_BLOCK, &old.sa_mask, &prevMask);
+
+  if(old.sa_flags & SA_RESETHAND)
+    signal(signum, SIG_DFL);
+
+  if(old.sa_flags & SA_SIGINFO)
+    old.sa_sigaction(signum, info, context);
+  else
+    old.sa_handler(signum);
+
+  pthread_sigmask(SIG_SETMASK, &prevMask, NULL);
+}
+
+static void WriteWatchHandler(int signum, siginfo_t *info, void *context)
+{
+  int saved_errno = errno;
+
+  byte *addr = (byte *)info->si_addr;
+  bool handled = false;
+
+  Atomic::Inc32(&writeWatchHandlers);
+
+  WriteWatchList *list = (WriteWatchList *)Atomic::CmpExchPtr((void **)&writeWatchList, NULL, NULL);
+
+  if(list)
+  {
+    const size_t pageSize = writeWatchPageSize;
+    byte *page = (byte *)(uintptr_t(addr) & ~uintptr_t(pageSize - 1));
+
+    // find the first region starting after the faulting page
+    size_t lo = 0, hi = list->size();
+    while(lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+      if(list->at(mid)->pageStart <= page)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    // a page may be covered by several regions if mappings share a page, so walk back over all of
+    // them and mark it dirty in each. The page is made writeable *before* it is marked dirty, so
+    // that a concurrent reset can only leave it dirty-and-protected, never clean-and-writeable.
+    while(lo > 0)
+    {
+      WriteWatch::Region *r = list->at(--lo);
+      if(page >= r->pageStart + r->pageCount * pageSize)
+        break;
+
+      if(!handled)
+        mprotect(page, pageSize, PROT_READ | PROT_WRITE);
+
+      Atomic::CmpExch32(&r->dirty[size_t(page - r->pageStart) / pageSize], 0, 1);
+      handled = true;
+    }
+  }
+
+  Atomic::Dec32(&writeWatchHandlers);
+
+  errno = saved_errno;
+
+  if(handled)
+    return;
+
+  // not one of ours, forward on to whoever was there before
+  ForwardWriteWatchSignal(signum, info, context);
+}
+
+// must be called with writeWatchLock held
+static void PublishWriteWatchList(WriteWatchList *list)
+{
+  WriteWatchList *old = writeWatchList;
+  Atomic::CmpExchPtr((void **)&writeWatchList, old, list);
+
+  // any handler that started before the swap may still be reading the old list, wait for it to
+  // finish. Handlers that start after the swap only see the new list.
+  while(Atomic::CmpExch32(&writeWatchHandlers, 0, 0) != 0)
+    Threading::Sleep(0);
+
+  delete old;
+}
+
+static void ProtectPages(WriteWatch::Region *region, size_t firstPage, size_t count, int prot)
+{
+  mprotect(region->pageStart + firstPage * writeWatchPageSize, count * writeWatchPageSize, prot);
+}
+
+bool WriteWatch::IsSupported()
+{
+  return true;
+}
+
+WriteWatch::Region *WriteWatch::Watch(void *base, size_t size)
+{
+  if(base == NULL || size == 0)
+    return NULL;
+
+  SCOPED_LOCK(writeWatchLock);
+
+  if(writeWatchPageSize == 0)
+    writeWatchPageSize = (size_t)sysconf(_SC_PAGESIZE);
+
+  struct sigaction cur_action = {};
+  sigaction(SIGSEGV, NULL, &cur_action);
+
+  // install our handler on first use, or again if something else (e.g. a crash reporter) has
+  // replaced it since. We always chain to whatever is installed at that point, never to a handler
+  // we saw earlier, so a later handler still gets every fault that isn't ours.
+  if(!(cur_action.sa_flags & SA_SIGINFO) || cur_action.sa_sigaction != &WriteWatchHandler)
+  {
+    // publish the action to forward to before installing, so no fault is forwarded to a stale one
+    struct sigaction *old = new struct sigaction(cur_action);
+    if(writeWatchOldAction)
+      writeWatchRetiredActions.push_back(writeWatchOldAction);
+    Atomic::CmpExchPtr((void **)&writeWatchOldAction, writeWatchOldAction, old);
+
+    // SA_ONSTACK so that faults on a thread running on an alternate signal stack (e.g. one that
+    // overflowed its stack) still reach whatever handler we chain to.
+    struct sigaction new_action = {};
+    sigemptyset(&new_action.sa_mask);
+    new_action.sa_flags = SA_SIGINFO | SA_RESTART | SA_ONSTACK;
+    new_action.sa_sigaction = &WriteWatchHandler;
+
+    if(sigaction(SIGSEGV, &new_action, NULL) != 0)
+    {
+      RDCWARN("Couldn't install write watch handler: %d", errno);
+      return NULL;
+    }
+  }
+
+  Region *region = new Region;
+  region->base = (byte *)base;
+  region->size = size;
+  region->pageStart = (byte *)(uintptr_t(base) & ~uintptr_t(writeWatchPageSize - 1));
+  region->pageCount =
+      (size_t(region->base + size - region->pageStart) + writeWatchPageSize - 1) / writeWatchPageSize;
+
+  // keep the list sorted. Regions may share a page but must not overlap, or the handler's search
+  // would not be able to stop early.
+  WriteWatchList *list = writeWatchList ? new WriteWatchList(*writeWatchList) : new WriteWatchList;
+
+  size_t idx = 0;
+  while(idx < list->size() && list->at(idx)->base < region->base)
+    idx++;
+
+  if((idx > 0 && list->at(idx - 1)->base + list->at(idx - 1)->size > region->base) ||
+     (idx < list->size() && region->base + size > list->at(idx)->base))
+  {
+    RDCWARN("Write watched range %p-%p overlaps an existing range", base, region->base + size);
+    delete list;
+    delete region;
+    return NULL;
+  }
+
+  region->dirty = new int32_t[region->pageCount];
+  memset(region->dirty, 0, sizeof(int32_t) * region->pageCount);
+
+  list->insert(idx, region);
+
+  // register before protecting, so any write from here on is caught
+  PublishWriteWatchList(list);
+
+  if(mprotect(region->pageStart, region->pageCount * writeWatchPageSize, PROT_READ) != 0)
+  {
+    RDCWARN("Couldn't write-protect %p for write watching: %d", base, errno);
+
+    list = new WriteWatchList(*writeWatchList);
+    list->removeOne(region);
+    PublishWriteWatchList(list);
+
+    ProtectPages(region, 0, region->pageCount, PROT_READ | PROT_WRITE);
+
+    delete[] region->dirty;
+    delete region;
+    return NULL;
+  }
+
+  return region;
+}
+
+void WriteWatch::Unwatch(Region *region)
+{
+  if(region == NULL)
+    return;
+
+  {
+    SCOPED_LOCK(writeWatchLock);
+
+    WriteWatchList *list = new WriteWatchList(*writeWatchList);
+    list->removeOne(region);
+
+    // once this returns no handler can be looking at the region
+    PublishWriteWatchList(list);
+
+    ProtectPages(region, 0, region->pageCount, PROT_READ | PROT_WRITE);
+
+    // any other region sharing our first or last page is no longer protected there, so mark it
+    // dirty. It will be re-protected the next time that region is reset.
+    byte *pageEnd = region->pageStart + region->pageCount * writeWatchPageSize;
+    for(Region *r : *list)
+    {
+      byte *rEnd = r->pageStart + r->pageCount * writeWatchPageSize;
+      for(byte *page = RDCMAX(r->pageStart, region->pageStart); page < RDCMIN(rEnd, pageEnd);
+          page += writeWatchPageSize)
+        Atomic::CmpExch32(&r->dirty[size_t(page - r->pageStart) / writeWatchPageSize], 0, 1);
+    }
+  }
+
+  delete[] region->dirty;
+  delete region;
+}
+
+void WriteWatch::MarkAllDirty(Region *region)
+{
+  if(region == NULL)
+    return;
+
+  for(size_t i = 0; i < region->pageCount; i++)
+    Atomic::CmpExch32(&region->dirty[i], 0, 1);
+}
+
+void WriteWatch::GetAndResetDirty(Region *region, rdcarray<rdcpair<size_t, size_t>> &ranges)
+{
+  ranges.clear();
+
+  if(region == NULL)
+    return;
+
+  size_t runStart = 0, runCount = 0;
+
+  for(size_t i = 0; i <= region->pageCount; i++)
+  {
+    // clear the flag before re-protecting, so a write between the two is still seen by the read
+    // that follows
+    if(i < region->pageCount && Atomic::CmpExch32(&region->dirty[i], 1, 0) == 1)
+    {
+      if(runCount == 0)
+        runStart = i;
+      runCount++;
+      continue;
+    }
+
+    if(runCount == 0)
+      continue;
+
+    ProtectPages(region, runStart, runCount, PROT_READ);
+
+    // clamp to the watched range, since the first and last page may extend beyond it
+    byte *start = RDCMAX(region->pageStart + runStart * writeWatchPageSize, region->base);
+    byte *end = RDCMIN(region->pageStart + (runStart + runCount) * writeWatchPageSize,
+                       region->base + region->size);
+
+    ranges.push_back({size_t(start - region->base), size_t(end - start)});
+
+    runCount = 0;
+  }
+}
+
+#else
+
+struct WriteWatch::Region
+{
+};
+
+bool WriteWatch::IsSupported()
+{
+  return false;
+}
+
+WriteWatch::Region *WriteWatch::Watch(void *base, size_t size)
+{
+  return NULL;
+}
+
+void WriteWatch::Unwatch(Region *region)
+{
+}
+
+void WriteWatch::MarkAllDirty(Region *region)
+{
+}
+
+void WriteWatch::GetAndResetDirty(Region *region, rdcarray<rdcpair<size_t, size_t>> &ranges)
+{
+  ranges.clear();
+}
+
+#endif
+
+static void (*crashCallback)() = NULL;
+static const int crashSignals[] = {SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT};
+static struct sigaction crashOldActions[ARRAY_COUNT(crashSignals)];
+
+static void CrashSignalHandler(int signum, siginfo_t *info, void *context)
+{
+  int saved_errno = errno;
+
+  crashCallback();
+
+  // put back the default action and let the signal happen again, so the process crashes as if we
+  // had never been installed
+  for(size_t i = 0; i < ARRAY_COUNT(crashSignals); i++)
+  {
+    if(crashSignals[i] == signum)
+      sigaction(signum, &crashOldActions[i], NULL);
+  }
+
+  // a fault re-executes the faulting instruction when we return, but a signal that was sent (e.g.
+  // by abort()) has to be sent again. It's blocked until we return.
+  if(info->si_code <= 0)
+    raise(signum);
+
+  errno = saved_errno;
+}
+
+void OSUtility::RegisterCrashCallback(void (*callback)())
+{
+  if(crashCallback)
+    return;
+
+  crashCallback = callback;
+
+  struct sigaction new_action = {};
+  sigemptyset(&new_action.sa_mask);
+  new_action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+  new_action.sa_sigaction = &CrashSignalHandler;
+
+  // only hook signals that would otherwise crash the process. Anything with a handler already may
+  // be expected and recovered from - e.g. runtimes that use faults for null checks - and its
+  // handler decides whether the process crashes.
+  for(size_t i = 0; i < ARRAY_COUNT(crashSignals); i++)
+  {
+    sigaction(crashSignals[i], NULL, &crashOldActions[i]);
+
+    if((crashOldActions[i].sa_flags & SA_SIGINFO) == 0 && crashOldActions[i].sa_handler == SIG_DFL)
+      sigaction(crashSignals[i], &new_action, NULL);
+  }
+}
+
 #if ENABLED(ENABLE_UNIT_TESTS)
 
 #include "catch/catch.hpp"
@@ -1451,4 +1840,163 @@ TEST_CASE("Test PID Node list handling", "[osspecific]")
   delete f;
 };
 
+TEST_CASE("Test write watching", "[osspecific]")
+{
+  if(!WriteWatch::IsSupported())
+    return;
+
+  const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+  const size_t size = pageSize * 16;
+
+  byte *mem = (byte *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  REQUIRE(mem != MAP_FAILED);
+
+  memset(mem, 0, size);
+
+  // watch an unaligned range, starting partway into the first page
+  const size_t offset = 100;
+  WriteWatch::Region *region = WriteWatch::Watch(mem + offset, size - offset);
+  REQUIRE(region);
+
+  rdcarray<rdcpair<size_t, size_t>> ranges;
+
+  SECTION("Nothing dirty without writes")
+  {
+    WriteWatch::GetAndResetDirty(region, ranges);
+    CHECK(ranges.empty());
+  };
+
+  SECTION("Written pages are reported")
+  {
+    mem[offset] = 1;
+    mem[pageSize * 5 + 10] = 2;
+    mem[pageSize * 6 + 10] = 3;
+    mem[pageSize * 15 + 10] = 4;
+
+    WriteWatch::GetAndResetDirty(region, ranges);
+
+    REQUIRE(ranges.size() == 3);
+    CHECK(ranges[0].first == 0);
+    CHECK(ranges[0].second == pageSize - offset);
+    CHECK(ranges[1].first == pageSize * 5 - offset);
+    CHECK(ranges[1].second == pageSize * 2);
+    CHECK(ranges[2].first == pageSize * 15 - offset);
+    CHECK(ranges[2].second == pageSize);
+
+    // the writes landed
+    CHECK(mem[pageSize * 6 + 10] == 3);
+
+    // reset pages are protected again and re-report on the next write
+    WriteWatch::GetAndResetDirty(region, ranges);
+    CHECK(ranges.empty());
+
+    mem[pageSize * 6 + 20] = 5;
+
+    WriteWatch::GetAndResetDirty(region, ranges);
+    REQUIRE(ranges.size() == 1);
+    CHECK(ranges[0].first == pageSize * 6 - offset);
+    CHECK(ranges[0].second == pageSize);
+  };
+
+  SECTION("Mark all dirty")
+  {
+    WriteWatch::MarkAllDirty(region);
+
+    WriteWatch::GetAndResetDirty(region, ranges);
+    REQUIRE(ranges.size() == 1);
+    CHECK(ranges[0].first == 0);
+    CHECK(ranges[0].second == size - offset);
+  };
+
+  WriteWatch::Unwatch(region);
+
+  // memory is writeable again without being tracked
+  mem[pageSize * 3] = 6;
+  CHECK(mem[pageSize * 3] == 6);
+
+  munmap(mem, size);
+}
+
+TEST_CASE("Test write watching many small regions", "[osspecific]")
+{
+  if(!WriteWatch::IsSupported())
+    return;
+
+  const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+  const size_t size = pageSize * 16;
+
+  byte *mem = (byte *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  REQUIRE(mem != MAP_FAILED);
+
+  memset(mem, 0, size);
+
+  // many more regions than pages, so every page is shared by many regions
+  const size_t regionSize = 32;
+  const size_t regionsPerPage = pageSize / regionSize;
+  rdcarray<WriteWatch::Region *> regions;
+  regions.resize(size / regionSize);
+
+  // watch in a scattered order so the sorted insert is exercised
+  for(size_t i = 0; i < regions.size(); i++)
+  {
+    size_t r = (i * 7) % regions.size();
+    regions[r] = WriteWatch::Watch(mem + r * regionSize, regionSize);
+    REQUIRE(regions[r]);
+  }
+
+  rdcarray<rdcpair<size_t, size_t>> ranges;
+
+  // overlapping ranges are refused
+  CHECK(WriteWatch::Watch(mem + regionSize + 1, regionSize) == NULL);
+
+  for(WriteWatch::Region *r : regions)
+  {
+    WriteWatch::GetAndResetDirty(r, ranges);
+    CHECK(ranges.empty());
+  }
+
+  // a write marks the whole page dirty in every region on it
+  const size_t writtenPage = 9;
+  const size_t written = writtenPage * regionsPerPage + 3;
+  mem[written * regionSize + 5] = 1;
+
+  for(size_t i = 0; i < regions.size(); i++)
+  {
+    WriteWatch::GetAndResetDirty(regions[i], ranges);
+
+    if(i / regionsPerPage == writtenPage)
+    {
+      REQUIRE(ranges.size() == 1);
+      CHECK(ranges[0].first == 0);
+      CHECK(ranges[0].second == regionSize);
+    }
+    else
+    {
+      CHECK(ranges.empty());
+    }
+  }
+
+  CHECK(mem[written * regionSize + 5] == 1);
+
+  // unwatching a region makes its page writeable, so the others sharing it become dirty
+  WriteWatch::Unwatch(regions[written]);
+  regions[written] = NULL;
+
+  mem[written * regionSize] = 2;
+
+  for(size_t i = 0; i < regions.size(); i++)
+  {
+    if(regions[i] == NULL)
+      continue;
+
+    WriteWatch::GetAndResetDirty(regions[i], ranges);
+    CHECK(ranges.size() == (i / regionsPerPage == writtenPage ? 1U : 0U));
+  }
+
+  for(WriteWatch::Region *r : regions)
+    WriteWatch::Unwatch(r);
+
+  munmap(mem, size);
+}
+
 #endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -22,6 +22,7 @@
  * THE SOFTWARE.
  ******************************************************************************/
 
+#include <errno.h>
 #include <time.h>
 #include <unistd.h>
 #include "common/common.h"
@@ -70,6 +71,21 @@ int32_t CmpExch32(int32_t *dest, int32_t oldVal, int32_t newVal)
 {
   return __sync_val_compare_and_swap(dest, oldVal, newVal);
 }
+
+void *CmpExchPtr(void **dest, void *oldVal, void *newVal)
+{
+  return __sync_val_compare_and_swap(dest, oldVal, newVal);
+}
+
+int32_t LoadAcquire32(int32_t *i)
+{
+  return __atomic_load_n(i, __ATOMIC_ACQUIRE);
+}
+
+void StoreRelease32(int32_t *i, int32_t val)
+{
+  __atomic_store_n(i, val, __ATOMIC_RELEASE);
+}
 };
 
 namespace Threading
@@ -157,6 +173,73 @@ void RWLock::ReadUnlock()
   pthread_rwlock_unlock(&m_Data.rwlock);
 }
 
+template <>
+Semaphore::SemaphoreTemplate()
+{
+  pthread_mutex_init(&m_Data.lock, NULL);
+  pthread_cond_init(&m_Data.cond, NULL);
+  m_Data.count = 0;
+}
+
+template <>
+Semaphore::~SemaphoreTemplate()
+{
+  pthread_cond_destroy(&m_Data.cond);
+  pthread_mutex_destroy(&m_Data.lock);
+}
+
+template <>
+void Semaphore::Wake(uint32_t numToWake)
+{
+  pthread_mutex_lock(&m_Data.lock);
+  m_Data.count += numToWake;
+  if(numToWake == 1)
+    pthread_cond_signal(&m_Data.cond);
+  else
+    pthread_cond_broadcast(&m_Data.cond);
+  pthread_mutex_unlock(&m_Data.lock);
+}
+
+template <>
+bool Semaphore::WaitForWake(uint32_t timeoutMilliseconds)
+{
+  // the condition variable uses the realtime clock, so the deadline is absolute in that clock
+  timespec deadline = {};
+  if(timeoutMilliseconds != ~0U)
+  {
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeoutMilliseconds / 1000;
+    deadline.tv_nsec += long(timeoutMilliseconds % 1000) * 1000000;
+    if(deadline.tv_nsec >= 1000000000)
+    {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000;
+    }
+  }
+
+  pthread_mutex_lock(&m_Data.lock);
+
+  while(m_Data.count == 0)
+  {
+    int res = 0;
+    if(timeoutMilliseconds == ~0U)
+      res = pthread_cond_wait(&m_Data.cond, &m_Data.lock);
+    else
+      res = pthread_cond_timedwait(&m_Data.cond, &m_Data.lock, &deadline);
+
+    if(res == ETIMEDOUT)
+      break;
+  }
+
+  bool woken = m_Data.count > 0;
+  if(woken)
+    m_Data.count--;
+
+  pthread_mutex_unlock(&m_Data.lock);
+
+  return woken;
+}
+
 struct ThreadInitData
 {
   std::function<void()> entryFunc;
@@ -303,4 +386,10 @@ void Sleep(uint32_t milliseconds)
 {
   usleep(milliseconds * 1000);
 }
+
+uint32_t GetProcessorCount()
+{
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (uint32_t)count : 1;
+}
 };
@@ -147,7 +147,7 @@ uint32_t Socket::GetRemoteIP() const
 
 Socket *Socket::AcceptClient(uint32_t timeoutMilliseconds)
 {
-  do
+  for(;;)
   {
     SOCKET s = accept(socket, NULL, NULL);
 
@@ -169,19 +169,132 @@ Socket *Socket::AcceptClient(uint32_t timeoutMilliseconds)
       SET_WARNING_RESULT(m_Error, ResultCode::NetworkIOFailed, "accept failed: %s",
                          wsaerr_string(err).c_str());
       Shutdown();
+      return NULL;
     }
 
-    const uint32_t sleeptime = 4;
+    if(timeoutMilliseconds == 0)
+      return NULL;
+
+    // block until a connection comes in rather than polling, then try to accept it once more
+    WSAPOLLFD pfd = {(SOCKET)socket, POLLRDNORM, 0};
+    int ret = WSAPoll(&pfd, 1, (INT)RDCMIN(timeoutMilliseconds, (uint32_t)INT32_MAX));
+
+    if(ret <= 0)
+      return NULL;
+
+    timeoutMilliseconds = 0;
+  }
+}
+
+SocketReactor::SocketReactor()
+{
+  // there are no pipes that WSAPoll can wait on, so wake-ups are sent as datagrams to a loopback
+  // UDP socket instead.
+  m_Handle = 0;
+  m_WakeRead = m_WakeWrite = (ptrdiff_t)INVALID_SOCKET;
+
+  SOCKET r = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  SOCKET w = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+
+  int len = sizeof(addr);
+
+  if(r != INVALID_SOCKET && w != INVALID_SOCKET && bind(r, (sockaddr *)&addr, len) == 0 &&
+     getsockname(r, (sockaddr *)&addr, &len) == 0 && connect(w, (sockaddr *)&addr, len) == 0)
+  {
+    u_long enable = 1;
+    ioctlsocket(r, FIONBIO, &enable);
+    ioctlsocket(w, FIONBIO, &enable);
+
+    m_WakeRead = (ptrdiff_t)r;
+    m_WakeWrite = (ptrdiff_t)w;
+  }
+  else
+  {
+    RDCWARN("Couldn't create wake socket for socket reactor: %s",
+            wsaerr_string(WSAGetLastError()).c_str());
+
+    if(r != INVALID_SOCKET)
+      closesocket(r);
+    if(w != INVALID_SOCKET)
+      closesocket(w);
+  }
+}
 
-    Threading::Sleep(sleeptime);
+SocketReactor::~SocketReactor()
+{
+  if((SOCKET)m_WakeRead != INVALID_SOCKET)
+    closesocket((SOCKET)m_WakeRead);
+  if((SOCKET)m_WakeWrite != INVALID_SOCKET)
+    closesocket((SOCKET)m_WakeWrite);
+}
 
-    if(sleeptime < timeoutMilliseconds)
-      timeoutMilliseconds -= sleeptime;
+void SocketReactor::Add(Socket *sock)
+{
+  if(!m_Sockets.contains(sock))
+    m_Sockets.push_back(sock);
+}
+
+void SocketReactor::Remove(Socket *sock)
+{
+  m_Sockets.removeOne(sock);
+}
+
+bool SocketReactor::Wait(uint32_t timeoutMilliseconds)
+{
+  for(Socket *sock : m_Sockets)
+    if(!sock->Connected())
+      return true;
+
+  rdcarray<WSAPOLLFD> fds;
+  fds.reserve(m_Sockets.size() + 1);
+
+  if((SOCKET)m_WakeRead != INVALID_SOCKET)
+    fds.push_back({(SOCKET)m_WakeRead, POLLRDNORM, 0});
+
+  for(Socket *sock : m_Sockets)
+    fds.push_back({(SOCKET)sock->socket, POLLRDNORM, 0});
+
+  int ret = WSAPoll(fds.data(), (ULONG)fds.size(),
+                    (INT)RDCMIN(timeoutMilliseconds, (uint32_t)INT32_MAX));
+
+  bool readable = false;
+  bool woken = false;
+
+  for(int i = 0; ret > 0 && i < fds.count(); i++)
+  {
+    if(fds[i].revents == 0)
+      continue;
+
+    if(fds[i].fd == (SOCKET)m_WakeRead)
+      woken = true;
     else
-      timeoutMilliseconds = 0U;
-  } while(timeoutMilliseconds);
+      readable = true;
+  }
 
-  return NULL;
+  if(woken)
+  {
+    // drain any pending datagrams so the next wait blocks again
+    char dummy[64];
+    while(recv((SOCKET)m_WakeRead, dummy, sizeof(dummy), 0) > 0)
+    {
+    }
+  }
+
+  return readable;
+}
+
+void SocketReactor::Wake()
+{
+  if((SOCKET)m_WakeWrite == INVALID_SOCKET)
+    return;
+
+  char dummy = 0;
+  send((SOCKET)m_WakeWrite, &dummy, 1, 0);
 }
 
 bool Socket::SendDataBlocking(const void *buf, uint32_t length)
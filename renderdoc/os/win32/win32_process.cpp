@@ -1745,3 +1745,28 @@ void Process::Shutdown()
 {
   // nothing to do
 }
+
+// there is no equivalent of page-protection write tracking for driver-owned mappings, as
+// GetWriteWatch only works on memory we allocate ourselves.
+bool WriteWatch::IsSupported()
+{
+  return false;
+}
+
+WriteWatch::Region *WriteWatch::Watch(void *base, size_t size)
+{
+  return NULL;
+}
+
+void WriteWatch::Unwatch(Region *region)
+{
+}
+
+void WriteWatch::MarkAllDirty(Region *region)
+{
+}
+
+void WriteWatch::GetAndResetDirty(Region *region, rdcarray<rdcpair<size_t, size_t>> &ranges)
+{
+  ranges.clear();
+}
@@ -962,4 +962,26 @@ uint64_t GetMachineIdent()
 
   return ret;
 }
+
+static void (*crashCallback)() = NULL;
+static LPTOP_LEVEL_EXCEPTION_FILTER crashOldFilter = NULL;
+
+static LONG WINAPI CrashExceptionFilter(EXCEPTION_POINTERS *exceptionInfo)
+{
+  crashCallback();
+
+  if(crashOldFilter)
+    return crashOldFilter(exceptionInfo);
+
+  return EXCEPTION_CONTINUE_SEARCH;
+}
+
+void RegisterCrashCallback(void (*callback)())
+{
+  if(crashCallback)
+    return;
+
+  crashCallback = callback;
+  crashOldFilter = SetUnhandledExceptionFilter(&CrashExceptionFilter);
+}
 };
@@ -83,6 +83,21 @@ int32_t CmpExch32(int32_t *dest, int32_t oldVal, int32_t newVal)
 {
   return (int32_t)InterlockedCompareExchange((volatile LONG *)dest, newVal, oldVal);
 }
+
+void *CmpExchPtr(void **dest, void *oldVal, void *newVal)
+{
+  return InterlockedCompareExchangePointer((PVOID volatile *)dest, newVal, oldVal);
+}
+
+int32_t LoadAcquire32(int32_t *i)
+{
+  return (int32_t)ReadAcquire((volatile LONG *)i);
+}
+
+void StoreRelease32(int32_t *i, int32_t val)
+{
+  WriteRelease((volatile LONG *)i, val);
+}
 };
 
 namespace Threading
@@ -164,6 +179,31 @@ void RWLock::ReadUnlock()
   ReleaseSRWLockShared(&m_Data);
 }
 
+template <>
+Semaphore::SemaphoreTemplate()
+{
+  m_Data = CreateSemaphore(NULL, 0, LONG_MAX, NULL);
+}
+
+template <>
+Semaphore::~SemaphoreTemplate()
+{
+  CloseHandle(m_Data);
+}
+
+template <>
+void Semaphore::Wake(uint32_t numToWake)
+{
+  ReleaseSemaphore(m_Data, (LONG)numToWake, NULL);
+}
+
+template <>
+bool Semaphore::WaitForWake(uint32_t timeoutMilliseconds)
+{
+  DWORD timeout = timeoutMilliseconds == ~0U ? INFINITE : timeoutMilliseconds;
+  return WaitForSingleObject(m_Data, timeout) == WAIT_OBJECT_0;
+}
+
 struct ThreadInitData
 {
   std::function<void()> entryFunc;
@@ -368,4 +408,11 @@ void Sleep(uint32_t milliseconds)
 {
   ::Sleep((DWORD)milliseconds);
 }
+
+uint32_t GetProcessorCount()
+{
+  SYSTEM_INFO info = {};
+  GetSystemInfo(&info);
+  return RDCMAX(info.dwNumberOfProcessors, (DWORD)1);
+}
 };
@@ -0,0 +1,625 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2022 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+// A benchmark of the capture file processing paths that don't need a GPU - writing, opening,
+// decompressing, structured processing, exporting, re-saving and replay-style deserialising. The
+// capture is generated synthetically so the results are reproducible and comparable between runs
+// and machines.
+
+#include "api/replay/renderdoc_replay.h"
+#include "common/formatting.h"
+#include "common/threading.h"
+#include "common/timing.h"
+#include "core/core.h"
+#include "os/os_specific.h"
+#include "serialise/rdcfile.h"
+#include "serialise/serialiser.h"
+#include "strings/string_utils.h"
+
+enum class BenchmarkChunk : uint32_t
+{
+  Object = (uint32_t)SystemChunk::FirstDriverChunk,
+};
+
+static rdcstr GetBenchmarkChunkName(uint32_t chunkType)
+{
+  if(chunkType == (uint32_t)BenchmarkChunk::Object)
+    return "BenchmarkObject"_lit;
+
+  return ToStr((SystemChunk)chunkType);
+}
+
+struct BenchmarkRange
+{
+  uint64_t offset;
+  uint64_t size;
+};
+
+DECLARE_REFLECTION_STRUCT(BenchmarkRange);
+
+template <class SerialiserType>
+void DoSerialise(SerialiserType &ser, BenchmarkRange &el)
+{
+  SERIALISE_MEMBER(offset);
+  SERIALISE_MEMBER(size);
+}
+
+// the layout of each synthetic chunk - a handful of scalars, a fixed array, variable arrays, an
+// optional struct and an optional blob, which is roughly the mix a real API call chunk has.
+template <typename SerialiserType>
+static void Serialise_BenchmarkObject(SerialiserType &ser, uint32_t index, const byte *payload,
+                                      uint64_t payloadSize, bool allocateContents = false)
+{
+  float Transform[16] = {};
+  rdcarray<uint64_t> Bindings;
+  BenchmarkRange RangeData[4] = {};
+  BenchmarkRange *Ranges = NULL;
+  uint32_t RangeCount = 0;
+  BenchmarkRange *Scissor = NULL;
+
+  if(ser.IsWriting())
+  {
+    for(uint32_t i = 0; i < 16; i++)
+      Transform[i] = float(index + i) * 0.25f;
+    for(uint32_t i = 0; i < 8; i++)
+      Bindings.push_back(uint64_t(index) * 8 + i);
+    for(uint32_t i = 0; i < 4; i++)
+      RangeData[i] = {uint64_t(index) * 256 + i * 64, 64};
+    Ranges = RangeData;
+    RangeCount = 4;
+    Scissor = &RangeData[0];
+  }
+
+  SERIALISE_ELEMENT_LOCAL(ObjectIndex, index);
+  SERIALISE_ELEMENT_LOCAL(Name, StringFormat::Fmt("Object %u", index));
+  SERIALISE_ELEMENT(Transform);
+  SERIALISE_ELEMENT(Bindings);
+  SERIALISE_ELEMENT(RangeCount);
+  SERIALISE_ELEMENT_ARRAY(Ranges, RangeCount);
+  SERIALISE_ELEMENT_OPT(Scissor);
+
+  byte *Contents = (byte *)payload;
+  uint64_t ContentsSize = payloadSize;
+
+  if(allocateContents)
+  {
+    // read the contents into memory the way a replayed API call would
+    SERIALISE_ELEMENT_ARRAY(Contents, ContentsSize);
+  }
+  else
+  {
+    // otherwise on reading we never want the contents ourselves, the serialiser will still fetch
+    // them when exporting buffers to structured data
+    ser.Serialise("Contents"_lit, Contents, ContentsSize, SerialiserFlags::NoFlags);
+  }
+}
+
+// fill with data that compresses somewhere around 2:1, by repeating half of the blocks from a
+// random stream. Entirely random or entirely constant data would make the compressors look
+// unrealistically bad or good.
+static void GenerateBenchmarkPayload(bytebuf &payload, size_t size)
+{
+  payload.resize(size);
+
+  uint64_t state = 0x9E3779B97F4A7C15ULL;
+
+  const size_t blockSize = 64;
+
+  for(size_t offs = 0; offs < size; offs += blockSize)
+  {
+    size_t len = RDCMIN(blockSize, size - offs);
+
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+
+    if(offs >= blockSize && (state & 1))
+    {
+      memcpy(payload.data() + offs, payload.data() + offs - blockSize, len);
+      continue;
+    }
+
+    for(size_t i = 0; i < len; i++)
+    {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      payload[offs + i] = byte(state & 0xff);
+    }
+  }
+}
+
+// samples the process memory usage on a background thread, to catch the peak within each phase
+// rather than only what's left once it finishes.
+class BenchmarkMemorySampler
+{
+public:
+  BenchmarkMemorySampler()
+  {
+    m_Thread = Threading::CreateThread([this]() {
+      while(Atomic::CmpExch32(&m_Stop, 0, 0) == 0)
+      {
+        Sample();
+        Threading::Sleep(2);
+      }
+    });
+  }
+
+  ~BenchmarkMemorySampler()
+  {
+    Atomic::Inc32(&m_Stop);
+    Threading::JoinThread(m_Thread);
+    Threading::CloseThread(m_Thread);
+  }
+
+  void BeginPhase()
+  {
+    uint64_t mem = Process::GetMemoryUsage();
+    SCOPED_LOCK(m_Lock);
+    m_PhasePeak = mem;
+  }
+
+  uint64_t EndPhase()
+  {
+    Sample();
+    SCOPED_LOCK(m_Lock);
+    return m_PhasePeak;
+  }
+
+  uint64_t GetOverallPeak()
+  {
+    SCOPED_LOCK(m_Lock);
+    return m_OverallPeak;
+  }
+
+private:
+  void Sample()
+  {
+    uint64_t mem = Process::GetMemoryUsage();
+    SCOPED_LOCK(m_Lock);
+    m_PhasePeak = RDCMAX(m_PhasePeak, mem);
+    m_OverallPeak = RDCMAX(m_OverallPeak, mem);
+  }
+
+  Threading::ThreadHandle m_Thread = 0;
+  int32_t m_Stop = 0;
+  Threading::CriticalSection m_Lock;
+  uint64_t m_PhasePeak = 0;
+  uint64_t m_OverallPeak = 0;
+};
+
+struct BenchmarkPhase
+{
+  rdcstr name;
+  rdcarray<double> times;
+  uint64_t outputBytes = 0;
+  uint64_t peakMemory = 0;
+  uint64_t heapAllocations = 0;
+  uint64_t scratchAllocations = 0;
+};
+
+static RDResult BenchmarkWrite(const rdcstr &filename, SectionFlags compression,
+                               uint32_t chunkCount, const bytebuf &payload, uint32_t bufferSize,
+                               uint64_t &sectionSize)
+{
+  RDCFile rdc;
+  rdc.SetData(RDCDriver::Unknown, "Benchmark", 0, NULL, 0, 1.0);
+  rdc.Create(filename);
+
+  if(rdc.Error() != ResultCode::Succeeded)
+    return rdc.Error();
+
+  SectionProperties props;
+  props.flags = compression;
+  props.type = SectionType::FrameCapture;
+  props.name = ToStr(props.type);
+
+  StreamWriter *writer = rdc.WriteSection(props);
+
+  {
+    WriteSerialiser ser(writer, Ownership::Nothing);
+
+    // vary which part of the payload each chunk uses so consecutive chunks aren't identical
+    const uint32_t window = uint32_t(payload.size()) - bufferSize;
+
+    for(uint32_t i = 0; i < chunkCount; i++)
+    {
+      SCOPED_SERIALISE_CHUNK(BenchmarkChunk::Object, bufferSize + 256);
+      Serialise_BenchmarkObject(ser, i, payload.data() + (i * 4099) % (window + 1), bufferSize);
+    }
+  }
+
+  sectionSize = writer->GetOffset();
+
+  writer->Finish();
+
+  RDResult ret = writer->GetError();
+
+  delete writer;
+
+  return ret;
+}
+
+static RDResult BenchmarkDecompress(const RDCFile &rdc)
+{
+  int idx = rdc.SectionIndex(SectionType::FrameCapture);
+  if(idx < 0)
+    RETURN_ERROR_RESULT(ResultCode::FileCorrupted,
+                        "Benchmark capture has no frame capture section");
+
+  StreamReader *reader = rdc.ReadSection(idx);
+
+  bytebuf scratch;
+  scratch.resize(1024 * 1024);
+
+  while(!reader->IsErrored() && !reader->AtEnd())
+  {
+    uint64_t len = RDCMIN(reader->GetSize() - reader->GetOffset(), (uint64_t)scratch.size());
+    reader->Read(scratch.data(), len);
+  }
+
+  RDResult ret = reader->GetError();
+
+  delete reader;
+
+  return ret;
+}
+
+static RDResult BenchmarkStructure(const RDCFile &rdc, SDFile &structData)
+{
+  int idx = rdc.SectionIndex(SectionType::FrameCapture);
+  if(idx < 0)
+    RETURN_ERROR_RESULT(ResultCode::FileCorrupted,
+                        "Benchmark capture has no frame capture section");
+
+  StreamReader *reader = rdc.ReadSection(idx);
+
+  if(reader->IsErrored())
+  {
+    RDResult ret = reader->GetError();
+    delete reader;
+    return ret;
+  }
+
+  ReadSerialiser ser(reader, Ownership::Stream);
+
+  ser.ConfigureStructuredExport(&GetBenchmarkChunkName, true, 0, 1.0);
+
+  while(!reader->AtEnd())
+  {
+    BenchmarkChunk chunk = ser.ReadChunk<BenchmarkChunk>();
+
+    if(ser.IsErrored())
+      return ser.GetError();
+
+    if(chunk != BenchmarkChunk::Object)
+      RETURN_ERROR_RESULT(ResultCode::APIDataCorrupted, "Unexpected chunk %u in benchmark capture",
+                          (uint32_t)chunk);
+
+    Serialise_BenchmarkObject(ser, 0, NULL, 0);
+
+    ser.EndChunk();
+
+    if(ser.IsErrored())
+      return ser.GetError();
+  }
+
+  structData.Swap(ser.GetStructuredFile());
+
+  return RDResult();
+}
+
+// read every chunk as replay would, without any structured export, to measure how deserialisation
+// allocates its temporary buffers.
+static RDResult BenchmarkDeserialise(const RDCFile &rdc, bool scratchArena,
+                                     ReadScratchArena::Stats &stats)
+{
+  int idx = rdc.SectionIndex(SectionType::FrameCapture);
+  if(idx < 0)
+    RETURN_ERROR_RESULT(ResultCode::FileCorrupted,
+                        "Benchmark capture has no frame capture section");
+
+  StreamReader *reader = rdc.ReadSection(idx);
+
+  if(reader->IsErrored())
+  {
+    RDResult ret = reader->GetError();
+    delete reader;
+    return ret;
+  }
+
+  ReadSerialiser ser(reader, Ownership::Stream);
+
+  ser.SetScratchArenaEnabled(scratchArena);
+
+  while(!reader->AtEnd())
+  {
+    BenchmarkChunk chunk = ser.ReadChunk<BenchmarkChunk>();
+
+    if(ser.IsErrored())
+      return ser.GetError();
+
+    if(chunk != BenchmarkChunk::Object)
+      RETURN_ERROR_RESULT(ResultCode::APIDataCorrupted, "Unexpected chunk %u in benchmark capture",
+                          (uint32_t)chunk);
+
+    Serialise_BenchmarkObject(ser, 0, NULL, 0, true);
+
+    ser.EndChunk();
+
+    if(ser.IsErrored())
+      return ser.GetError();
+  }
+
+  stats = ser.GetScratchArenaStats();
+
+  return RDResult();
+}
+
+static RDResult BenchmarkResave(const rdcstr &filename, const RDCFile &rdc,
+                                SectionFlags compression, const SDFile &structData)
+{
+  RDCFile output;
+
+  output.SetData(rdc.GetDriver(), rdc.GetDriverName(), rdc.GetMachineIdent(), &rdc.GetThumbnail(),
+                 rdc.GetTimestampBase(), rdc.GetTimestampFrequency());
+
+  output.Create(filename);
+
+  if(output.Error() != ResultCode::Succeeded)
+    return output.Error();
+
+  SectionProperties props;
+  props.flags = compression;
+  props.type = SectionType::FrameCapture;
+  props.name = ToStr(props.type);
+  props.version = structData.version;
+
+  StreamWriter *writer = output.WriteSection(props);
+
+  {
+    WriteSerialiser ser(writer, Ownership::Nothing);
+
+    ser.WriteStructuredFile(structData, NULL);
+  }
+
+  writer->Finish();
+
+  RDResult ret = writer->GetError();
+
+  delete writer;
+
+  return ret;
+}
+
+static rdcstr CompressionName(SectionFlags compression)
+{
+  if(compression & SectionFlags::LZ4Compressed)
+    return "lz4";
+  if(compression & SectionFlags::ZstdCompressed)
+    return "zstd";
+  return "none";
+}
+
+static rdcstr BenchmarkJSON(uint32_t chunkCount, uint32_t bufferSize, SectionFlags compression,
+                            uint32_t iterations, uint64_t sectionSize, uint64_t fileSize,
+                            uint64_t baselineMemory, uint64_t peakMemory,
+                            const rdcarray<BenchmarkPhase> &phases)
+{
+  rdcstr json = "{\n";
+
+  json += StringFormat::Fmt(
+      "  \"config\": {\"chunks\": %u, \"bufferSize\": %u, \"compression\": \"%s\", "
+      "\"iterations\": %u},\n",
+      chunkCount, bufferSize, CompressionName(compression).c_str(), iterations);
+  json += StringFormat::Fmt("  \"sectionBytes\": %llu,\n", sectionSize);
+  json += StringFormat::Fmt("  \"fileBytes\": %llu,\n", fileSize);
+  json += StringFormat::Fmt("  \"baselineMemoryBytes\": %llu,\n", baselineMemory);
+  json += StringFormat::Fmt("  \"peakMemoryBytes\": %llu,\n", peakMemory);
+  json += "  \"phases\": [\n";
+
+  for(size_t p = 0; p < phases.size(); p++)
+  {
+    const BenchmarkPhase &phase = phases[p];
+
+    double minMS = phase.times[0], maxMS = phase.times[0], total = 0.0;
+    for(double t : phase.times)
+    {
+      minMS = RDCMIN(minMS, t);
+      maxMS = RDCMAX(maxMS, t);
+      total += t;
+    }
+
+    // throughput is always relative to the uncompressed capture data, so phases are comparable
+    double mbps = minMS > 0.0 ? (double(sectionSize) / (1024.0 * 1024.0)) / (minMS / 1000.0) : 0.0;
+
+    json += StringFormat::Fmt(
+        "    {\"name\": \"%s\", \"minMS\": %.3f, \"meanMS\": %.3f, \"maxMS\": %.3f, "
+        "\"throughputMBps\": %.2f, \"outputBytes\": %llu, \"peakMemoryBytes\": %llu, "
+        "\"heapAllocations\": %llu, \"scratchAllocations\": %llu}%s\n",
+        phase.name.c_str(), minMS, total / phase.times.size(), maxMS, mbps, phase.outputBytes,
+        phase.peakMemory, phase.heapAllocations, phase.scratchAllocations,
+        p + 1 < phases.size() ? "," : "");
+  }
+
+  json += "  ]\n}\n";
+
+  return json;
+}
+
+RDResult RunCaptureBenchmark(uint32_t chunkCount, uint32_t bufferSize, SectionFlags compression,
+                             uint32_t iterations, rdcstr tempDir, rdcstr &report)
+{
+  if(chunkCount == 0 || iterations == 0)
+    RETURN_ERROR_RESULT(ResultCode::InvalidParameter,
+                        "Benchmark needs at least one chunk and one iteration");
+
+  if(tempDir.empty())
+    tempDir = FileIO::GetTempFolderFilename();
+
+  const rdcstr base = StringFormat::Fmt("%s/renderdoc_benchmark_%u", tempDir.c_str(),
+                                        Process::GetCurrentPID());
+  const rdcstr capturePath = base + ".rdc";
+  const rdcstr resavePath = base + "_resave.rdc";
+  const rdcstr xmlPath = base + ".xml";
+  const rdcstr zipXmlPath = base + ".zip.xml";
+  const rdcstr zipPath = base + ".zip";
+
+  CaptureExporter xmlExporter = RenderDoc::Inst().GetCaptureExporter("xml");
+  CaptureExporter zipExporter = RenderDoc::Inst().GetCaptureExporter("zip.xml");
+
+  bytebuf payload;
+  GenerateBenchmarkPayload(payload, bufferSize + 64 * 1024);
+
+  rdcarray<BenchmarkPhase> phases;
+  phases.resize(9);
+  phases[0].name = "write";
+  phases[1].name = "open";
+  phases[2].name = "decompress";
+  phases[3].name = "structure";
+  phases[4].name = "export_xml";
+  phases[5].name = "export_zip_xml";
+  phases[6].name = "resave";
+  phases[7].name = "deserialise_heap";
+  phases[8].name = "deserialise_arena";
+
+  uint64_t sectionSize = 0;
+  uint64_t baselineMemory = Process::GetMemoryUsage();
+
+  RDResult result;
+
+  BenchmarkMemorySampler sampler;
+
+  // run one phase, timing it and recording its peak memory.
+  auto runPhase = [&](BenchmarkPhase &phase, std::function<RDResult()> callback) {
+    if(result != ResultCode::Succeeded)
+      return;
+
+    sampler.BeginPhase();
+
+    PerformanceTimer timer;
+    result = callback();
+    phase.times.push_back(timer.GetMilliseconds());
+
+    phase.peakMemory = RDCMAX(phase.peakMemory, sampler.EndPhase());
+  };
+
+  for(uint32_t it = 0; it < iterations && result == ResultCode::Succeeded; it++)
+  {
+    runPhase(phases[0], [&]() {
+      return BenchmarkWrite(capturePath, compression, chunkCount, payload, bufferSize, sectionSize);
+    });
+    phases[0].outputBytes = FileIO::GetFileSize(capturePath);
+
+    RDCFile *rdc = new RDCFile;
+    runPhase(phases[1], [&]() {
+      rdc->Open(capturePath);
+      return rdc->Error();
+    });
+
+    runPhase(phases[2], [&]() { return BenchmarkDecompress(*rdc); });
+
+    SDFile *structData = new SDFile;
+    runPhase(phases[3], [&]() { return BenchmarkStructure(*rdc, *structData); });
+
+    if(xmlExporter)
+    {
+      runPhase(phases[4], [&]() { return xmlExporter(xmlPath, *rdc, *structData, NULL); });
+      phases[4].outputBytes = FileIO::GetFileSize(xmlPath);
+    }
+
+    if(zipExporter)
+    {
+      runPhase(phases[5], [&]() { return zipExporter(zipXmlPath, *rdc, *structData, NULL); });
+      phases[5].outputBytes = FileIO::GetFileSize(zipXmlPath) + FileIO::GetFileSize(zipPath);
+    }
+
+    runPhase(phases[6],
+             [&]() { return BenchmarkResave(resavePath, *rdc, compression, *structData); });
+    phases[6].outputBytes = FileIO::GetFileSize(resavePath);
+
+    // the same replay-style read with and without the chunk scratch arena, counting the buffer
+    // allocations each one makes
+    for(int arena = 0; arena < 2; arena++)
+    {
+      BenchmarkPhase &phase = phases[7 + arena];
+      ReadScratchArena::Stats stats;
+      runPhase(phase, [&]() { return BenchmarkDeserialise(*rdc, arena == 1, stats); });
+      phase.heapAllocations = stats.heapAllocations;
+      phase.scratchAllocations = stats.scratchAllocations;
+    }
+
+    delete structData;
+    delete rdc;
+  }
+
+  for(const rdcstr &f : {capturePath, resavePath, xmlPath, zipXmlPath, zipPath})
+    FileIO::Delete(f);
+
+  if(result != ResultCode::Succeeded)
+    return result;
+
+  phases.removeIf([](const BenchmarkPhase &phase) { return phase.times.empty(); });
+
+  report = BenchmarkJSON(chunkCount, bufferSize, compression, iterations, sectionSize,
+                         phases[0].outputBytes, baselineMemory, sampler.GetOverallPeak(), phases);
+
+  return result;
+}
+
+extern "C" RENDERDOC_API ResultDetails RENDERDOC_CC RENDERDOC_RunCaptureBenchmark(
+    uint32_t chunkCount, uint32_t bufferSize, SectionFlags compression, uint32_t iterations,
+    const rdcstr &tempDir, rdcstr &report)
+{
+  return RunCaptureBenchmark(chunkCount, bufferSize, compression, iterations, tempDir, report);
+}
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "catch/catch.hpp"
+
+TEST_CASE("Synthetic capture benchmark", "[serialiser][benchmark]")
+{
+  for(SectionFlags compression :
+      {SectionFlags::NoFlags, SectionFlags::LZ4Compressed, SectionFlags::ZstdCompressed})
+  {
+    rdcstr report;
+    RDResult result = RunCaptureBenchmark(64, 1024, compression, 1, rdcstr(), report);
+
+    REQUIRE(result.code == ResultCode::Succeeded);
+
+    CHECK(report.contains("\"compression\": \"" + CompressionName(compression) + "\""));
+
+    for(const char *phase : {"write", "open", "decompress", "structure", "export_xml",
+                             "export_zip_xml", "resave", "deserialise_heap", "deserialise_arena"})
+      CHECK(report.contains(StringFormat::Fmt("\"name\": \"%s\"", phase)));
+
+    // every chunk's contents, ranges and scissor are heap allocations without the arena, with it
+    // only the pages are
+    CHECK(report.contains("\"heapAllocations\": 192, \"scratchAllocations\": 0"));
+    CHECK(report.contains("\"heapAllocations\": 1, \"scratchAllocations\": 192"));
+  }
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -22,6 +22,7 @@
  * THE SOFTWARE.
  ******************************************************************************/
 
+#include "common/profiler.h"
 #include "core/core.h"
 #include "jpeg-compressor/jpgd.h"
 #include "jpeg-compressor/jpge.h"
@@ -195,6 +196,8 @@ CaptureFile::~CaptureFile()
 ResultDetails CaptureFile::OpenFile(const rdcstr &filename, const rdcstr &filetype,
                                     RENDERDOC_ProgressCallback progress)
 {
+  RDCPROFILE_ZONE("CaptureFile OpenFile");
+
   CaptureImporter importer = RenderDoc::Inst().GetCaptureImporter(filetype);
 
   if(importer)
@@ -415,6 +418,8 @@ void CaptureFile::SetMetadata(const rdcstr &driverName, uint64_t machineIdent, F
 ResultDetails CaptureFile::Convert(const rdcstr &filename, const rdcstr &filetype,
                                    const SDFile *file, RENDERDOC_ProgressCallback progress)
 {
+  RDCPROFILE_ZONE("CaptureFile Convert");
+
   if(!m_RDC)
   {
     RETURN_ERROR_RESULT(ResultCode::FileCorrupted,
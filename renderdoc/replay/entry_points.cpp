@@ -28,6 +28,7 @@
 #include "api/replay/version.h"
 #include "common/common.h"
 #include "common/formatting.h"
+#include "common/profiler.h"
 #include "common/threading.h"
 #include "core/core.h"
 #include "maths/camera.h"
@@ -298,6 +299,9 @@ extern "C" RENDERDOC_API const char *RENDERDOC_CC RENDERDOC_GetLogFile()
 extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_GetLogFileContents(uint64_t offset,
                                                                         rdcstr &logfile)
 {
+  // write out anything still queued so the contents are up to date
+  rdclog_flush();
+
   logfile = FileIO::logfile_readall(offset, RDCGETLOGFILE());
 }
 
@@ -999,9 +1003,15 @@ extern "C" RENDERDOC_API int RENDERDOC_CC RENDERDOC_RunFunctionalTests(int pytho
 extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_BeginProfileRegion(const rdcstr &name)
 {
   Superluminal::BeginProfileRange(name);
+
+  if(Profiler::IsRecording())
+    Profiler::BeginZone(Profiler::Intern(name));
 }
 
 extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_EndProfileRegion()
 {
   Superluminal::EndProfileRange();
+
+  if(Profiler::IsRecording())
+    Profiler::EndZone();
 }
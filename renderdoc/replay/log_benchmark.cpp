@@ -0,0 +1,187 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2022 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+// A benchmark of the per-message cost of logging, with the log file written directly by each
+// logging thread and with it written by the background flusher thread. The messages are written
+// to the current log file at debug level so they don't show up on the console.
+
+#include "api/replay/renderdoc_replay.h"
+#include "common/common.h"
+#include "common/formatting.h"
+#include "common/timing.h"
+#include "os/os_specific.h"
+
+struct LogBenchmarkMode
+{
+  rdcstr name;
+  double totalMS = 0.0;
+  double flushMS = 0.0;
+};
+
+static void LogBenchmarkMessages(uint32_t threadIndex, uint32_t count)
+{
+  for(uint32_t i = 0; i < count; i++)
+    rdclog_direct(time_t(FILL_AUTO_VALUE), FILL_AUTO_VALUE, LogType::Debug, RDCLOG_PROJECT,
+                  __FILE__, __LINE__, "Log benchmark message %u from thread %u", i, threadIndex);
+}
+
+static void RunLogBenchmarkMode(LogBenchmarkMode &mode, uint32_t messageCount, uint32_t threadCount)
+{
+  rdcarray<Threading::ThreadHandle> threads;
+
+  PerformanceTimer timer;
+
+  // the calling thread is one of the logging threads
+  for(uint32_t t = 1; t < threadCount; t++)
+  {
+    const uint32_t count = messageCount / threadCount;
+    threads.push_back(Threading::CreateThread([t, count]() { LogBenchmarkMessages(t, count); }));
+  }
+
+  LogBenchmarkMessages(0, messageCount - (messageCount / threadCount) * (threadCount - 1));
+
+  for(Threading::ThreadHandle thread : threads)
+  {
+    Threading::JoinThread(thread);
+    Threading::CloseThread(thread);
+  }
+
+  mode.totalMS = timer.GetMilliseconds();
+
+  // the time to get everything that was logged onto disk
+  timer.Restart();
+  rdclog_flush();
+  mode.flushMS = timer.GetMilliseconds();
+}
+
+RDResult RunLogBenchmark(uint32_t messageCount, uint32_t threadCount, rdcstr &report)
+{
+  if(messageCount == 0 || threadCount == 0)
+    RETURN_ERROR_RESULT(ResultCode::InvalidParameter,
+                        "Benchmark needs at least one message and one thread");
+
+  rdcarray<LogBenchmarkMode> modes;
+  modes.resize(2);
+  modes[0].name = "direct";
+  modes[1].name = "background";
+
+  const bool wasAsync = rdclog_getasync();
+
+  rdclog_setasync(false);
+  RunLogBenchmarkMode(modes[0], messageCount, threadCount);
+
+  rdclog_setasync(true);
+  RunLogBenchmarkMode(modes[1], messageCount, threadCount);
+
+  rdclog_setasync(wasAsync);
+
+  report = "{\n";
+  report += StringFormat::Fmt("  \"config\": {\"messages\": %u, \"threads\": %u},\n", messageCount,
+                              threadCount);
+  report += "  \"modes\": [\n";
+
+  for(size_t m = 0; m < modes.size(); m++)
+  {
+    const LogBenchmarkMode &mode = modes[m];
+
+    // the cost seen by the logging threads, per message
+    double nsPerMessage = mode.totalMS * 1000000.0 / messageCount;
+
+    report += StringFormat::Fmt(
+        "    {\"name\": \"%s\", \"totalMS\": %.3f, \"nsPerMessage\": %.1f, \"flushMS\": %.3f}%s\n",
+        mode.name.c_str(), mode.totalMS, nsPerMessage, mode.flushMS,
+        m + 1 < modes.size() ? "," : "");
+  }
+
+  report += "  ]\n}\n";
+
+  return RDResult();
+}
+
+extern "C" RENDERDOC_API ResultDetails RENDERDOC_CC RENDERDOC_RunLogBenchmark(uint32_t messageCount,
+                                                                            uint32_t threadCount,
+                                                                            rdcstr &report)
+{
+  return RunLogBenchmark(messageCount, threadCount, report);
+}
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "catch/catch.hpp"
+
+TEST_CASE("Log benchmark", "[logging][benchmark]")
+{
+  rdcstr report;
+  RDResult result = RunLogBenchmark(256, 4, report);
+
+  REQUIRE(result.code == ResultCode::Succeeded);
+
+  CHECK(report.contains("\"messages\": 256, \"threads\": 4"));
+  CHECK(report.contains("\"name\": \"direct\""));
+  CHECK(report.contains("\"name\": \"background\""));
+}
+
+TEST_CASE("Log benchmark keeps the logging mode", "[logging][benchmark]")
+{
+  const bool wasAsync = rdclog_getasync();
+
+  rdcstr report;
+
+  rdclog_setasync(false);
+  RunLogBenchmark(16, 2, report);
+  CHECK(!rdclog_getasync());
+
+  // this only turns on if there's a log file open
+  rdclog_setasync(true);
+  const bool asyncOn = rdclog_getasync();
+  RunLogBenchmark(16, 2, report);
+  CHECK(rdclog_getasync() == asyncOn);
+
+  rdclog_setasync(wasAsync);
+}
+
+TEST_CASE("Crash flush writes out queued messages", "[logging]")
+{
+  const bool wasAsync = rdclog_getasync();
+
+  rdclog_setasync(true);
+
+  // without a log file there's nothing queued or written
+  if(rdclog_getasync())
+  {
+    const rdcstr marker = StringFormat::Fmt("Crash flush marker %llu", Timing::GetTick());
+    rdclog(LogType::Debug, "%s", marker.c_str());
+
+    rdclog_crashflush();
+    CHECK(rdclog_getasync());
+
+    rdcstr contents;
+    FileIO::ReadAll(rdclog_getfilename(), contents);
+    CHECK(contents.contains(marker));
+  }
+
+  rdclog_setasync(wasAsync);
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -0,0 +1,166 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2022 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+// A benchmark of the cost of allocating and freeing objects from a WrappingPool on several threads
+// at once, as the number of pools grows. Each extra pool holds the objects kept alive in between,
+// so with per-thread free slots and the address lookup this should stay roughly flat.
+
+#include "api/replay/renderdoc_replay.h"
+#include "common/common.h"
+#include "common/formatting.h"
+#include "common/timing.h"
+#include "common/wrapped_pool.h"
+#include "os/os_specific.h"
+
+struct PoolBenchmarkItem
+{
+  ALLOCATE_WITH_WRAPPED_POOL(PoolBenchmarkItem);
+
+  uint64_t tag;
+  uint64_t payload[7];
+};
+
+WRAPPED_POOL_INST(PoolBenchmarkItem);
+
+struct PoolBenchmarkRun
+{
+  size_t liveCount = 0;
+  size_t poolCount = 0;
+  double nsPerPair = 0.0;
+};
+
+static void PoolBenchmarkChurn(uint32_t opCount)
+{
+  PoolBenchmarkItem *ring[16] = {};
+
+  for(uint32_t o = 0; o < opCount; o++)
+  {
+    PoolBenchmarkItem *&slot = ring[o % 16];
+    delete slot;
+    slot = new PoolBenchmarkItem;
+    PoolBenchmarkItem::IsAlloc(slot);
+  }
+
+  for(PoolBenchmarkItem *item : ring)
+    delete item;
+}
+
+static void RunPoolBenchmarkLiveCount(PoolBenchmarkRun &run, uint32_t opsPerThread,
+                                      uint32_t threadCount)
+{
+  rdcarray<PoolBenchmarkItem *> held;
+  held.resize(run.liveCount);
+  for(size_t o = 0; o < run.liveCount; o++)
+    held[o] = new PoolBenchmarkItem;
+
+  run.poolCount = PoolBenchmarkItem::m_Pool.GetPoolCount();
+
+  rdcarray<Threading::ThreadHandle> threads;
+
+  PerformanceTimer timer;
+
+  // the calling thread is one of the churning threads
+  for(uint32_t t = 1; t < threadCount; t++)
+    threads.push_back(
+        Threading::CreateThread([opsPerThread]() { PoolBenchmarkChurn(opsPerThread); }));
+
+  PoolBenchmarkChurn(opsPerThread);
+
+  for(Threading::ThreadHandle thread : threads)
+  {
+    Threading::JoinThread(thread);
+    Threading::CloseThread(thread);
+  }
+
+  run.nsPerPair = timer.GetMilliseconds() * 1000000.0 / (double(opsPerThread) * threadCount);
+
+  for(PoolBenchmarkItem *item : held)
+    delete item;
+}
+
+RDResult RunPoolBenchmark(uint32_t opsPerThread, uint32_t threadCount, rdcstr &report)
+{
+  if(opsPerThread == 0 || threadCount == 0)
+    RETURN_ERROR_RESULT(ResultCode::InvalidParameter,
+                        "Benchmark needs at least one operation and one thread");
+
+  // each additional pool is 512kB, so this spans from the first few pools up to ~50
+  const size_t liveCounts[] = {0, 50000, 400000};
+
+  rdcarray<PoolBenchmarkRun> runs;
+  runs.resize(ARRAY_COUNT(liveCounts));
+
+  for(size_t r = 0; r < runs.size(); r++)
+  {
+    runs[r].liveCount = liveCounts[r];
+    RunPoolBenchmarkLiveCount(runs[r], opsPerThread, threadCount);
+  }
+
+  report = "{\n";
+  report += StringFormat::Fmt("  \"config\": {\"operations\": %u, \"threads\": %u},\n",
+                              opsPerThread, threadCount);
+  report += "  \"runs\": [\n";
+
+  for(size_t r = 0; r < runs.size(); r++)
+  {
+    const PoolBenchmarkRun &run = runs[r];
+
+    report += StringFormat::Fmt(
+        "    {\"liveObjects\": %zu, \"pools\": %zu, \"nsPerAllocFree\": %.1f}%s\n", run.liveCount,
+        run.poolCount, run.nsPerPair, r + 1 < runs.size() ? "," : "");
+  }
+
+  report += "  ],\n";
+
+  // how much slower churn is with the most pools than with the fewest
+  report += StringFormat::Fmt("  \"growth\": %.2f\n}\n",
+                              runs.back().nsPerPair / RDCMAX(runs[0].nsPerPair, 0.001));
+
+  return RDResult();
+}
+
+extern "C" RENDERDOC_API ResultDetails RENDERDOC_CC RENDERDOC_RunPoolBenchmark(uint32_t opsPerThread,
+                                                                             uint32_t threadCount,
+                                                                             rdcstr &report)
+{
+  return RunPoolBenchmark(opsPerThread, threadCount, report);
+}
+
+#if ENABLED(ENABLE_UNIT_TESTS)
+
+#include "catch/catch.hpp"
+
+TEST_CASE("Pool benchmark", "[threading][benchmark]")
+{
+  rdcstr report;
+  RDResult result = RunPoolBenchmark(1000, 4, report);
+
+  REQUIRE(result.code == ResultCode::Succeeded);
+
+  CHECK(report.contains("\"operations\": 1000, \"threads\": 4"));
+  CHECK(report.contains("\"liveObjects\": 400000"));
+  CHECK(report.contains("\"growth\": "));
+}
+
+#endif    // ENABLED(ENABLE_UNIT_TESTS)
@@ -415,6 +415,36 @@ void DoSerialise(SerialiserType &ser, ShaderDebugTrace &el)
   SIZE_CHECK(184);
 }
 
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, DebugPixelInvocation &el)
+{
+  SERIALISE_MEMBER(x);
+  SERIALISE_MEMBER(y);
+  SERIALISE_MEMBER(sample);
+  SERIALISE_MEMBER(primitive);
+
+  SIZE_CHECK(16);
+}
+
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, DebugThreadInvocation &el)
+{
+  SERIALISE_MEMBER(groupid);
+  SERIALISE_MEMBER(threadid);
+
+  SIZE_CHECK(24);
+}
+
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, ShaderDebugResult &el)
+{
+  SERIALISE_MEMBER(valid);
+  SERIALISE_MEMBER(stepCount);
+  SERIALISE_MEMBER(variables);
+
+  SIZE_CHECK(32);
+}
+
 template <typename SerialiserType>
 void DoSerialise(SerialiserType &ser, TextureFilter &el)
 {
@@ -907,6 +937,16 @@ void DoSerialise(SerialiserType &ser, PixelModification &el)
   SIZE_CHECK(100);
 }
 
+template <typename SerialiserType>
+void DoSerialise(SerialiserType &ser, PixelHistoryResult &el)
+{
+  SERIALISE_MEMBER(x);
+  SERIALISE_MEMBER(y);
+  SERIALISE_MEMBER(modifications);
+
+  SIZE_CHECK(32);
+}
+
 template <typename SerialiserType>
 void DoSerialise(SerialiserType &ser, EventUsage &el)
 {
@@ -2384,6 +2424,9 @@ INSTANTIATE_SERIALISE_TYPE(ShaderVariable)
 INSTANTIATE_SERIALISE_TYPE(SourceVariableMapping);
 INSTANTIATE_SERIALISE_TYPE(ShaderDebugState)
 INSTANTIATE_SERIALISE_TYPE(ShaderDebugTrace)
+INSTANTIATE_SERIALISE_TYPE(DebugPixelInvocation)
+INSTANTIATE_SERIALISE_TYPE(DebugThreadInvocation)
+INSTANTIATE_SERIALISE_TYPE(ShaderDebugResult)
 INSTANTIATE_SERIALISE_TYPE(ResourceDescription)
 INSTANTIATE_SERIALISE_TYPE(TextureDescription)
 INSTANTIATE_SERIALISE_TYPE(BufferDescription)
@@ -2417,6 +2460,7 @@ INSTANTIATE_SERIALISE_TYPE(CounterDescription)
 INSTANTIATE_SERIALISE_TYPE(PixelValue)
 INSTANTIATE_SERIALISE_TYPE(Subresource)
 INSTANTIATE_SERIALISE_TYPE(PixelModification)
+INSTANTIATE_SERIALISE_TYPE(PixelHistoryResult)
 INSTANTIATE_SERIALISE_TYPE(EventUsage)
 INSTANTIATE_SERIALISE_TYPE(CounterResult)
 INSTANTIATE_SERIALISE_TYPE(CounterValue)
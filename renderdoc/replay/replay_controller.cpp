@@ -1412,27 +1412,22 @@ ResultDetails ReplayController::SaveTexture(const TextureSave &saveData, const r
   return res;
 }
 
-rdcarray<PixelModification> ReplayController::PixelHistory(ResourceId target, uint32_t x, uint32_t y,
-                                                           const Subresource &sub, CompType typeCast)
+rdcarray<EventUsage> ReplayController::GetPixelHistoryEvents(ResourceId target,
+                                                              const Subresource &sub,
+                                                              Subresource &subresource,
+                                                              uint32_t &width, uint32_t &height)
 {
-  CHECK_REPLAY_THREAD();
-
-  RENDERDOC_PROFILEFUNCTION();
-
-  rdcarray<PixelModification> ret;
+  rdcarray<EventUsage> events;
 
-  Subresource subresource = sub;
+  subresource = sub;
+  width = height = ~0U;
 
   for(size_t t = 0; t < m_Textures.size(); t++)
   {
     if(m_Textures[t].resourceId == target)
     {
-      if(x >= m_Textures[t].width || y >= m_Textures[t].height)
-      {
-        RDCDEBUG("PixelHistory out of bounds on %s (%u,%u) vs (%u,%u)", ToStr(target).c_str(), x, y,
-                 m_Textures[t].width, m_Textures[t].height);
-        return ret;
-      }
+      width = m_Textures[t].width;
+      height = m_Textures[t].height;
 
       if(m_Textures[t].msSamp == 1)
         subresource.sample = ~0U;
@@ -1455,12 +1450,10 @@ rdcarray<PixelModification> ReplayController::PixelHistory(ResourceId target, ui
   ResourceId id = m_pDevice->GetLiveID(target);
 
   if(id == ResourceId())
-    return ret;
+    return events;
 
   rdcarray<EventUsage> usage = m_pDevice->GetUsage(id);
 
-  rdcarray<EventUsage> events;
-
   for(size_t i = 0; i < usage.size(); i++)
   {
     if(usage[i].eventId > m_EventID)
@@ -1525,12 +1518,35 @@ rdcarray<PixelModification> ReplayController::PixelHistory(ResourceId target, ui
   }
 
   if(events.empty())
-  {
     RDCDEBUG("Target %s not written to before %u", ToStr(target).c_str(), m_EventID);
+
+  return events;
+}
+
+rdcarray<PixelModification> ReplayController::PixelHistory(ResourceId target, uint32_t x, uint32_t y,
+                                                           const Subresource &sub, CompType typeCast)
+{
+  CHECK_REPLAY_THREAD();
+
+  RENDERDOC_PROFILEFUNCTION();
+
+  rdcarray<PixelModification> ret;
+
+  Subresource subresource;
+  uint32_t width, height;
+  rdcarray<EventUsage> events = GetPixelHistoryEvents(target, sub, subresource, width, height);
+
+  if(x >= width || y >= height)
+  {
+    RDCDEBUG("PixelHistory out of bounds on %s (%u,%u) vs (%u,%u)", ToStr(target).c_str(), x, y,
+             width, height);
     return ret;
   }
 
-  id = m_pDevice->GetLiveID(target);
+  if(events.empty())
+    return ret;
+
+  ResourceId id = m_pDevice->GetLiveID(target);
 
   if(id == ResourceId())
     return ret;
@@ -1543,6 +1559,65 @@ rdcarray<PixelModification> ReplayController::PixelHistory(ResourceId target, ui
   return ret;
 }
 
+rdcarray<PixelHistoryResult> ReplayController::PixelHistoryBatch(
+    ResourceId target, const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels,
+    const Subresource &sub, CompType typeCast)
+{
+  CHECK_REPLAY_THREAD();
+
+  RENDERDOC_PROFILEFUNCTION();
+
+  rdcarray<PixelHistoryResult> ret;
+  ret.resize(pixels.size());
+  for(size_t i = 0; i < pixels.size(); i++)
+  {
+    ret[i].x = pixels[i].first;
+    ret[i].y = pixels[i].second;
+  }
+
+  Subresource subresource;
+  uint32_t width, height;
+  rdcarray<EventUsage> events = GetPixelHistoryEvents(target, sub, subresource, width, height);
+
+  if(events.empty())
+    return ret;
+
+  ResourceId id = m_pDevice->GetLiveID(target);
+
+  if(id == ResourceId())
+    return ret;
+
+  // only send the in-bounds pixels to the driver, out of bounds pixels keep an empty history
+  rdcarray<rdcpair<uint32_t, uint32_t>> validPixels;
+  rdcarray<size_t> validIndices;
+  for(size_t i = 0; i < pixels.size(); i++)
+  {
+    if(pixels[i].first >= width || pixels[i].second >= height)
+    {
+      RDCDEBUG("PixelHistory out of bounds on %s (%u,%u) vs (%u,%u)", ToStr(target).c_str(),
+               pixels[i].first, pixels[i].second, width, height);
+      continue;
+    }
+
+    validPixels.push_back(pixels[i]);
+    validIndices.push_back(i);
+  }
+
+  if(validPixels.empty())
+    return ret;
+
+  rdcarray<PixelHistoryResult> history =
+      m_pDevice->PixelHistoryBatch(events, id, validPixels, subresource, typeCast);
+  FatalErrorCheck();
+
+  for(size_t i = 0; i < history.size() && i < validIndices.size(); i++)
+    ret[validIndices[i]].modifications.swap(history[i].modifications);
+
+  SetFrameEvent(m_EventID, true);
+
+  return ret;
+}
+
 PixelValue ReplayController::PickPixel(ResourceId tex, uint32_t x, uint32_t y,
                                        const Subresource &sub, CompType typeCast)
 {
@@ -1670,6 +1745,38 @@ void ReplayController::FreeTrace(ShaderDebugTrace *trace)
   }
 }
 
+rdcarray<ShaderDebugResult> ReplayController::DebugPixelBatch(
+    const rdcarray<DebugPixelInvocation> &pixels, const rdcarray<rdcstr> &variables)
+{
+  CHECK_REPLAY_THREAD();
+
+  RENDERDOC_PROFILEFUNCTION();
+
+  rdcarray<ShaderDebugResult> ret = m_pDevice->DebugPixelBatch(m_EventID, pixels, variables);
+  FatalErrorCheck();
+
+  // each debug replays up to the event itself, so we only need to restore the current state once
+  // for the whole batch
+  SetFrameEvent(m_EventID, true);
+
+  return ret;
+}
+
+rdcarray<ShaderDebugResult> ReplayController::DebugThreadBatch(
+    const rdcarray<DebugThreadInvocation> &threads, const rdcarray<rdcstr> &variables)
+{
+  CHECK_REPLAY_THREAD();
+
+  RENDERDOC_PROFILEFUNCTION();
+
+  rdcarray<ShaderDebugResult> ret = m_pDevice->DebugThreadBatch(m_EventID, threads, variables);
+  FatalErrorCheck();
+
+  SetFrameEvent(m_EventID, true);
+
+  return ret;
+}
+
 rdcarray<ShaderVariable> ReplayController::GetCBufferVariableContents(
     ResourceId pipeline, ResourceId shader, ShaderStage stage, const rdcstr &entryPoint,
     uint32_t cbufslot, ResourceId buffer, uint64_t offset, uint64_t length)
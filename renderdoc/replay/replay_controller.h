@@ -202,12 +202,19 @@ public:
                                   float minval, float maxval, const rdcfixedarray<bool, 4> &channels);
   rdcarray<PixelModification> PixelHistory(ResourceId target, uint32_t x, uint32_t y,
                                            const Subresource &sub, CompType typeCast);
+  rdcarray<PixelHistoryResult> PixelHistoryBatch(ResourceId target,
+                                                 const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels,
+                                                 const Subresource &sub, CompType typeCast);
   ShaderDebugTrace *DebugVertex(uint32_t vertid, uint32_t instid, uint32_t idx, uint32_t view);
   ShaderDebugTrace *DebugPixel(uint32_t x, uint32_t y, uint32_t sample, uint32_t primitive);
   ShaderDebugTrace *DebugThread(const rdcfixedarray<uint32_t, 3> &groupid,
                                 const rdcfixedarray<uint32_t, 3> &threadid);
   rdcarray<ShaderDebugState> ContinueDebug(ShaderDebugger *debugger);
   void FreeTrace(ShaderDebugTrace *trace);
+  rdcarray<ShaderDebugResult> DebugPixelBatch(const rdcarray<DebugPixelInvocation> &pixels,
+                                              const rdcarray<rdcstr> &variables);
+  rdcarray<ShaderDebugResult> DebugThreadBatch(const rdcarray<DebugThreadInvocation> &threads,
+                                               const rdcarray<rdcstr> &variables);
 
   MeshFormat GetPostVSData(uint32_t instID, uint32_t viewID, MeshDataStage stage);
 
@@ -247,6 +254,10 @@ private:
   bool ContainsMarker(const rdcarray<ActionDescription> &actions);
   bool PassEquivalent(const ActionDescription &a, const ActionDescription &b);
 
+  rdcarray<EventUsage> GetPixelHistoryEvents(ResourceId target, const Subresource &sub,
+                                             Subresource &subresource, uint32_t &width,
+                                             uint32_t &height);
+
   IReplayDriver *GetDevice() { return m_pDevice; }
   FrameRecord m_FrameRecord;
   rdcarray<ActionDescription *> m_Actions;
@@ -56,6 +56,155 @@ void DoSerialise(SerialiserType &ser, GetTextureDataParams &el)
 
 INSTANTIATE_SERIALISE_TYPE(GetTextureDataParams);
 
+rdcarray<PixelHistoryResult> IRemoteDriver::PixelHistoryBatch(
+    rdcarray<EventUsage> events, ResourceId target,
+    const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels, const Subresource &sub, CompType typeCast)
+{
+  rdcarray<PixelHistoryResult> ret;
+  ret.resize(pixels.size());
+
+  for(size_t i = 0; i < pixels.size(); i++)
+  {
+    ret[i].x = pixels[i].first;
+    ret[i].y = pixels[i].second;
+    ret[i].modifications = PixelHistory(events, target, ret[i].x, ret[i].y, sub, typeCast);
+  }
+
+  return ret;
+}
+
+static const ShaderVariable *FindDebugVariable(const ShaderVariable &var, const rdcstr &path)
+{
+  if(var.name == path)
+    return &var;
+
+  if(!path.beginsWith(var.name) || path.size() <= var.name.size())
+    return NULL;
+
+  // the rest of the path must continue with a member access or array index. Struct members are
+  // named without the separator, array elements are named with their index brackets
+  rdcstr rest = path.substr(var.name.size());
+  if(rest[0] == '.')
+    rest.erase(0, 1);
+  else if(rest[0] != '[')
+    return NULL;
+
+  for(const ShaderVariable &member : var.members)
+  {
+    const ShaderVariable *ret = FindDebugVariable(member, rest);
+    if(ret)
+      return ret;
+  }
+
+  return NULL;
+}
+
+ShaderDebugResult RunDebugToCompletion(IRemoteDriver *driver, ShaderDebugTrace *trace,
+                                       const rdcarray<rdcstr> &variables)
+{
+  ShaderDebugResult ret;
+
+  if(!trace)
+    return ret;
+
+  if(trace->debugger)
+  {
+    ret.valid = true;
+
+    rdcarray<rdcstr> names = variables;
+
+    // with no explicit names, return whichever variables back the output signature
+    if(names.empty())
+    {
+      for(const SourceVariableMapping &sourceVar : trace->sourceVars)
+      {
+        if(sourceVar.signatureIndex < 0)
+          continue;
+
+        for(const DebugVariableReference &ref : sourceVar.variables)
+        {
+          if(ref.type == DebugVariableType::Variable && !names.contains(ref.name))
+            names.push_back(ref.name);
+        }
+      }
+    }
+
+    // we only keep the latest value of each variable rather than every state
+    std::map<rdcstr, ShaderVariable> current;
+
+    for(;;)
+    {
+      rdcarray<ShaderDebugState> states = driver->ContinueDebug(trace->debugger);
+
+      if(states.empty())
+        break;
+
+      for(ShaderDebugState &state : states)
+      {
+        for(ShaderVariableChange &change : state.changes)
+        {
+          // a change with no 'after' means the variable went out of scope. Keep the last value it
+          // had so that it can still be returned.
+          if(!change.after.name.empty())
+            current[change.after.name] = std::move(change.after);
+        }
+      }
+
+      ret.stepCount = states.back().stepIndex;
+    }
+
+    ret.variables.resize(names.size());
+    for(size_t i = 0; i < names.size(); i++)
+    {
+      for(auto it = current.begin(); it != current.end(); ++it)
+      {
+        const ShaderVariable *var = FindDebugVariable(it->second, names[i]);
+        if(var)
+        {
+          ret.variables[i] = *var;
+          break;
+        }
+      }
+
+      ret.variables[i].name = names[i];
+    }
+
+    driver->FreeDebugger(trace->debugger);
+  }
+
+  delete trace;
+
+  return ret;
+}
+
+rdcarray<ShaderDebugResult> IRemoteDriver::DebugPixelBatch(uint32_t eventId,
+                                                           const rdcarray<DebugPixelInvocation> &pixels,
+                                                           const rdcarray<rdcstr> &variables)
+{
+  rdcarray<ShaderDebugResult> ret;
+  ret.reserve(pixels.size());
+
+  for(const DebugPixelInvocation &pixel : pixels)
+    ret.push_back(RunDebugToCompletion(
+        this, DebugPixel(eventId, pixel.x, pixel.y, pixel.sample, pixel.primitive), variables));
+
+  return ret;
+}
+
+rdcarray<ShaderDebugResult> IRemoteDriver::DebugThreadBatch(
+    uint32_t eventId, const rdcarray<DebugThreadInvocation> &threads,
+    const rdcarray<rdcstr> &variables)
+{
+  rdcarray<ShaderDebugResult> ret;
+  ret.reserve(threads.size());
+
+  for(const DebugThreadInvocation &thread : threads)
+    ret.push_back(RunDebugToCompletion(
+        this, DebugThread(eventId, thread.groupid, thread.threadid), variables));
+
+  return ret;
+}
+
 static bool PreviousNextExcludedMarker(ActionDescription *action)
 {
   return bool(action->flags & (ActionFlags::PushMarker | ActionFlags::PopMarker |
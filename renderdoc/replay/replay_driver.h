@@ -197,6 +197,12 @@ public:
   virtual rdcarray<PixelModification> PixelHistory(rdcarray<EventUsage> events, ResourceId target,
                                                    uint32_t x, uint32_t y, const Subresource &sub,
                                                    CompType typeCast) = 0;
+  // fetches the history for several pixels at once. Drivers that can share replay passes between
+  // pixels should override this, by default it fetches each pixel's history in turn.
+  virtual rdcarray<PixelHistoryResult> PixelHistoryBatch(
+      rdcarray<EventUsage> events, ResourceId target,
+      const rdcarray<rdcpair<uint32_t, uint32_t>> &pixels, const Subresource &sub,
+      CompType typeCast);
   virtual ShaderDebugTrace *DebugVertex(uint32_t eventId, uint32_t vertid, uint32_t instid,
                                         uint32_t idx, uint32_t view) = 0;
   virtual ShaderDebugTrace *DebugPixel(uint32_t eventId, uint32_t x, uint32_t y, uint32_t sample,
@@ -205,6 +211,16 @@ public:
                                         const rdcfixedarray<uint32_t, 3> &threadid) = 0;
   virtual rdcarray<ShaderDebugState> ContinueDebug(ShaderDebugger *debugger) = 0;
   virtual void FreeDebugger(ShaderDebugger *debugger) = 0;
+  // debugs several invocations, running each to completion and returning only the final values
+  // of the requested variables. By default each invocation is debugged in turn through the
+  // functions above, drivers that can share setup between invocations or run them in parallel
+  // should override these.
+  virtual rdcarray<ShaderDebugResult> DebugPixelBatch(uint32_t eventId,
+                                                      const rdcarray<DebugPixelInvocation> &pixels,
+                                                      const rdcarray<rdcstr> &variables);
+  virtual rdcarray<ShaderDebugResult> DebugThreadBatch(uint32_t eventId,
+                                                       const rdcarray<DebugThreadInvocation> &threads,
+                                                       const rdcarray<rdcstr> &variables);
 
   virtual ResourceId RenderOverlay(ResourceId texid, FloatVector clearCol, DebugOverlay overlay,
                                    uint32_t eventId, const rdcarray<uint32_t> &passEvents) = 0;
@@ -319,6 +335,11 @@ void StandardFillCBufferVariables(ResourceId shader, const rdcarray<ShaderConsta
                                   rdcarray<ShaderVariable> &outvars, const bytebuf &data);
 void PreprocessLineDirectives(rdcarray<ShaderSourceFile> &sourceFiles);
 
+// continues a debug trace until it finishes, then frees it and its debugger. Only the final values
+// of the given variables are kept, or of those backing the output signature if none are given.
+ShaderDebugResult RunDebugToCompletion(IRemoteDriver *driver, ShaderDebugTrace *trace,
+                                       const rdcarray<rdcstr> &variables);
+
 // simple cache for when we need buffer data for highlighting
 // vertices, typical use will be lots of vertices in the same
 // mesh, not jumping back and forth much between meshes.
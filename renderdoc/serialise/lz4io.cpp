@@ -120,6 +120,8 @@ bool LZ4Compressor::Finish()
 
 bool LZ4Compressor::FlushPage0()
 {
+  RDCPROFILE_ZONE("LZ4 compress");
+
   // if we encountered a stream error this will be NULL
   if(!m_CompressBuffer)
     return false;
@@ -262,6 +264,8 @@ bool LZ4Decompressor::Read(void *data, uint64_t numBytes)
 
 bool LZ4Decompressor::FillPage0()
 {
+  RDCPROFILE_ZONE("LZ4 decompress");
+
   // swap pages
   std::swap(m_Page[0], m_Page[1]);
 
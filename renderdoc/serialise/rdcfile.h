@@ -75,6 +75,8 @@ public:
   void Create(const rdcstr &filename);
 
   bool IsUntrusted() const { return m_Untrusted; }
+  // empty if the file was opened from memory
+  const rdcstr &GetFilename() const { return m_Filename; }
   const RDResult &Error() const { return m_Error; }
   RDCDriver GetDriver() const { return m_Driver; }
   const rdcstr &GetDriverName() const { return m_DriverName; }
@@ -306,6 +306,9 @@ void Serialiser<SerialiserMode::Reading>::EndChunk()
 
   // align to the natural chunk alignment
   m_Read->AlignTo<ChunkAlignment>();
+
+  // anything deserialised in this chunk has been freed by now
+  m_ScratchArena.Reset();
 }
 
 /////////////////////////////////////////////////////////////
@@ -1184,6 +1187,65 @@ void ChunkAllocator::swap(ChunkAllocator &alloc)
   pages.swap(alloc.pages);
 }
 
+ReadScratchArena::~ReadScratchArena()
+{
+  Reset();
+
+  for(byte *page : m_Pages)
+    ::FreeAlignedBuffer(page);
+}
+
+byte *ReadScratchArena::AllocAlignedBuffer(uint64_t size)
+{
+  if(m_Enabled && size <= MaxScratchSize)
+    return Carve(size, 64);
+
+  m_Stats.heapAllocations++;
+  byte *ret = ::AllocAlignedBuffer(size);
+  if(m_Enabled)
+    m_Releases.push_back({ret, &DeleteBuffer});
+  return ret;
+}
+
+byte *ReadScratchArena::Carve(uint64_t size, uint64_t alignment)
+{
+  m_Stats.scratchAllocations++;
+
+  for(;;)
+  {
+    if(m_CurPage < m_Pages.size())
+    {
+      byte *page = m_Pages[m_CurPage];
+
+      byte *ret = (byte *)AlignUp(uint64_t(page + m_PageOffset), alignment);
+
+      if(ret + size <= page + PageSize)
+      {
+        m_PageOffset = size_t(ret + size - page);
+        return ret;
+      }
+
+      // a page always fits at least one maximum size allocation, so move to the next one
+      m_CurPage++;
+      m_PageOffset = 0;
+      continue;
+    }
+
+    m_Stats.heapAllocations++;
+    m_Pages.push_back(::AllocAlignedBuffer(PageSize));
+  }
+}
+
+void ReadScratchArena::Reset()
+{
+  for(const Release &r : m_Releases)
+    r.release(r.ptr);
+  m_Releases.clear();
+
+  m_CurPage = 0;
+  m_PageOffset = 0;
+}
+
 byte *ChunkAllocator::AllocAlignedBuffer(uint64_t size)
 {
   // always allocate 64-bytes at a time even if the size is smaller
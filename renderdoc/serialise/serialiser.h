@@ -82,6 +82,105 @@ enum class SerialiserMode
 
 struct CompressedFileIO;
 
+// Scratch memory for everything allocated while reading a single chunk - byte buffers, arrays and
+// nullable structs. Small allocations of types with no destructor are carved out of pages that are
+// all reclaimed at once when the chunk ends, rather than each being a separate heap allocation and
+// free. Anything larger, or that needs destructing, still comes from the heap but is released
+// along with the pages.
+//
+// This is opt-in per serialiser, since it's only valid when everything reading chunks from it
+// drops what it deserialised by the end of each chunk. While it's enabled the ScopedDeserialise*
+// helpers don't free anything themselves, and code that frees deserialised memory by hand must go
+// through FreeDeserialisedBuffer() / FreeDeserialisedNullable() rather than FreeAlignedBuffer() or
+// delete.
+class ReadScratchArena
+{
+public:
+  ReadScratchArena() = default;
+  ReadScratchArena(const ReadScratchArena &) = delete;
+  ReadScratchArena &operator=(const ReadScratchArena &) = delete;
+  ~ReadScratchArena();
+
+  struct Stats
+  {
+    // allocations handed out from the arena pages
+    uint64_t scratchAllocations = 0;
+    // heap allocations made, both for allocations unsuitable for the arena and for the pages
+    uint64_t heapAllocations = 0;
+  };
+
+  // when disabled every allocation is a plain heap allocation owned by the caller, as if there were
+  // no arena. This must not change while a chunk is being read.
+  void SetEnabled(bool enabled) { m_Enabled = enabled; }
+  bool IsEnabled() const { return m_Enabled; }
+  byte *AllocAlignedBuffer(uint64_t size);
+
+  template <typename T>
+  T *NewArray(uint64_t count)
+  {
+    if(m_Enabled && std::is_trivially_destructible<T>::value && sizeof(T) * count <= MaxScratchSize)
+    {
+      T *ret = (T *)Carve(sizeof(T) * count, alignof(T));
+      for(uint64_t i = 0; i < count; i++)
+        new(ret + i) T;
+      return ret;
+    }
+
+    m_Stats.heapAllocations++;
+    T *ret = new T[(size_t)count];
+    if(m_Enabled)
+      m_Releases.push_back({ret, &DeleteArray<T>});
+    return ret;
+  }
+
+  template <typename T>
+  T *New()
+  {
+    if(m_Enabled && std::is_trivially_destructible<T>::value && sizeof(T) <= MaxScratchSize)
+      return new(Carve(sizeof(T), alignof(T))) T;
+
+    m_Stats.heapAllocations++;
+    T *ret = new T;
+    if(m_Enabled)
+      m_Releases.push_back({ret, &DeleteObject<T>});
+    return ret;
+  }
+
+  // reclaim everything allocated since the last reset. The pages are kept for re-use
+  void Reset();
+
+  const Stats &GetStats() const { return m_Stats; }
+private:
+  static const size_t PageSize = 64 * 1024;
+  static const size_t MaxScratchSize = PageSize / 4;
+
+  byte *Carve(uint64_t size, uint64_t alignment);
+
+  struct Release
+  {
+    void *ptr;
+    void (*release)(void *);
+  };
+
+  template <typename T>
+  static void DeleteArray(void *ptr)
+  {
+    delete[](T *) ptr;
+  }
+  template <typename T>
+  static void DeleteObject(void *ptr)
+  {
+    delete(T *) ptr;
+  }
+  static void DeleteBuffer(void *ptr) { FreeAlignedBuffer((byte *)ptr); }
+  bool m_Enabled = false;
+  rdcarray<byte *> m_Pages;
+  size_t m_CurPage = 0;
+  size_t m_PageOffset = 0;
+  rdcarray<Release> m_Releases;
+  Stats m_Stats;
+};
+
 template <SerialiserMode sertype>
 class Serialiser
 {
@@ -309,7 +408,7 @@ public:
         if(!m_Structuriser && (flags & SerialiserFlags::AllocateMemory))
         {
           if(byteSize > 0)
-            el = AllocAlignedBuffer(byteSize);
+            el = m_ScratchArena.AllocAlignedBuffer(byteSize);
           else
             el = NULL;
         }
@@ -320,7 +419,7 @@ public:
         if(el == NULL && ExportStructure() && m_ExportBuffers)
         {
           if(byteSize > 0)
-            el = tempAlloc = AllocAlignedBuffer(byteSize);
+            el = tempAlloc = m_ScratchArena.AllocAlignedBuffer(byteSize);
           else
             el = NULL;
         }
@@ -352,7 +451,7 @@ public:
 #if !defined(__COVERITY__)
     if(tempAlloc)
     {
-      FreeAlignedBuffer(tempAlloc);
+      FreeDeserialisedBuffer(tempAlloc);
       el = NULL;
     }
 #endif
@@ -630,7 +729,7 @@ public:
       if(IsReading() && !m_Structuriser && (flags & SerialiserFlags::AllocateMemory))
       {
         if(arrayCount > 0)
-          el = new T[(size_t)arrayCount];
+          el = m_ScratchArena.NewArray<T>(arrayCount);
         else
           el = NULL;
       }
@@ -677,7 +776,7 @@ public:
       if(IsReading() && !m_Structuriser && (flags & SerialiserFlags::AllocateMemory))
       {
         if(arrayCount > 0)
-          el = new T[(size_t)arrayCount];
+          el = m_ScratchArena.NewArray<T>(arrayCount);
         else
           el = NULL;
       }
@@ -963,7 +1062,7 @@ public:
       if(IsReading())
       {
         if(present)
-          el = new T;
+          el = m_ScratchArena.New<T>();
         else
           el = NULL;
       }
@@ -1003,7 +1102,7 @@ public:
       if(IsReading())
       {
         if(present)
-          el = new T;
+          el = m_ScratchArena.New<T>();
         else
           el = NULL;
       }
@@ -1231,6 +1330,25 @@ public:
   // this sets the current threshold for making structured data lazy for arrays above this size.
   // If set to 0, structured data is never set as lazy
   void SetLazyThreshold(uint32_t arraySize) { m_LazyThreshold = arraySize; }
+  // allocate everything read in a chunk from a scratch arena that is reset at the end of the
+  // chunk, instead of from the heap. See ReadScratchArena for when this is safe to enable.
+  void SetScratchArenaEnabled(bool enabled) { m_ScratchArena.SetEnabled(enabled); }
+  bool IsScratchArenaEnabled() const { return m_ScratchArena.IsEnabled(); }
+  const ReadScratchArena::Stats &GetScratchArenaStats() const { return m_ScratchArena.GetStats(); }
+  // frees a byte buffer allocated while reading. With the arena it's released at the end of the
+  // chunk instead
+  void FreeDeserialisedBuffer(byte *buf) const
+  {
+    if(!m_ScratchArena.IsEnabled())
+      FreeAlignedBuffer(buf);
+  }
+  // as above, for a struct allocated by SerialiseNullable
+  template <class T>
+  void FreeDeserialisedNullable(T *el) const
+  {
+    if(!m_ScratchArena.IsEnabled())
+      delete el;
+  }
   /////////////////////////////////////////////////////////////////////////////
 
   // for basic/leaf types. Read/written just as byte soup, MUST be plain old data
@@ -1510,6 +1628,7 @@ private:
   bool m_ExportBuffers = false;
   int m_InternalElement = 0;
   uint32_t m_LazyThreshold = 0;
+  ReadScratchArena m_ScratchArena;
   SDFile m_StructData;
   SDFile *m_StructuredFile = &m_StructData;
   rdcarray<SDObject *> m_StructureStack;
@@ -1887,7 +2006,7 @@ struct ScopedDeserialise
   ScopedDeserialise(const SerialiserType &ser, const T &el) : m_Ser(ser), m_El(el) {}
   ~ScopedDeserialise()
   {
-    if(m_Ser.IsReading())
+    if(m_Ser.IsReading() && !m_Ser.IsScratchArenaEnabled())
       Deserialise(m_El);
   }
   const SerialiserType &m_Ser;
@@ -1902,7 +2021,8 @@ struct ScopedDeserialiseNullable
   ScopedDeserialiseNullable(const SerialiserType &ser, T **el) : m_Ser(ser), m_El(el) {}
   ~ScopedDeserialiseNullable()
   {
-    if(m_Ser.IsReading() && *m_El != NULL)
+    // with the scratch arena everything is released at the end of the chunk instead
+    if(m_Ser.IsReading() && *m_El != NULL && !m_Ser.IsScratchArenaEnabled())
     {
       Deserialise(**m_El);
       delete *m_El;
@@ -1923,7 +2043,7 @@ struct ScopedDeserialiseArray
   }
   ~ScopedDeserialiseArray()
   {
-    if(m_Ser.IsReading() && *m_El)
+    if(m_Ser.IsReading() && *m_El && !m_Ser.IsScratchArenaEnabled())
     {
       for(uint64_t i = 0; i < count; i++)
         Deserialise((*m_El)[i]);
@@ -1942,7 +2062,7 @@ struct ScopedDeserialiseArray<SerialiserType, void *>
   ~ScopedDeserialiseArray()
   {
     if(m_Ser.IsReading())
-      FreeAlignedBuffer((byte *)*m_El);
+      m_Ser.FreeDeserialisedBuffer((byte *)*m_El);
   }
   const SerialiserType &m_Ser;
   void **m_El;
@@ -1958,7 +2078,7 @@ struct ScopedDeserialiseArray<SerialiserType, const void *>
   ~ScopedDeserialiseArray()
   {
     if(m_Ser.IsReading())
-      FreeAlignedBuffer((byte *)*m_El);
+      m_Ser.FreeDeserialisedBuffer((byte *)*m_El);
   }
   const SerialiserType &m_Ser;
   const void **m_El;
@@ -1971,7 +2091,7 @@ struct ScopedDeserialiseArray<SerialiserType, byte *>
   ~ScopedDeserialiseArray()
   {
     if(m_Ser.IsReading())
-      FreeAlignedBuffer(*m_El);
+      m_Ser.FreeDeserialisedBuffer(*m_El);
   }
   const SerialiserType &m_Ser;
   byte **m_El;
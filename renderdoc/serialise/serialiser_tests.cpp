@@ -595,6 +595,130 @@ TEST_CASE("Read/writing large buffers", "[serialiser]")
   FileIO::Delete(filename);
 };
 
+TEST_CASE("Read chunk temporaries into the chunk scratch arena", "[serialiser]")
+{
+  StreamWriter *buf = new StreamWriter(StreamWriter::DefaultScratchSize);
+
+  const uint32_t numChunks = 50;
+  const uint32_t smallPerChunk = 20;
+
+  bytebuf small, large;
+  small.resize(1000);
+  large.resize(1024 * 1024);
+  for(size_t i = 0; i < small.size(); i++)
+    small[i] = byte(i & 0xff);
+  for(size_t i = 0; i < large.size(); i++)
+    large[i] = byte((i * 7) & 0xff);
+
+  {
+    WriteSerialiser ser(buf, Ownership::Nothing);
+
+    for(uint32_t c = 0; c < numChunks; c++)
+    {
+      SCOPED_SERIALISE_CHUNK(5 + c);
+
+      for(uint32_t i = 0; i < smallPerChunk; i++)
+      {
+        byte *data = small.data();
+        ser.Serialise("small"_lit, data, small.size());
+      }
+
+      byte *data = large.data();
+      ser.Serialise("large"_lit, data, large.size());
+
+      uint32_t values[16];
+      for(uint32_t i = 0; i < 16; i++)
+        values[i] = c * 16 + i;
+      uint32_t *array = values;
+      ser.Serialise("array"_lit, array, 16);
+
+      uint64_t optValue = c;
+      uint64_t *opt = &optValue;
+      ser.SerialiseNullable("opt"_lit, opt);
+    }
+  }
+
+  for(bool arena : {false, true})
+  {
+    StreamReader reader(buf->GetData(), buf->GetOffset());
+
+    ReadSerialiser ser(&reader, Ownership::Nothing);
+
+    // the arena is opt-in, since buffers can't be kept past the chunk
+    CHECK(ser.GetScratchArenaStats().scratchAllocations == 0);
+    ser.SetScratchArenaEnabled(arena);
+
+    for(uint32_t c = 0; c < numChunks; c++)
+    {
+      CHECK(ser.ReadChunk<uint32_t>() == 5 + c);
+
+      byte *smallBufs[smallPerChunk] = {};
+
+      for(uint32_t i = 0; i < smallPerChunk; i++)
+      {
+        ser.Serialise("small"_lit, smallBufs[i], small.size(), SerialiserFlags::AllocateMemory);
+        REQUIRE(smallBufs[i]);
+      }
+
+      byte *largeBuf = NULL;
+      ser.Serialise("large"_lit, largeBuf, large.size(), SerialiserFlags::AllocateMemory);
+      REQUIRE(largeBuf);
+
+      // buffers must stay distinct and intact until the end of the chunk
+      for(uint32_t i = 0; i < smallPerChunk; i++)
+      {
+        CHECK(((uint64_t)smallBufs[i] % 64) == 0);
+        CHECK_FALSE(memcmp(smallBufs[i], small.data(), small.size()));
+      }
+      CHECK_FALSE(memcmp(largeBuf, large.data(), large.size()));
+
+      uint32_t *array = NULL;
+      ser.Serialise("array"_lit, array, 16, SerialiserFlags::AllocateMemory);
+      REQUIRE(array);
+      for(uint32_t i = 0; i < 16; i++)
+        CHECK(array[i] == c * 16 + i);
+
+      uint64_t *opt = NULL;
+      ser.SerialiseNullable("opt"_lit, opt);
+      REQUIRE(opt);
+      CHECK(*opt == c);
+
+      // the serialiser knows which buffers it owns, so freeing looks the same either way
+      for(uint32_t i = 0; i < smallPerChunk; i++)
+        ser.FreeDeserialisedBuffer(smallBufs[i]);
+      ser.FreeDeserialisedBuffer(largeBuf);
+
+      // arrays and nullables are released by the scoped deserialise helpers, which leave them to
+      // the arena when it's enabled
+      {
+        ScopedDeserialiseArray<ReadSerialiser, uint32_t *> freeArray(ser, &array, 16);
+        ScopedDeserialiseNullable<ReadSerialiser, uint64_t *> freeOpt(ser, &opt);
+      }
+
+      ser.EndChunk();
+    }
+
+    CHECK_FALSE(ser.IsErrored());
+
+    const ReadScratchArena::Stats &stats = ser.GetScratchArenaStats();
+
+    if(arena)
+    {
+      // the small buffers, array and nullable all fit in one page which is re-used for every
+      // chunk, the large buffers still go to the heap
+      CHECK(stats.scratchAllocations == numChunks * (smallPerChunk + 2));
+      CHECK(stats.heapAllocations == numChunks + 1);
+    }
+    else
+    {
+      CHECK(stats.scratchAllocations == 0);
+      CHECK(stats.heapAllocations == numChunks * (smallPerChunk + 3));
+    }
+  }
+
+  delete buf;
+};
+
 TEST_CASE("Read/write chunk metadata", "[serialiser]")
 {
   StreamWriter *buf = new StreamWriter(StreamWriter::DefaultScratchSize);
@@ -1544,6 +1668,140 @@ void test(const char *aasd)
   RDCLOG("got a test of %s", aasd);
 }
 
+TEST_CASE("Query structured data in bulk", "[structured]")
+{
+  SDFile file;
+
+  for(uint32_t i = 0; i < 6; i++)
+  {
+    SDChunk *chunk = new SDChunk(i % 2 == 0 ? "vkCreateImage"_lit : "vkCmdDraw"_lit);
+    chunk->metadata.chunkID = 1000 + (i % 2);
+
+    if(i % 2 == 0)
+    {
+      SDObject *info = chunk->AddAndOwnChild(makeSDStruct("CreateInfo"_lit, "VkImageCreateInfo"_lit));
+      SDObject *extent = info->AddAndOwnChild(makeSDStruct("extent"_lit, "VkExtent3D"_lit));
+      extent->AddAndOwnChild(makeSDUInt32("width"_lit, 16 << i));
+      SDObject *queues = info->AddAndOwnChild(makeSDArray("pQueueFamilyIndices"_lit));
+      for(uint32_t q = 0; q <= i; q++)
+        queues->AddAndOwnChild(makeSDUInt32("$el"_lit, q * 10));
+      info->AddAndOwnChild(makeSDString("name"_lit, StringFormat::Fmt("image%u", i)));
+    }
+    else
+    {
+      chunk->AddAndOwnChild(makeSDInt32("vertexCount"_lit, -int32_t(i)));
+      chunk->AddAndOwnChild(makeSDFloat("scale"_lit, 0.5f * i));
+    }
+
+    file.chunks.push_back(chunk);
+  }
+
+  SECTION("Select by name and extract nested paths")
+  {
+    SDQuery query;
+    query.chunkName = "vkCreateImage";
+    query.paths = {"CreateInfo.extent.width", "CreateInfo.pQueueFamilyIndices[2]",
+                   "CreateInfo.name", "CreateInfo.missing"};
+
+    SDQueryResult result = file.Query(query);
+
+    REQUIRE(result.chunkIndices.size() == 3);
+    CHECK(result.chunkIndices[0] == 0);
+    CHECK(result.chunkIndices[1] == 2);
+    CHECK(result.chunkIndices[2] == 4);
+
+    REQUIRE(result.columns.size() == 4);
+
+    const SDQueryColumn &width = result.columns[0];
+    CHECK(width.type == SDBasic::UnsignedInteger);
+    CHECK(width.unsignedValues == rdcarray<uint64_t>({16, 64, 256}));
+    CHECK(width.missingRows.empty());
+
+    // only the later chunks have a third queue family index, earlier rows are padded
+    const SDQueryColumn &queue = result.columns[1];
+    CHECK(queue.type == SDBasic::UnsignedInteger);
+    CHECK(queue.unsignedValues == rdcarray<uint64_t>({0, 20, 20}));
+    CHECK(queue.missingRows == rdcarray<uint32_t>({0}));
+
+    const SDQueryColumn &name = result.columns[2];
+    CHECK(name.type == SDBasic::String);
+    CHECK(name.stringValues == rdcarray<rdcstr>({"image0", "image2", "image4"}));
+
+    const SDQueryColumn &missing = result.columns[3];
+    CHECK(missing.type == SDBasic::Null);
+    CHECK(missing.unsignedValues.empty());
+    CHECK(missing.missingRows == rdcarray<uint32_t>({0, 1, 2}));
+  }
+
+  SECTION("Select by ID and index range")
+  {
+    SDQuery query;
+    query.chunkID = 1001;
+    query.firstChunk = 2;
+    query.lastChunk = 5;
+    query.paths = {"vertexCount", "scale"};
+
+    SDQueryResult result = file.Query(query);
+
+    REQUIRE(result.chunkIndices.size() == 2);
+    CHECK(result.chunkIndices[0] == 3);
+    CHECK(result.chunkIndices[1] == 5);
+
+    CHECK(result.columns[0].type == SDBasic::SignedInteger);
+    CHECK(result.columns[0].signedValues == rdcarray<int64_t>({-3, -5}));
+    CHECK(result.columns[1].type == SDBasic::Float);
+    CHECK(result.columns[1].floatValues == rdcarray<double>({1.5, 2.5}));
+  }
+
+  SECTION("Mismatched types are missing")
+  {
+    SDQuery query;
+    query.paths = {"vertexCount"};
+
+    // only the draw chunks have the value, the first of which decides the column type
+    SDQueryResult result = file.Query(query);
+
+    REQUIRE(result.chunkIndices.size() == 6);
+    CHECK(result.columns[0].signedValues == rdcarray<int64_t>({0, -1, 0, -3, 0, -5}));
+    CHECK(result.columns[0].missingRows == rdcarray<uint32_t>({0, 2, 4}));
+  }
+
+  SECTION("Malformed paths are rejected")
+  {
+    SDQuery query;
+    query.chunkName = "vkCreateImage";
+    query.paths = {
+        "CreateInfo.pQueueFamilyIndices[1]",
+        "CreateInfo.pQueueFamilyIndices[x]",
+        "CreateInfo.pQueueFamilyIndices[1",
+        "CreateInfo.pQueueFamilyIndices[0][1]",
+        "CreateInfo.pQueueFamilyIndices[]",
+        "CreateInfo.pQueueFamilyIndices[1]x",
+        "CreateInfo.pQueueFamilyIndices]",
+        "CreateInfo..name",
+        "CreateInfo.name.",
+        "",
+        "CreateInfo.pQueueFamilyIndices[9999999999]",
+    };
+
+    SDQueryResult result = file.Query(query);
+
+    REQUIRE(result.chunkIndices.size() == 3);
+    REQUIRE(result.columns.size() == query.paths.size());
+
+    // the well-formed path still resolves where the index exists
+    CHECK(result.columns[0].unsignedValues == rdcarray<uint64_t>({0, 10, 10}));
+    CHECK(result.columns[0].missingRows == rdcarray<uint32_t>({0}));
+
+    for(size_t p = 1; p < result.columns.size(); p++)
+    {
+      INFO("path: " << query.paths[p].c_str());
+      CHECK(result.columns[p].type == SDBasic::Null);
+      CHECK(result.columns[p].missingRows == rdcarray<uint32_t>({0, 1, 2}));
+    }
+  }
+}
+
 TEST_CASE("Test stringification works as expected", "[tostr]")
 {
   SECTION("Enum classes")
@@ -376,6 +376,8 @@ bool StreamReader::ReadFromExternal(void *buffer, uint64_t length)
   }
   else if(m_File)
   {
+    RDCPROFILE_ZONE("File read");
+
     uint64_t numRead = FileIO::fread(buffer, 1, (size_t)length, m_File);
     success = (numRead == length);
 
@@ -29,6 +29,7 @@
 #include "api/replay/replay_enums.h"
 #include "common/common.h"
 #include "common/formatting.h"
+#include "common/profiler.h"
 #include "os/os_specific.h"
 
 enum class Ownership
@@ -383,6 +384,8 @@ public:
     }
     else if(m_File)
     {
+      RDCPROFILE_ZONE("File write");
+
       uint64_t written = (uint64_t)FileIO::fwrite(data, 1, (size_t)numBytes, m_File);
       if(written != numBytes)
       {
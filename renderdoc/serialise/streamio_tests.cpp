@@ -302,6 +302,117 @@ TEST_CASE("Test stream I/O operations over the network", "[streamio][network]")
     CHECK(writer.IsErrored());
   };
 
+  SECTION("Socket reactor waits")
+  {
+    Network::SocketReactor reactor;
+    reactor.Add(receiver);
+
+    // nothing has been sent, so this should time out
+    CHECK_FALSE(reactor.Wait(10));
+
+    // a timeout can't return before it has expired, so returning earlier than this means the wait
+    // was woken
+    const uint32_t timeoutMS = 5000;
+
+    // a pending wake returns immediately
+    {
+      reactor.Wake();
+
+      PerformanceTimer timer;
+      CHECK_FALSE(reactor.Wait(timeoutMS));
+      CHECK(timer.GetMilliseconds() < double(timeoutMS));
+    }
+
+    // a wake from another thread interrupts a wait in progress
+    {
+      Threading::ThreadHandle wakeThread = Threading::CreateThread([&reactor]() {
+        Threading::Sleep(20);
+        reactor.Wake();
+      });
+
+      PerformanceTimer timer;
+      CHECK_FALSE(reactor.Wait(timeoutMS));
+      CHECK(timer.GetMilliseconds() < double(timeoutMS));
+
+      Threading::JoinThread(wakeThread);
+      Threading::CloseThread(wakeThread);
+    }
+
+    // incoming data is reported
+    {
+      uint32_t value = 1234;
+      REQUIRE(sender->SendDataBlocking(&value, sizeof(value)));
+
+      CHECK(reactor.Wait(5000));
+      CHECK(receiver->IsRecvDataWaiting());
+
+      value = 0;
+      REQUIRE(receiver->RecvDataBlocking(&value, sizeof(value)));
+      CHECK(value == 1234);
+    }
+
+    // disconnected sockets are reported so that the caller notices
+    {
+      receiver->Shutdown();
+
+      CHECK(reactor.Wait(5000));
+    }
+  };
+
+  SECTION("Ping round-trip latency")
+  {
+    const int numPings = 200;
+
+    // number of times the echo wait ran to its timeout instead of being woken by the ping
+    uint32_t timeouts = 0;
+
+    // echo every ping straight back, as a target control or remote server would with a message
+    Threading::ThreadHandle echoThread = Threading::CreateThread([receiver, &timeouts]() {
+      Network::SocketReactor reactor;
+      reactor.Add(receiver);
+
+      for(int i = 0; i < numPings; i++)
+      {
+        uint32_t ping = 0;
+
+        // nothing else wakes this reactor, so returning false means the timeout expired
+        while(!receiver->IsRecvDataWaiting() && receiver->Connected())
+          if(!reactor.Wait(5000))
+            timeouts++;
+
+        if(!receiver->RecvDataBlocking(&ping, sizeof(ping)) ||
+           !receiver->SendDataBlocking(&ping, sizeof(ping)))
+          break;
+      }
+    });
+
+    double total = 0.0, worst = 0.0;
+
+    for(uint32_t i = 0; i < numPings; i++)
+    {
+      PerformanceTimer timer;
+
+      uint32_t pong = 0;
+      REQUIRE(sender->SendDataBlocking(&i, sizeof(i)));
+      REQUIRE(sender->RecvDataBlocking(&pong, sizeof(pong)));
+      CHECK(pong == i);
+
+      double ms = timer.GetMilliseconds();
+      total += ms;
+      worst = RDCMAX(worst, ms);
+    }
+
+    Threading::JoinThread(echoThread);
+    Threading::CloseThread(echoThread);
+
+    RDCLOG("Loopback ping round-trip: %.3lf ms average, %.3lf ms worst over %d pings",
+           total / numPings, worst, numPings);
+
+    // each ping is sent as soon as the previous one is echoed, so the echo's waits should always be
+    // woken by the incoming data rather than falling back to their timeout.
+    CHECK(timeouts == 0);
+  };
+
   delete sender;
   delete receiver;
   delete server;
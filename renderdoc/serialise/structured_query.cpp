@@ -0,0 +1,173 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2022 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "api/replay/renderdoc_replay.h"
+
+extern "C" RENDERDOC_API void RENDERDOC_CC RENDERDOC_QueryStructuredFile(const SDFile &file,
+                                                                         const SDQuery &query,
+                                                                         SDQueryResult &result)
+{
+  // pre-parse each path into steps of a child name and an optional array index (-1 for none). A
+  // malformed path gets no steps, so it's missing in every row.
+  struct PathStep
+  {
+    rdcstr name;
+    int32_t index;
+  };
+
+  rdcarray<rdcarray<PathStep>> steps;
+  steps.resize(query.paths.size());
+  result.columns.resize(query.paths.size());
+
+  for(size_t p = 0; p < query.paths.size(); p++)
+  {
+    result.columns[p].path = query.paths[p];
+
+    const rdcstr &path = query.paths[p];
+    bool valid = true;
+    for(int32_t start = 0, end = 0; valid && start <= path.count(); start = end + 1)
+    {
+      end = path.find('.', start);
+      if(end < 0)
+        end = path.count();
+
+      rdcstr name = path.substr(start, end - start);
+      PathStep step = {name, -1};
+
+      int32_t bracket = name.find('[');
+      if(bracket >= 0)
+      {
+        step.name = name.substr(0, bracket);
+
+        // the index must be at least one digit, closed by a ']' that ends the name
+        int32_t i = bracket + 1;
+        step.index = 0;
+        for(; i < name.count() && name[i] >= '0' && name[i] <= '9' && i - bracket <= 9; i++)
+          step.index = step.index * 10 + (name[i] - '0');
+
+        valid = i > bracket + 1 && i == name.count() - 1 && name[i] == ']';
+      }
+
+      // an empty name is only allowed when indexing directly into the parent
+      if(step.name.empty() && step.index < 0)
+        valid = false;
+      if(step.name.find(']') >= 0)
+        valid = false;
+
+      steps[p].push_back(step);
+    }
+
+    if(!valid)
+      steps[p].clear();
+  }
+
+  // all kinds of value that are stored in unsignedValues are treated as one
+  auto storage = [](SDBasic basetype) {
+    switch(basetype)
+    {
+      case SDBasic::UnsignedInteger:
+      case SDBasic::Enum:
+      case SDBasic::Boolean:
+      case SDBasic::Character:
+      case SDBasic::Resource:
+      case SDBasic::Buffer: return SDBasic::UnsignedInteger;
+      case SDBasic::SignedInteger:
+      case SDBasic::Float:
+      case SDBasic::String: return basetype;
+      default: return SDBasic::Null;
+    }
+  };
+
+  for(size_t c = query.firstChunk; c < file.chunks.size() && c <= query.lastChunk; c++)
+  {
+    const SDChunk *chunk = file.chunks[c];
+
+    if(query.chunkID != 0 && chunk->metadata.chunkID != query.chunkID)
+      continue;
+    if(!query.chunkName.empty() && chunk->name != query.chunkName)
+      continue;
+
+    const uint32_t row = (uint32_t)result.chunkIndices.size();
+    result.chunkIndices.push_back((uint32_t)c);
+
+    for(size_t p = 0; p < steps.size(); p++)
+    {
+      SDQueryColumn &col = result.columns[p];
+
+      const SDObject *o = steps[p].empty() ? NULL : chunk;
+      for(size_t st = 0; o && st < steps[p].size(); st++)
+      {
+        if(!steps[p][st].name.empty())
+          o = o->FindChild(steps[p][st].name);
+        if(o && steps[p][st].index >= 0)
+          o = o->GetChild((size_t)steps[p][st].index);
+      }
+
+      SDBasic kind = o ? storage(o->type.basetype) : SDBasic::Null;
+
+      // the first value found decides the column's type. All earlier rows were missing, so pad
+      // the values up to this row.
+      if(col.type == SDBasic::Null && kind != SDBasic::Null)
+      {
+        col.type = o->type.basetype;
+        col.unsignedValues.resize(kind == SDBasic::UnsignedInteger ? row : 0);
+        col.signedValues.resize(kind == SDBasic::SignedInteger ? row : 0);
+        col.floatValues.resize(kind == SDBasic::Float ? row : 0);
+        col.stringValues.resize(kind == SDBasic::String ? row : 0);
+      }
+
+      const SDBasic colkind = storage(col.type);
+
+      if(kind != colkind || kind == SDBasic::Null)
+      {
+        col.missingRows.push_back(row);
+        o = NULL;
+      }
+
+      if(colkind == SDBasic::UnsignedInteger)
+      {
+        uint64_t val = 0;
+        if(o && o->type.basetype == SDBasic::Boolean)
+          val = o->data.basic.b ? 1 : 0;
+        else if(o && o->type.basetype == SDBasic::Character)
+          val = (unsigned char)o->data.basic.c;
+        else if(o)
+          val = o->data.basic.u;
+        col.unsignedValues.push_back(val);
+      }
+      else if(colkind == SDBasic::SignedInteger)
+      {
+        col.signedValues.push_back(o ? o->data.basic.i : 0);
+      }
+      else if(colkind == SDBasic::Float)
+      {
+        col.floatValues.push_back(o ? o->data.basic.d : 0.0);
+      }
+      else if(colkind == SDBasic::String)
+      {
+        col.stringValues.push_back(o ? rdcstr(o->data.str) : rdcstr());
+      }
+    }
+  }
+}
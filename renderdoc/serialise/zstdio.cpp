@@ -117,6 +117,8 @@ bool ZSTDCompressor::Finish()
 
 bool ZSTDCompressor::FlushPage()
 {
+  RDCPROFILE_ZONE("Zstd compress");
+
   // if we encountered a stream error this will be NULL
   if(!m_CompressBuffer)
     return false;
@@ -298,6 +300,8 @@ bool ZSTDDecompressor::Read(void *data, uint64_t numBytes)
 
 bool ZSTDDecompressor::FillPage()
 {
+  RDCPROFILE_ZONE("Zstd decompress");
+
   uint32_t compSize = 0;
 
   bool success = true;
@@ -905,6 +905,134 @@ public:
   }
 };
 
+struct BenchmarkCommand : public Command
+{
+private:
+  uint32_t chunks = 0;
+  uint32_t buffersize = 0;
+  SectionFlags compression = SectionFlags::NoFlags;
+  uint32_t iterations = 0;
+  std::string tempdir;
+  std::string outfile;
+  bool logging = false;
+  uint32_t messages = 0;
+  bool pool = false;
+  uint32_t operations = 0;
+  uint32_t threads = 0;
+
+public:
+  BenchmarkCommand() : Command() {}
+  virtual void AddOptions(cmdline::parser &parser)
+  {
+    parser.add<uint32_t>("chunks", 'n', "The number of chunks in the synthetic capture.", false,
+                         20000);
+    parser.add<uint32_t>("buffer-size", 'b', "The size in bytes of the buffer in each chunk.",
+                         false, 4096);
+    parser.add<std::string>("compression", 'c', "The compression of the capture data.", false,
+                            "lz4", cmdline::oneof<std::string>("none", "lz4", "zstd"));
+    parser.add<uint32_t>("iterations", 'i', "The number of times to run each phase.", false, 3,
+                         cmdline::range(1, 1000));
+    parser.add<std::string>("temp-dir", '\0', "The directory to write temporary files to.", false);
+    parser.add<std::string>("output", 'o', "Write the JSON results to a file instead of stdout.",
+                            false);
+    parser.add("log", '\0', "Benchmark logging instead of capture file processing.");
+    parser.add<uint32_t>("messages", '\0', "The number of messages to log with --log.", false,
+                         100000);
+    parser.add("pool", '\0',
+               "Benchmark pooled object allocation instead of capture file processing.");
+    parser.add<uint32_t>("operations", '\0',
+                         "The number of allocations per thread with --pool.", false, 200000);
+    parser.add<uint32_t>("threads", '\0', "The number of threads to use with --log or --pool.",
+                         false, 4, cmdline::range(1, 64));
+  }
+  virtual const char *Description()
+  {
+    return "Benchmark capture file processing on a synthetic capture, logging, or pooled "
+           "allocation, reporting JSON results.";
+  }
+  virtual bool IsInternalOnly() { return false; }
+  virtual bool IsCaptureCommand() { return false; }
+  virtual bool Parse(cmdline::parser &parser, GlobalEnvironment &)
+  {
+    chunks = parser.get<uint32_t>("chunks");
+    buffersize = parser.get<uint32_t>("buffer-size");
+    iterations = parser.get<uint32_t>("iterations");
+    tempdir = parser.get<std::string>("temp-dir");
+    outfile = parser.get<std::string>("output");
+    logging = parser.exist("log");
+    messages = parser.get<uint32_t>("messages");
+    pool = parser.exist("pool");
+    operations = parser.get<uint32_t>("operations");
+    threads = parser.get<uint32_t>("threads");
+
+    std::string comp = parser.get<std::string>("compression");
+    if(comp == "lz4")
+      compression = SectionFlags::LZ4Compressed;
+    else if(comp == "zstd")
+      compression = SectionFlags::ZstdCompressed;
+
+    if(logging && messages == 0)
+    {
+      std::cerr << "Need at least one message (--messages)." << std::endl << std::endl;
+      std::cerr << parser.usage() << std::endl;
+      return false;
+    }
+
+    if(pool && operations == 0)
+    {
+      std::cerr << "Need at least one operation (--operations)." << std::endl << std::endl;
+      std::cerr << parser.usage() << std::endl;
+      return false;
+    }
+
+    if(chunks == 0)
+    {
+      std::cerr << "Need at least one chunk (-n)." << std::endl << std::endl;
+      std::cerr << parser.usage() << std::endl;
+      return false;
+    }
+
+    return true;
+  }
+
+  virtual int Execute(const CaptureOptions &)
+  {
+    rdcstr report;
+    ResultDetails result;
+    if(logging)
+      result = RENDERDOC_RunLogBenchmark(messages, threads, report);
+    else if(pool)
+      result = RENDERDOC_RunPoolBenchmark(operations, threads, report);
+    else
+      result = RENDERDOC_RunCaptureBenchmark(chunks, buffersize, compression, iterations,
+                                             conv(tempdir), report);
+
+    if(!result.OK())
+    {
+      std::cerr << "Benchmark failed: " << conv(result.Message()) << std::endl;
+      return 1;
+    }
+
+    if(outfile.empty())
+    {
+      std::cout << report.c_str();
+      return 0;
+    }
+
+    FILE *f = fopen(outfile.c_str(), "wb");
+    if(!f)
+    {
+      std::cerr << "Couldn't open '" << outfile << "' for writing." << std::endl;
+      return 1;
+    }
+
+    fwrite(report.c_str(), 1, report.size(), f);
+    fclose(f);
+
+    return 0;
+  }
+};
+
 struct CapAltBitCommand : public Command
 {
 private:
@@ -1563,6 +1691,7 @@ int renderdoccmd(GlobalEnvironment &env, std::vector<std::string> &argv)
     add_command("capaltbit", new CapAltBitCommand());
     add_command("test", new TestCommand());
     add_command("convert", new ConvertCommand());
+    add_command("benchmark", new BenchmarkCommand());
     add_command("embed", new EmbeddedSectionCommand(false));
     add_command("extract", new EmbeddedSectionCommand(true));
 
@@ -1641,6 +1770,14 @@ int renderdoccmd(GlobalEnvironment &env, std::vector<std::string> &argv)
               "Capturing Option: In D3D11, record all command lists from application start.");
     }
 
+    if(!it->second->IsCaptureCommand())
+    {
+      cmd.add<std::string>("profile-trace", 0,
+                           "Record RenderDoc's own profiling zones while running this command, and "
+                           "write them as a Chrome trace to the given file.",
+                           false);
+    }
+
     cmd.parse_check(argv, true);
 
     CaptureOptions opts;
@@ -1685,6 +1822,14 @@ int renderdoccmd(GlobalEnvironment &env, std::vector<std::string> &argv)
       return 1;
     }
 
+    if(!it->second->IsCaptureCommand())
+    {
+      std::string profileTrace = cmd.get<std::string>("profile-trace");
+      SDObject *setting = RENDERDOC_SetConfigSetting("Profiling_ChromeTracePath");
+      if(setting && !profileTrace.empty())
+        setting->data.str = profileTrace.c_str();
+    }
+
     rdcarray<rdcstr> args = convertArgs(cmd.rest());
 
     args.append(it->second->ReplayArgs());
@@ -0,0 +1,187 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2022 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "vk_test.h"
+
+RD_TEST(VK_Aliased_Image_Writes, VulkanGraphicsTest)
+{
+  static constexpr const char *Description =
+      "Binds two images to the same memory, reads one and then overwrites the other in the frame. "
+      "The read image must get its initial contents back even though it wasn't written itself.";
+
+  int main()
+  {
+    // initialise, create window, create context, etc
+    if(!Init())
+      return 3;
+
+    vkh::ImageCreateInfo imgInfo(
+        64, 64, 0, VK_FORMAT_R8G8B8A8_UNORM,
+        VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+
+    VkImage imgA = VK_NULL_HANDLE, imgB = VK_NULL_HANDLE;
+    vkCreateImage(device, imgInfo, NULL, &imgA);
+    vkCreateImage(device, imgInfo, NULL, &imgB);
+
+    setName(imgA, "Image A");
+    setName(imgB, "Image B");
+
+    const VkPhysicalDeviceMemoryProperties *props = NULL;
+    vmaGetMemoryProperties(allocator, &props);
+
+    VkMemoryRequirements mrq;
+    vkGetImageMemoryRequirements(device, imgA, &mrq);
+
+    VkMemoryAllocateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    info.allocationSize = mrq.size;
+    info.memoryTypeIndex = 100;
+
+    for(uint32_t i = 0; i < props->memoryTypeCount; i++)
+    {
+      if(mrq.memoryTypeBits & (1 << i))
+      {
+        info.memoryTypeIndex = i;
+        break;
+      }
+    }
+
+    TEST_ASSERT(info.memoryTypeIndex != 100, "Couldn't find compatible memory type");
+
+    // both images alias the whole allocation
+    VkDeviceMemory mem = VK_NULL_HANDLE;
+    vkAllocateMemory(device, &info, NULL, &mem);
+    vkBindImageMemory(device, imgA, mem, 0);
+    vkBindImageMemory(device, imgB, mem, 0);
+
+    std::vector<uint32_t> green(64 * 64, 0xff00ff00U);
+
+    AllocatedBuffer srcbuf(this,
+                           vkh::BufferCreateInfo(green.size() * sizeof(uint32_t),
+                                                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT),
+                           VmaAllocationCreateInfo({0, VMA_MEMORY_USAGE_CPU_TO_GPU}));
+
+    srcbuf.upload(green.data(), green.size() * sizeof(uint32_t));
+
+    AllocatedImage dstimg(
+        this,
+        vkh::ImageCreateInfo(1, 1, 0, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_TRANSFER_DST_BIT),
+        VmaAllocationCreateInfo({0, VMA_MEMORY_USAGE_GPU_ONLY}));
+
+    VkBufferImageCopy fill = {};
+    fill.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    fill.imageExtent = {64, 64, 1};
+
+    // fill image A before the capture, so its contents are dirty when the capture starts
+    {
+      VkCommandBuffer cmd = GetCommandBuffer();
+
+      vkBeginCommandBuffer(cmd, vkh::CommandBufferBeginInfo());
+
+      vkh::cmdPipelineBarrier(
+          cmd, {
+                   vkh::ImageMemoryBarrier(0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                           VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                                           imgA),
+                   vkh::ImageMemoryBarrier(0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                           VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                                           dstimg.image),
+               });
+
+      vkCmdCopyBufferToImage(cmd, srcbuf.buffer, imgA, VK_IMAGE_LAYOUT_GENERAL, 1, &fill);
+
+      vkEndCommandBuffer(cmd);
+
+      Submit(99, 99, {cmd});
+
+      vkDeviceWaitIdle(device);
+    }
+
+    while(Running())
+    {
+      VkCommandBuffer cmd = GetCommandBuffer();
+
+      vkBeginCommandBuffer(cmd, vkh::CommandBufferBeginInfo());
+
+      VkImage swapimg =
+          StartUsingBackbuffer(cmd, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL);
+
+      vkCmdClearColorImage(cmd, swapimg, VK_IMAGE_LAYOUT_GENERAL,
+                           vkh::ClearColorValue(0.2f, 0.2f, 0.2f, 1.0f), 1,
+                           vkh::ImageSubresourceRange());
+
+      setMarker(cmd, "Read A");
+
+      VkImageCopy region = {};
+      region.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+      region.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+      region.extent = {1, 1, 1};
+
+      vkCmdCopyImage(cmd, imgA, VK_IMAGE_LAYOUT_GENERAL, dstimg.image, VK_IMAGE_LAYOUT_GENERAL, 1,
+                     &region);
+
+      // image B takes over the memory and overwrites it, without image A being written
+      vkh::cmdPipelineBarrier(
+          cmd, {
+                   vkh::ImageMemoryBarrier(VK_ACCESS_TRANSFER_READ_BIT,
+                                           VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED,
+                                           VK_IMAGE_LAYOUT_GENERAL, imgB),
+               });
+
+      vkCmdClearColorImage(cmd, imgB, VK_IMAGE_LAYOUT_GENERAL,
+                           vkh::ClearColorValue(1.0f, 0.0f, 0.0f, 1.0f), 1,
+                           vkh::ImageSubresourceRange());
+
+      setMarker(cmd, "Written B");
+
+      // restore image A for the next frame
+      vkh::cmdPipelineBarrier(
+          cmd, {
+                   vkh::ImageMemoryBarrier(VK_ACCESS_TRANSFER_WRITE_BIT,
+                                           VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                                           VK_IMAGE_LAYOUT_GENERAL, imgA),
+               });
+
+      vkCmdCopyBufferToImage(cmd, srcbuf.buffer, imgA, VK_IMAGE_LAYOUT_GENERAL, 1, &fill);
+
+      FinishUsingBackbuffer(cmd, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL);
+
+      vkEndCommandBuffer(cmd);
+
+      Submit(0, 1, {cmd});
+
+      Present();
+    }
+
+    vkDeviceWaitIdle(device);
+
+    vkDestroyImage(device, imgA, NULL);
+    vkDestroyImage(device, imgB, NULL);
+    vkFreeMemory(device, mem, NULL);
+
+    return 0;
+  }
+};
+
+REGISTER_TEST();
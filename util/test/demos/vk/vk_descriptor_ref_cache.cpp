@@ -0,0 +1,316 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "vk_test.h"
+
+RD_TEST(VK_Descriptor_Ref_Cache, VulkanGraphicsTest)
+{
+  static constexpr const char *Description =
+      "Draws from one large descriptor set across several submits, writing and copying a few "
+      "descriptors between them and releasing buffers both bound and unbound.";
+
+  static const uint32_t NumSubmits = 8;
+  static const uint32_t NumSlots = 64;
+
+  std::string pixel = R"EOSHADER(
+#version 460 core
+
+layout(location = 0, index = 0) out vec4 Color;
+
+layout(push_constant) uniform PushData
+{
+  uint slot;
+} push;
+
+layout(set = 0, binding = 0, std140) uniform colbuf
+{
+  vec4 col;
+} cols[64];
+
+void main()
+{
+	Color = cols[push.slot].col;
+}
+
+)EOSHADER";
+
+  void Prepare(int argc, char **argv)
+  {
+    features.shaderUniformBufferArrayDynamicIndexing = VK_TRUE;
+
+    VulkanGraphicsTest::Prepare(argc, argv);
+  }
+
+  int main()
+  {
+    // initialise, create window, create context, etc
+    if(!Init())
+      return 3;
+
+    VkDescriptorSetLayout setlayout = createDescriptorSetLayout(vkh::DescriptorSetLayoutCreateInfo({
+        {0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, NumSlots, VK_SHADER_STAGE_FRAGMENT_BIT},
+    }));
+
+    VkPipelineLayout layout = createPipelineLayout(vkh::PipelineLayoutCreateInfo(
+        {setlayout}, {vkh::PushConstantRange(VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(uint32_t))}));
+
+    VkRect2D size = mainWindow->scissor;
+
+    AllocatedImage img(
+        this,
+        vkh::ImageCreateInfo(size.extent.width, size.extent.height, 0, VK_FORMAT_R8G8B8A8_UNORM,
+                             VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                                 VK_IMAGE_USAGE_TRANSFER_DST_BIT),
+        VmaAllocationCreateInfo({0, VMA_MEMORY_USAGE_GPU_ONLY}));
+
+    setName(img.image, "Target");
+
+    VkImageView imgview = createImageView(
+        vkh::ImageViewCreateInfo(img.image, VK_IMAGE_VIEW_TYPE_2D, VK_FORMAT_R8G8B8A8_UNORM));
+
+    vkh::RenderPassCreator renderPassCreateInfo;
+
+    // every submit loads what the previous ones drew
+    renderPassCreateInfo.attachments.push_back(
+        vkh::AttachmentDescription(VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_GENERAL,
+                                   VK_IMAGE_LAYOUT_GENERAL, VK_ATTACHMENT_LOAD_OP_LOAD));
+
+    renderPassCreateInfo.addSubpass({VkAttachmentReference({0, VK_IMAGE_LAYOUT_GENERAL})});
+
+    VkRenderPass renderPass = createRenderPass(renderPassCreateInfo);
+
+    VkFramebuffer framebuffer =
+        createFramebuffer(vkh::FramebufferCreateInfo(renderPass, {imgview}, size.extent));
+
+    vkh::GraphicsPipelineCreateInfo pipeCreateInfo;
+
+    pipeCreateInfo.layout = layout;
+    pipeCreateInfo.renderPass = renderPass;
+
+    pipeCreateInfo.vertexInputState.vertexBindingDescriptions = {vkh::vertexBind(0, DefaultA2V)};
+    pipeCreateInfo.vertexInputState.vertexAttributeDescriptions = {
+        vkh::vertexAttr(0, 0, DefaultA2V, pos), vkh::vertexAttr(1, 0, DefaultA2V, col),
+        vkh::vertexAttr(2, 0, DefaultA2V, uv),
+    };
+
+    pipeCreateInfo.stages = {
+        CompileShaderModule(VKDefaultVertex, ShaderLang::glsl, ShaderStage::vert, "main"),
+        CompileShaderModule(pixel, ShaderLang::glsl, ShaderStage::frag, "main"),
+    };
+
+    VkPipeline pipe = createGraphicsPipeline(pipeCreateInfo);
+
+    // one triangle per submit, each in its own column
+    std::vector<DefaultA2V> tris;
+
+    for(uint32_t i = 0; i < NumSubmits; i++)
+    {
+      float width = 1.8f / NumSubmits;
+      float left = -0.9f + width * i;
+
+      tris.push_back({Vec3f(left + width * 0.1f, 0.5f, 0.0f), Vec4f(), Vec2f(0.0f, 0.0f)});
+      tris.push_back({Vec3f(left + width * 0.5f, -0.5f, 0.0f), Vec4f(), Vec2f(0.0f, 1.0f)});
+      tris.push_back({Vec3f(left + width * 0.9f, 0.5f, 0.0f), Vec4f(), Vec2f(1.0f, 0.0f)});
+    }
+
+    AllocatedBuffer vb(
+        this, vkh::BufferCreateInfo(sizeof(DefaultA2V) * tris.size(),
+                                    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                                        VK_BUFFER_USAGE_TRANSFER_DST_BIT),
+        VmaAllocationCreateInfo({0, VMA_MEMORY_USAGE_CPU_TO_GPU}));
+
+    vb.upload(tris.data(), sizeof(DefaultA2V) * tris.size());
+
+    // every slot has its own buffer that it goes back to at the end of each frame
+    std::vector<AllocatedBuffer> colours;
+    std::vector<VkDescriptorBufferInfo> colourInfos;
+
+    for(uint32_t s = 0; s < NumSlots; s++)
+    {
+      colours.push_back(AllocatedBuffer(
+          this, vkh::BufferCreateInfo(sizeof(Vec4f), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT),
+          VmaAllocationCreateInfo({0, VMA_MEMORY_USAGE_CPU_TO_GPU})));
+
+      Vec4f col(0.1f, 0.1f, float(s) / NumSlots, 1.0f);
+      colours.back().upload(&col, sizeof(col));
+
+      colourInfos.push_back(vkh::DescriptorBufferInfo(colours.back().buffer));
+    }
+
+    VkDescriptorSet descset = allocateDescriptorSet(setlayout);
+
+    vkh::updateDescriptorSets(device, {vkh::WriteDescriptorSet(descset, 0,
+                                                               VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                                                               colourInfos)});
+
+    while(Running())
+    {
+      VkCommandBuffer cmd = GetCommandBuffer();
+
+      vkBeginCommandBuffer(cmd, vkh::CommandBufferBeginInfo());
+
+      vkh::cmdPipelineBarrier(
+          cmd, {
+                   vkh::ImageMemoryBarrier(0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                           VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                                           img.image),
+               });
+
+      vkCmdClearColorImage(cmd, img.image, VK_IMAGE_LAYOUT_GENERAL,
+                           vkh::ClearColorValue(0.2f, 0.2f, 0.2f, 1.0f), 1,
+                           vkh::ImageSubresourceRange());
+
+      vkEndCommandBuffer(cmd);
+
+      Submit(0, NumSubmits + 2, {cmd});
+
+      std::vector<AllocatedBuffer> transients;
+
+      for(uint32_t i = 0; i < NumSubmits; i++)
+      {
+        std::string name = "Submit " + std::to_string(i);
+
+        // the set can't be updated while an earlier submit is still using it
+        vkDeviceWaitIdle(device);
+
+        // a buffer that's never bound is released on every submit
+        AllocatedBuffer unbound(
+            this, vkh::BufferCreateInfo(sizeof(Vec4f), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT),
+            VmaAllocationCreateInfo({0, VMA_MEMORY_USAGE_CPU_TO_GPU}));
+        unbound.free();
+
+        transients.push_back(AllocatedBuffer(
+            this, vkh::BufferCreateInfo(sizeof(Vec4f), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT),
+            VmaAllocationCreateInfo({0, VMA_MEMORY_USAGE_CPU_TO_GPU})));
+
+        Vec4f col(1.0f, float(i) / NumSubmits, float(i % 2), 1.0f);
+        transients.back().upload(&col, sizeof(col));
+
+        // even submits write their buffer straight into their slot, odd ones write it into the last
+        // slot and copy it from there
+        if(i % 2 == 0)
+        {
+          vkh::updateDescriptorSets(
+              device, {vkh::WriteDescriptorSet(descset, 0, i, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                                               {vkh::DescriptorBufferInfo(transients[i].buffer)})});
+        }
+        else
+        {
+          VkCopyDescriptorSet copy = {
+              VK_STRUCTURE_TYPE_COPY_DESCRIPTOR_SET, NULL, descset, 0, NumSlots - 1, descset, 0, i,
+              1,
+          };
+
+          vkh::updateDescriptorSets(
+              device,
+              {vkh::WriteDescriptorSet(descset, 0, NumSlots - 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                                       {vkh::DescriptorBufferInfo(transients[i].buffer)})},
+              {copy});
+        }
+
+        // halfway through, put the first slot back and release the buffer that was bound there
+        if(i == NumSubmits / 2)
+        {
+          vkh::updateDescriptorSets(
+              device, {vkh::WriteDescriptorSet(descset, 0, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                                               {colourInfos[0]})});
+
+          transients[0].free();
+        }
+
+        cmd = GetCommandBuffer();
+
+        vkBeginCommandBuffer(cmd, vkh::CommandBufferBeginInfo());
+
+        vkh::cmdPipelineBarrier(
+            cmd,
+            {
+                vkh::ImageMemoryBarrier(
+                    VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                    VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, img.image),
+            });
+
+        vkCmdBeginRenderPass(cmd, vkh::RenderPassBeginInfo(renderPass, framebuffer, size),
+                             VK_SUBPASS_CONTENTS_INLINE);
+
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &descset, 0,
+                                NULL);
+        vkCmdPushConstants(cmd, layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(uint32_t), &i);
+        vkCmdSetViewport(cmd, 0, 1, &mainWindow->viewport);
+        vkCmdSetScissor(cmd, 0, 1, &size);
+        vkh::cmdBindVertexBuffers(cmd, 0, {vb.buffer}, {0});
+
+        setMarker(cmd, name);
+
+        vkCmdDraw(cmd, 3, 1, i * 3, 0);
+
+        vkCmdEndRenderPass(cmd);
+
+        vkEndCommandBuffer(cmd);
+
+        Submit(i + 1, NumSubmits + 2, {cmd});
+      }
+
+      cmd = GetCommandBuffer();
+
+      vkBeginCommandBuffer(cmd, vkh::CommandBufferBeginInfo());
+
+      VkImage swapimg =
+          StartUsingBackbuffer(cmd, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL);
+
+      vkh::cmdPipelineBarrier(
+          cmd, {
+                   vkh::ImageMemoryBarrier(VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                                           VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                                           VK_IMAGE_LAYOUT_GENERAL, img.image),
+               });
+
+      blitToSwap(cmd, img.image, VK_IMAGE_LAYOUT_GENERAL, swapimg, VK_IMAGE_LAYOUT_GENERAL);
+
+      FinishUsingBackbuffer(cmd, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL);
+
+      vkEndCommandBuffer(cmd);
+
+      Submit(NumSubmits + 1, NumSubmits + 2, {cmd});
+
+      Present();
+
+      vkDeviceWaitIdle(device);
+
+      // put every slot back before the rest of the transient buffers are released
+      vkh::updateDescriptorSets(device, {vkh::WriteDescriptorSet(descset, 0,
+                                                                 VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                                                                 colourInfos)});
+
+      for(uint32_t i = 1; i < NumSubmits; i++)
+        transients[i].free();
+    }
+
+    return 0;
+  }
+};
+
+REGISTER_TEST();
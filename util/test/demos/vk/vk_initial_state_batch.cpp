@@ -0,0 +1,163 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019-2022 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "vk_test.h"
+
+RD_TEST(VK_Initial_State_Batch, VulkanGraphicsTest)
+{
+  static constexpr const char *Description =
+      "Dirties more buffer and image data before the capture than fits in one batch of initial "
+      "state readbacks, so the initial contents are read back over several batches.";
+
+  int main()
+  {
+    // initialise, create window, create context, etc
+    if(!Init())
+      return 3;
+
+    // 320MB of buffers, more than the default 256MB batch
+    const int numBufs = 40;
+    const VkDeviceSize bufSize = 8 * 1024 * 1024;
+    const int numImgs = 8;
+
+    AllocatedBuffer bufs[numBufs];
+    AllocatedImage imgs[numImgs];
+
+    for(int i = 0; i < numBufs; i++)
+    {
+      bufs[i] = AllocatedBuffer(
+          this, vkh::BufferCreateInfo(bufSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                                                   VK_BUFFER_USAGE_TRANSFER_DST_BIT),
+          VmaAllocationCreateInfo({0, VMA_MEMORY_USAGE_GPU_ONLY}));
+
+      setName(bufs[i].buffer, "Buffer " + std::to_string(i));
+    }
+
+    for(int i = 0; i < numImgs; i++)
+    {
+      imgs[i] = AllocatedImage(
+          this,
+          vkh::ImageCreateInfo(64, 64, 0, VK_FORMAT_R32G32B32A32_SFLOAT,
+                               VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT),
+          VmaAllocationCreateInfo({0, VMA_MEMORY_USAGE_GPU_ONLY}));
+
+      setName(imgs[i].image, "Image " + std::to_string(i));
+    }
+
+    AllocatedBuffer dstbuf(
+        this, vkh::BufferCreateInfo(numBufs * 16, VK_BUFFER_USAGE_TRANSFER_DST_BIT),
+        VmaAllocationCreateInfo({0, VMA_MEMORY_USAGE_GPU_ONLY}));
+
+    AllocatedImage dstimg(
+        this, vkh::ImageCreateInfo(numImgs, 1, 0, VK_FORMAT_R32G32B32A32_SFLOAT,
+                                   VK_IMAGE_USAGE_TRANSFER_DST_BIT),
+        VmaAllocationCreateInfo({0, VMA_MEMORY_USAGE_GPU_ONLY}));
+
+    // fill everything once up front, so it's all dirty when the capture starts and the frame only
+    // reads it
+    {
+      VkCommandBuffer cmd = GetCommandBuffer();
+
+      vkBeginCommandBuffer(cmd, vkh::CommandBufferBeginInfo());
+
+      for(int i = 0; i < numBufs; i++)
+        vkCmdFillBuffer(cmd, bufs[i].buffer, 0, bufSize, 0x01010101U * uint32_t(i + 1));
+
+      for(int i = 0; i < numImgs; i++)
+      {
+        vkh::cmdPipelineBarrier(
+            cmd, {
+                     vkh::ImageMemoryBarrier(0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                             VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                                             imgs[i].image),
+                 });
+
+        vkCmdClearColorImage(cmd, imgs[i].image, VK_IMAGE_LAYOUT_GENERAL,
+                             vkh::ClearColorValue(float(i + 1) / numImgs, 0.5f, 0.25f, 1.0f), 1,
+                             vkh::ImageSubresourceRange());
+      }
+
+      vkh::cmdPipelineBarrier(
+          cmd, {
+                   vkh::ImageMemoryBarrier(0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                           VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                                           dstimg.image),
+               });
+
+      vkEndCommandBuffer(cmd);
+
+      Submit(99, 99, {cmd});
+
+      vkDeviceWaitIdle(device);
+    }
+
+    while(Running())
+    {
+      VkCommandBuffer cmd = GetCommandBuffer();
+
+      vkBeginCommandBuffer(cmd, vkh::CommandBufferBeginInfo());
+
+      VkImage swapimg =
+          StartUsingBackbuffer(cmd, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL);
+
+      vkCmdClearColorImage(cmd, swapimg, VK_IMAGE_LAYOUT_GENERAL,
+                           vkh::ClearColorValue(0.2f, 0.2f, 0.2f, 1.0f), 1,
+                           vkh::ImageSubresourceRange());
+
+      setMarker(cmd, "Reads");
+
+      // read from the end of every resource, so they are all referenced in the frame
+      for(int i = 0; i < numBufs; i++)
+      {
+        VkBufferCopy region = {bufSize - 16, VkDeviceSize(i) * 16, 16};
+        vkCmdCopyBuffer(cmd, bufs[i].buffer, dstbuf.buffer, 1, &region);
+      }
+
+      for(int i = 0; i < numImgs; i++)
+      {
+        VkImageCopy region = {};
+        region.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+        region.srcOffset = {63, 63, 0};
+        region.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+        region.dstOffset = {i, 0, 0};
+        region.extent = {1, 1, 1};
+
+        vkCmdCopyImage(cmd, imgs[i].image, VK_IMAGE_LAYOUT_GENERAL, dstimg.image,
+                       VK_IMAGE_LAYOUT_GENERAL, 1, &region);
+      }
+
+      FinishUsingBackbuffer(cmd, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL);
+
+      vkEndCommandBuffer(cmd);
+
+      Submit(0, 1, {cmd});
+
+      Present();
+    }
+
+    return 0;
+  }
+};
+
+REGISTER_TEST();
@@ -0,0 +1,239 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2022 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "vk_test.h"
+
+RD_TEST(VK_Submit_Navigation, VulkanGraphicsTest)
+{
+  static constexpr const char *Description =
+      "Draws one triangle per queue submit, alternating between primary and secondary command "
+      "buffers, so that replaying to each submit leaves a different result.";
+
+  static const uint32_t NumSubmits = 12;
+
+  int main()
+  {
+    // initialise, create window, create context, etc
+    if(!Init())
+      return 3;
+
+    VkPipelineLayout layout = createPipelineLayout(vkh::PipelineLayoutCreateInfo());
+
+    VkRect2D size = mainWindow->scissor;
+
+    AllocatedImage img(
+        this,
+        vkh::ImageCreateInfo(size.extent.width, size.extent.height, 0, VK_FORMAT_R8G8B8A8_UNORM,
+                             VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                                 VK_IMAGE_USAGE_TRANSFER_DST_BIT),
+        VmaAllocationCreateInfo({0, VMA_MEMORY_USAGE_GPU_ONLY}));
+
+    setName(img.image, "Target");
+
+    VkImageView imgview = createImageView(
+        vkh::ImageViewCreateInfo(img.image, VK_IMAGE_VIEW_TYPE_2D, VK_FORMAT_R8G8B8A8_UNORM));
+
+    vkh::RenderPassCreator renderPassCreateInfo;
+
+    // every submit loads what the previous ones drew
+    renderPassCreateInfo.attachments.push_back(
+        vkh::AttachmentDescription(VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_GENERAL,
+                                   VK_IMAGE_LAYOUT_GENERAL, VK_ATTACHMENT_LOAD_OP_LOAD));
+
+    renderPassCreateInfo.addSubpass({VkAttachmentReference({0, VK_IMAGE_LAYOUT_GENERAL})});
+
+    VkRenderPass renderPass = createRenderPass(renderPassCreateInfo);
+
+    VkFramebuffer framebuffer =
+        createFramebuffer(vkh::FramebufferCreateInfo(renderPass, {imgview}, size.extent));
+
+    vkh::GraphicsPipelineCreateInfo pipeCreateInfo;
+
+    pipeCreateInfo.layout = layout;
+    pipeCreateInfo.renderPass = renderPass;
+
+    pipeCreateInfo.vertexInputState.vertexBindingDescriptions = {vkh::vertexBind(0, DefaultA2V)};
+    pipeCreateInfo.vertexInputState.vertexAttributeDescriptions = {
+        vkh::vertexAttr(0, 0, DefaultA2V, pos), vkh::vertexAttr(1, 0, DefaultA2V, col),
+        vkh::vertexAttr(2, 0, DefaultA2V, uv),
+    };
+
+    pipeCreateInfo.stages = {
+        CompileShaderModule(VKDefaultVertex, ShaderLang::glsl, ShaderStage::vert, "main"),
+        CompileShaderModule(VKDefaultPixel, ShaderLang::glsl, ShaderStage::frag, "main"),
+    };
+
+    VkPipeline pipe = createGraphicsPipeline(pipeCreateInfo);
+
+    // one triangle per submit, each in its own column with its own colour
+    std::vector<DefaultA2V> tris;
+
+    for(uint32_t i = 0; i < NumSubmits; i++)
+    {
+      float width = 1.8f / NumSubmits;
+      float left = -0.9f + width * i;
+      Vec4f col(float(i + 1) / NumSubmits, float(i % 3) / 2.0f, 1.0f - float(i) / NumSubmits, 1.0f);
+
+      tris.push_back({Vec3f(left + width * 0.1f, 0.5f, 0.0f), col, Vec2f(0.0f, 0.0f)});
+      tris.push_back({Vec3f(left + width * 0.5f, -0.5f, 0.0f), col, Vec2f(0.0f, 1.0f)});
+      tris.push_back({Vec3f(left + width * 0.9f, 0.5f, 0.0f), col, Vec2f(1.0f, 0.0f)});
+    }
+
+    AllocatedBuffer vb(
+        this, vkh::BufferCreateInfo(sizeof(DefaultA2V) * tris.size(),
+                                    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                                        VK_BUFFER_USAGE_TRANSFER_DST_BIT),
+        VmaAllocationCreateInfo({0, VMA_MEMORY_USAGE_CPU_TO_GPU}));
+
+    vb.upload(tris.data(), sizeof(DefaultA2V) * tris.size());
+
+    // each submit writes its own index into its own slot of this buffer
+    AllocatedBuffer slots(
+        this, vkh::BufferCreateInfo(sizeof(Vec4u) * NumSubmits, VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                                                                    VK_BUFFER_USAGE_TRANSFER_DST_BIT),
+        VmaAllocationCreateInfo({0, VMA_MEMORY_USAGE_GPU_ONLY}));
+
+    setName(slots.buffer, "Slots");
+
+    while(Running())
+    {
+      VkCommandBuffer cmd = GetCommandBuffer();
+
+      vkBeginCommandBuffer(cmd, vkh::CommandBufferBeginInfo());
+
+      pushMarker(cmd, "Reset");
+
+      vkh::cmdPipelineBarrier(
+          cmd, {
+                   vkh::ImageMemoryBarrier(0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                           VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                                           img.image),
+               });
+
+      vkCmdClearColorImage(cmd, img.image, VK_IMAGE_LAYOUT_GENERAL,
+                           vkh::ClearColorValue(0.2f, 0.2f, 0.2f, 1.0f), 1,
+                           vkh::ImageSubresourceRange());
+
+      vkCmdFillBuffer(cmd, slots.buffer, 0, VK_WHOLE_SIZE, 0);
+
+      popMarker(cmd);
+
+      vkEndCommandBuffer(cmd);
+
+      Submit(0, NumSubmits + 2, {cmd});
+
+      for(uint32_t i = 0; i < NumSubmits; i++)
+      {
+        std::string name = "Submit " + std::to_string(i);
+
+        cmd = GetCommandBuffer();
+
+        vkBeginCommandBuffer(cmd, vkh::CommandBufferBeginInfo());
+
+        Vec4u slot(i + 1, i * 3, i * 5, 0xcafe0000 + i);
+        vkCmdUpdateBuffer(cmd, slots.buffer, sizeof(Vec4u) * i, sizeof(Vec4u), &slot);
+
+        vkh::cmdPipelineBarrier(
+            cmd,
+            {
+                vkh::ImageMemoryBarrier(
+                    VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                    VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, img.image),
+            });
+
+        // odd submits draw from a secondary command buffer, even ones draw inline
+        bool secondary = (i % 2) == 1;
+
+        vkCmdBeginRenderPass(cmd, vkh::RenderPassBeginInfo(renderPass, framebuffer, size),
+                             secondary ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+                                       : VK_SUBPASS_CONTENTS_INLINE);
+
+        VkCommandBuffer drawcmd = cmd;
+        std::vector<VkCommandBuffer> seccmds;
+
+        if(secondary)
+        {
+          drawcmd = GetCommandBuffer(VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+          seccmds.push_back(drawcmd);
+
+          vkBeginCommandBuffer(
+              drawcmd,
+              vkh::CommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+                                          vkh::CommandBufferInheritanceInfo(renderPass, 0)));
+        }
+
+        vkCmdBindPipeline(drawcmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe);
+        vkCmdSetViewport(drawcmd, 0, 1, &mainWindow->viewport);
+        vkCmdSetScissor(drawcmd, 0, 1, &size);
+        vkh::cmdBindVertexBuffers(drawcmd, 0, {vb.buffer}, {0});
+
+        setMarker(drawcmd, name);
+
+        vkCmdDraw(drawcmd, 3, 1, i * 3, 0);
+
+        if(secondary)
+        {
+          vkEndCommandBuffer(drawcmd);
+
+          vkCmdExecuteCommands(cmd, 1, &drawcmd);
+        }
+
+        vkCmdEndRenderPass(cmd);
+
+        vkEndCommandBuffer(cmd);
+
+        Submit(i + 1, NumSubmits + 2, {cmd}, seccmds);
+      }
+
+      cmd = GetCommandBuffer();
+
+      vkBeginCommandBuffer(cmd, vkh::CommandBufferBeginInfo());
+
+      VkImage swapimg =
+          StartUsingBackbuffer(cmd, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL);
+
+      vkh::cmdPipelineBarrier(
+          cmd, {
+                   vkh::ImageMemoryBarrier(VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                                           VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL,
+                                           VK_IMAGE_LAYOUT_GENERAL, img.image),
+               });
+
+      blitToSwap(cmd, img.image, VK_IMAGE_LAYOUT_GENERAL, swapimg, VK_IMAGE_LAYOUT_GENERAL);
+
+      FinishUsingBackbuffer(cmd, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL);
+
+      vkEndCommandBuffer(cmd);
+
+      Submit(NumSubmits + 1, NumSubmits + 2, {cmd});
+
+      Present();
+    }
+
+    return 0;
+  }
+};
+
+REGISTER_TEST();
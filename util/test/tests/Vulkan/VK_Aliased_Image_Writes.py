@@ -0,0 +1,34 @@
+import rdtest
+import renderdoc as rd
+
+
+class VK_Aliased_Image_Writes(rdtest.TestCase):
+    demos_test_name = 'VK_Aliased_Image_Writes'
+
+    def check_capture(self):
+        read_a = self.find_action("Read A")
+        written_b = self.find_action("Written B")
+
+        self.check(read_a is not None and written_b is not None)
+
+        img_a = self.get_resource_by_name("Image A").resourceId
+        img_b = self.get_resource_by_name("Image B").resourceId
+
+        self.controller.SetFrameEvent(read_a.eventId, False)
+
+        self.check_pixel_value(img_a, 0, 0, [0.0, 1.0, 0.0, 1.0])
+
+        rdtest.log.success("Image A has its initial contents")
+
+        # image B overwrites the memory both images are bound to
+        self.controller.SetFrameEvent(written_b.eventId, False)
+
+        self.check_pixel_value(img_b, 0, 0, [1.0, 0.0, 0.0, 1.0])
+
+        # going back must restore image A, even though only image B was written
+        self.controller.SetFrameEvent(read_a.eventId, False)
+
+        self.check_pixel_value(img_a, 0, 0, [0.0, 1.0, 0.0, 1.0])
+        self.check_pixel_value(img_a, 63, 63, [0.0, 1.0, 0.0, 1.0])
+
+        rdtest.log.success("Image A is restored after the aliased image is written")
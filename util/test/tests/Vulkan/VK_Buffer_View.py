@@ -0,0 +1,59 @@
+import sys
+import renderdoc as rd
+import rdtest
+
+
+class VK_Buffer_View(rdtest.TestCase):
+    demos_test_name = 'VK_Simple_Triangle'
+
+    def check_capture(self):
+        action = self.find_action("Draw")
+
+        self.controller.SetFrameEvent(action.eventId, False)
+
+        # The zero-copy views must see the same contents as the copying functions
+        for res in self.controller.GetResources():
+            res: rd.ResourceDescription
+
+            buf_data = self.controller.GetBufferData(res.resourceId, 0, 0)
+            tex_data = self.controller.GetTextureData(res.resourceId, rd.Subresource())
+
+            buf_view: rd.BufferView = self.controller.GetBufferDataView(res.resourceId, 0, 0)
+            tex_view: rd.BufferView = self.controller.GetTextureDataView(res.resourceId, rd.Subresource())
+
+            if bytes(buf_view) != buf_data or bytes(tex_view) != tex_data:
+                raise rdtest.TestFailureException("View of {} doesn't match its data".format(res.name))
+
+            if len(buf_data) >= 16:
+                typed = buf_view.Typed('<I', stride=8, offset=4)
+                expected = b''.join(buf_data[4 + 8 * i:8 + 8 * i] for i in range(typed.count))
+                if bytes(typed) != expected:
+                    raise rdtest.TestFailureException("Typed view of {} doesn't match".format(res.name))
+
+        rdtest.log.success("Buffer and texture views match their data")
+
+        sdfile: rd.SDFile = self.controller.GetStructuredFile()
+
+        if len(sdfile.buffers) == 0:
+            raise rdtest.TestFailureException("Structured file has no buffers")
+
+        # a borrowed view must keep the file it was taken from alive
+        refs = sys.getrefcount(sdfile)
+        view: rd.BufferView = sdfile.GetBufferView(0)
+        typed: rd.BufferView = view.Typed('B')
+        expected = bytes(view)
+
+        if sys.getrefcount(sdfile) != refs + 1:
+            raise rdtest.TestFailureException("Buffer view doesn't reference the structured file")
+
+        del sdfile
+
+        if bytes(view) != expected or bytes(typed) != expected:
+            raise rdtest.TestFailureException("Borrowed view doesn't match the structured buffer")
+
+        del view
+
+        if bytes(typed) != expected:
+            raise rdtest.TestFailureException("Typed view doesn't outlive the view it was created from")
+
+        rdtest.log.success("Structured buffer views keep their owner alive")
@@ -0,0 +1,81 @@
+import os
+import renderdoc as rd
+import rdtest
+
+
+class VK_Descriptor_Ref_Cache(rdtest.TestCase):
+    demos_test_name = 'VK_Descriptor_Ref_Cache'
+
+    NUM_SUBMITS = 8
+
+    def run(self):
+        # The setting is read by the captured program, so it has to be saved before each run
+        setting = rd.SetConfigSetting('Vulkan_Debug_CacheDescriptorBindRefs')
+        old = setting.AsBool()
+
+        results = []
+
+        try:
+            for cached in [True, False]:
+                setting.data.basic.b = cached
+                rd.SaveConfigSettings()
+
+                rdtest.log.print("Capturing with cached descriptor references {}".format(
+                    "enabled" if cached else "disabled"))
+
+                results.append(self.capture_and_check())
+        finally:
+            setting.data.basic.b = old
+            rd.SaveConfigSettings()
+
+        cached, uncached = results
+
+        if cached[0] != uncached[0]:
+            raise rdtest.TestFailureException(
+                "Capture has {} resources with cached descriptor references, {} without".format(
+                    cached[0], uncached[0]))
+
+        for i in range(self.NUM_SUBMITS):
+            if cached[1][i] != uncached[1][i]:
+                raise rdtest.TestFailureException(
+                    "Target after submit {} differs with cached descriptor references".format(i))
+
+        rdtest.log.success("Captures match with and without cached descriptor references")
+
+    def capture_and_check(self):
+        self.capture_filename = self.get_capture()
+
+        self.check(os.path.exists(self.capture_filename), "Didn't generate capture in make_capture")
+
+        rdtest.log.print("Loading capture")
+
+        self.controller = rdtest.open_capture(self.capture_filename, opts=self.get_replay_options())
+        self.sdfile = self.controller.GetStructuredFile()
+
+        target = self.get_resource_by_name("Target").resourceId
+        tex: rd.TextureDescription = self.get_texture(target)
+
+        data = []
+
+        for i in range(self.NUM_SUBMITS):
+            marker = self.find_action("Submit {}".format(i))
+            self.check(marker is not None and marker.next is not None)
+
+            self.controller.SetFrameEvent(marker.next.eventId, True)
+
+            # Each submit draws in its own column from the buffer written into its slot just before
+            x = int(tex.width * (0.05 + 0.9 * (i + 0.5) / self.NUM_SUBMITS))
+            y = int(tex.height / 2)
+
+            self.check_pixel_value(target, x, y, [1.0, i / self.NUM_SUBMITS, float(i % 2), 1.0])
+
+            data.append(self.controller.GetTextureData(target, rd.Subresource()))
+
+        rdtest.log.success("Every submit drew from the right buffer")
+
+        ret = (len(self.controller.GetResources()), data)
+
+        self.controller.Shutdown()
+        self.controller = None
+
+        return ret
@@ -0,0 +1,42 @@
+import struct
+import rdtest
+import renderdoc as rd
+
+
+class VK_Initial_State_Batch(rdtest.TestCase):
+    demos_test_name = 'VK_Initial_State_Batch'
+
+    def check_capture(self):
+        action = self.find_action("Reads")
+
+        self.check(action is not None)
+
+        self.controller.SetFrameEvent(action.eventId, False)
+
+        num_bufs = 40
+        buf_size = 8 * 1024 * 1024
+
+        # every buffer was read back in one of several batches at the start of the capture, check the
+        # start, middle and end of each
+        for i in range(num_bufs):
+            buf = self.get_resource_by_name("Buffer {}".format(i)).resourceId
+
+            expected = bytes([i + 1] * 16)
+
+            for offs in [0, buf_size // 2, buf_size - 16]:
+                data = self.controller.GetBufferData(buf, offs, 16)
+                if data != expected:
+                    raise rdtest.TestFailureException(
+                        "Buffer {} at {} has {} instead of {}".format(i, offs, data.hex(), expected.hex()))
+
+        rdtest.log.success("Buffer initial contents are correct")
+
+        num_imgs = 8
+
+        for i in range(num_imgs):
+            img = self.get_resource_by_name("Image {}".format(i)).resourceId
+
+            self.check_pixel_value(img, 0, 0, [(i + 1) / num_imgs, 0.5, 0.25, 1.0])
+            self.check_pixel_value(img, 63, 63, [(i + 1) / num_imgs, 0.5, 0.25, 1.0])
+
+        rdtest.log.success("Image initial contents are correct")
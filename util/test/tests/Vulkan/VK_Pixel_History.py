@@ -21,6 +21,11 @@ def pre_mod_depth(x): return x.preMod.depth
 def post_mod_depth(x): return x.postMod.depth
 def primitive_id(x): return x.primitiveID
 def unboundPS(x): return x.unboundPS
+def frag_index(x): return x.fragIndex
+def sample_masked(x): return x.sampleMasked
+def direct_shader_write(x): return x.directShaderWrite
+def pre_mod_stencil(x): return x.preMod.stencil
+def post_mod_stencil(x): return x.postMod.stencil
 
 class VK_Pixel_History(rdtest.TestCase):
     demos_test_name = 'VK_Pixel_History'
@@ -223,6 +228,9 @@ class VK_Pixel_History(rdtest.TestCase):
         self.check_events(events, modifs, False)
         self.check_pixel_value(tex, x, y, value_selector(modifs[-1].postMod.col), sub=sub, cast=rt.typeCast)
 
+        self.check_batch(tex, [(190, 149), (190, 150), (200, 50), (150, 250), (330, 145), (340, 145), (330, 105),
+                               (320, 105), (345, 105), (100, 250), (275, 260), (0, 0)], sub, rt.typeCast)
+
     def multisampled_image_test(self):
         test_marker: rd.ActionDescription = self.find_action("Multisampled: test")
         action_eid = test_marker.next.eventId
@@ -283,6 +291,8 @@ class VK_Pixel_History(rdtest.TestCase):
 
         self.check_events(events, modifs, True)
 
+        self.check_batch(tex, [(x, y), (x + 1, y), (x, y + 10), (10, 10)], sub, rt.typeCast)
+
         if self.is_depth:
             self.check_pixel_value(tex, x, y,
                                    [modifs[-1].postMod.depth, float(modifs[-1].postMod.stencil) / 255.0, 0.0, 1.0],
@@ -346,6 +356,9 @@ class VK_Pixel_History(rdtest.TestCase):
         self.check_events(events, modifs, True)
         self.check_pixel_value(tex, x, y, value_selector(modifs[-1].postMod.col), sub=sub, cast=rt.typeCast)
 
+        self.controller.SetFrameEvent(sec_red_and_blue, True)
+        self.check_batch(tex, [(70, 40), (40, 40), (5, 5)], sub, rt.typeCast)
+
     def depth_target_test(self):
         test_marker: rd.ActionDescription = self.find_action("Test Begin")
         self.controller.SetFrameEvent(test_marker.next.eventId, True)
@@ -379,6 +392,40 @@ class VK_Pixel_History(rdtest.TestCase):
         self.check_events(events, modifs, False)
 
 
+    # Fetch the history of several pixels in one batch, and check each pixel's history is identical
+    # to fetching it on its own
+    def check_batch(self, tex, pixels, sub, cast):
+        rdtest.log.print("Testing batch of {} pixels".format(len(pixels)))
+        results: List[rd.PixelHistoryResult] = self.controller.PixelHistoryBatch(tex, pixels, sub, cast)
+
+        self.check(len(results) == len(pixels), "Expected {} results, got {}".format(len(pixels), len(results)))
+
+        selectors = [event_id, frag_index, primitive_id, passed, culled, depth_test_failed, depth_clipped,
+                     depth_bounds_failed, scissor_clipped, stencil_test_failed, shader_discarded, sample_masked,
+                     unboundPS, direct_shader_write, pre_mod_col, post_mod_col, shader_out_col, pre_mod_depth,
+                     post_mod_depth, shader_out_depth, pre_mod_stencil, post_mod_stencil]
+
+        for (x, y), result in zip(pixels, results):
+            self.check((result.x, result.y) == (x, y),
+                       "Batch result for {}, {} is for {}, {}".format(x, y, result.x, result.y))
+
+            single: List[rd.PixelModification] = self.controller.PixelHistory(tex, x, y, sub, cast)
+            batch: List[rd.PixelModification] = result.modifications
+
+            self.check(len(batch) == len(single),
+                       "Pixel {}, {} has {} modifications in a batch, {} on its own".format(x, y, len(batch),
+                                                                                        len(single)))
+
+            for a, b in zip(batch, single):
+                for sel in selectors:
+                    if not rdtest.value_compare(sel(a), sel(b)):
+                        raise rdtest.TestFailureException(
+                            "Pixel {}, {} eventId {}: {} is {} in a batch, {} on its own".format(x, y, b.eventId,
+                                                                                           sel.__name__, sel(a),
+                                                                                           sel(b)))
+
+        rdtest.log.success("Batch of {} pixels matched single pixel history".format(len(pixels)))
+
     def check_events(self, events, modifs, hasSecondary):
         self.check(len(modifs) == len(events), "Expected {} events, got {}".format(len(events), len(modifs)))
         # Check for consistency first. For secondary command buffers,
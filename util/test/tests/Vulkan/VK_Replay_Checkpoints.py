@@ -0,0 +1,119 @@
+import math
+import os
+import re
+import struct
+import time
+import renderdoc as rd
+import rdtest
+
+
+class VK_Replay_Checkpoints(rdtest.TestCase):
+    demos_test_name = 'VK_Submit_Navigation'
+
+    NUM_SUBMITS = 12
+
+    def check_capture(self):
+        self.target = self.get_resource_by_name("Target").resourceId
+        self.slots = self.get_resource_by_name("Slots").resourceId
+        self.tex: rd.TextureDescription = self.get_texture(self.target)
+
+        self.draws = []
+        for i in range(self.NUM_SUBMITS):
+            marker = self.find_action("Submit {}".format(i))
+            self.check(marker is not None and marker.next is not None)
+            self.draws.append(marker.next.eventId)
+
+        # Visit the later submits forward then backward, so checkpoints are both taken and restored
+        late = list(range(self.NUM_SUBMITS // 2, self.NUM_SUBMITS))
+        order = late + list(reversed(late))
+
+        logfile = rd.GetLogFile()
+        self.log_start = os.path.getsize(logfile) if os.path.exists(logfile) else 0
+
+        enabled = rd.SetConfigSetting('Vulkan_ReplayCheckpoints')
+        interval = rd.SetConfigSetting('Vulkan_ReplayCheckpointInterval')
+        budget = rd.SetConfigSetting('Vulkan_ReplayCheckpointBudgetMB')
+        old = (enabled.data.basic.b, interval.data.basic.u, budget.data.basic.u)
+
+        try:
+            enabled.data.basic.b = False
+            baseline = self.navigate(order)
+
+            # A checkpoint at every submit, and take the first one so we know how big each one is
+            enabled.data.basic.b = True
+            interval.data.basic.u = 1
+            self.navigate([1])
+
+            took = self.find_log(r"Took replay checkpoint at \d+: (\d+) bytes")
+            if len(took) == 0:
+                raise rdtest.TestFailureException("No replay checkpoint was taken")
+
+            # Only leave room for two checkpoints, so navigating across the later submits evicts some
+            size = int(took[0].group(1))
+            budget.data.basic.u = max(1, math.ceil(size * 2.5 / (1024 * 1024)))
+
+            rdtest.log.print("Checkpoints are {} bytes, budget is {} MB".format(size, budget.data.basic.u))
+
+            checkpointed = self.navigate(order)
+        finally:
+            enabled.data.basic.b, interval.data.basic.u, budget.data.basic.u = old
+
+        for n, submit in enumerate(order):
+            if baseline[n] != checkpointed[n]:
+                raise rdtest.TestFailureException(
+                    "Readback at submit {} differs when replaying from checkpoints".format(submit))
+
+        rdtest.log.success("Readback matches with and without replay checkpoints")
+
+        if len(self.find_log(r"Replay to \d+ took [\d.]+ ms from the checkpoint at \d+")) == 0:
+            raise rdtest.TestFailureException("No replay started from a checkpoint")
+
+        if len(self.find_log(r"Evicted replay checkpoint at \d+")) == 0:
+            raise rdtest.TestFailureException("No replay checkpoint was evicted to stay within budget")
+
+        rdtest.log.success("Checkpoints were restored and evicted to stay within budget")
+
+    def navigate(self, order):
+        ret = []
+
+        for submit in order:
+            self.controller.SetFrameEvent(self.draws[submit], True)
+
+            self.check_expected(submit)
+
+            ret.append((self.controller.GetTextureData(self.target, rd.Subresource()),
+                        self.controller.GetBufferData(self.slots, 0, 0)))
+
+        return ret
+
+    def check_expected(self, submit: int):
+        data = self.controller.GetBufferData(self.slots, 0, 0)
+
+        for i in range(self.NUM_SUBMITS):
+            slot = struct.unpack_from("4I", data, 16 * i)
+            expected = (i + 1, i * 3, i * 5, 0xcafe0000 + i) if i <= submit else (0, 0, 0, 0)
+
+            if slot != expected:
+                raise rdtest.TestFailureException(
+                    "Slot {} at submit {} is {}, expected {}".format(i, submit, slot, expected))
+
+        for i in range(self.NUM_SUBMITS):
+            x = int(self.tex.width * (0.05 + 0.9 * (i + 0.5) / self.NUM_SUBMITS))
+            y = int(self.tex.height / 2)
+
+            if i <= submit:
+                n = self.NUM_SUBMITS
+                expected = [(i + 1) / n, (i % 3) / 2.0, 1.0 - i / n, 1.0]
+            else:
+                expected = [0.2, 0.2, 0.2, 1.0]
+
+            self.check_pixel_value(self.target, x, y, expected)
+
+    # Search the log written since the test started. Messages are flushed to the file in the
+    # background, so give that a moment first
+    def find_log(self, pattern: str):
+        time.sleep(0.5)
+
+        with open(rd.GetLogFile(), 'rb') as f:
+            f.seek(self.log_start)
+            return list(re.finditer(pattern, f.read().decode('utf-8', errors='replace')))
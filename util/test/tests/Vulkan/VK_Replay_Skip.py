@@ -0,0 +1,85 @@
+import struct
+import renderdoc as rd
+import rdtest
+
+
+class VK_Replay_Skip(rdtest.TestCase):
+    demos_test_name = 'VK_Submit_Navigation'
+
+    NUM_SUBMITS = 12
+
+    def check_capture(self):
+        self.target = self.get_resource_by_name("Target").resourceId
+        self.slots = self.get_resource_by_name("Slots").resourceId
+        self.tex: rd.TextureDescription = self.get_texture(self.target)
+
+        # Each submit has a marker then a draw. Odd submits draw from a secondary command buffer, so
+        # stopping on either event there partially replays the secondary
+        self.events = []
+        for i in range(self.NUM_SUBMITS):
+            marker = self.find_action("Submit {}".format(i))
+            self.check(marker is not None and marker.next is not None)
+            self.events.append((i, False, marker.eventId))
+            self.events.append((i, True, marker.next.eventId))
+
+        # Forward through every submit, back again, then jump back and forth across several submits
+        # at a time
+        order = self.events + list(reversed(self.events))
+        order += [self.events[e] for e in [21, 2, 17, 6, 23, 0, 13, 8]]
+
+        setting = rd.SetConfigSetting('Vulkan_SkipNoOpReplayChunks')
+        old = setting.AsBool()
+
+        try:
+            setting.data.basic.b = True
+            skipped = self.navigate(order)
+
+            setting.data.basic.b = False
+            replayed = self.navigate(order)
+        finally:
+            setting.data.basic.b = old
+
+        for n, (submit, drawn, eid) in enumerate(order):
+            if skipped[n] != replayed[n]:
+                raise rdtest.TestFailureException(
+                    "Readback at event {} (submit {}) differs with chunk skipping enabled".format(eid, submit))
+
+        rdtest.log.success("Readback matches with and without chunk skipping")
+
+    def navigate(self, order):
+        ret = []
+
+        for submit, drawn, eid in order:
+            self.controller.SetFrameEvent(eid, True)
+
+            self.check_expected(submit, drawn, eid)
+
+            ret.append((self.controller.GetTextureData(self.target, rd.Subresource()),
+                        self.controller.GetBufferData(self.slots, 0, 0)))
+
+        return ret
+
+    def check_expected(self, submit: int, drawn: bool, eid: int):
+        # The slot for the current submit is written before its render pass begins
+        data = self.controller.GetBufferData(self.slots, 0, 0)
+
+        for i in range(self.NUM_SUBMITS):
+            slot = struct.unpack_from("4I", data, 16 * i)
+            expected = (i + 1, i * 3, i * 5, 0xcafe0000 + i) if i <= submit else (0, 0, 0, 0)
+
+            if slot != expected:
+                raise rdtest.TestFailureException(
+                    "Slot {} at event {} is {}, expected {}".format(i, eid, slot, expected))
+
+        # Each submit's triangle covers the middle of its own column
+        for i in range(self.NUM_SUBMITS):
+            x = int(self.tex.width * (0.05 + 0.9 * (i + 0.5) / self.NUM_SUBMITS))
+            y = int(self.tex.height / 2)
+
+            if i < submit or (i == submit and drawn):
+                n = self.NUM_SUBMITS
+                expected = [(i + 1) / n, (i % 3) / 2.0, 1.0 - i / n, 1.0]
+            else:
+                expected = [0.2, 0.2, 0.2, 1.0]
+
+            self.check_pixel_value(self.target, x, y, expected)
@@ -25,6 +25,8 @@ class VK_Shader_Debug_Zoo(rdtest.TestCase):
                     rdtest.log.print("Skipping undebuggable shader at {} in {}.".format(child, test_name))
                     return
 
+                singles = []
+
                 for test in range(section.numInstances):
                     x = 4 * test + 1
                     y = 4 * child + 1
@@ -41,6 +43,8 @@ class VK_Shader_Debug_Zoo(rdtest.TestCase):
 
                     cycles, variables = self.process_trace(trace)
 
+                    singles.append((test, x, y, cycles, variables))
+
                     output: rd.SourceVariableMapping = self.find_output_source_var(trace, rd.ShaderBuiltin.ColorOutput, 0)
 
                     debugged = self.evaluate_source_var(output, variables)
@@ -55,9 +59,79 @@ class VK_Shader_Debug_Zoo(rdtest.TestCase):
                         self.controller.FreeTrace(trace)
 
                     rdtest.log.success("Test {} in sub-section {} matched as expected".format(test, child))
+
+                if not self.check_batch(child, singles):
+                    failed = True
             rdtest.log.end_section(test_name)
 
         if failed:
             raise rdtest.TestFailureException("Some tests were not as expected")
 
         rdtest.log.success("All tests matched")
+
+    # Debug the same pixels again as one batch, and check each invocation finishes with the same
+    # output values after the same number of steps as when it was debugged on its own
+    def check_batch(self, child: int, singles):
+        pixels = [rd.DebugPixelInvocation(x, y, rd.ReplayController.NoPreference,
+                                          rd.ReplayController.NoPreference) for _, x, y, _, _ in singles]
+
+        results: List[rd.ShaderDebugResult] = self.controller.DebugPixelBatch(pixels, [])
+
+        if len(results) != len(singles):
+            rdtest.log.error("Batch in sub-section {} returned {} results for {} pixels"
+                             .format(child, len(results), len(singles)))
+            return False
+
+        ok = True
+
+        for (test, x, y, cycles, variables), result in zip(singles, results):
+            if not result.valid:
+                rdtest.log.error("Test {} in sub-section {} did not debug in a batch".format(test, child))
+                ok = False
+                continue
+
+            if result.stepCount != cycles:
+                rdtest.log.error("Test {} in sub-section {} took {} steps in a batch, {} on its own"
+                                 .format(test, child, result.stepCount, cycles))
+                ok = False
+
+            if len(result.variables) == 0:
+                rdtest.log.error("Test {} in sub-section {} returned no output variables in a batch"
+                                 .format(test, child))
+                ok = False
+
+            for var in result.variables:
+                single = None
+                for v in variables.values():
+                    single = single or self.find_debug_var(v, var.name)
+
+                if single is None or var.value.u32v != single.value.u32v:
+                    rdtest.log.error("Test {} in sub-section {} output {} differs in a batch"
+                                     .format(test, child, var.name))
+                    ok = False
+
+        if ok:
+            rdtest.log.success("Batch in sub-section {} matched single debugging".format(child))
+
+        return ok
+
+    # Find a variable or one of its members by the path a batch debug names it with
+    def find_debug_var(self, var: rd.ShaderVariable, path: str):
+        if var.name == path:
+            return var
+
+        if not path.startswith(var.name) or len(path) <= len(var.name):
+            return None
+
+        rest = path[len(var.name):]
+        if rest[0] == '.':
+            rest = rest[1:]
+        elif rest[0] != '[':
+            return None
+
+        for member in var.members:
+            found = self.find_debug_var(member, rest)
+            if found is not None:
+                return found
+
+        return None